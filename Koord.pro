@@ -338,6 +338,7 @@ HEADERS += src/buffer.h \
     src/channel.h \
     src/global.h \
     src/kdsingleapplication.h \
+    src/packettrace.h \
     src/protocol.h \
     src/recorder/jamcontroller.h \
     src/threadpool.h \
@@ -346,8 +347,12 @@ HEADERS += src/buffer.h \
     src/serverlogging.h \
     src/settings.h \
     src/socket.h \
+    src/traceevents.h \
     src/util.h \
     src/recorder/jamrecorder.h \
+    src/recorder/caudioframering.h \
+    src/recorder/cflacstream.h \
+    src/recorder/coggopusstream.h \
     src/recorder/creaperproject.h \
     src/recorder/cwavestream.h \
     src/signalhandler.h \
@@ -448,6 +453,7 @@ SOURCES += src/buffer.cpp \
     src/kdapplication.cpp \
     src/kdsingleapplication.cpp \
     src/main.cpp \
+    src/packettrace.cpp \
     src/protocol.cpp \
     src/recorder/jamcontroller.cpp \
     src/server.cpp \
@@ -456,8 +462,12 @@ SOURCES += src/buffer.cpp \
     src/settings.cpp \
     src/signalhandler.cpp \
     src/socket.cpp \
+    src/traceevents.cpp \
     src/util.cpp \
     src/recorder/jamrecorder.cpp \
+    src/recorder/caudioframering.cpp \
+    src/recorder/cflacstream.cpp \
+    src/recorder/coggopusstream.cpp \
     src/recorder/creaperproject.cpp \
     src/recorder/cwavestream.cpp \
     src/urlhandler.cpp \
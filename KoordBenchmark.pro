@@ -0,0 +1,42 @@
+# micro-benchmarks of the real time critical code paths, builds headless
+# without audio backends and Opus:
+#   qmake KoordBenchmark.pro && make && ./KoordBenchmark --output results.json
+
+VERSION = $$fromfile(Koord.pro, VERSION)
+
+TARGET = KoordBenchmark
+
+CONFIG += console \
+    c++11
+
+CONFIG -= app_bundle
+
+QT = core \
+    network
+
+INCLUDEPATH += src
+
+DEFINES += APP_VERSION=\\\"$$VERSION\\\" \
+    HEADLESS \
+    SERVER_ONLY \
+    _REENTRANT
+
+DEFINES += QT_NO_DEPRECATED_WARNINGS
+
+win32 {
+    DEFINES += NOMINMAX
+    LIBS += winmm.lib \
+        ws2_32.lib
+}
+
+HEADERS += src/buffer.h \
+    src/global.h \
+    src/protocol.h \
+    src/traceevents.h \
+    src/util.h
+
+SOURCES += src/benchmark/benchmark.cpp \
+    src/buffer.cpp \
+    src/protocol.cpp \
+    src/traceevents.cpp \
+    src/util.cpp
@@ -0,0 +1,42 @@
+# libFuzzer target of the protocol message parsing, builds headless with clang
+# (the CRC of the protocol frames is not checked in this build):
+#   qmake -spec linux-clang KoordFuzz.pro && make && ./KoordFuzz -max_len=20000 corpus
+
+VERSION = $$fromfile(Koord.pro, VERSION)
+
+TARGET = KoordFuzz
+
+CONFIG += console \
+    c++11
+
+CONFIG -= app_bundle
+
+QT = core \
+    network
+
+INCLUDEPATH += src
+
+DEFINES += APP_VERSION=\\\"$$VERSION\\\" \
+    HEADLESS \
+    SERVER_ONLY \
+    FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION \
+    _REENTRANT
+
+DEFINES += QT_NO_DEPRECATED_WARNINGS
+
+QMAKE_CXXFLAGS += -g \
+    -fsanitize=fuzzer,address,undefined
+
+QMAKE_LFLAGS += -fsanitize=fuzzer,address,undefined
+
+HEADERS += src/buffer.h \
+    src/global.h \
+    src/protocol.h \
+    src/traceevents.h \
+    src/util.h
+
+SOURCES += src/fuzz/protocolfuzzer.cpp \
+    src/buffer.cpp \
+    src/protocol.cpp \
+    src/traceevents.cpp \
+    src/util.cpp
@@ -0,0 +1,46 @@
+# tests of the recorder file formats and of the network statistics, builds
+# headless without audio backends and Opus (if the flac command line tool is
+# installed, the encoded streams are also checked with "flac -t"):
+#   qmake KoordTest.pro && make && ./KoordTest
+
+VERSION = $$fromfile(Koord.pro, VERSION)
+
+TARGET = KoordTest
+
+CONFIG += console \
+    c++11
+
+CONFIG -= app_bundle
+
+QT = core \
+    network
+
+INCLUDEPATH += src
+
+DEFINES += APP_VERSION=\\\"$$VERSION\\\" \
+    HEADLESS \
+    SERVER_ONLY \
+    _REENTRANT
+
+DEFINES += QT_NO_DEPRECATED_WARNINGS
+
+win32 {
+    DEFINES += NOMINMAX
+    LIBS += winmm.lib \
+        ws2_32.lib
+}
+
+HEADERS += src/buffer.h \
+    src/global.h \
+    src/recorder/cflacstream.h \
+    src/test/tests.h \
+    src/traceevents.h \
+    src/util.h
+
+SOURCES += src/test/main.cpp \
+    src/test/flacstreamtest.cpp \
+    src/test/netstatstest.cpp \
+    src/buffer.cpp \
+    src/recorder/cflacstream.cpp \
+    src/traceevents.cpp \
+    src/util.cpp
@@ -0,0 +1,426 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+   Micro-benchmarks of the real time critical code paths. All input data is
+   generated with a fixed seed so that the runs are repeatable. Each benchmark
+   is run a number of times and the minimum, median and maximum time per
+   operation is written as JSON (to stdout or the given file) for trend tracking.
+
+   Build and run headless:
+       qmake KoordBenchmark.pro && make && ./KoordBenchmark --output results.json
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QFile>
+#include <algorithm>
+#include "global.h"
+#include "buffer.h"
+#include "protocol.h"
+#include "util.h"
+
+/* Definitions ****************************************************************/
+// default number of runs of each benchmark
+#define BENCHMARK_DEFAULT_NUM_REPEATS 5
+
+// number of mixed sources per frame for the mixing benchmarks (the server mixes
+// every source into the personal mix of every client, i.e. N * N additions)
+#define BENCHMARK_NUM_MIX_CLIENTS { 4, 16, 64 }
+
+/* Classes ********************************************************************/
+class CBenchmark
+{
+public:
+    CBenchmark ( const int iNNumRepeats, const QString& strNFilter ) : iNumRepeats ( iNNumRepeats ), strFilter ( strNFilter ), iSink ( 0 ) {}
+
+    // runs the given operation iNumIterations times per repeat, the return
+    // value of the operation is accumulated so that it is not optimized away
+    template<typename TOperation>
+    void Run ( const QString& strName, const int iNumIterations, TOperation Operation )
+    {
+        if ( !strFilter.isEmpty() && !strName.contains ( strFilter ) )
+        {
+            return;
+        }
+
+        CVector<double> vecdNsPerOp ( iNumRepeats );
+        QElapsedTimer   ElapsedTimer;
+
+        // warm up caches and branch predictors
+        for ( int i = 0; i < iNumIterations / 10 + 1; i++ )
+        {
+            iSink += Operation();
+        }
+
+        for ( int iRepeat = 0; iRepeat < iNumRepeats; iRepeat++ )
+        {
+            ElapsedTimer.start();
+
+            for ( int i = 0; i < iNumIterations; i++ )
+            {
+                iSink += Operation();
+            }
+
+            vecdNsPerOp[iRepeat] = static_cast<double> ( ElapsedTimer.nsecsElapsed() ) / iNumIterations;
+        }
+
+        std::sort ( vecdNsPerOp.begin(), vecdNsPerOp.end() );
+
+        QJsonObject Result;
+        Result["name"]             = strName;
+        Result["iterations"]       = iNumIterations;
+        Result["repeats"]          = iNumRepeats;
+        Result["ns_per_op_min"]    = vecdNsPerOp[0];
+        Result["ns_per_op_median"] = vecdNsPerOp[iNumRepeats / 2];
+        Result["ns_per_op_max"]    = vecdNsPerOp[iNumRepeats - 1];
+        Results.append ( Result );
+
+        qInfo() << qUtf8Printable ( QString ( "%1: %2 ns/op" ).arg ( strName, -40 ).arg ( vecdNsPerOp[iNumRepeats / 2], 0, 'f', 1 ) );
+    }
+
+    QJsonDocument GetResults() const
+    {
+        QJsonObject Document;
+        Document["version"]    = VERSION;
+        Document["qt_version"] = qVersion();
+        Document["timestamp"]  = QDateTime::currentDateTimeUtc().toString ( Qt::ISODate );
+        Document["checksum"]   = static_cast<qint64> ( iSink );
+        Document["benchmarks"] = Results;
+
+        return QJsonDocument ( Document );
+    }
+
+protected:
+    int        iNumRepeats;
+    QString    strFilter;
+    QJsonArray Results;
+    int64_t    iSink;
+};
+
+/* Benchmarks *****************************************************************/
+static int16_t GenRandomSample() { return static_cast<int16_t> ( rand() % 65536 - 32768 ); }
+
+// one frame of the server mixing: every source is mixed into the mix of every
+// client with the same kernels the server uses, half of the sources are mono
+static void RunMixBenchmarks ( CBenchmark& Benchmark )
+{
+    const int iFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+
+    for ( const int iNumClients : BENCHMARK_NUM_MIX_CLIENTS )
+    {
+        CVector<CVector<int16_t>> vecvecsData ( iNumClients );
+        CVector<CVector<int16_t>> vecvecsDataPrev ( iNumClients );
+        CVector<int>              vecNumAudioChannels ( iNumClients );
+        CVector<float>            vecfGains ( iNumClients );
+        CVector<float>            vecfPannings ( iNumClients );
+        CVector<float>            vecfMix ( 2 * iFrameSizeSamples );
+        CVector<int16_t>          vecsSendData ( 2 * iFrameSizeSamples );
+
+        for ( int j = 0; j < iNumClients; j++ )
+        {
+            vecvecsData[j].Init ( 2 * iFrameSizeSamples );
+            vecvecsDataPrev[j].Init ( 2 * iFrameSizeSamples );
+
+            for ( int i = 0; i < 2 * iFrameSizeSamples; i++ )
+            {
+                vecvecsData[j][i]     = GenRandomSample() / iNumClients;
+                vecvecsDataPrev[j][i] = GenRandomSample() / iNumClients;
+            }
+
+            vecNumAudioChannels[j] = 1 + ( j % 2 );
+            vecfGains[j]           = ( j % 4 == 0 ) ? 1.0f : static_cast<float> ( rand() ) / RAND_MAX;
+            vecfPannings[j]        = static_cast<float> ( rand() ) / RAND_MAX;
+        }
+
+        const int iNumIterations = std::max ( 10, 200000 / ( iNumClients * iNumClients ) );
+
+        Benchmark.Run ( QString ( "mix/mono/n=%1" ).arg ( iNumClients ), iNumIterations, [&]() {
+            for ( int iTarget = 0; iTarget < iNumClients; iTarget++ )
+            {
+                vecfMix.Reset ( 0 );
+
+                for ( int j = 0; j < iNumClients; j++ )
+                {
+                    MixUtils::AddToMono ( vecfMix, vecvecsData[j], vecNumAudioChannels[j], vecfGains[j], iFrameSizeSamples );
+                }
+
+                MixUtils::ConvertToShort ( vecfMix, vecsSendData, iFrameSizeSamples );
+            }
+
+            return vecsSendData[0];
+        } );
+
+        Benchmark.Run ( QString ( "mix/stereo/n=%1" ).arg ( iNumClients ), iNumIterations, [&]() {
+            for ( int iTarget = 0; iTarget < iNumClients; iTarget++ )
+            {
+                vecfMix.Reset ( 0 );
+
+                for ( int j = 0; j < iNumClients; j++ )
+                {
+                    const float fGainL = MathUtils::GetLeftPan ( vecfPannings[j], false ) * vecfGains[j];
+                    const float fGainR = MathUtils::GetRightPan ( vecfPannings[j], false ) * vecfGains[j];
+
+                    MixUtils::AddToStereo ( vecfMix, vecvecsData[j], vecNumAudioChannels[j], fGainL, fGainR, iFrameSizeSamples );
+                }
+
+                MixUtils::ConvertToShort ( vecfMix, vecsSendData, 2 * iFrameSizeSamples );
+            }
+
+            return vecsSendData[0];
+        } );
+
+        Benchmark.Run ( QString ( "mix/stereo_delaypan/n=%1" ).arg ( iNumClients ), iNumIterations, [&]() {
+            for ( int iTarget = 0; iTarget < iNumClients; iTarget++ )
+            {
+                vecfMix.Reset ( 0 );
+
+                for ( int j = 0; j < iNumClients; j++ )
+                {
+                    const int iPanDel = lround ( static_cast<float> ( 2 * MAX_DELAY_PANNING_SAMPLES - 2 ) * ( vecfPannings[j] - 0.5f ) );
+
+                    MixUtils::AddToStereoDelayPan ( vecfMix,
+                                                    vecvecsData[j],
+                                                    vecvecsDataPrev[j],
+                                                    vecNumAudioChannels[j],
+                                                    vecfGains[j],
+                                                    ( iPanDel > 0 ) ? iPanDel : 0,
+                                                    ( iPanDel < 0 ) ? -iPanDel : 0,
+                                                    iFrameSizeSamples );
+                }
+
+                MixUtils::ConvertToShort ( vecfMix, vecsSendData, 2 * iFrameSizeSamples );
+            }
+
+            return vecsSendData[0];
+        } );
+    }
+}
+
+// jitter buffer put and get of one coded stereo frame, the buffer with
+// statistics additionally runs the simulation buffers of the auto setting
+static void RunNetBufBenchmarks ( CBenchmark& Benchmark )
+{
+    const int        iBlockSize = 71; // stereo normal quality, 128 samples
+    CVector<uint8_t> vecbyPacket ( iBlockSize );
+    CVector<uint8_t> vecbyOut ( iBlockSize );
+    CNetBuf          NetBuf;
+    CNetBufWithStats NetBufWithStats;
+
+    for ( int i = 0; i < iBlockSize; i++ )
+    {
+        vecbyPacket[i] = static_cast<uint8_t> ( rand() );
+    }
+
+    NetBuf.Init ( iBlockSize, DEF_NET_BUF_SIZE_NUM_BL, false );
+    NetBufWithStats.SetUseDoubleSystemFrameSize ( true );
+    NetBufWithStats.Init ( iBlockSize, DEF_NET_BUF_SIZE_NUM_BL, false );
+
+    Benchmark.Run ( "netbuf/put_get", 1000000, [&]() {
+        NetBuf.Put ( vecbyPacket, iBlockSize );
+        return static_cast<int> ( NetBuf.Get ( vecbyOut, iBlockSize ) );
+    } );
+
+    Benchmark.Run ( "netbufwithstats/put_get", 200000, [&]() {
+        NetBufWithStats.Put ( vecbyPacket, iBlockSize );
+        return static_cast<int> ( NetBufWithStats.Get ( vecbyOut, iBlockSize ) );
+    } );
+}
+
+// frame size conversion of the server: one 128 samples stereo frame is split
+// into two 64 samples frames and two 64 samples frames are combined again
+static void RunConvBufBenchmarks ( CBenchmark& Benchmark )
+{
+    const int         iFrameSize = 2 * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    CVector<int16_t>  vecsFrame ( iFrameSize );
+    CVector<int16_t>  vecsHalf ( iFrameSize / 2 );
+    CConvBuf<int16_t> ConvBufIn;
+    CConvBuf<int16_t> ConvBufOut;
+
+    for ( int i = 0; i < iFrameSize; i++ )
+    {
+        vecsFrame[i] = GenRandomSample();
+    }
+
+    ConvBufIn.Init ( iFrameSize );
+    ConvBufOut.Init ( iFrameSize );
+
+    Benchmark.Run ( "convbuf/split_combine", 1000000, [&]() {
+        ConvBufIn.PutAll ( vecsFrame );
+        ConvBufIn.Get ( vecsHalf, iFrameSize / 2 );
+        ConvBufOut.Put ( vecsHalf, iFrameSize / 2 );
+        ConvBufIn.Get ( vecsHalf, iFrameSize / 2 );
+        ConvBufOut.Put ( vecsHalf, iFrameSize / 2 );
+        return ConvBufOut.GetAll()[0];
+    } );
+}
+
+// sound card conversion buffer of the client with a block size which is no
+// integer fraction of the buffer size (so that the wrap around is used)
+static void RunBufferBenchmarks ( CBenchmark& Benchmark )
+{
+    const int        iBlockSize = 2 * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    CVector<int16_t> vecsIn ( iBlockSize );
+    CVector<int16_t> vecsOut ( iBlockSize );
+    CBuffer<int16_t> Buffer;
+
+    for ( int i = 0; i < iBlockSize; i++ )
+    {
+        vecsIn[i] = GenRandomSample();
+    }
+
+    Buffer.Init ( 2 * iBlockSize + 2 * SYSTEM_FRAME_SIZE_SAMPLES + 96 );
+
+    Benchmark.Run ( "buffer/put_get", 1000000, [&]() {
+        Buffer.Put ( vecsIn, iBlockSize );
+        Buffer.Get ( vecsOut, iBlockSize );
+        return vecsOut[0];
+    } );
+}
+
+// protocol frame parsing and CRC of typical connection less messages
+static void RunProtocolBenchmarks ( CBenchmark& Benchmark )
+{
+    const CHostAddress        HostAddr ( QHostAddress ( QHostAddress::LocalHost ), DEFAULT_PORT_NUMBER );
+    CProtocol                 Protocol;
+    CVector<CVector<uint8_t>> vecvecMessages;
+    CVector<uint16_t>         vecLevelList ( MAX_NUM_CHANNELS );
+
+    QObject::connect ( &Protocol, &CProtocol::CLMessReadyForSending, [&] ( CHostAddress, CVector<uint8_t> vecMessage ) {
+        vecvecMessages.push_back ( vecMessage );
+    } );
+
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        vecLevelList[i] = static_cast<uint16_t> ( rand() % 10 );
+    }
+
+    Protocol.CreateCLPingWithNumClientsMes ( HostAddr, 1234, 12 );
+    Protocol.CreateCLVersionAndOSMes ( HostAddr );
+    Protocol.CreateCLChannelLevelListMes ( HostAddr, vecLevelList, 16 );
+    Protocol.CreateCLChannelLevelListMes ( HostAddr, vecLevelList, MAX_NUM_CHANNELS );
+
+    const int iNumMessages = vecvecMessages.Size();
+    int       iCurMessage  = 0;
+
+    Benchmark.Run ( "protocol/parse_message_frame", 1000000, [&]() {
+        const CVector<uint8_t>& vecMessage = vecvecMessages[iCurMessage];
+        int                     iRecCounter;
+        int                     iRecID;
+        int                     iRecLenBy;
+
+        iCurMessage = ( iCurMessage + 1 ) % iNumMessages;
+
+        return static_cast<int> ( CProtocol::ParseMessageFrame ( &vecMessage[0], vecMessage.Size(), iRecCounter, iRecID, iRecLenBy ) ) + iRecLenBy;
+    } );
+
+    Benchmark.Run ( "crc/message", 1000000, [&]() {
+        const CVector<uint8_t>& vecMessage = vecvecMessages[iCurMessage];
+        CCRC                    CRCObj;
+
+        iCurMessage = ( iCurMessage + 1 ) % iNumMessages;
+
+        CRCObj.AddBytes ( &vecMessage[0], vecMessage.Size() - 2 /* without the CRC */ );
+
+        return static_cast<int> ( CRCObj.GetCRC() );
+    } );
+}
+
+// client side audio effects and metering of one 128 samples stereo frame
+static void RunAudioBenchmarks ( CBenchmark& Benchmark )
+{
+    const int               iBlockSize = 2 * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    CVector<int16_t>        vecsAudio ( iBlockSize );
+    CAudioReverb            AudioReverb;
+    CStereoSignalLevelMeter SignalLevelMeter;
+
+    for ( int i = 0; i < iBlockSize; i++ )
+    {
+        vecsAudio[i] = GenRandomSample() / 4;
+    }
+
+    AudioReverb.Init ( CC_STEREO, iBlockSize, SYSTEM_SAMPLE_RATE_HZ );
+
+    Benchmark.Run ( "audioreverb/process", 200000, [&]() {
+        AudioReverb.Process ( vecsAudio, false, 0.25f );
+        return vecsAudio[0];
+    } );
+
+    Benchmark.Run ( "signallevelmeter/update", 1000000, [&]() {
+        SignalLevelMeter.Update ( vecsAudio, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, true );
+        return static_cast<int> ( SignalLevelMeter.GetLevelForMeterdBLeftOrMono() );
+    } );
+}
+
+/* Implementation *************************************************************/
+int main ( int argc, char** argv )
+{
+    QCoreApplication   App ( argc, argv );
+    QCommandLineParser Parser;
+
+    Parser.setApplicationDescription ( "Micro-benchmarks of the real time critical code paths." );
+    Parser.addHelpOption();
+    Parser.addOption ( { { "o", "output" }, "Write the JSON results to <file> instead of stdout.", "file" } );
+    Parser.addOption ( { { "r", "repeats" }, "Number of runs of each benchmark.", "repeats", QString::number ( BENCHMARK_DEFAULT_NUM_REPEATS ) } );
+    Parser.addOption ( { { "f", "filter" }, "Only run the benchmarks whose name contains <filter>.", "filter" } );
+    Parser.process ( App );
+
+    CBenchmark Benchmark ( std::max ( 1, Parser.value ( "repeats" ).toInt() ), Parser.value ( "filter" ) );
+
+    // same input data on every run
+    srand ( 1 );
+
+    RunMixBenchmarks ( Benchmark );
+    RunNetBufBenchmarks ( Benchmark );
+    RunConvBufBenchmarks ( Benchmark );
+    RunBufferBenchmarks ( Benchmark );
+    RunProtocolBenchmarks ( Benchmark );
+    RunAudioBenchmarks ( Benchmark );
+
+    const QByteArray Json = Benchmark.GetResults().toJson();
+
+    if ( Parser.isSet ( "output" ) )
+    {
+        QFile File ( Parser.value ( "output" ) );
+
+        if ( !File.open ( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        {
+            qCritical() << qUtf8Printable ( QString ( "Cannot write %1" ).arg ( File.fileName() ) );
+            return 1;
+        }
+
+        File.write ( Json );
+    }
+    else
+    {
+        fputs ( Json.constData(), stdout );
+    }
+
+    return 0;
+}
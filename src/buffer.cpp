@@ -131,6 +131,8 @@ void CNetBuf::Resize ( const int iNewNumBlocks, const int iNewBlockSize )
 
 bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
 {
+    eLastPutResult = PR_OK;
+
     // if the sequence number is used, we need a complete different way of applying
     // the new network packet
     if ( bUseSequenceNumber )
@@ -181,6 +183,8 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
             // buffer which did not use any sequence number at all.
             if ( iSeqNumDiff < 0 )
             {
+                eLastPutResult = PR_LATE;
+
                 // the received packet comes too late so we shift the "buffer window" to the past
                 // until the received packet is the very first packet in the buffer
                 for ( int i = iSeqNumDiff; i < 0; i++ )
@@ -203,6 +207,8 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
             }
             else if ( iSeqNumDiff >= iNumBlocksMemory )
             {
+                eLastPutResult = PR_OVERRUN;
+
                 // the received packet comes too early so we move the "buffer window" in the
                 // future until the received packet is the last packet in the buffer
                 for ( int i = 0; i < iSeqNumDiff - iNumBlocksMemory + 1; i++ )
@@ -254,10 +260,16 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
     }
     else
     {
-        // check if there is not enough space available and that the input size is a
-        // multiple of the block size
-        if ( ( GetAvailSpace() < iInSize ) || ( ( iInSize % iBlockSize ) != 0 ) )
+        // check that the input size is a multiple of the block size
+        if ( ( iInSize % iBlockSize ) != 0 )
+        {
+            return false;
+        }
+
+        // check if there is not enough space available
+        if ( GetAvailSpace() < iInSize )
         {
+            eLastPutResult = PR_OVERRUN;
             return false;
         }
 
@@ -399,6 +411,30 @@ int CNetBuf::GetAvailData() const
     return iAvBlocks * iBlockSize;
 }
 
+int CNetBuf::GetNumBufferedBlocks() const
+{
+    if ( !bIsInitialized )
+    {
+        return 0;
+    }
+
+    // in case of using sequence numbers, the buffer always has data per
+    // definition, so we count the received blocks which were not yet taken
+    if ( bUseSequenceNumber )
+    {
+        int iNumValidBlocks = 0;
+
+        for ( int iBlock = 0; iBlock < iNumBlocksMemory; iBlock++ )
+        {
+            iNumValidBlocks += veciBlockValid[iBlock];
+        }
+
+        return iNumValidBlocks;
+    }
+
+    return GetAvailData() / iBlockSize;
+}
+
 /* Network buffer with statistic calculations implementation ******************/
 CNetBufWithStats::CNetBufWithStats() :
     CNetBuf ( false ), // base class init: no simulation mode
@@ -675,3 +711,151 @@ void CNetBufWithStats::UpdateAutoSetting()
         }
     }
 }
+
+/* Network statistics counter implementation **********************************/
+void CNetStatsCounter::Reset()
+{
+    iHighestSeqNum = -1;
+    iRecSeqNumMask = 0;
+    iLastTransitNs = 0;
+    dJitterNs      = 0;
+    iRateStartNs   = 0;
+    iRateNumBytes  = 0;
+}
+
+void CNetStatsCounter::Update ( CChannelNetStats&         NetStats,
+                                const CVector<uint8_t>&   vecbyData,
+                                const int                 iNumBytes,
+                                const int                 iNumCodedBytes,
+                                const bool                bUseSequenceNumber,
+                                const int                 iBlockSizeSamples,
+                                const CNetBuf::EPutResult ePutResult,
+                                const int64_t             iArrivalNs )
+{
+    // a packet holds one or more blocks, each followed by its own sequence
+    // number (this is the same layout as used in CNetBuf::Put)
+    const int     iNumBytesPerBlock = iNumCodedBytes + ( bUseSequenceNumber ? 1 : 0 ); // per definition 1 byte counter
+    const int     iNumBlocks        = std::max ( 1, iNumBytes / std::max ( 1, iNumBytesPerBlock ) );
+    const int64_t iBlockDurationNs  = static_cast<int64_t> ( iBlockSizeSamples ) * 1000000000 / SYSTEM_SAMPLE_RATE_HZ;
+    const int64_t iNumPackets       = NetStats.iNumPackets.load ( std::memory_order_relaxed );
+
+    // without sequence numbers we assume that the packets arrive in order, the
+    // send time stamp of the packet is given by the index of its last block
+    int64_t iBlockIndex   = ( iNumPackets + 1 ) * iNumBlocks - 1;
+    bool    bFirstTransit = ( iNumPackets == 0 );
+    bool    bDuplicate    = false;
+
+    if ( bUseSequenceNumber && ( iNumCodedBytes > 0 ) )
+    {
+        // the send time stamps are now based on the sequence numbers
+        bFirstTransit = ( iHighestSeqNum < 0 );
+        bDuplicate    = true;
+
+        for ( int iBlock = 0; iBlock < iNumBlocks; iBlock++ )
+        {
+            // per definition the sequence number is the last byte of the block, the
+            // packet is only a duplicate if all of its blocks were received before
+            if ( !UpdateSequenceNumber ( NetStats, vecbyData[( iBlock + 1 ) * iNumBytesPerBlock - 1], iBlockIndex ) )
+            {
+                bDuplicate = false;
+            }
+        }
+    }
+
+    switch ( ePutResult )
+    {
+    case CNetBuf::PR_LATE:
+        NetStats.iNumLate.fetch_add ( 1, std::memory_order_relaxed );
+        break;
+
+    case CNetBuf::PR_OVERRUN:
+        NetStats.iNumOverruns.fetch_add ( 1, std::memory_order_relaxed );
+        break;
+
+    case CNetBuf::PR_OK:
+        break;
+    }
+
+    // inter-arrival jitter as defined in RFC 3550, the blocks are sent with
+    // a fixed interval so the block index is used as the send time stamp (a
+    // duplicate does not take part in the jitter calculation)
+    if ( !bDuplicate )
+    {
+        const int64_t iTransitNs = iArrivalNs - iBlockIndex * iBlockDurationNs;
+
+        if ( !bFirstTransit )
+        {
+            dJitterNs += ( qAbs ( iTransitNs - iLastTransitNs ) - dJitterNs ) / 16;
+            NetStats.iJitterUs.store ( static_cast<int> ( dJitterNs / 1000 ), std::memory_order_relaxed );
+        }
+
+        iLastTransitNs = iTransitNs;
+    }
+
+    // the upstream bit rate is updated once per second
+    iRateNumBytes += iNumBytes;
+
+    if ( iArrivalNs - iRateStartNs >= 1000000000 )
+    {
+        NetStats.iUpstreamKbps.store ( static_cast<int> ( iRateNumBytes * 8 * 1000000 / ( iArrivalNs - iRateStartNs ) ), std::memory_order_relaxed );
+
+        iRateStartNs  = iArrivalNs;
+        iRateNumBytes = 0;
+    }
+
+    NetStats.iNumPackets.store ( iNumPackets + 1, std::memory_order_relaxed );
+}
+
+bool CNetStatsCounter::UpdateSequenceNumber ( CChannelNetStats& NetStats, const int iSequenceNumber, int64_t& iBlockIndex )
+{
+    if ( iHighestSeqNum < 0 )
+    {
+        iHighestSeqNum = iSequenceNumber;
+        iRecSeqNumMask = 1;
+        iBlockIndex    = iSequenceNumber;
+        return false;
+    }
+
+    // calculate the sequence number difference and take care of wrap
+    int iSeqNumDiff = iSequenceNumber - static_cast<int> ( iHighestSeqNum & 0xFF );
+
+    if ( iSeqNumDiff < -128 )
+    {
+        iSeqNumDiff += 256;
+    }
+    else if ( iSeqNumDiff >= 128 )
+    {
+        iSeqNumDiff -= 256;
+    }
+
+    if ( iSeqNumDiff > 0 )
+    {
+        // the skipped sequence numbers are lost unless they are received later
+        NetStats.iNumLost.fetch_add ( iSeqNumDiff - 1, std::memory_order_relaxed );
+
+        iHighestSeqNum += iSeqNumDiff;
+        iRecSeqNumMask = ( iSeqNumDiff < 64 ) ? ( ( iRecSeqNumMask << iSeqNumDiff ) | 1 ) : 1;
+        iBlockIndex    = iHighestSeqNum;
+        return false;
+    }
+
+    const uint64_t iSeqNumBit = ( -iSeqNumDiff < 64 ) ? ( static_cast<uint64_t> ( 1 ) << -iSeqNumDiff ) : 0;
+
+    if ( iRecSeqNumMask & iSeqNumBit )
+    {
+        NetStats.iNumDuplicates.fetch_add ( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    NetStats.iNumReordered.fetch_add ( 1, std::memory_order_relaxed );
+
+    // a sequence number which was counted as lost is now received
+    if ( iSeqNumBit != 0 )
+    {
+        iRecSeqNumMask |= iSeqNumBit;
+        NetStats.iNumLost.fetch_sub ( 1, std::memory_order_relaxed );
+    }
+
+    iBlockIndex = iHighestSeqNum + iSeqNumDiff;
+    return false;
+}
@@ -233,7 +233,20 @@ protected:
 class CNetBuf
 {
 public:
-    CNetBuf ( const bool bNIsSim = false ) : iSequenceNumberAtGetPos ( 0 ), bIsSimulation ( bNIsSim ), bIsInitialized ( false ) {}
+    // result of the last Put() with respect to the buffer window
+    enum EPutResult
+    {
+        PR_OK,
+        PR_LATE,   // the packet came after its play out time
+        PR_OVERRUN // the packet did not fit into the buffer
+    };
+
+    CNetBuf ( const bool bNIsSim = false ) :
+        iSequenceNumberAtGetPos ( 0 ),
+        eLastPutResult ( PR_OK ),
+        bIsSimulation ( bNIsSim ),
+        bIsInitialized ( false )
+    {}
 
     void Init ( const int iNewBlockSize, const int iNewNumBlocks, const bool bNUseSequenceNumber, const bool bPreserve = false );
 
@@ -242,6 +255,9 @@ public:
     virtual bool Put ( const CVector<uint8_t>& vecbyData, int iInSize );
     virtual bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
 
+    EPutResult GetLastPutResult() const { return eLastPutResult; }
+    int        GetNumBufferedBlocks() const;
+
 protected:
     enum EBufState
     {
@@ -262,6 +278,7 @@ protected:
     int                       iBlockSize;
     uint8_t                   iSequenceNumberAtGetPos; // uint8_t so that it wraps automatically
     EBufState                 eBufState;
+    EPutResult                eLastPutResult;
     bool                      bUseSequenceNumber;
     bool                      bIsSimulation;
     bool                      bIsInitialized;
@@ -310,6 +327,71 @@ protected:
     double dUpMaxErrorBound;
 };
 
+// Network quality statistics of a channel since the connection was established.
+// The values are written by the socket and the server threads and may be read
+// from any other thread.
+class CChannelNetStats
+{
+public:
+    CChannelNetStats() { Reset(); }
+
+    void Reset()
+    {
+        iNumPackets.store ( 0, std::memory_order_relaxed );
+        iNumLost.store ( 0, std::memory_order_relaxed );
+        iNumDuplicates.store ( 0, std::memory_order_relaxed );
+        iNumReordered.store ( 0, std::memory_order_relaxed );
+        iNumLate.store ( 0, std::memory_order_relaxed );
+        iNumOverruns.store ( 0, std::memory_order_relaxed );
+        iNumUnderruns.store ( 0, std::memory_order_relaxed );
+        iJitterUs.store ( 0, std::memory_order_relaxed );
+        iNumBufferedFrames.store ( 0, std::memory_order_relaxed );
+        iUpstreamKbps.store ( 0, std::memory_order_relaxed );
+    }
+
+    std::atomic<int64_t> iNumPackets;        // received audio packets
+    std::atomic<int64_t> iNumLost;           // missing sequence numbers
+    std::atomic<int64_t> iNumDuplicates;     // sequence numbers received more than once
+    std::atomic<int64_t> iNumReordered;      // packets received after a packet with a higher sequence number
+    std::atomic<int64_t> iNumLate;           // packets received after their play out time
+    std::atomic<int64_t> iNumOverruns;       // packets which did not fit into the jitter buffer
+    std::atomic<int64_t> iNumUnderruns;      // frames for which the jitter buffer had no data
+    std::atomic<int>     iJitterUs;          // inter-arrival jitter as defined in RFC 3550
+    std::atomic<int>     iNumBufferedFrames; // current jitter buffer occupancy
+    std::atomic<int>     iUpstreamKbps;      // received audio payload bit rate
+};
+
+// Network statistics counter -------------------------------------------------
+// Updates the network statistics of a channel with each received audio packet.
+// A packet carries one or more coded blocks and, if sequence numbers are used,
+// each block has its own sequence number in its last byte.
+class CNetStatsCounter
+{
+public:
+    CNetStatsCounter() { Reset(); }
+
+    void Reset();
+
+    void Update ( CChannelNetStats&         NetStats,
+                  const CVector<uint8_t>&   vecbyData,
+                  const int                 iNumBytes,
+                  const int                 iNumCodedBytes,
+                  const bool                bUseSequenceNumber,
+                  const int                 iBlockSizeSamples,
+                  const CNetBuf::EPutResult ePutResult,
+                  const int64_t             iArrivalNs );
+
+protected:
+    bool UpdateSequenceNumber ( CChannelNetStats& NetStats, const int iSequenceNumber, int64_t& iBlockIndex );
+
+    int64_t  iHighestSeqNum; // extended sequence number, negative if no sequence number was received yet
+    uint64_t iRecSeqNumMask; // received flags of the last 64 sequence numbers, bit 0 is the highest one
+    int64_t  iLastTransitNs;
+    double   dJitterNs;
+    int64_t  iRateStartNs;
+    int64_t  iRateNumBytes;
+};
+
 // Conversion buffer (very simple buffer) --------------------------------------
 // For this very simple buffer no wrap around mechanism is implemented. We
 // assume here, that the applied buffers are an integer fraction of the total
@@ -54,6 +54,9 @@ CChannel::CChannel ( const bool bNIsServer ) :
     // init the socket buffer
     SetSockBufNumFrames ( DEF_NET_BUF_SIZE_NUM_BL );
 
+    // init the network statistics
+    ResetNetStats();
+
     // initialize channel info
     ResetInfo();
 
@@ -97,11 +100,17 @@ CChannel::CChannel ( const bool bNIsServer ) :
 
     QObject::connect ( &Protocol, &CProtocol::SplitMessSupported, this, &CChannel::OnSplitMessSupported );
 
+    QObject::connect ( &Protocol, &CProtocol::ReqConClientListDeltaSupport, this, &CChannel::OnReqConClientListDeltaSupport );
+
+    QObject::connect ( &Protocol, &CProtocol::ConClientListDeltaSupported, this, &CChannel::OnConClientListDeltaSupported );
+
     QObject::connect ( &Protocol, &CProtocol::LicenceRequired, this, &CChannel::LicenceRequired );
 
     QObject::connect ( &Protocol, &CProtocol::VersionAndOSReceived, this, &CChannel::OnVersionAndOSReceived );
 
     QObject::connect ( &Protocol, &CProtocol::RecorderStateReceived, this, &CChannel::RecorderStateReceived );
+
+    QObject::connect ( &Protocol, &CProtocol::NetwFrameSizeFactReceived, this, &CChannel::NetwFrameSizeFactReceived );
 }
 
 bool CChannel::ProtocolIsEnabled()
@@ -144,6 +153,16 @@ void CChannel::SetEnable ( const bool bNEnStat )
     }
 }
 
+void CChannel::SetMaxNumChannels ( const int iNMaxNumChannels )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // the server sets the number of channels it actually has, the client keeps
+    // the MAX_NUM_CHANNELS it was constructed with
+    vecfGains.Init ( iNMaxNumChannels, 1.0f );
+    vecfPannings.Init ( iNMaxNumChannels, 0.5f );
+}
+
 void CChannel::OnVersionAndOSReceived ( COSUtil::EOpSystemType eOSType, QString strVersion )
 {
     // check if audio packet counter is supported by the server (minimum version is 3.6.0)
@@ -275,7 +294,7 @@ void CChannel::SetGain ( const int iChanID, const float fNewGain )
     QMutexLocker locker ( &Mutex );
 
     // set value (make sure channel ID is in range)
-    if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
+    if ( ( iChanID >= 0 ) && ( iChanID < vecfGains.Size() ) )
     {
         // signal mute change
         if ( ( vecfGains[iChanID] == 0 ) && ( fNewGain > 0 ) )
@@ -296,7 +315,7 @@ float CChannel::GetGain ( const int iChanID )
     QMutexLocker locker ( &Mutex );
 
     // get value (make sure channel ID is in range)
-    if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
+    if ( ( iChanID >= 0 ) && ( iChanID < vecfGains.Size() ) )
     {
         return vecfGains[iChanID];
     }
@@ -311,7 +330,7 @@ void CChannel::SetPan ( const int iChanID, const float fNewPan )
     QMutexLocker locker ( &Mutex );
 
     // set value (make sure channel ID is in range)
-    if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
+    if ( ( iChanID >= 0 ) && ( iChanID < vecfPannings.Size() ) )
     {
         vecfPannings[iChanID] = fNewPan;
     }
@@ -322,7 +341,7 @@ float CChannel::GetPan ( const int iChanID )
     QMutexLocker locker ( &Mutex );
 
     // get value (make sure channel ID is in range)
-    if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
+    if ( ( iChanID >= 0 ) && ( iChanID < vecfPannings.Size() ) )
     {
         return vecfPannings[iChanID];
     }
@@ -529,7 +548,8 @@ void CChannel::PutProtocolData ( const int iRecCounter, const int iRecID, const
 EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData, const int iNumBytes, CHostAddress RecHostAddr )
 {
     // init return state
-    EPutDataStat eRet = PS_GEN_ERROR;
+    EPutDataStat eRet        = PS_GEN_ERROR;
+    bool         bAudioValid = false;
 
     // Only process audio data if:
     // - for client only: the packet comes from the server we want to talk to
@@ -551,6 +571,8 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData, const i
                     eRet = PS_AUDIO_ERR;
                 }
 
+                bAudioValid = true;
+
                 // manage audio fade-in counter, after channel is identified
                 if ( iFadeInCnt < iFadeInCntMax && bIsIdentified )
                 {
@@ -582,6 +604,22 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData, const i
 
                 // init level meter
                 SignalLevelMeter.Reset();
+
+                // init network statistics
+                ResetNetStats();
+            }
+
+            // the statistics of a new connection start with its first audio packet
+            if ( bAudioValid )
+            {
+                NetStatsCounter.Update ( NetStats,
+                                         vecbyData,
+                                         iNumBytes,
+                                         iCeltNumCodedBytes,
+                                         bUseSequenceNumber,
+                                         iAudioFrameSizeSamples,
+                                         SockBuf.GetLastPutResult(),
+                                         NetStatsTimer.nsecsElapsed() );
             }
 
             // reset time-out counter (note that this must be done after the
@@ -636,7 +674,10 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData, const int iNumByte
                 {
                     // channel is not yet disconnected but no data in buffer
                     eGetStatus = GS_BUFFER_UNDERRUN;
+                    NetStats.iNumUnderruns.fetch_add ( 1, std::memory_order_relaxed );
                 }
+
+                NetStats.iNumBufferedFrames.store ( SockBuf.GetNumBufferedBlocks(), std::memory_order_relaxed );
             }
         }
         else
@@ -701,6 +742,13 @@ int CChannel::GetUploadRateKbps()
     return ( iNetwFrameSize * iNetwFrameSizeFact + 28 + 26 + 23 /* header */ ) * 8 /* bits per byte */ * SYSTEM_SAMPLE_RATE_HZ / iAudioSizeOut / 1000;
 }
 
+void CChannel::ResetNetStats()
+{
+    NetStats.Reset();
+    NetStatsCounter.Reset();
+    NetStatsTimer.start();
+}
+
 void CChannel::UpdateSocketBufferSize()
 {
     // just update the socket buffer size if auto setting is enabled, otherwise
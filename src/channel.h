@@ -27,6 +27,7 @@
 #include <QThread>
 #include <QDateTime>
 #include <QFile>
+#include <QElapsedTimer>
 #if QT_VERSION >= QT_VERSION_CHECK( 5, 6, 0 )
 #    include <QVersionNumber>
 #endif
@@ -83,6 +84,8 @@ public:
     void SetEnable ( const bool bNEnStat );
     bool IsEnabled() { return bIsEnabled; }
 
+    void SetMaxNumChannels ( const int iNMaxNumChannels );
+
     void                SetAddress ( const CHostAddress NAddr ) { InetAddr = NAddr; }
     const CHostAddress& GetAddress() const { return InetAddr; }
 
@@ -151,6 +154,7 @@ public:
     void CreateClientIDMes ( const int iChanID ) { Protocol.CreateClientIDMes ( iChanID ); }
     void CreateReqNetwTranspPropsMes() { Protocol.CreateReqNetwTranspPropsMes(); }
     void CreateReqSplitMessSupportMes() { Protocol.CreateReqSplitMessSupportMes(); }
+    void CreateReqConClientListDeltaSupportMes() { Protocol.CreateReqConClientListDeltaSupportMes(); }
     void CreateReqJitBufMes() { Protocol.CreateReqJitBufMes(); }
     void CreateReqConnClientsList() { Protocol.CreateReqConnClientsList(); }
     void CreateChatTextMes ( const QString& strChatText ) { Protocol.CreateChatTextMes ( strChatText ); }
@@ -165,13 +169,28 @@ public:
 
     void CreateRecorderStateMes ( const ERecorderState eRecorderState ) { Protocol.CreateRecorderStateMes ( eRecorderState ); }
 
+    void CreateNetwFrameSizeFactMes ( const int iNetwFrameSizeFact ) { Protocol.CreateNetwFrameSizeFactMes ( iNetwFrameSizeFact ); }
+
+    void SendBroadcastMes ( const CProtocol::CBroadcastMes& BroadcastMes ) { Protocol.SendBroadcastMes ( BroadcastMes ); }
+
+    void SendConClientListDeltaMes ( const CProtocol::CBroadcastMes& DeltaMes, const int iNewVersion )
+    {
+        Protocol.SendConClientListDeltaMes ( DeltaMes, iNewVersion );
+    }
+    bool IsConClientListDeltaSupported() const { return Protocol.IsConClientListDeltaSupported(); }
+    int  GetConClientListVersion() const { return Protocol.GetConClientListVersion(); }
+
     CNetworkTransportProps GetNetworkTransportPropsFromCurrentSettings();
 
     double UpdateAndGetLevelForMeterdB ( const CVector<short>& vecsAudio, const int iInSize, const bool bIsStereoIn );
 
+    const CChannelNetStats& GetNetStats() const { return NetStats; }
+
 protected:
     bool ProtocolIsEnabled();
 
+    void ResetNetStats();
+
     void ResetNetworkTransportProperties()
     {
         // set it to a state were no decoding is ever possible (since we want
@@ -231,6 +250,11 @@ protected:
 
     CStereoSignalLevelMeter SignalLevelMeter;
 
+    // network statistics and the state for calculating them
+    CChannelNetStats NetStats;
+    CNetStatsCounter NetStatsCounter;
+    QElapsedTimer    NetStatsTimer;
+
 public slots:
     void OnSendProtMessage ( CVector<uint8_t> vecMessage );
     void OnJittBufSizeChange ( int iNewJitBufSize );
@@ -241,6 +265,12 @@ public slots:
     void OnReqNetTranspProps();
     void OnReqSplitMessSupport();
     void OnSplitMessSupported() { Protocol.SetSplitMessageSupported ( true ); }
+    void OnReqConClientListDeltaSupport() { Protocol.CreateConClientListDeltaSupportedMes(); }
+    void OnConClientListDeltaSupported()
+    {
+        Protocol.SetConClientListDeltaSupported ( true );
+        emit ConClientListDeltaSupported();
+    }
 
     void OnVersionAndOSReceived ( COSUtil::EOpSystemType eOSType, QString strVersion );
 
@@ -250,12 +280,12 @@ public slots:
         Protocol.ParseMessageBody ( vecbyMesBodyData, iRecCounter, iRecID );
     }
 
-    void OnProtocolMessageReceived ( int iRecCounter, int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress RecHostAddr )
+    void OnProtocolMessageReceived ( int iRecCounter, int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress RecHostAddr )
     {
         PutProtocolData ( iRecCounter, iRecID, vecbyMesBodyData, RecHostAddr );
     }
 
-    void OnProtocolCLMessageReceived ( int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress RecHostAddr )
+    void OnProtocolCLMessageReceived ( int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress RecHostAddr )
     {
         emit DetectedCLMessage ( vecbyMesBodyData, iRecID, RecHostAddr );
     }
@@ -269,6 +299,7 @@ signals:
     void JittBufSizeChanged ( int iNewJitBufSize );
     void ServerAutoSockBufSizeChange ( int iNNumFra );
     void ReqConnClientsList();
+    void ConClientListDeltaSupported();
     void ConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
     void ChanInfoHasChanged();
     void ClientIDReceived ( int iChanID );
@@ -280,6 +311,7 @@ signals:
     void LicenceRequired ( ELicenceType eLicenceType );
     void VersionAndOSReceived ( COSUtil::EOpSystemType eOSType, QString strVersion );
     void RecorderStateReceived ( ERecorderState eRecorderState );
+    void NetwFrameSizeFactReceived ( int iNetwFrameSizeFact );
     void Disconnected();
 
     void DetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData, int iRecID, CHostAddress RecHostAddr );
@@ -55,6 +55,7 @@ CClient::CClient ( const quint16  iPortNumber,
     iInputBoost ( 1 ),
     iSndCrdPrefFrameSizeFactor ( FRAME_SIZE_FACTOR_DEFAULT ),
     iSndCrdFrameSizeFactor ( FRAME_SIZE_FACTOR_DEFAULT ),
+    iSuggNetwFrameSizeFactor ( 0 ),
     bSndCrdConversionBufferRequired ( false ),
     iSndCardMonoBlockSizeSamConvBuff ( 0 ),
     bFraSiFactPrefSupported ( false ),
@@ -118,9 +119,8 @@ CClient::CClient ( const quint16  iPortNumber,
 
     QObject::connect ( &Channel, &CChannel::ReqChanInfo, this, &CClient::OnReqChanInfo );
 
-    // The first ConClientListMesReceived handler performs the necessary cleanup and has to run first:
+    // the ConClientListMesReceived handler performs the necessary cleanup and forwards the list
     QObject::connect ( &Channel, &CChannel::ConClientListMesReceived, this, &CClient::OnConClientListMesReceived );
-    QObject::connect ( &Channel, &CChannel::ConClientListMesReceived, this, &CClient::ConClientListMesReceived );
 
     QObject::connect ( &Channel, &CChannel::Disconnected, this, &CClient::Disconnected );
 
@@ -138,6 +138,8 @@ CClient::CClient ( const quint16  iPortNumber,
 
     QObject::connect ( &Channel, &CChannel::RecorderStateReceived, this, &CClient::RecorderStateReceived );
 
+    QObject::connect ( &Channel, &CChannel::NetwFrameSizeFactReceived, this, &CClient::OnNetwFrameSizeFactReceived );
+
     QObject::connect ( &ConnLessProtocol, &CProtocol::CLMessReadyForSending, this, &CClient::OnSendCLProtMessage );
 
     QObject::connect ( &ConnLessProtocol, &CProtocol::CLServerListReceived, this, &CClient::CLServerListReceived );
@@ -293,6 +295,14 @@ void CClient::OnNewConnection()
 
 void CClient::OnConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo )
 {
+    // A server may have more channels than the client can show, these channels
+    // are removed from the list. Since the channel level list of the server is
+    // ordered by the channel ID, the levels still match the remaining channels.
+    vecChanInfo.erase ( std::remove_if ( vecChanInfo.begin(),
+                                         vecChanInfo.end(),
+                                         [] ( const CChannelInfo& ChanInfo ) { return ChanInfo.iChanID >= MAX_NUM_CHANNELS; } ),
+                        vecChanInfo.end() );
+
     // Upon receiving a new client list, we have to reset oldGain and newGain
     // entries for unused channels. This ensures that a disconnected channel
     // does not leave behind wrong cached gain values which would leak into
@@ -316,6 +326,8 @@ void CClient::OnConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo )
             oldGain[iId] = newGain[iId] = 1;
         }
     }
+
+    emit ConClientListMesReceived ( vecChanInfo );
 }
 
 void CClient::CreateServerJitterBufferMessage()
@@ -858,8 +870,28 @@ void CClient::OnClientIDReceived ( int iChanID )
     emit ClientIDReceived ( iChanID );
 }
 
+void CClient::OnNetwFrameSizeFactReceived ( int iNetwFrameSizeFact )
+{
+    // The server suggests a larger network frame size factor to reduce its
+    // packet rate. The conversion buffer of the channel packs several sound card
+    // frames in one network packet (all frame size factors are powers of two),
+    // so only the network transport properties have to be changed and the sound
+    // card keeps running.
+    iSuggNetwFrameSizeFactor = iNetwFrameSizeFact;
+
+    const int iNewNetwFrameSizeFact = std::max ( iSndCrdFrameSizeFactor, iSuggNetwFrameSizeFactor );
+
+    if ( iNewNetwFrameSizeFact != Channel.GetNetwFrameSizeFact() )
+    {
+        Channel.SetAudioStreamProperties ( eAudioCompressionType, iCeltNumCodedBytes, iNewNetwFrameSizeFact, iNumAudioChannels );
+    }
+}
+
 void CClient::Start()
 {
+    // a suggested network frame size factor only applies to the current connection
+    iSuggNetwFrameSizeFactor = 0;
+
     // init object
     Init();
 
@@ -1091,8 +1123,12 @@ void CClient::Init()
     // inits for network and channel
     vecbyNetwData.Init ( iCeltNumCodedBytes );
 
-    // set the channel network properties
-    Channel.SetAudioStreamProperties ( eAudioCompressionType, iCeltNumCodedBytes, iSndCrdFrameSizeFactor, iNumAudioChannels );
+    // set the channel network properties (the network frame size factor may be
+    // larger than the sound card frame size factor if the server suggested so)
+    Channel.SetAudioStreamProperties ( eAudioCompressionType,
+                                       iCeltNumCodedBytes,
+                                       std::max ( iSndCrdFrameSizeFactor, iSuggNetwFrameSizeFactor ),
+                                       iNumAudioChannels );
 
     // init reverberation
     AudioReverb.Init ( eAudioChannelConf, iStereoBlockSizeSam, SYSTEM_SAMPLE_RATE_HZ );
@@ -329,6 +329,7 @@ protected:
 
     int iSndCrdPrefFrameSizeFactor;
     int iSndCrdFrameSizeFactor;
+    int iSuggNetwFrameSizeFactor; // minimum network frame size factor suggested by the server (0 if none)
 
     bool             bSndCrdConversionBufferRequired;
     int              iSndCardMonoBlockSizeSamConvBuff;
@@ -404,6 +405,7 @@ protected slots:
     void OnControllerInMuteMyself ( bool bMute );
     void OnClientIDReceived ( int iChanID );
     void OnConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
+    void OnNetwFrameSizeFactReceived ( int iNetwFrameSizeFact );
 
 signals:
     void ConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
@@ -0,0 +1,91 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+   libFuzzer target of the protocol message parsing. Each input is treated as
+   a received datagram: the frame is checked and the message body is evaluated
+   by the connection or the connection less message parser, as it is done for
+   the packets received by the socket. The CRC is not checked in this build
+   (FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) so that the fuzzer reaches the
+   message bodies.
+
+   Build with clang and run:
+       qmake -spec linux-clang KoordFuzz.pro && make && ./KoordFuzz -max_len=20000 corpus
+*/
+
+#include <QCoreApplication>
+#include <memory>
+#include "global.h"
+#include "protocol.h"
+#include "util.h"
+
+/* Implementation *************************************************************/
+static std::unique_ptr<QCoreApplication> pApp;
+static std::unique_ptr<CProtocol>        pProtocol;
+
+extern "C" int LLVMFuzzerInitialize ( int* argc, char*** argv )
+{
+    // the protocol uses timers which require an application object
+    pApp.reset ( new QCoreApplication ( *argc, *argv ) );
+    pProtocol.reset ( new CProtocol() );
+
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput ( const uint8_t* pbyData, size_t iSize )
+{
+    const CHostAddress HostAddr ( QHostAddress ( QHostAddress::LocalHost ), DEFAULT_PORT_NUMBER );
+    int                iRecCounter;
+    int                iRecID;
+    int                iRecLenBy;
+
+    // the socket does not receive larger datagrams
+    if ( iSize > MAX_SIZE_BYTES_NETW_BUF )
+    {
+        return 0;
+    }
+
+    if ( CProtocol::ParseMessageFrame ( pbyData, static_cast<int> ( iSize ), iRecCounter, iRecID, iRecLenBy ) )
+    {
+        return 0; // not a protocol message
+    }
+
+    CVector<uint8_t> vecbyMesBodyData;
+
+    vecbyMesBodyData.assign ( pbyData + MESS_HEADER_LENGTH_BYTE, pbyData + MESS_HEADER_LENGTH_BYTE + iRecLenBy );
+
+    // every input starts with a new connection so that the runs are reproducible
+    pProtocol->Reset();
+
+    if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
+    {
+        pProtocol->ParseConnectionLessMessageBody ( vecbyMesBodyData, iRecID, HostAddr );
+    }
+    else
+    {
+        pProtocol->ParseMessageBody ( vecbyMesBodyData, iRecCounter, iRecID );
+    }
+
+    return 0;
+}
@@ -204,11 +204,17 @@ LED bar:      lbr
 #define RED_BOUND_LED_BAR    7
 #define YELLOW_BOUND_LED_BAR 5
 
-// maximum number of connected clients at the server (must not be larger than 256)
-#define MAX_NUM_CHANNELS 150 // max number channels for server
+// maximum number of connected clients at the server, the server allocates its
+// channels at runtime for the configured number of channels (the channel IDs
+// and the number of clients are transmitted as one byte in the protocol)
+#define MAX_NUM_SERVER_CHANNELS 255
+
+// maximum number of channels shown by the client, channels with larger IDs
+// are not shown (must not be larger than MAX_NUM_SERVER_CHANNELS)
+#define MAX_NUM_CHANNELS 150
 
 // actual number of used channels in the server
-// this parameter can safely be changed from 1 to MAX_NUM_CHANNELS
+// this parameter can safely be changed from 1 to MAX_NUM_SERVER_CHANNELS
 // without any other changes in the code
 #define DEFAULT_USED_NUM_CHANNELS 10 // default used number channels for server
 
@@ -225,6 +231,11 @@ LED bar:      lbr
 // defines the interval between Channel Level updates from the server
 #define CHANNEL_LEVEL_UPDATE_INTERVAL 200 // number of frames at 64 samples frame size
 
+// time window in which the server collects channel list changes (e.g., many
+// clients joining at the same time) before sending one updated list
+#define DEF_CHAN_LIST_UPDATE_DELAY_MS 100  // ms
+#define MAX_CHAN_LIST_UPDATE_DELAY_MS 2000 // ms
+
 // time-out until a registered server is deleted from the server list if no
 // new registering was made in minutes
 #define SERVLIST_TIME_OUT_MINUTES 33 // minutes (should include 3 UDP registration messages)
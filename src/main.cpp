@@ -38,6 +38,7 @@
 #    endif
 #endif
 #include "settings.h"
+#include "packettrace.h"
 #ifndef SERVER_ONLY
 #    include "testbench.h"
 #endif
@@ -90,41 +91,51 @@ int main ( int argc, char** argv )
 #else
     bool bIsClient = true;
 #endif
-    bool         bUseGUI                     = true;
-    bool         bStartMinimized             = false;
-    bool         bShowComplRegConnList       = false;
-    bool         bDisconnectAllClientsOnQuit = false;
-    bool         bUseDoubleSystemFrameSize   = true; // default is 128 samples frame size
-    bool         bUseMultithreading          = false;
-    bool         bShowAnalyzerConsole        = false;
-    bool         bMuteStream                 = false;
-    bool         bMuteMeInPersonalMix        = false;
-    bool         bDisableRecording           = false;
-    bool         bDelayPan                   = false;
-    bool         bNoAutoJackConnect          = false;
-    bool         bUseTranslation             = true;
-    bool         bCustomPortNumberGiven      = false;
-    bool         bEnableIPv6                 = false;
-    int          iNumServerChannels          = DEFAULT_USED_NUM_CHANNELS;
-    quint16      iPortNumber                 = DEFAULT_PORT_NUMBER;
-    int          iJsonRpcPortNumber          = INVALID_PORT;
-    quint16      iQosNumber                  = DEFAULT_QOS_NUMBER;
-    ELicenceType eLicenceType                = LT_NO_LICENCE;
-    QString      strMIDISetup                = "";
-    QString      strConnOnStartupAddress     = "";
-    QString      strIniFileName              = "";
-    QString      strHTMLStatusFileName       = "";
-    QString      strLoggingFileName          = "";
-    QString      strRecordingDirName         = "";
-    QString      strDirectoryServer          = "";
-    QString      strServerListFileName       = "";
-    QString      strServerInfo               = "";
-    QString      strServerPublicIP           = "";
-    QString      strServerBindIP             = "";
-    QString      strServerListFilter         = "";
-    QString      strWelcomeMessage           = "";
-    QString      strClientName               = "";
-    QString      strJsonRpcSecretFileName    = "";
+    bool              bUseGUI                     = true;
+    bool              bStartMinimized             = false;
+    bool              bShowComplRegConnList       = false;
+    bool              bDisconnectAllClientsOnQuit = false;
+    bool              bUseDoubleSystemFrameSize   = true; // default is 128 samples frame size
+    bool              bUseMultithreading          = false;
+    bool              bShowAnalyzerConsole        = false;
+    bool              bMuteStream                 = false;
+    bool              bMuteMeInPersonalMix        = false;
+    bool              bDisableRecording           = false;
+    bool              bDelayPan                   = false;
+    bool              bNoAutoJackConnect          = false;
+    bool              bUseTranslation             = true;
+    bool              bCustomPortNumberGiven      = false;
+    bool              bEnableIPv6                 = false;
+    bool              bFastReplayTrace            = false;
+    int               iNumServerChannels          = DEFAULT_USED_NUM_CHANNELS;
+    int               iMaxFrameLoadPercent        = 0;
+    int               iChanListUpdateDelayMs      = DEF_CHAN_LIST_UPDATE_DELAY_MS;
+    int               iLoadTestNumClients         = 0;
+    quint16           iPortNumber                 = DEFAULT_PORT_NUMBER;
+    int               iJsonRpcPortNumber          = INVALID_PORT;
+    quint16           iQosNumber                  = DEFAULT_QOS_NUMBER;
+    ELicenceType      eLicenceType                = LT_NO_LICENCE;
+    ERecordingFormat  eRecordingFormat            = RF_WAV;
+    ERecordingMixdown eRecordingMixdown           = RM_NONE;
+    QString           strMIDISetup                = "";
+    QString           strConnOnStartupAddress     = "";
+    QString           strIniFileName              = "";
+    QString           strHTMLStatusFileName       = "";
+    QString           strLoggingFileName          = "";
+    QString           strRecordingDirName         = "";
+    QString           strDirectoryServer          = "";
+    QString           strServerListFileName       = "";
+    QString           strServerInfo               = "";
+    QString           strServerPublicIP           = "";
+    QString           strServerBindIP             = "";
+    QString           strServerListFilter         = "";
+    QString           strWelcomeMessage           = "";
+    QString           strClientName               = "";
+    QString           strJsonRpcSecretFileName    = "";
+    QString           strLoadTestSignal           = "";
+    QString           strCaptureTraceFileName     = "";
+    QString           strReplayTraceFileName      = "";
+    QString           strTraceEventsFileName      = "";
     // handle primary / secondary instances
     MessageReceiver msgReceiver;
 
@@ -139,6 +150,8 @@ int main ( int argc, char** argv )
     Q_UNUSED ( bMuteMeInPersonalMix )
     Q_UNUSED ( bNoAutoJackConnect )
     Q_UNUSED ( bCustomPortNumberGiven )
+    Q_UNUSED ( iLoadTestNumClients )
+    Q_UNUSED ( strLoadTestSignal )
 #endif
 
 #if !defined( HEADLESS ) && defined( _WIN32 )
@@ -247,6 +260,23 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Trace events --------------------------------------------------------
+        // Undocumented debugging command line argument: Record the timeline of
+        // the processing threads and write it in the Chrome trace format into
+        // the given file when quitting.
+        if ( GetStringArgument ( argc,
+                                 argv,
+                                 i,
+                                 "--tracefile", // no short form
+                                 "--tracefile",
+                                 strArgument ) )
+        {
+            strTraceEventsFileName = strArgument;
+            qInfo() << qUtf8Printable ( QString ( "- trace events file: %1" ).arg ( strTraceEventsFileName ) );
+            CommandLineOptions << "--tracefile";
+            continue;
+        }
+
         // Server only:
 
         // Disconnect all clients on quit --------------------------------------
@@ -408,6 +438,65 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Recording file format -----------------------------------------------
+        if ( GetStringArgument ( argc,
+                                 argv,
+                                 i,
+                                 "--recordformat", // no short form
+                                 "--recordformat",
+                                 strArgument ) )
+        {
+            if ( !strArgument.compare ( "opus", Qt::CaseInsensitive ) )
+            {
+                eRecordingFormat = RF_OPUS;
+            }
+            else if ( !strArgument.compare ( "flac", Qt::CaseInsensitive ) )
+            {
+                eRecordingFormat = RF_FLAC;
+            }
+            else if ( strArgument.compare ( "wav", Qt::CaseInsensitive ) )
+            {
+                qCritical() << qUtf8Printable (
+                    QString ( "%1: Unknown recording format '%2' -- use '--help' for help" ).arg ( argv[0] ).arg ( strArgument ) );
+                exit ( 1 );
+            }
+
+            qInfo() << qUtf8Printable ( QString ( "- recording format: %1" )
+                                            .arg ( eRecordingFormat == RF_OPUS ? "Ogg/Opus" : eRecordingFormat == RF_FLAC ? "FLAC" : "WAV" ) );
+            CommandLineOptions << "--recordformat";
+            ServerOnlyOptions << "--recordformat";
+            continue;
+        }
+
+        // Recording mixdown track ---------------------------------------------
+        if ( GetStringArgument ( argc,
+                                 argv,
+                                 i,
+                                 "--recordmixdown", // no short form
+                                 "--recordmixdown",
+                                 strArgument ) )
+        {
+            if ( !strArgument.compare ( "stereo", Qt::CaseInsensitive ) )
+            {
+                eRecordingMixdown = RM_STEREO;
+            }
+            else if ( !strArgument.compare ( "centre", Qt::CaseInsensitive ) || !strArgument.compare ( "center", Qt::CaseInsensitive ) )
+            {
+                eRecordingMixdown = RM_CENTRE;
+            }
+            else
+            {
+                qCritical() << qUtf8Printable (
+                    QString ( "%1: Unknown recording mixdown '%2' -- use '--help' for help" ).arg ( argv[0] ).arg ( strArgument ) );
+                exit ( 1 );
+            }
+
+            qInfo() << qUtf8Printable ( QString ( "- recording mixdown: %1" ).arg ( eRecordingMixdown == RM_CENTRE ? "centre panned" : "stereo" ) );
+            CommandLineOptions << "--recordmixdown";
+            ServerOnlyOptions << "--recordmixdown";
+            continue;
+        }
+
         // Server mode flag ----------------------------------------------------
         if ( GetFlagArgument ( argv, i, "-s", "--server" ) )
         {
@@ -444,7 +533,7 @@ int main ( int argc, char** argv )
         }
 
         // Maximum number of channels ------------------------------------------
-        if ( GetNumericArgument ( argc, argv, i, "-u", "--numchannels", 1, MAX_NUM_CHANNELS, rDbleArgument ) )
+        if ( GetNumericArgument ( argc, argv, i, "-u", "--numchannels", 1, MAX_NUM_SERVER_CHANNELS, rDbleArgument ) )
         {
             iNumServerChannels = static_cast<int> ( rDbleArgument );
 
@@ -455,6 +544,44 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Maximum frame load --------------------------------------------------
+        if ( GetNumericArgument ( argc,
+                                  argv,
+                                  i,
+                                  "--maxframeload", // no short form
+                                  "--maxframeload",
+                                  1,
+                                  100,
+                                  rDbleArgument ) )
+        {
+            iMaxFrameLoadPercent = static_cast<int> ( rDbleArgument );
+
+            qInfo() << qUtf8Printable ( QString ( "- maximum frame load: %1 %" ).arg ( iMaxFrameLoadPercent ) );
+
+            CommandLineOptions << "--maxframeload";
+            ServerOnlyOptions << "--maxframeload";
+            continue;
+        }
+
+        // Channel list update delay -------------------------------------------
+        if ( GetNumericArgument ( argc,
+                                  argv,
+                                  i,
+                                  "--chanlistdelay", // no short form
+                                  "--chanlistdelay",
+                                  0,
+                                  MAX_CHAN_LIST_UPDATE_DELAY_MS,
+                                  rDbleArgument ) )
+        {
+            iChanListUpdateDelayMs = static_cast<int> ( rDbleArgument );
+
+            qInfo() << qUtf8Printable ( QString ( "- channel list update delay: %1 ms" ).arg ( iChanListUpdateDelayMs ) );
+
+            CommandLineOptions << "--chanlistdelay";
+            ServerOnlyOptions << "--chanlistdelay";
+            continue;
+        }
+
         // Server welcome message ----------------------------------------------
         if ( GetStringArgument ( argc, argv, i, "-w", "--welcomemessage", strArgument ) )
         {
@@ -475,6 +602,55 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Packet trace capture ------------------------------------------------
+        // Undocumented debugging command line argument: Record every received
+        // datagram with its time and sender address into the given file.
+        if ( GetStringArgument ( argc,
+                                 argv,
+                                 i,
+                                 "--capturetrace", // no short form
+                                 "--capturetrace",
+                                 strArgument ) )
+        {
+            strCaptureTraceFileName = strArgument;
+            qInfo() << qUtf8Printable ( QString ( "- packet trace capture file: %1" ).arg ( strCaptureTraceFileName ) );
+            CommandLineOptions << "--capturetrace";
+            ServerOnlyOptions << "--capturetrace";
+            continue;
+        }
+
+        // Packet trace replay -------------------------------------------------
+        // Undocumented debugging command line argument: Do not use the network
+        // but feed the given packet trace into the server and quit at its end.
+        if ( GetStringArgument ( argc,
+                                 argv,
+                                 i,
+                                 "--replaytrace", // no short form
+                                 "--replaytrace",
+                                 strArgument ) )
+        {
+            strReplayTraceFileName = strArgument;
+            qInfo() << qUtf8Printable ( QString ( "- packet trace replay file: %1" ).arg ( strReplayTraceFileName ) );
+            CommandLineOptions << "--replaytrace";
+            ServerOnlyOptions << "--replaytrace";
+            continue;
+        }
+
+        // Fast packet trace replay --------------------------------------------
+        // Undocumented debugging command line argument: Replay the packet trace
+        // as fast as possible instead of at the recorded pace.
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--replayfast", // no short form
+                               "--replayfast" ) )
+        {
+            bFastReplayTrace = true;
+            qInfo() << "- fast packet trace replay";
+            CommandLineOptions << "--replayfast";
+            ServerOnlyOptions << "--replayfast";
+            continue;
+        }
+
         // Client only:
 
         // Connect on startup --------------------------------------------------
@@ -622,6 +798,43 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Load test -----------------------------------------------------------
+        // Undocumented debugging command line argument: Instead of the client,
+        // run the given number of synthetic clients against the server given
+        // by --connect (localhost if not given) and report their statistics.
+        if ( GetNumericArgument ( argc,
+                                  argv,
+                                  i,
+                                  "--loadtest", // no short form
+                                  "--loadtest",
+                                  1,
+                                  MAX_NUM_SERVER_CHANNELS,
+                                  rDbleArgument ) )
+        {
+            iLoadTestNumClients = static_cast<int> ( rDbleArgument );
+            qInfo() << qUtf8Printable ( QString ( "- load test with %1 clients" ).arg ( iLoadTestNumClients ) );
+            CommandLineOptions << "--loadtest";
+            ClientOnlyOptions << "--loadtest";
+            continue;
+        }
+
+        // Load test signal ----------------------------------------------------
+        // Undocumented debugging command line argument: Signal the synthetic
+        // clients of the load test send: sine (default), noise or a WAV file.
+        if ( GetStringArgument ( argc,
+                                 argv,
+                                 i,
+                                 "--loadtestsignal", // no short form
+                                 "--loadtestsignal",
+                                 strArgument ) )
+        {
+            strLoadTestSignal = strArgument;
+            qInfo() << qUtf8Printable ( QString ( "- load test signal: %1" ).arg ( strLoadTestSignal ) );
+            CommandLineOptions << "--loadtestsignal";
+            ClientOnlyOptions << "--loadtestsignal";
+            continue;
+        }
+
         // Clean up legacy fader settings --------------------------------------
         // Undocumented temporary command line argument: Clean up fader settings
         // corrupted by bug #2680.  Only needs to be used once (per file).
@@ -951,10 +1164,30 @@ int main ( int argc, char** argv )
     // init resources
     Q_INIT_RESOURCE ( resources );
 
+    // record trace events until the application quits
+    CTraceEvents::SetThreadName ( "main" );
+
+    if ( !strTraceEventsFileName.isEmpty() )
+    {
+        CTraceEvents::Enable();
+
+        QObject::connect ( pApp, &QCoreApplication::aboutToQuit, [strTraceEventsFileName]() {
+            CTraceEvents::Disable();
+
+            if ( !CTraceEvents::WriteChromeTrace ( strTraceEventsFileName ) )
+            {
+                qWarning() << qUtf8Printable ( QString ( "- cannot write the trace events file %1" ).arg ( strTraceEventsFileName ) );
+            }
+        } );
+    }
+
 #ifndef SERVER_ONLY
     //### TEST: BEGIN ###//
     // activate the following line to activate the test bench,
     // CTestbench Testbench ( "127.0.0.1", DEFAULT_PORT_NUMBER );
+    // activate the following lines to run the CRC and protocol benchmarks,
+    // CTestbench::RunCRCBenchmark();
+    // CTestbench::RunProtocolBenchmark();
     //### TEST: END ###//
 #endif
 
@@ -1005,7 +1238,17 @@ int main ( int argc, char** argv )
     try
     {
 #ifndef SERVER_ONLY
-        if ( bIsClient )
+        if ( bIsClient && ( iLoadTestNumClients > 0 ) )
+        {
+            // Load test:
+            CTestbenchLoadGenerator LoadGenerator ( strConnOnStartupAddress.isEmpty() ? QString ( "127.0.0.1" ) : strConnOnStartupAddress,
+                                                    iLoadTestNumClients,
+                                                    strLoadTestSignal,
+                                                    bEnableIPv6 );
+
+            pApp->exec();
+        }
+        else if ( bIsClient )
         {
             // Client:
             // actual client object
@@ -1089,8 +1332,26 @@ int main ( int argc, char** argv )
                              bDisableRecording,
                              bDelayPan,
                              bEnableIPv6,
+                             !strReplayTraceFileName.isEmpty(),
+                             iChanListUpdateDelayMs,
+                             eRecordingFormat,
+                             eRecordingMixdown,
                              eLicenceType );
 
+            if ( !strCaptureTraceFileName.isEmpty() && !Server.StartPacketTraceCapture ( strCaptureTraceFileName ) )
+            {
+                throw CGenErr ( QString ( "Cannot write the packet trace file %1." ).arg ( strCaptureTraceFileName ), "Packet Trace Error" );
+            }
+
+            Server.SetMaxFrameLoad ( iMaxFrameLoadPercent );
+
+            std::unique_ptr<CPacketTraceReplay> pPacketTraceReplay;
+
+            if ( !strReplayTraceFileName.isEmpty() )
+            {
+                pPacketTraceReplay.reset ( new CPacketTraceReplay ( &Server, strReplayTraceFileName, bFastReplayTrace ) );
+            }
+
 #ifndef NO_JSON_RPC
             if ( pRpcServer )
             {
@@ -1194,6 +1455,8 @@ QString UsageArguments ( char** argv )
            "  -6, --enableipv6      enable IPv6 addressing (IPv4 is always enabled)\n"
            "\n"
            "Server only:\n"
+           "      --chanlistdelay   time window in ms to collect channel list changes\n"
+           "                        before sending them to the Clients (0: no delay)\n"
            "  -d, --discononquit    disconnect all Clients on quit\n"
            "  -e, --directoryserver address of the directory Server with which to register\n"
            "                        (or 'localhost' to host a server list on this Server)\n"
@@ -1212,11 +1475,16 @@ QString UsageArguments ( char** argv )
            "  -P, --delaypan        start with delay panning enabled\n"
            "  -R, --recording       set server recording directory; server will record when a session is active by default\n"
            "      --norecord        set server not to record by default when recording is configured\n"
+           "      --recordformat    recording file format: wav (default), opus (Ogg/Opus) or flac\n"
+           "      --recordmixdown   also record a stereo mix of all clients: stereo or centre\n"
+           "                        (all clients panned to the centre)\n"
            "  -s, --server          start Server\n"
            "      --serverbindip    IP address the Server will bind to (rather than all)\n"
            "  -T, --multithreading  use multithreading to make better use of\n"
            "                        multi-core CPUs and support more Clients\n"
            "  -u, --numchannels     maximum number of channels\n"
+           "      --maxframeload    refuse new Clients if the projected frame processing\n"
+           "                        time exceeds this percentage of the frame duration\n"
            "  -w, --welcomemessage  welcome message to display on connect\n"
            "                        (string or filename, HTML supported)\n"
            "  -z, --startminimized  start minimizied\n"
@@ -0,0 +1,362 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "packettrace.h"
+#include "server.h"
+
+/* Implementation *************************************************************/
+// CPacketTraceWriter implementation *******************************************
+bool CPacketTraceWriter::Open ( const QString& strFileName )
+{
+    File.setFileName ( strFileName );
+
+    if ( !File.open ( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        return false;
+    }
+
+    Stream.setDevice ( &File );
+    Stream.setByteOrder ( QDataStream::LittleEndian );
+    Stream.writeRawData ( PACKET_TRACE_MAGIC, 8 );
+
+    iLastRecordTimeUs = 0;
+
+    return true;
+}
+
+void CPacketTraceWriter::Write ( const int64_t iRecTimeUs, const CHostAddress& HostAddr, const uint8_t* pbyData, const int iNumBytes )
+{
+    // IPv4 addresses are stored as IPv4 mapped IPv6 addresses
+    const Q_IPV6ADDR IPv6Addr = HostAddr.InetAddr.toIPv6Address();
+    const int64_t    iDeltaUs = std::min ( iRecTimeUs - iLastRecordTimeUs, static_cast<int64_t> ( UINT32_MAX ) );
+
+    iLastRecordTimeUs = iRecTimeUs;
+
+    Stream << static_cast<quint32> ( iDeltaUs );
+    Stream.writeRawData ( reinterpret_cast<const char*> ( IPv6Addr.c ), 16 );
+    Stream << static_cast<quint16> ( HostAddr.iPort ) << static_cast<quint16> ( iNumBytes );
+    Stream.writeRawData ( reinterpret_cast<const char*> ( pbyData ), iNumBytes );
+}
+
+// CPacketTraceCapture implementation ******************************************
+CPacketTraceCapture::CPacketTraceCapture() :
+    iMask ( 0 ),
+    iReadPos ( 0 ),
+    iWritePos ( 0 ),
+    iNumDroppedPackets ( 0 ),
+    bRun ( false ),
+    vecbyPacketData ( MAX_SIZE_BYTES_NETW_BUF )
+{
+    setObjectName ( "CPacketTraceCapture" );
+}
+
+bool CPacketTraceCapture::Start ( const QString& strFileName )
+{
+    if ( !Writer.Open ( strFileName ) )
+    {
+        return false;
+    }
+
+    // the ring memory is only allocated if a capture is actually started
+    vecbyRing.Init ( PACKET_TRACE_CAPTURE_RING_SIZE_BYTES );
+    iMask = PACKET_TRACE_CAPTURE_RING_SIZE_BYTES - 1;
+
+    Writer.MoveToThread ( this );
+    ElapsedTimer.start();
+
+    bRun = true;
+    QThread::start ( QThread::LowestPriority );
+
+    return true;
+}
+
+void CPacketTraceCapture::Stop()
+{
+    if ( !isRunning() )
+    {
+        return;
+    }
+
+    // the remaining datagrams are written before the thread finishes
+    bRun = false;
+    wait();
+
+    if ( GetNumDroppedPackets() > 0 )
+    {
+        qWarning() << qUtf8Printable ( QString ( "- packet trace capture: %1 datagrams dropped" ).arg ( GetNumDroppedPackets() ) );
+    }
+}
+
+void CPacketTraceCapture::WriteAt ( const uint32_t iPos, const void* pData, const int iLen )
+{
+    const uint32_t iStart    = iPos & iMask;
+    const int      iFirstLen = std::min ( iLen, static_cast<int> ( iMask + 1 - iStart ) );
+
+    memcpy ( &vecbyRing[iStart], pData, iFirstLen );
+    memcpy ( &vecbyRing[0], static_cast<const uint8_t*> ( pData ) + iFirstLen, iLen - iFirstLen );
+}
+
+void CPacketTraceCapture::ReadAt ( const uint32_t iPos, void* pData, const int iLen ) const
+{
+    const uint32_t iStart    = iPos & iMask;
+    const int      iFirstLen = std::min ( iLen, static_cast<int> ( iMask + 1 - iStart ) );
+
+    memcpy ( pData, &vecbyRing[iStart], iFirstLen );
+    memcpy ( static_cast<uint8_t*> ( pData ) + iFirstLen, &vecbyRing[0], iLen - iFirstLen );
+}
+
+void CPacketTraceCapture::Put ( const CHostAddress& HostAddr, const uint8_t* pbyData, const int iNumBytes )
+{
+    const uint32_t iCurWritePos = iWritePos.load ( std::memory_order_relaxed );
+    const uint32_t iRecordLen   = static_cast<uint32_t> ( iRecordHeaderSizeBytes + iNumBytes );
+
+    // the indices are free running, the unsigned difference is the used size
+    if ( iCurWritePos + iRecordLen - iReadPos.load ( std::memory_order_acquire ) > iMask + 1 )
+    {
+        iNumDroppedPackets.fetch_add ( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    uint8_t vecbyHeader[iRecordHeaderSizeBytes];
+
+    const int64_t    iRecTimeUs  = ElapsedTimer.nsecsElapsed() / 1000;
+    const Q_IPV6ADDR IPv6Addr    = HostAddr.InetAddr.toIPv6Address();
+    const uint16_t   iPort16     = static_cast<uint16_t> ( HostAddr.iPort );
+    const uint16_t   iNumBytes16 = static_cast<uint16_t> ( iNumBytes );
+
+    memcpy ( &vecbyHeader[0], &iRecTimeUs, 8 );
+    memcpy ( &vecbyHeader[8], IPv6Addr.c, 16 );
+    memcpy ( &vecbyHeader[24], &iPort16, 2 );
+    memcpy ( &vecbyHeader[26], &iNumBytes16, 2 );
+
+    WriteAt ( iCurWritePos, vecbyHeader, iRecordHeaderSizeBytes );
+    WriteAt ( iCurWritePos + iRecordHeaderSizeBytes, pbyData, iNumBytes );
+
+    iWritePos.store ( iCurWritePos + iRecordLen, std::memory_order_release );
+}
+
+void CPacketTraceCapture::WriteCapturedPackets()
+{
+    const uint32_t iCurWritePos = iWritePos.load ( std::memory_order_acquire );
+    uint32_t       iCurReadPos  = iReadPos.load ( std::memory_order_relaxed );
+
+    while ( iCurReadPos != iCurWritePos )
+    {
+        uint8_t    vecbyHeader[iRecordHeaderSizeBytes];
+        int64_t    iRecTimeUs;
+        Q_IPV6ADDR IPv6Addr;
+        uint16_t   iPort16;
+        uint16_t   iNumBytes16;
+
+        ReadAt ( iCurReadPos, vecbyHeader, iRecordHeaderSizeBytes );
+
+        memcpy ( &iRecTimeUs, &vecbyHeader[0], 8 );
+        memcpy ( IPv6Addr.c, &vecbyHeader[8], 16 );
+        memcpy ( &iPort16, &vecbyHeader[24], 2 );
+        memcpy ( &iNumBytes16, &vecbyHeader[26], 2 );
+
+        ReadAt ( iCurReadPos + iRecordHeaderSizeBytes, &vecbyPacketData[0], iNumBytes16 );
+
+        iCurReadPos += static_cast<uint32_t> ( iRecordHeaderSizeBytes + iNumBytes16 );
+        iReadPos.store ( iCurReadPos, std::memory_order_release );
+
+        Writer.Write ( iRecTimeUs, CHostAddress ( QHostAddress ( IPv6Addr ), iPort16 ), &vecbyPacketData[0], iNumBytes16 );
+    }
+}
+
+void CPacketTraceCapture::run()
+{
+    CTraceEvents::SetThreadName ( "packet trace capture" );
+
+    while ( bRun )
+    {
+        WriteCapturedPackets();
+        msleep ( PACKET_TRACE_CAPTURE_POLL_INTERVAL_MS );
+    }
+
+    WriteCapturedPackets();
+    Writer.Close();
+}
+
+// CPacketTraceReader implementation *******************************************
+bool CPacketTraceReader::Open ( const QString& strFileName )
+{
+    char strMagic[8];
+
+    File.setFileName ( strFileName );
+
+    if ( !File.open ( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+
+    Stream.setDevice ( &File );
+    Stream.setByteOrder ( QDataStream::LittleEndian );
+
+    iTimeUs = 0;
+
+    return ( Stream.readRawData ( strMagic, 8 ) == 8 ) && ( memcmp ( strMagic, PACKET_TRACE_MAGIC, 8 ) == 0 );
+}
+
+bool CPacketTraceReader::ReadPacket ( int64_t& iRecTimeUs, CHostAddress& HostAddr, CVector<uint8_t>& vecbyData, int& iNumBytes )
+{
+    quint32    iDeltaUs;
+    Q_IPV6ADDR IPv6Addr;
+    quint16    iPort;
+    quint16    iRecNumBytes;
+
+    Stream >> iDeltaUs;
+    Stream.readRawData ( reinterpret_cast<char*> ( IPv6Addr.c ), 16 );
+    Stream >> iPort >> iRecNumBytes;
+
+    // check for the end of the trace and for corrupt records
+    if ( ( Stream.status() != QDataStream::Ok ) || ( iRecNumBytes > vecbyData.Size() ) ||
+         ( Stream.readRawData ( reinterpret_cast<char*> ( &vecbyData[0] ), iRecNumBytes ) != iRecNumBytes ) )
+    {
+        return false;
+    }
+
+    // restore IPv4 addresses as the socket reports them
+    QHostAddress  InetAddr ( IPv6Addr );
+    bool          bIsIPv4;
+    const quint32 iIPv4Addr = InetAddr.toIPv4Address ( &bIsIPv4 );
+
+    if ( bIsIPv4 )
+    {
+        InetAddr.setAddress ( iIPv4Addr );
+    }
+
+    iTimeUs += iDeltaUs;
+
+    iRecTimeUs = iTimeUs;
+    HostAddr   = CHostAddress ( InetAddr, iPort );
+    iNumBytes  = iRecNumBytes;
+
+    return true;
+}
+
+// CPacketTraceReplay implementation *******************************************
+CPacketTraceReplay::CPacketTraceReplay ( CServer* pNServP, const QString& strFileName, const bool bNFastReplay ) :
+    pServer ( pNServP ),
+    bFastReplay ( bNFastReplay ),
+    iFrameDurationNs ( pNServP->GetFrameDeadlineNs() ),
+    iCurFrameStartNs ( 0 ),
+    iNumFrames ( 0 ),
+    iNumPackets ( 0 ),
+    vecbyPacketData ( MAX_SIZE_BYTES_NETW_BUF ),
+    iPacketNumBytes ( 0 )
+{
+    if ( !Reader.Open ( strFileName ) )
+    {
+        throw CGenErr ( QString ( "Cannot open the packet trace file %1." ).arg ( strFileName ), "Packet Trace Error" );
+    }
+
+    ReadNextPacket();
+
+    qInfo() << qUtf8Printable (
+        QString ( "- replaying packet trace %1 %2" ).arg ( strFileName ).arg ( bFastReplay ? "as fast as possible" : "at recorded pace" ) );
+
+    QObject::connect ( &Timer, &QTimer::timeout, this, &CPacketTraceReplay::OnTimer );
+
+    ElapsedTimer.start();
+    Timer.start ( bFastReplay ? 0 : PACKET_TRACE_REPLAY_TIMER_INTERVAL_MS );
+}
+
+void CPacketTraceReplay::ReadNextPacket()
+{
+    int64_t iRecTimeUs;
+
+    bPacketPending = Reader.ReadPacket ( iRecTimeUs, PacketHostAddr, vecbyPacketData, iPacketNumBytes );
+    iPacketTimeNs  = iRecTimeUs * 1000;
+}
+
+void CPacketTraceReplay::OnTimer()
+{
+    const int64_t iElapsedNs         = ElapsedTimer.nsecsElapsed();
+    int           iNumFramesThisCall = 0;
+
+    // at recorded pace, all frames which are due are processed
+    while ( bFastReplay ? ( iNumFramesThisCall < PACKET_TRACE_FAST_REPLAY_FRAMES_PER_CALL ) : ( iCurFrameStartNs + iFrameDurationNs <= iElapsedNs ) )
+    {
+        if ( !bPacketPending )
+        {
+            Finish();
+            return;
+        }
+
+        const int64_t iFrameEndNs = iCurFrameStartNs + iFrameDurationNs;
+
+        // a server without clients does not process frames, skip to the frame of the next packet
+        if ( !pServer->IsRunning() && ( iPacketTimeNs >= iFrameEndNs ) )
+        {
+            iCurFrameStartNs += ( iPacketTimeNs - iCurFrameStartNs ) / iFrameDurationNs * iFrameDurationNs;
+            continue;
+        }
+
+        // put all packets which were received during the frame
+        while ( bPacketPending && ( iPacketTimeNs < iFrameEndNs ) )
+        {
+            pServer->PutReplayPacket ( vecbyPacketData, iPacketNumBytes, PacketHostAddr );
+            iNumPackets++;
+
+            ReadNextPacket();
+        }
+
+        // a new connection posts an event to start the server, which must take effect in this frame
+        QCoreApplication::sendPostedEvents ( pServer );
+
+        if ( pServer->IsRunning() )
+        {
+            pServer->OnTimer();
+            iNumFrames++;
+        }
+
+        iCurFrameStartNs = iFrameEndNs;
+        iNumFramesThisCall++;
+    }
+}
+
+void CPacketTraceReplay::Finish()
+{
+    Timer.stop();
+
+    const double            dElapsedS            = static_cast<double> ( ElapsedTimer.nsecsElapsed() ) / 1000000000;
+    const double            dTraceS              = static_cast<double> ( iCurFrameStartNs ) / 1000000000;
+    const CTimingHistogram& FrameTimingHistogram = pServer->GetFrameTimingHistogram ( SFP_FRAME );
+
+    qInfo() << qUtf8Printable ( QString ( "- packet trace replay finished: %1 packets, %2 frames, %3 s trace in %4 s (%5x real time)" )
+                                    .arg ( iNumPackets )
+                                    .arg ( iNumFrames )
+                                    .arg ( dTraceS, 0, 'f', 1 )
+                                    .arg ( dElapsedS, 0, 'f', 1 )
+                                    .arg ( ( dElapsedS > 0 ) ? dTraceS / dElapsedS : 0, 0, 'f', 1 ) );
+
+    qInfo() << qUtf8Printable ( QString ( "- frame processing time: p50 %1 us, p99 %2 us, max %3 us, %4 deadline misses" )
+                                    .arg ( static_cast<double> ( FrameTimingHistogram.GetPercentileNs ( 50 ) ) / 1000, 0, 'f', 1 )
+                                    .arg ( static_cast<double> ( FrameTimingHistogram.GetPercentileNs ( 99 ) ) / 1000, 0, 'f', 1 )
+                                    .arg ( static_cast<double> ( FrameTimingHistogram.GetMaxNs() ) / 1000, 0, 'f', 1 )
+                                    .arg ( pServer->GetNumFrameDeadlineMisses() ) );
+
+    QCoreApplication::quit();
+}
@@ -0,0 +1,178 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QDataStream>
+#include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <atomic>
+#include "global.h"
+#include "util.h"
+
+// The packet trace replay feeds the server, to avoid a cyclic dependency only
+// a prototype of the server class is defined here.
+class CServer; // forward declaration of CServer
+
+/* Definitions ****************************************************************/
+// packet trace file format (all values little endian):
+// header: magic "KDTRACE1" (8 bytes)
+// record: time since the previous record in us (uint32), IPv6 or IPv4 mapped
+//         sender address (16 bytes), sender port (uint16), number of bytes
+//         (uint16), datagram
+#define PACKET_TRACE_MAGIC "KDTRACE1"
+
+// number of frames the fast replay processes before returning to the event loop
+#define PACKET_TRACE_FAST_REPLAY_FRAMES_PER_CALL 100
+
+// interval of the replay timer at recorded pace
+#define PACKET_TRACE_REPLAY_TIMER_INTERVAL_MS 1
+
+// size of the ring buffer between the receive thread and the capture writer
+// thread (must be a power of two), this holds more than a second of datagrams
+// of a fully loaded server
+#define PACKET_TRACE_CAPTURE_RING_SIZE_BYTES ( 1 << 23 ) // 8 MB
+
+// interval in which the capture writer thread writes the captured datagrams
+#define PACKET_TRACE_CAPTURE_POLL_INTERVAL_MS 20
+
+/* Classes ********************************************************************/
+// records datagrams into a packet trace file, note that the file is written in
+// the calling thread (buffered by QFile)
+class CPacketTraceWriter
+{
+public:
+    CPacketTraceWriter() : iLastRecordTimeUs ( 0 ) {}
+
+    bool Open ( const QString& strFileName );
+    void Write ( const int64_t iRecTimeUs, const CHostAddress& HostAddr, const uint8_t* pbyData, const int iNumBytes );
+    void Close() { File.close(); }
+
+    // the file must be written in the thread it belongs to
+    void MoveToThread ( QThread* pThread ) { File.moveToThread ( pThread ); }
+
+protected:
+    QFile       File;
+    QDataStream Stream;
+    int64_t     iLastRecordTimeUs;
+};
+
+// Captures the received datagrams into a packet trace file. The receive thread
+// copies each datagram into a preallocated single producer, single consumer ring
+// buffer without locking or allocating memory, a low priority thread writes the
+// datagrams into the file. If the writer falls behind and the ring buffer is
+// full, the datagram is dropped and counted instead of blocking the reception.
+class CPacketTraceCapture : public QThread
+{
+public:
+    CPacketTraceCapture();
+    virtual ~CPacketTraceCapture() { Stop(); }
+
+    bool Start ( const QString& strFileName );
+    void Stop();
+
+    // producer (receive thread)
+    void Put ( const CHostAddress& HostAddr, const uint8_t* pbyData, const int iNumBytes );
+
+    int GetNumDroppedPackets() const { return iNumDroppedPackets.load ( std::memory_order_relaxed ); }
+
+protected:
+    // each record starts with a header: receive time in us (8 bytes), IPv6 or
+    // mapped IPv4 address (16 bytes), port (2 bytes) and number of bytes (2 bytes)
+    static const int iRecordHeaderSizeBytes = 28;
+
+    virtual void run();
+
+    void WriteAt ( const uint32_t iPos, const void* pData, const int iLen );
+    void ReadAt ( const uint32_t iPos, void* pData, const int iLen ) const;
+    void WriteCapturedPackets();
+
+    CPacketTraceWriter    Writer;
+    QElapsedTimer         ElapsedTimer;
+    CVector<uint8_t>      vecbyRing;
+    uint32_t              iMask;
+    std::atomic<uint32_t> iReadPos;
+    std::atomic<uint32_t> iWritePos;
+    std::atomic<int>      iNumDroppedPackets;
+    std::atomic<bool>     bRun;
+
+    // consumer state
+    CVector<uint8_t> vecbyPacketData;
+};
+
+// reads the datagrams of a packet trace file in the recorded order
+class CPacketTraceReader
+{
+public:
+    CPacketTraceReader() : iTimeUs ( 0 ) {}
+
+    bool Open ( const QString& strFileName );
+    bool ReadPacket ( int64_t& iRecTimeUs, CHostAddress& HostAddr, CVector<uint8_t>& vecbyData, int& iNumBytes );
+
+protected:
+    QFile       File;
+    QDataStream Stream;
+    int64_t     iTimeUs;
+};
+
+// Feeds a packet trace into a server which does not use the network. The server
+// frames are processed by the replay (instead of the server timer) with the
+// packets of each frame put before the frame, so that the replay is the same on
+// each run. The frames are processed either at the recorded pace or as fast as
+// possible. The application is quit at the end of the trace.
+class CPacketTraceReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    CPacketTraceReplay ( CServer* pNServP, const QString& strFileName, const bool bNFastReplay );
+
+protected:
+    void ReadNextPacket();
+    void Finish();
+
+    CServer*           pServer;
+    CPacketTraceReader Reader;
+    bool               bFastReplay;
+    QTimer             Timer;
+    QElapsedTimer      ElapsedTimer;
+
+    int64_t iFrameDurationNs;
+    int64_t iCurFrameStartNs;
+    int64_t iNumFrames;
+    int64_t iNumPackets;
+
+    // the next packet of the trace
+    bool             bPacketPending;
+    int64_t          iPacketTimeNs;
+    CHostAddress     PacketHostAddr;
+    CVector<uint8_t> vecbyPacketData;
+    int              iPacketNumBytes;
+
+public slots:
+    void OnTimer();
+};
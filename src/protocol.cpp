@@ -135,6 +135,30 @@ MESSAGES (with connection)
         ... ------------------+---------------------------+
 
 
+- PROTMESSID_CONN_CLIENTS_LIST_DELTA: Changes of the connected clients list
+
+    +----------------------+---------------------+------------------------+ ...
+    | 2 bytes base version | 2 bytes new version | 1 byte number removed n | ...
+    +----------------------+---------------------+------------------------+ ...
+        ... -------------------------+-----------------------------------+
+        ...  n bytes removed chan IDs | added or changed clients          |
+        ... -------------------------+-----------------------------------+
+
+    - the added or changed clients are encoded as in
+      PROTMESSID_CONN_CLIENTS_LIST (until the end of the message)
+    - "base version": the list version the changes are based on, if it does
+      not match the version of the list of the receiver, the receiver must
+      discard the message and request the complete list by
+      PROTMESSID_REQ_CONN_CLIENTS_LIST; a base version of zero means that the
+      receiver must clear its list before applying the changes (complete list)
+    - "new version": the list version after applying the changes (1..65535),
+      zero means that the list is unversioned
+
+    note: the server only sends this message to clients which have answered
+          PROTMESSID_REQ_CLIENTS_LIST_DELTA, all others get
+          PROTMESSID_CONN_CLIENTS_LIST
+
+
 - PROTMESSID_REQ_CONN_CLIENTS_LIST: Request connected clients list
 
     note: does not have any data -> n = 0
@@ -215,6 +239,16 @@ MESSAGES (with connection)
     note: does not have any data -> n = 0
 
 
+- PROTMESSID_REQ_CLIENTS_LIST_DELTA: Request delta client list support
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_CLIENTS_LIST_DELTA_SUPP: Delta client lists are supported
+
+    note: does not have any data -> n = 0
+
+
 - PROTMESSID_LICENCE_REQUIRED: Licence required to connect to the server
 
     +---------------------+
@@ -246,6 +280,21 @@ MESSAGES (with connection)
     - tbc
 
 
+- PROTMESSID_NETW_FRAME_SIZE_FACT: Network frame size factor suggested by the
+                                   server
+
+    +-----------------------------------+
+    | 2 bytes network frame size factor |
+    +-----------------------------------+
+
+    The server suggests a minimum network frame size factor to reduce its
+    packet rate under load. The client packs its audio frames in network
+    packets of at least this size without changing its sound card buffer
+    size and announces the result via PROTMESSID_NETW_TRANSPORT_PROPS.
+    - 0: no suggestion, the client uses its own frame size factor again
+    - 1, 2, 4: suggested minimum network frame size factor
+
+
 CONNECTION LESS MESSAGES
 ------------------------
 
@@ -448,6 +497,25 @@ CProtocol::CProtocol()
     QObject::connect ( &TimerSendMess, &QTimer::timeout, this, &CProtocol::OnTimerSendMess );
 }
 
+CProtocol::CBroadcastMes::CBroadcastMes ( const int iNID, const CVector<uint8_t>& vecNData ) :
+    iID ( iNID ),
+    vecData ( vecNData ),
+    vecvecSplitParts ( 0 ),
+    vecCLFrame ( 0 )
+{
+    if ( IsConnectionLessMessageID ( iID ) )
+    {
+        // build complete message (counter per definition=0 for connection less
+        // messages)
+        GenMessageFrame ( vecCLFrame, 0, iID, vecData );
+    }
+    else if ( vecData.Size() > MESS_SPLIT_PART_SIZE_BYTES )
+    {
+        // prepare the split parts in case the recipient supports them
+        GenSplitMessageParts ( vecvecSplitParts, iID, vecData );
+    }
+}
+
 void CProtocol::Reset()
 {
     QMutexLocker locker ( &Mutex );
@@ -460,11 +528,16 @@ void CProtocol::Reset()
     iSplitMessageDataIndex = 0;
     bSplitMessageSupported = false; // compatilibity to old versions
 
+    // delta client lists are only used after negotiation
+    bConClientListDeltaSupported = false;
+    iConClientListVersion        = 0;
+    vecConClientList.Init ( 0 );
+
     // delete complete "send message queue"
     SendMessQueue.clear();
 }
 
-void CProtocol::EnqueueMessage ( CVector<uint8_t>& vecMessage, const int iCnt, const int iID )
+void CProtocol::EnqueueMessage ( CVector<uint8_t>& vecMessage, const int iCnt, const int iID, const int iOrigID, const int iSplitCnt )
 {
     bool bListWasEmpty;
 
@@ -474,7 +547,7 @@ void CProtocol::EnqueueMessage ( CVector<uint8_t>& vecMessage, const int iCnt, c
         bListWasEmpty = SendMessQueue.empty();
 
         // create send message object for the queue
-        CSendMessage SendMessageObj ( vecMessage, iCnt, iID );
+        CSendMessage SendMessageObj ( vecMessage, iCnt, iID, iOrigID, iSplitCnt );
 
         // we want to have a FIFO: we add at the end and take from the beginning
         SendMessQueue.push_back ( SendMessageObj );
@@ -518,88 +591,151 @@ void CProtocol::SendMessage()
     if ( bSendMess )
     {
         // send message
+        CTraceEvents::Instant ( "protocol/send" );
         emit MessReadyForSending ( vecMessage );
     }
 }
 
-void CProtocol::CreateAndSendMessage ( const int iID, const CVector<uint8_t>& vecData )
+void CProtocol::RemoveQueuedMessages ( const int iOrigID )
 {
-    CVector<uint8_t> vecNewMessage;
-    int              iCurCounter;
-    const int        iDataLen = vecData.Size();
+    QMutexLocker locker ( &Mutex );
 
-    // check if message has to be split because it is too large
-    if ( bSplitMessageSupported && ( iDataLen > MESS_SPLIT_PART_SIZE_BYTES ) )
+    if ( SendMessQueue.empty() )
     {
-        CVector<uint8_t> vecNewSplitMessage;
-        int              iStartIndexInData = 0; // init index
+        return;
+    }
 
-        // calculate the number of split parts
-        const int iNumParts = static_cast<int> ( std::ceil ( static_cast<double> ( iDataLen ) / MESS_SPLIT_PART_SIZE_BYTES ) );
+    // the first message in the queue may already be sent and waits for its
+    // acknowledgement, it and the remaining parts of its split message must
+    // be kept since the receiver would discard a split message otherwise
+    std::list<CSendMessage>::iterator it = std::next ( SendMessQueue.begin() );
 
-        for ( int iSplitCnt = 0; iSplitCnt < iNumParts; iSplitCnt++ )
+    while ( ( it != SendMessQueue.end() ) && ( it->iSplitCnt > 0 ) )
+    {
+        ++it;
+    }
+
+    // remove all other messages (including all of their split parts) with
+    // the given ID which are not yet sent
+    while ( it != SendMessQueue.end() )
+    {
+        if ( it->iOrigID == iOrigID )
         {
-            // the split part size may be smaller for the last part
-            int iCurPartSize = MESS_SPLIT_PART_SIZE_BYTES;
+            it = SendMessQueue.erase ( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
 
-            if ( iDataLen - iStartIndexInData < MESS_SPLIT_PART_SIZE_BYTES )
-            {
-                iCurPartSize = iDataLen - iStartIndexInData;
-            }
+void CProtocol::EnqueueMessageFrame ( const int iID, const CVector<uint8_t>& vecData, const int iOrigID, const int iSplitCnt )
+{
+    CVector<uint8_t> vecNewMessage;
+    int              iCurCounter;
 
-            GenSplitMessageContainer ( vecNewSplitMessage, iID, iNumParts, iSplitCnt, vecData, iStartIndexInData, iCurPartSize );
+    Mutex.lock();
+    {
+        // store current counter value
+        iCurCounter = iCounter;
 
-            // increment the start index of the source data by the last part size
-            iStartIndexInData += iCurPartSize;
+        // increase counter (wraps around automatically)
+        iCounter++;
+    }
+    Mutex.unlock();
 
-            Mutex.lock();
-            {
-                // store current counter value
-                iCurCounter = iCounter;
+    // build complete message
+    GenMessageFrame ( vecNewMessage, iCurCounter, iID, vecData );
 
-                // increase counter (wraps around automatically)
-                iCounter++;
-            }
-            Mutex.unlock();
+    // enqueue message
+    EnqueueMessage ( vecNewMessage, iCurCounter, iID, iOrigID, iSplitCnt );
+}
+
+void CProtocol::CreateAndSendMessage ( const int iID, const CVector<uint8_t>& vecData )
+{
+    // a complete connected client list makes all not yet sent lists obsolete
+    if ( iID == PROTMESSID_CONN_CLIENTS_LIST )
+    {
+        RemoveQueuedMessages ( iID );
+    }
+
+    // check if message has to be split because it is too large
+    if ( bSplitMessageSupported && ( vecData.Size() > MESS_SPLIT_PART_SIZE_BYTES ) )
+    {
+        CVector<CVector<uint8_t>> vecvecSplitParts;
 
-            // build complete message
-            GenMessageFrame ( vecNewMessage, iCurCounter, PROTMESSID_SPECIAL_SPLIT_MESSAGE, vecNewSplitMessage );
+        GenSplitMessageParts ( vecvecSplitParts, iID, vecData );
 
-            // enqueue message
-            EnqueueMessage ( vecNewMessage, iCurCounter, PROTMESSID_SPECIAL_SPLIT_MESSAGE );
+        for ( int iSplitCnt = 0; iSplitCnt < vecvecSplitParts.Size(); iSplitCnt++ )
+        {
+            EnqueueMessageFrame ( PROTMESSID_SPECIAL_SPLIT_MESSAGE, vecvecSplitParts[iSplitCnt], iID, iSplitCnt );
         }
     }
     else
     {
-        Mutex.lock();
-        {
-            // store current counter value
-            iCurCounter = iCounter;
+        EnqueueMessageFrame ( iID, vecData, iID, 0 );
+    }
+}
+
+void CProtocol::SendBroadcastMes ( const CBroadcastMes& BroadcastMes )
+{
+    const int                        iID              = BroadcastMes.GetID();
+    const CVector<CVector<uint8_t>>& vecvecSplitParts = BroadcastMes.GetSplitParts();
+
+    // a complete connected client list makes all not yet sent lists obsolete
+    if ( iID == PROTMESSID_CONN_CLIENTS_LIST )
+    {
+        RemoveQueuedMessages ( iID );
+    }
 
-            // increase counter (wraps around automatically)
-            iCounter++;
+    // the split parts are only generated if the body is too large, but
+    // whether we may use them depends on the capabilities of the recipient
+    if ( bSplitMessageSupported && ( vecvecSplitParts.Size() > 0 ) )
+    {
+        for ( int iSplitCnt = 0; iSplitCnt < vecvecSplitParts.Size(); iSplitCnt++ )
+        {
+            EnqueueMessageFrame ( PROTMESSID_SPECIAL_SPLIT_MESSAGE, vecvecSplitParts[iSplitCnt], iID, iSplitCnt );
         }
-        Mutex.unlock();
+    }
+    else
+    {
+        EnqueueMessageFrame ( iID, BroadcastMes.GetData(), iID, 0 );
+    }
+}
 
-        // build complete message
-        GenMessageFrame ( vecNewMessage, iCurCounter, iID, vecData );
+void CProtocol::SendConClientListDeltaMes ( const CBroadcastMes& DeltaMes, const int iNewVersion )
+{
+    int iPos = 0; // init position pointer
 
-        // enqueue message
-        EnqueueMessage ( vecNewMessage, iCurCounter, iID );
+    // a delta list with base version zero contains the complete list, all not
+    // yet sent delta lists are obsolete
+    if ( GetValFromStream ( DeltaMes.GetData(), iPos, 2 ) == 0 )
+    {
+        RemoveQueuedMessages ( PROTMESSID_CONN_CLIENTS_LIST_DELTA );
     }
+
+    SendBroadcastMes ( DeltaMes );
+
+    // the messages are delivered in order, i.e., after processing this message
+    // the client has the new list version
+    iConClientListVersion = iNewVersion;
+}
+
+void CProtocol::SendCLBroadcastMes ( const CHostAddress& InetAddr, const CBroadcastMes& BroadcastMes )
+{
+    Q_ASSERT ( IsConnectionLessMessageID ( BroadcastMes.GetID() ) );
+
+    // the complete frame was already generated, immediately send message
+    emit CLMessReadyForSending ( InetAddr, BroadcastMes.GetCLFrame() );
 }
 
 void CProtocol::CreateAndImmSendAcknMess ( const int& iID, const int& iCnt )
 {
     CVector<uint8_t> vecAcknMessage;
-    CVector<uint8_t> vecData ( 2 ); // 2 bytes of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iID ), 2 );
 
     // build complete message
-    GenMessageFrame ( vecAcknMessage, iCnt, PROTMESSID_ACKN, vecData );
+    GenMessageFrame ( vecAcknMessage, iCnt, PROTMESSID_ACKN, CAcknMesLayout::Encode ( iID ) );
 
     // immediately send acknowledge message
     emit MessReadyForSending ( vecAcknMessage );
@@ -642,16 +778,16 @@ void CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData, con
         // special treatment for acknowledge messages
         if ( iRecID == PROTMESSID_ACKN )
         {
-            // check size
-            if ( vecbyMesBodyData.Size() != 2 )
+            uint32_t iVals[CAcknMesLayout::iNumFields];
+
+            // check size and extract data
+            if ( CAcknMesLayout::Decode ( vecbyMesBodyData, iVals ) )
             {
                 return;
             }
 
-            // extract data from stream and emit signal for received value
             bool      bSendNextMess = false;
-            int       iPos          = 0;
-            const int iData         = static_cast<int> ( GetValFromStream ( vecbyMesBodyData, iPos, 2 ) );
+            const int iData         = static_cast<int> ( iVals[0] );
 
             Mutex.lock();
             {
@@ -662,6 +798,7 @@ void CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData, con
                     {
                         // message acknowledged, remove from queue
                         SendMessQueue.pop_front();
+                        CTraceEvents::Instant ( "protocol/ack" );
 
                         // send next message in queue
                         bSendNextMess = true;
@@ -813,6 +950,18 @@ void CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData, con
                     EvaluateSplitMessSupportedMes();
                     break;
 
+                case PROTMESSID_REQ_CLIENTS_LIST_DELTA:
+                    EvaluateReqConClientListDeltaSupportMes();
+                    break;
+
+                case PROTMESSID_CLIENTS_LIST_DELTA_SUPP:
+                    EvaluateConClientListDeltaSupportedMes();
+                    break;
+
+                case PROTMESSID_CONN_CLIENTS_LIST_DELTA:
+                    EvaluateConClientListDeltaMes ( vecbyMesBodyDataRef );
+                    break;
+
                 case PROTMESSID_LICENCE_REQUIRED:
                     EvaluateLicenceRequiredMes ( vecbyMesBodyDataRef );
                     break;
@@ -824,6 +973,10 @@ void CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData, con
                 case PROTMESSID_RECORDER_STATE:
                     EvaluateRecorderStateMes ( vecbyMesBodyDataRef );
                     break;
+
+                case PROTMESSID_NETW_FRAME_SIZE_FACT:
+                    EvaluateNetwFrameSizeFactMes ( vecbyMesBodyDataRef );
+                    break;
                 }
             }
 
@@ -924,27 +1077,21 @@ void CProtocol::ParseConnectionLessMessageBody ( const CVector<uint8_t>& vecbyMe
 \******************************************************************************/
 void CProtocol::CreateJitBufMes ( const int iJitBufSize )
 {
-    CVector<uint8_t> vecData ( 2 ); // 2 bytes of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iJitBufSize ), 2 );
-
-    CreateAndSendMessage ( PROTMESSID_JITT_BUF_SIZE, vecData );
+    CreateAndSendMessage ( PROTMESSID_JITT_BUF_SIZE, CJitBufMesLayout::Encode ( iJitBufSize ) );
 }
 
 bool CProtocol::EvaluateJitBufMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CJitBufMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 2 )
+    // check size and extract data
+    if ( CJitBufMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
-    // extract jitter buffer size
-    const int iData = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+    // jitter buffer size
+    const int iData = static_cast<int> ( iVals[0] );
 
     if ( ( ( iData < MIN_NET_BUF_SIZE_NUM_BL ) || ( iData > MAX_NET_BUF_SIZE_NUM_BL ) ) && ( iData != AUTO_NET_BUF_SIZE_FOR_PROTOCOL ) )
     {
@@ -969,70 +1116,48 @@ bool CProtocol::EvaluateReqJitBufMes()
 
 void CProtocol::CreateClientIDMes ( const int iChanID )
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    // channel ID
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iChanID ), 1 );
-
-    CreateAndSendMessage ( PROTMESSID_CLIENT_ID, vecData );
+    CreateAndSendMessage ( PROTMESSID_CLIENT_ID, CClientIDMesLayout::Encode ( iChanID ) );
 }
 
 bool CProtocol::EvaluateClientIDMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CClientIDMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 1 )
+    // check size and extract data
+    if ( CClientIDMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
-    // channel ID
-    const int iCurID = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // invoke message action
-    emit ClientIDReceived ( iCurID );
+    // invoke message action (channel ID)
+    emit ClientIDReceived ( static_cast<int> ( iVals[0] ) );
 
     return false; // no error
 }
 
 void CProtocol::CreateChanGainMes ( const int iChanID, const float fGain )
 {
-    CVector<uint8_t> vecData ( 3 ); // 3 bytes of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    // channel ID
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iChanID ), 1 );
-
     // actual gain, we convert from double with range 0..1 to integer
     const int iCurGain = static_cast<int> ( fGain * ( 1 << 15 ) );
 
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iCurGain ), 2 );
-
-    CreateAndSendMessage ( PROTMESSID_CHANNEL_GAIN, vecData );
+    CreateAndSendMessage ( PROTMESSID_CHANNEL_GAIN, CChanGainMesLayout::Encode ( iChanID, iCurGain ) );
 }
 
 bool CProtocol::EvaluateChanGainMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CChanGainMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 3 )
+    // check size and extract data
+    if ( CChanGainMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // channel ID
-    const int iCurID = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // gain (read integer value)
-    const int iData = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+    const int iCurID = static_cast<int> ( iVals[0] );
 
     // we convert the gain from integer to double with range 0..1
-    const float fNewGain = static_cast<float> ( iData ) / ( 1 << 15 );
+    const float fNewGain = static_cast<float> ( iVals[1] ) / ( 1 << 15 );
 
     // invoke message action
     emit ChangeChanGain ( iCurID, fNewGain );
@@ -1042,39 +1167,27 @@ bool CProtocol::EvaluateChanGainMes ( const CVector<uint8_t>& vecData )
 
 void CProtocol::CreateChanPanMes ( const int iChanID, const float fPan )
 {
-    CVector<uint8_t> vecData ( 3 ); // 3 bytes of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    // channel ID
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iChanID ), 1 );
-
     // actual pan, we convert from double with range 0..1 to integer
     const int iCurPan = static_cast<int> ( fPan * ( 1 << 15 ) );
 
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iCurPan ), 2 );
-
-    CreateAndSendMessage ( PROTMESSID_CHANNEL_PAN, vecData );
+    CreateAndSendMessage ( PROTMESSID_CHANNEL_PAN, CChanPanMesLayout::Encode ( iChanID, iCurPan ) );
 }
 
 bool CProtocol::EvaluateChanPanMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CChanPanMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 3 )
+    // check size and extract data
+    if ( CChanPanMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // channel ID
-    const int iCurID = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // pan (read integer value)
-    const int iData = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+    const int iCurID = static_cast<int> ( iVals[0] );
 
     // we convert the pan from integer to double with range 0..1
-    const float fNewPan = static_cast<float> ( iData ) / ( 1 << 15 );
+    const float fNewPan = static_cast<float> ( iVals[1] ) / ( 1 << 15 );
 
     // invoke message action
     emit ChangeChanPan ( iCurID, fNewPan );
@@ -1084,34 +1197,24 @@ bool CProtocol::EvaluateChanPanMes ( const CVector<uint8_t>& vecData )
 
 void CProtocol::CreateMuteStateHasChangedMes ( const int iChanID, const bool bIsMuted )
 {
-    CVector<uint8_t> vecData ( 2 ); // 2 bytes of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    // channel ID
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iChanID ), 1 );
-
-    // mute state
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( bIsMuted ), 1 );
-
-    CreateAndSendMessage ( PROTMESSID_MUTE_STATE_CHANGED, vecData );
+    CreateAndSendMessage ( PROTMESSID_MUTE_STATE_CHANGED, CMuteStateHasChangedMesLayout::Encode ( iChanID, bIsMuted ) );
 }
 
 bool CProtocol::EvaluateMuteStateHasChangedMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CMuteStateHasChangedMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 2 )
+    // check size and extract data
+    if ( CMuteStateHasChangedMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // channel ID
-    const int iCurID = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+    const int iCurID = static_cast<int> ( iVals[0] );
 
     // mute state
-    const bool bIsMuted = static_cast<bool> ( GetValFromStream ( vecData, iPos, 1 ) );
+    const bool bIsMuted = static_cast<bool> ( iVals[1] );
 
     // invoke message action
     emit MuteStateHasChangedReceived ( iCurID, bIsMuted );
@@ -1121,110 +1224,223 @@ bool CProtocol::EvaluateMuteStateHasChangedMes ( const CVector<uint8_t>& vecData
 
 void CProtocol::CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo )
 {
-    const int iNumClients = vecChanInfo.Size();
+    CVector<uint8_t> vecData ( 0 );
+    int              iPos = 0; // init position pointer
+
+    PutChanInfoListOnStream ( vecData, iPos, vecChanInfo );
+
+    CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
+}
 
-    // build data vector
+CProtocol::CBroadcastMes CProtocol::PrepConClientListMes ( const CVector<CChannelInfo>& vecChanInfo )
+{
     CVector<uint8_t> vecData ( 0 );
     int              iPos = 0; // init position pointer
 
-    for ( int i = 0; i < iNumClients; i++ )
+    PutChanInfoListOnStream ( vecData, iPos, vecChanInfo );
+
+    return CBroadcastMes ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
+}
+
+bool CProtocol::EvaluateConClientListMes ( const CVector<uint8_t>& vecData )
+{
+    int                   iPos = 0; // init position pointer
+    CVector<CChannelInfo> vecChanInfo ( 0 );
+
+    if ( GetChanInfoListFromStream ( vecData, iPos, vecChanInfo ) )
+    {
+        return true; // return error code
+    }
+
+    // a complete list replaces the stored list (which is then unversioned)
+    vecConClientList      = vecChanInfo;
+    iConClientListVersion = 0;
+
+    // invoke message action
+    emit ConClientListMesReceived ( vecChanInfo );
+
+    return false; // no error
+}
+
+CProtocol::CBroadcastMes CProtocol::PrepConClientListDeltaMes ( const int                    iBaseVersion,
+                                                                const int                    iNewVersion,
+                                                                const CVector<CChannelInfo>& vecOldChanInfo,
+                                                                const CVector<CChannelInfo>& vecNewChanInfo )
+{
+    CVector<uint8_t> vecData;
+
+    GenConClientListDeltaMesBody ( vecData, iBaseVersion, iNewVersion, vecOldChanInfo, vecNewChanInfo );
+
+    return CBroadcastMes ( PROTMESSID_CONN_CLIENTS_LIST_DELTA, vecData );
+}
+
+void CProtocol::GenConClientListDeltaMesBody ( CVector<uint8_t>&            vecData,
+                                               const int                    iBaseVersion,
+                                               const int                    iNewVersion,
+                                               const CVector<CChannelInfo>& vecOldChanInfo,
+                                               const CVector<CChannelInfo>& vecNewChanInfo )
+{
+    const int             iNumOldClients = vecOldChanInfo.Size();
+    const int             iNumNewClients = vecNewChanInfo.Size();
+    CVector<int>          vecOldListIdx ( 256, INVALID_INDEX ); // the channel ID is transmitted as one byte
+    CVector<bool>         vecIsStillConnected ( iNumOldClients, false );
+    CVector<int>          vecRemovedChanIDs ( 0 );
+    CVector<CChannelInfo> vecChangedChanInfo ( 0 );
+    int                   iPos = 0; // init position pointer
+
+    for ( int i = 0; i < iNumOldClients; i++ )
+    {
+        vecOldListIdx[vecOldChanInfo[i].iChanID & 0xFF] = i;
+    }
+
+    // find the added and changed clients
+    for ( int i = 0; i < iNumNewClients; i++ )
     {
-        // convert strings to utf-8
-        const QByteArray strUTF8Name = vecChanInfo[i].strName.toUtf8();
-        const QByteArray strUTF8City = vecChanInfo[i].strCity.toUtf8();
+        const int iOldIdx = vecOldListIdx[vecNewChanInfo[i].iChanID & 0xFF];
 
-        // size of current list entry
-        const int iCurListEntrLen = 1 +                      // chan ID
-                                    2 +                      // country
-                                    4 +                      // instrument
-                                    1 +                      // skill level
-                                    4 +                      // IP address
-                                    2 + strUTF8Name.size() + // utf-8 str. size / str.
-                                    2 + strUTF8City.size();  // utf-8 str. size / str.
+        if ( iOldIdx == INVALID_INDEX )
+        {
+            vecChangedChanInfo.Add ( vecNewChanInfo[i] );
+        }
+        else
+        {
+            vecIsStillConnected[iOldIdx] = true;
 
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
+            if ( CChannelCoreInfo ( vecNewChanInfo[i] ) != vecOldChanInfo[iOldIdx] )
+            {
+                vecChangedChanInfo.Add ( vecNewChanInfo[i] );
+            }
+        }
+    }
 
-        // channel ID (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iChanID ), 1 );
+    // find the removed clients
+    for ( int i = 0; i < iNumOldClients; i++ )
+    {
+        if ( !vecIsStillConnected[i] )
+        {
+            vecRemovedChanIDs.Add ( vecOldChanInfo[i].iChanID );
+        }
+    }
 
-        // country (2 bytes)
-        PutCountryOnStream ( vecData, iPos, vecChanInfo[i].eCountry );
+    const int iNumRemoved = vecRemovedChanIDs.Size();
 
-        // instrument (4 bytes)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iInstrument ), 4 );
+    // build data vector (the changed clients are appended below)
+    vecData.Init ( 2 + // base version
+                   2 + // new version
+                   1 + // number of removed clients
+                   iNumRemoved );
 
-        // skill level (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].eSkillLevel ), 1 );
+    // base version (2 bytes)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iBaseVersion ), 2 );
 
-        // used to be IP address before #316 (4 bytes)
-        PutValOnStream ( vecData, iPos, 0, 4 );
+    // new version (2 bytes)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iNewVersion ), 2 );
 
-        // name
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
+    // number of removed clients (1 byte)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iNumRemoved ), 1 );
 
-        // city
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
+    // removed channel IDs (1 byte each)
+    for ( int i = 0; i < iNumRemoved; i++ )
+    {
+        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecRemovedChanIDs[i] ), 1 );
     }
 
-    CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
+    // added and changed clients
+    PutChanInfoListOnStream ( vecData, iPos, vecChangedChanInfo );
 }
 
-bool CProtocol::EvaluateConClientListMes ( const CVector<uint8_t>& vecData )
+bool CProtocol::EvaluateConClientListDeltaMes ( const CVector<uint8_t>& vecData )
 {
     int                   iPos     = 0; // init position pointer
     const int             iDataLen = vecData.Size();
-    CVector<CChannelInfo> vecChanInfo ( 0 );
+    CVector<CChannelInfo> vecChangedChanInfo ( 0 );
 
-    while ( iPos < iDataLen )
+    // check size (the first 5 bytes)
+    if ( iDataLen < 5 )
     {
-        // check size (the next 12 bytes)
-        if ( ( iDataLen - iPos ) < 12 )
-        {
-            return true; // return error code
-        }
+        return true; // return error code
+    }
+
+    // base version (2 bytes)
+    const int iBaseVersion = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+
+    // new version (2 bytes)
+    const int iNewVersion = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+
+    // number of removed clients (1 byte)
+    const int iNumRemoved = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // check size
+    if ( ( iDataLen - iPos ) < iNumRemoved )
+    {
+        return true; // return error code
+    }
 
-        // channel ID (1 byte)
-        const int iChanID = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+    // removed channel IDs (1 byte each)
+    CVector<int> vecRemovedChanIDs ( iNumRemoved );
 
-        // country (2 bytes)
-        const QLocale::Country eCountry = GetCountryFromStream ( vecData, iPos );
+    for ( int i = 0; i < iNumRemoved; i++ )
+    {
+        vecRemovedChanIDs[i] = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+    }
 
-        // instrument (4 bytes)
-        const int iInstrument = static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+    // added and changed clients
+    if ( GetChanInfoListFromStream ( vecData, iPos, vecChangedChanInfo ) )
+    {
+        return true; // return error code
+    }
 
-        // skill level (1 byte)
-        const ESkillLevel eSkillLevel = static_cast<ESkillLevel> ( GetValFromStream ( vecData, iPos, 1 ) );
+    if ( iBaseVersion == 0 )
+    {
+        // the message contains the complete list
+        vecConClientList.Init ( 0 );
+    }
+    else if ( iBaseVersion != iConClientListVersion )
+    {
+        // we are out of sync with the server, request the complete list
+        iConClientListVersion = 0;
+        CreateReqConnClientsList();
 
-        // used to be IP address, zero since #316 (4 bytes)
-        iPos += 4;
+        return false; // no error
+    }
 
-        // name
-        QString strCurName;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_FADER_TAG, strCurName ) )
+    // apply the changes on the stored list
+    for ( int i = 0; i < iNumRemoved; i++ )
+    {
+        for ( int j = 0; j < vecConClientList.Size(); j++ )
         {
-            return true; // return error code
+            if ( vecConClientList[j].iChanID == vecRemovedChanIDs[i] )
+            {
+                vecConClientList.erase ( vecConClientList.begin() + j );
+                break;
+            }
         }
+    }
+
+    for ( int i = 0; i < vecChangedChanInfo.Size(); i++ )
+    {
+        // the list is sorted by the channel ID (as the server sends it)
+        int j = 0;
 
-        // city
-        QString strCurCity;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, strCurCity ) )
+        while ( ( j < vecConClientList.Size() ) && ( vecConClientList[j].iChanID < vecChangedChanInfo[i].iChanID ) )
         {
-            return true; // return error code
+            j++;
         }
 
-        // add channel information to vector
-        vecChanInfo.Add ( CChannelInfo ( iChanID, strCurName, eCountry, strCurCity, iInstrument, eSkillLevel ) );
+        if ( ( j < vecConClientList.Size() ) && ( vecConClientList[j].iChanID == vecChangedChanInfo[i].iChanID ) )
+        {
+            vecConClientList[j] = vecChangedChanInfo[i];
+        }
+        else
+        {
+            vecConClientList.insert ( vecConClientList.begin() + j, vecChangedChanInfo[i] );
+        }
     }
 
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
-    }
+    iConClientListVersion = iNewVersion;
 
-    // invoke message action
-    emit ConClientListMesReceived ( vecChanInfo );
+    // invoke message action (the receiver always gets the complete list)
+    emit ConClientListMesReceived ( vecConClientList );
 
     return false; // no error
 }
@@ -1241,78 +1457,28 @@ bool CProtocol::EvaluateReqConnClientsList()
 
 void CProtocol::CreateChanInfoMes ( const CChannelCoreInfo ChanInfo )
 {
-    int iPos = 0; // init position pointer
-
-    // convert strings to utf-8
-    const QByteArray strUTF8Name = ChanInfo.strName.toUtf8();
-    const QByteArray strUTF8City = ChanInfo.strCity.toUtf8();
-
-    // size of current list entry
-    const int iEntrLen = 2 +                      // country
-                         4 +                      // instrument
-                         1 +                      // skill level
-                         2 + strUTF8Name.size() + // utf-8 str. size / str.
-                         2 + strUTF8City.size();  // utf-8 str. size / str.
-
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
-
-    // country (2 bytes)
-    PutCountryOnStream ( vecData, iPos, ChanInfo.eCountry );
-
-    // instrument (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( ChanInfo.iInstrument ), 4 );
-
-    // skill level (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( ChanInfo.eSkillLevel ), 1 );
-
-    // name
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
-
-    // city
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
-
-    CreateAndSendMessage ( PROTMESSID_CHANNEL_INFOS, vecData );
+    CreateAndSendMessage ( PROTMESSID_CHANNEL_INFOS,
+                           CChanInfoMesLayout::Encode ( ChanInfo.eCountry,
+                                                        ChanInfo.iInstrument,
+                                                        ChanInfo.eSkillLevel,
+                                                        ChanInfo.strName.toUtf8(),
+                                                        ChanInfo.strCity.toUtf8() ) );
 }
 
 bool CProtocol::EvaluateChanInfoMes ( const CVector<uint8_t>& vecData )
 {
-    int              iPos     = 0; // init position pointer
-    const int        iDataLen = vecData.Size();
     CChannelCoreInfo ChanInfo;
+    uint32_t         iInstrument;
+    uint32_t         iSkillLevel;
 
-    // check size (the first 7 bytes)
-    if ( iDataLen < 7 )
-    {
-        return true; // return error code
-    }
-
-    // country (2 bytes)
-    ChanInfo.eCountry = GetCountryFromStream ( vecData, iPos );
-
-    // instrument (4 bytes)
-    ChanInfo.iInstrument = static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
-
-    // skill level (1 byte)
-    ChanInfo.eSkillLevel = static_cast<ESkillLevel> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // name
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_FADER_TAG, ChanInfo.strName ) )
+    // check size and extract data
+    if ( CChanInfoMesLayout::Decode ( vecData, ChanInfo.eCountry, iInstrument, iSkillLevel, ChanInfo.strName, ChanInfo.strCity ) )
     {
         return true; // return error code
     }
 
-    // city
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, ChanInfo.strCity ) )
-    {
-        return true; // return error code
-    }
-
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
-    }
+    ChanInfo.iInstrument = static_cast<int> ( iInstrument );
+    ChanInfo.eSkillLevel = static_cast<ESkillLevel> ( iSkillLevel );
 
     // invoke message action
     emit ChangeChanInfo ( ChanInfo );
@@ -1332,38 +1498,33 @@ bool CProtocol::EvaluateReqChanInfoMes()
 
 void CProtocol::CreateChatTextMes ( const QString strChatText )
 {
-    int iPos = 0; // init position pointer
+    CVector<uint8_t> vecData;
 
-    // convert chat text string to utf-8
-    const QByteArray strUTF8ChatText = strChatText.toUtf8();
+    GenChatTextMesBody ( vecData, strChatText );
 
-    const int iStrUTF8Len = strUTF8ChatText.size(); // get utf-8 str. size / string
+    CreateAndSendMessage ( PROTMESSID_CHAT_TEXT, vecData );
+}
 
-    // size of message body
-    const int iEntrLen = 2 + iStrUTF8Len; // utf-8 str. size / string
+CProtocol::CBroadcastMes CProtocol::PrepChatTextMes ( const QString& strChatText )
+{
+    CVector<uint8_t> vecData;
 
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
+    GenChatTextMesBody ( vecData, strChatText );
 
-    // chat text
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8ChatText );
+    return CBroadcastMes ( PROTMESSID_CHAT_TEXT, vecData );
+}
 
-    CreateAndSendMessage ( PROTMESSID_CHAT_TEXT, vecData );
+void CProtocol::GenChatTextMesBody ( CVector<uint8_t>& vecData, const QString& strChatText )
+{
+    vecData = CChatTextMesLayout::Encode ( strChatText.toUtf8() );
 }
 
 bool CProtocol::EvaluateChatTextMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
-
-    // chat text
     QString strChatText;
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_CHAT_TEXT_PLUS_HTML, strChatText ) )
-    {
-        return true; // return error code
-    }
 
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != vecData.Size() )
+    // check size and extract data
+    if ( CChatTextMesLayout::Decode ( vecData, strChatText ) )
     {
         return true; // return error code
     }
@@ -1376,66 +1537,29 @@ bool CProtocol::EvaluateChatTextMes ( const CVector<uint8_t>& vecData )
 
 void CProtocol::CreateNetwTranspPropsMes ( const CNetworkTransportProps& NetTrProps )
 {
-    int iPos = 0; // init position pointer
-
-    // size of current message body
-    const int iEntrLen = 4 + // netw size
-                         2 + // block size fact
-                         1 + // num chan
-                         4 + // sam rate
-                         2 + // audiocod type
-                         2 + // version
-                         4;  // audiocod arg
-
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
-
-    // length of the base network packet (frame) in bytes (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.iBaseNetworkPacketSize ), 4 );
-
-    // block size factor (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.iBlockSizeFact ), 2 );
-
-    // number of channels of the audio signal, e.g. "2" is stereo (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.iNumAudioChannels ), 1 );
-
-    // sample rate of the audio stream (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.iSampleRate ), 4 );
-
-    // audio coding type (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.eAudioCodingType ), 2 );
-
-    // flags (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.eFlags ), 2 );
-
-    // argument for the audio coder (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( NetTrProps.iAudioCodingArg ), 4 );
-
-    CreateAndSendMessage ( PROTMESSID_NETW_TRANSPORT_PROPS, vecData );
+    CreateAndSendMessage ( PROTMESSID_NETW_TRANSPORT_PROPS,
+                           CNetwTranspPropsMesLayout::Encode ( NetTrProps.iBaseNetworkPacketSize,
+                                                               NetTrProps.iBlockSizeFact,
+                                                               NetTrProps.iNumAudioChannels,
+                                                               NetTrProps.iSampleRate,
+                                                               NetTrProps.eAudioCodingType,
+                                                               NetTrProps.eFlags,
+                                                               NetTrProps.iAudioCodingArg ) );
 }
 
 bool CProtocol::EvaluateNetwTranspPropsMes ( const CVector<uint8_t>& vecData )
 {
-    int                    iPos = 0; // init position pointer
+    uint32_t               iVals[CNetwTranspPropsMesLayout::iNumFields];
     CNetworkTransportProps ReceivedNetwTranspProps;
 
-    // size of current message body
-    const int iEntrLen = 4 + // netw size
-                         2 + // block size fact
-                         1 + // num chan
-                         4 + // sam rate
-                         2 + // audiocod type
-                         2 + // flags
-                         4;  // audiocod arg
-
-    // check size
-    if ( vecData.Size() != iEntrLen )
+    // check size and extract data
+    if ( CNetwTranspPropsMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
-    // length of the base network packet (frame) in bytes (4 bytes)
-    ReceivedNetwTranspProps.iBaseNetworkPacketSize = static_cast<uint32_t> ( GetValFromStream ( vecData, iPos, 4 ) );
+    // length of the base network packet (frame) in bytes
+    ReceivedNetwTranspProps.iBaseNetworkPacketSize = iVals[0];
 
     // at least CELT_MINIMUM_NUM_BYTES bytes are required for the CELC codec
     if ( ( ReceivedNetwTranspProps.iBaseNetworkPacketSize < CELT_MINIMUM_NUM_BYTES ) ||
@@ -1444,8 +1568,8 @@ bool CProtocol::EvaluateNetwTranspPropsMes ( const CVector<uint8_t>& vecData )
         return true; // return error code
     }
 
-    // block size factor (2 bytes)
-    ReceivedNetwTranspProps.iBlockSizeFact = static_cast<uint16_t> ( GetValFromStream ( vecData, iPos, 2 ) );
+    // block size factor
+    ReceivedNetwTranspProps.iBlockSizeFact = static_cast<uint16_t> ( iVals[1] );
 
     if ( ( ReceivedNetwTranspProps.iBlockSizeFact != FRAME_SIZE_FACTOR_PREFERRED ) &&
          ( ReceivedNetwTranspProps.iBlockSizeFact != FRAME_SIZE_FACTOR_DEFAULT ) &&
@@ -1455,19 +1579,19 @@ bool CProtocol::EvaluateNetwTranspPropsMes ( const CVector<uint8_t>& vecData )
     }
 
     // number of channels of the audio signal, only mono (1 channel) or
-    // stereo (2 channels) allowed (1 byte)
-    ReceivedNetwTranspProps.iNumAudioChannels = static_cast<uint32_t> ( GetValFromStream ( vecData, iPos, 1 ) );
+    // stereo (2 channels) allowed
+    ReceivedNetwTranspProps.iNumAudioChannels = iVals[2];
 
     if ( ( ReceivedNetwTranspProps.iNumAudioChannels != 1 ) && ( ReceivedNetwTranspProps.iNumAudioChannels != 2 ) )
     {
         return true; // return error code
     }
 
-    // sample rate of the audio stream (4 bytes)
-    ReceivedNetwTranspProps.iSampleRate = static_cast<uint32_t> ( GetValFromStream ( vecData, iPos, 4 ) );
+    // sample rate of the audio stream
+    ReceivedNetwTranspProps.iSampleRate = iVals[3];
 
-    // audio coding type (2 bytes) with error check
-    const int iRecCodingType = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+    // audio coding type with error check
+    const int iRecCodingType = static_cast<int> ( iVals[4] );
 
     // note that CT_NONE is not a valid setting but only used for server
     // initialization
@@ -1478,11 +1602,11 @@ bool CProtocol::EvaluateNetwTranspPropsMes ( const CVector<uint8_t>& vecData )
 
     ReceivedNetwTranspProps.eAudioCodingType = static_cast<EAudComprType> ( iRecCodingType );
 
-    // flags (2 bytes)
-    ReceivedNetwTranspProps.eFlags = static_cast<ENetwFlags> ( GetValFromStream ( vecData, iPos, 2 ) );
+    // flags
+    ReceivedNetwTranspProps.eFlags = static_cast<ENetwFlags> ( iVals[5] );
 
-    // argument for the audio coder (4 bytes)
-    ReceivedNetwTranspProps.iAudioCodingArg = static_cast<int32_t> ( GetValFromStream ( vecData, iPos, 4 ) );
+    // argument for the audio coder
+    ReceivedNetwTranspProps.iAudioCodingArg = static_cast<int32_t> ( iVals[6] );
 
     // invoke message action
     emit NetTranspPropsReceived ( ReceivedNetwTranspProps );
@@ -1520,29 +1644,46 @@ bool CProtocol::EvaluateSplitMessSupportedMes()
     return false; // no error
 }
 
-void CProtocol::CreateLicenceRequiredMes ( const ELicenceType eLicenceType )
+void CProtocol::CreateReqConClientListDeltaSupportMes()
+{
+    CreateAndSendMessage ( PROTMESSID_REQ_CLIENTS_LIST_DELTA, CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateReqConClientListDeltaSupportMes()
+{
+    // invoke message action
+    emit ReqConClientListDeltaSupport();
+
+    return false; // no error
+}
+
+void CProtocol::CreateConClientListDeltaSupportedMes() { CreateAndSendMessage ( PROTMESSID_CLIENTS_LIST_DELTA_SUPP, CVector<uint8_t> ( 0 ) ); }
+
+bool CProtocol::EvaluateConClientListDeltaSupportedMes()
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 bytes of data
-    int              iPos = 0;      // init position pointer
+    // invoke message action
+    emit ConClientListDeltaSupported();
 
-    // build data vector
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( eLicenceType ), 1 );
+    return false; // no error
+}
 
-    CreateAndSendMessage ( PROTMESSID_LICENCE_REQUIRED, vecData );
+void CProtocol::CreateLicenceRequiredMes ( const ELicenceType eLicenceType )
+{
+    CreateAndSendMessage ( PROTMESSID_LICENCE_REQUIRED, CLicenceRequiredMesLayout::Encode ( eLicenceType ) );
 }
 
 bool CProtocol::EvaluateLicenceRequiredMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CLicenceRequiredMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 1 )
+    // check size and extract data
+    if ( CLicenceRequiredMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
-    // extract licence type
-    const ELicenceType eLicenceType = static_cast<ELicenceType> ( GetValFromStream ( vecData, iPos, 1 ) );
+    // licence type
+    const ELicenceType eLicenceType = static_cast<ELicenceType> ( iVals[0] );
 
     if ( ( eLicenceType != LT_CREATIVECOMMONS ) && ( eLicenceType != LT_NO_LICENCE ) )
     {
@@ -1560,97 +1701,54 @@ void CProtocol::CreateOpusSupportedMes() { CreateAndSendMessage ( PROTMESSID_OPU
 // TODO needed for compatibility to old servers >= 3.4.6 and <= 3.5.12
 void CProtocol::CreateReqChannelLevelListMes()
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
-    int              iPos = 0;      // init position pointer
-
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( true ), 1 );
-
-    CreateAndSendMessage ( PROTMESSID_REQ_CHANNEL_LEVEL_LIST, vecData );
+    CreateAndSendMessage ( PROTMESSID_REQ_CHANNEL_LEVEL_LIST, CReqChannelLevelListMesLayout::Encode ( true ) );
 }
 
 void CProtocol::CreateVersionAndOSMes()
 {
-    int iPos = 0; // init position pointer
-
-    // get the version number string
-    const QString strVerion = VERSION;
-
-    // convert version string to utf-8
-    const QByteArray strUTF8Version = strVerion.toUtf8();
-
-    // size of current message body
-    const int iEntrLen = 1 +                        // operating system
-                         2 + strUTF8Version.size(); // version utf-8 str. size / string
-
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
-
-    // operating system (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( COSUtil::GetOperatingSystem() ), 1 );
-
-    // version
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8Version );
-
-    CreateAndSendMessage ( PROTMESSID_VERSION_AND_OS, vecData );
+    CreateAndSendMessage ( PROTMESSID_VERSION_AND_OS,
+                           CVersionAndOSMesLayout::Encode ( COSUtil::GetOperatingSystem(), QString ( VERSION ).toUtf8() ) );
 }
 
 bool CProtocol::EvaluateVersionAndOSMes ( const CVector<uint8_t>& vecData )
 {
-    int       iPos     = 0; // init position pointer
-    const int iDataLen = vecData.Size();
-
-    // check size (the first 1 byte)
-    if ( iDataLen < 1 )
-    {
-        return true; // return error code
-    }
-
-    // operating system (1 byte)
-    const COSUtil::EOpSystemType eOSType = static_cast<COSUtil::EOpSystemType> ( GetValFromStream ( vecData, iPos, 1 ) );
+    uint32_t iOSType;
+    QString  strVersion;
 
-    // version text
-    QString strVersion;
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_VERSION_TEXT, strVersion ) )
-    {
-        return true; // return error code
-    }
-
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
+    // check size and extract data
+    if ( CVersionAndOSMesLayout::Decode ( vecData, iOSType, strVersion ) )
     {
         return true; // return error code
     }
 
     // invoke message action
-    emit VersionAndOSReceived ( eOSType, strVersion );
+    emit VersionAndOSReceived ( static_cast<COSUtil::EOpSystemType> ( iOSType ), strVersion );
 
     return false; // no error
 }
 
 void CProtocol::CreateRecorderStateMes ( const ERecorderState eRecorderState )
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
-    int              iPos = 0;      // init position pointer
-
-    // build data vector
-    // server jam recorder state (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( eRecorderState ), 1 );
+    CreateAndSendMessage ( PROTMESSID_RECORDER_STATE, CRecorderStateMesLayout::Encode ( eRecorderState ) );
+}
 
-    CreateAndSendMessage ( PROTMESSID_RECORDER_STATE, vecData );
+CProtocol::CBroadcastMes CProtocol::PrepRecorderStateMes ( const ERecorderState eRecorderState )
+{
+    return CBroadcastMes ( PROTMESSID_RECORDER_STATE, CRecorderStateMesLayout::Encode ( eRecorderState ) );
 }
 
 bool CProtocol::EvaluateRecorderStateMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CRecorderStateMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 1 )
+    // check size and extract data
+    if ( CRecorderStateMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // server jam recorder state (1 byte)
-    const int iRecorderState = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+    const int iRecorderState = static_cast<int> ( iVals[0] );
 
     // note that RS_UNDEFINED is only internally used
     if ( ( iRecorderState != RS_NOT_INITIALISED ) && ( iRecorderState != RS_NOT_ENABLED ) && ( iRecorderState != RS_RECORDING ) )
@@ -1664,67 +1762,78 @@ bool CProtocol::EvaluateRecorderStateMes ( const CVector<uint8_t>& vecData )
     return false; // no error
 }
 
-// Connection less messages ----------------------------------------------------
-void CProtocol::CreateCLPingMes ( const CHostAddress& InetAddr, const int iMs )
+void CProtocol::CreateNetwFrameSizeFactMes ( const int iNetwFrameSizeFact )
 {
-    int iPos = 0; // init position pointer
+    CreateAndSendMessage ( PROTMESSID_NETW_FRAME_SIZE_FACT, CNetwFrameSizeFactMesLayout::Encode ( iNetwFrameSizeFact ) );
+}
+
+bool CProtocol::EvaluateNetwFrameSizeFactMes ( const CVector<uint8_t>& vecData )
+{
+    uint32_t iVals[CNetwFrameSizeFactMesLayout::iNumFields];
+
+    // check size and extract data
+    if ( CNetwFrameSizeFactMesLayout::Decode ( vecData, iVals ) )
+    {
+        return true; // return error code
+    }
+
+    // network frame size factor (2 bytes), zero withdraws the suggestion
+    const int iNetwFrameSizeFact = static_cast<int> ( iVals[0] );
 
-    // build data vector (4 bytes long)
-    CVector<uint8_t> vecData ( 4 );
+    if ( ( iNetwFrameSizeFact != 0 ) && ( iNetwFrameSizeFact != FRAME_SIZE_FACTOR_PREFERRED ) &&
+         ( iNetwFrameSizeFact != FRAME_SIZE_FACTOR_DEFAULT ) && ( iNetwFrameSizeFact != FRAME_SIZE_FACTOR_SAFE ) )
+    {
+        return true; // return error code
+    }
 
-    // transmit time (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iMs ), 4 );
+    // invoke message action
+    emit NetwFrameSizeFactReceived ( iNetwFrameSizeFact );
 
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_PING_MS, vecData, InetAddr );
+    return false; // no error
+}
+
+// Connection less messages ----------------------------------------------------
+void CProtocol::CreateCLPingMes ( const CHostAddress& InetAddr, const int iMs )
+{
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_PING_MS, CCLPingMesLayout::Encode ( iMs ), InetAddr );
 }
 
 bool CProtocol::EvaluateCLPingMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CCLPingMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 4 )
+    // check size and extract data
+    if ( CCLPingMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // invoke message action
-    emit CLPingReceived ( InetAddr, static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) ) );
+    emit CLPingReceived ( InetAddr, static_cast<int> ( iVals[0] ) );
 
     return false; // no error
 }
 
 void CProtocol::CreateCLPingWithNumClientsMes ( const CHostAddress& InetAddr, const int iMs, const int iNumClients )
 {
-    int iPos = 0; // init position pointer
-
-    // build data vector (5 bytes long)
-    CVector<uint8_t> vecData ( 5 );
-
-    // transmit time (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iMs ), 4 );
-
-    // current number of connected clients (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iNumClients ), 1 );
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_PING_MS_WITHNUMCLIENTS, vecData, InetAddr );
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_PING_MS_WITHNUMCLIENTS, CCLPingWithNumClientsMesLayout::Encode ( iMs, iNumClients ), InetAddr );
 }
 
 bool CProtocol::EvaluateCLPingWithNumClientsMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CCLPingWithNumClientsMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 5 )
+    // check size and extract data
+    if ( CCLPingWithNumClientsMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // transmit time
-    const int iCurMs = static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+    const int iCurMs = static_cast<int> ( iVals[0] );
 
     // current number of connected clients
-    const int iCurNumClients = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+    const int iCurNumClients = static_cast<int> ( iVals[1] );
 
     // invoke message action
     emit CLPingWithNumClientsReceived ( InetAddr, iCurMs, iCurNumClients );
@@ -1747,247 +1856,113 @@ bool CProtocol::EvaluateCLServerFullMes()
 
 void CProtocol::CreateCLRegisterServerMes ( const CHostAddress& InetAddr, const CHostAddress& LInetAddr, const CServerCoreInfo& ServerInfo )
 {
-    int iPos = 0; // init position pointer
-
-    // convert server info strings to utf-8
-    const QByteArray strUTF8LInetAddr = LInetAddr.InetAddr.toString().toUtf8();
-    const QByteArray strUTF8Name      = ServerInfo.strName.toUtf8();
-    const QByteArray strUTF8City      = ServerInfo.strCity.toUtf8();
-
-    // size of current message body
-    const int iEntrLen = 2 +                           // server internal port number
-                         2 +                           // country
-                         1 +                           // maximum number of connected clients
-                         1 +                           // is permanent flag
-                         2 + strUTF8Name.size() +      // name utf-8 str. size / str.
-                         2 + strUTF8LInetAddr.size() + // server internal address utf-8 str. size / str.
-                         2 + strUTF8City.size();       // city utf-8 str. size / str.
-
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
-
-    // port number (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( LInetAddr.iPort ), 2 );
-
-    // country (2 bytes)
-    PutCountryOnStream ( vecData, iPos, ServerInfo.eCountry );
-
-    // maximum number of connected clients (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( ServerInfo.iMaxNumClients ), 1 );
-
-    // "is permanent" flag (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( ServerInfo.bPermanentOnline ), 1 );
-
-    // name
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
-
-    // server internal address (formerly unused topic)
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8LInetAddr );
-
-    // city
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_REGISTER_SERVER, vecData, InetAddr );
+    // note that the server internal address is sent in the formerly unused topic
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_REGISTER_SERVER,
+                                     CCLRegisterServerMesLayout::Encode ( LInetAddr.iPort,
+                                                                          ServerInfo.eCountry,
+                                                                          ServerInfo.iMaxNumClients,
+                                                                          ServerInfo.bPermanentOnline,
+                                                                          ServerInfo.strName.toUtf8(),
+                                                                          LInetAddr.InetAddr.toString().toUtf8(),
+                                                                          ServerInfo.strCity.toUtf8() ),
+                                     InetAddr );
 }
 
 bool CProtocol::EvaluateCLRegisterServerMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int             iPos     = 0; // init position pointer
-    const int       iDataLen = vecData.Size();
-    QString         sLocHost; // temp string for server internal address
     CHostAddress    LInetAddr;
     CServerCoreInfo RecServerInfo;
+    uint32_t        iPort;
+    uint32_t        iMaxNumClients;
+    uint32_t        iPermanentOnline;
+    QString         sLocHost; // temp string for server internal address
 
-    // check size (the first 6 bytes)
-    if ( iDataLen < 6 )
+    // check size and extract data
+    if ( CCLRegisterServerMesLayout::Decode ( vecData,
+                                              iPort,
+                                              RecServerInfo.eCountry,
+                                              iMaxNumClients,
+                                              iPermanentOnline,
+                                              RecServerInfo.strName,
+                                              sLocHost,
+                                              RecServerInfo.strCity ) ||
+         GetServerInternalAddress ( sLocHost, LInetAddr.InetAddr ) )
     {
         return true; // return error code
     }
 
-    // port number (2 bytes)
-    LInetAddr.iPort = static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) );
+    LInetAddr.iPort                = static_cast<quint16> ( iPort );
+    RecServerInfo.iMaxNumClients   = static_cast<int> ( iMaxNumClients );
+    RecServerInfo.bPermanentOnline = static_cast<bool> ( iPermanentOnline );
 
-    // country (2 bytes)
-    RecServerInfo.eCountry = GetCountryFromStream ( vecData, iPos );
-
-    // maximum number of connected clients (1 byte)
-    RecServerInfo.iMaxNumClients = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // "is permanent" flag (1 byte)
-    RecServerInfo.bPermanentOnline = static_cast<bool> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // server name
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_NAME, RecServerInfo.strName ) )
-    {
-        return true; // return error code
-    }
+    // invoke message action
+    emit CLRegisterServerReceived ( InetAddr, LInetAddr, RecServerInfo );
 
-    // server internal address
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_IP_ADDRESS, sLocHost ) )
-    {
-        return true; // return error code
-    }
+    return false; // no error
+}
 
+bool CProtocol::GetServerInternalAddress ( const QString& sLocHost, QHostAddress& InetAddr )
+{
     if ( sLocHost.isEmpty() )
     {
         // old server, empty "topic", register as local host
-        LInetAddr.InetAddr.setAddress ( QHostAddress::LocalHost );
-    }
-    else if ( !LInetAddr.InetAddr.setAddress ( sLocHost ) )
-    {
-        return true; // return error code
-    }
+        InetAddr.setAddress ( QHostAddress::LocalHost );
 
-    // server city
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, RecServerInfo.strCity ) )
-    {
-        return true; // return error code
-    }
-
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
+        return false; // no error
     }
 
-    // invoke message action
-    emit CLRegisterServerReceived ( InetAddr, LInetAddr, RecServerInfo );
-
-    return false; // no error
+    return !InetAddr.setAddress ( sLocHost );
 }
 
 void CProtocol::CreateCLRegisterServerExMes ( const CHostAddress& InetAddr, const CHostAddress& LInetAddr, const CServerCoreInfo& ServerInfo )
 {
-    int iPos = 0; // init position pointer
-
-    // convert server info strings to utf-8
-    const QByteArray strUTF8LInetAddr = LInetAddr.InetAddr.toString().toUtf8();
-    const QByteArray strUTF8Name      = ServerInfo.strName.toUtf8();
-    const QByteArray strUTF8City      = ServerInfo.strCity.toUtf8();
-    const QByteArray strUTF8Version   = QString ( VERSION ).toUtf8();
-
-    // size of current message body
-    const int iEntrLen = 2 +                           // server internal port number
-                         2 +                           // country
-                         1 +                           // maximum number of connected clients
-                         1 +                           // is permanent flag
-                         2 + strUTF8Name.size() +      // name utf-8 str. size / str.
-                         2 + strUTF8LInetAddr.size() + // server internal address utf-8 str. size / str.
-                         2 + strUTF8City.size() +      // city utf-8 str. size / str.
-                         1 +                           // operating system
-                         2 + strUTF8Version.size();    // version utf-8 str. size / str.
-
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
-
-    // port number (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( LInetAddr.iPort ), 2 );
-
-    // country (2 bytes)
-    PutCountryOnStream ( vecData, iPos, ServerInfo.eCountry );
-
-    // maximum number of connected clients (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( ServerInfo.iMaxNumClients ), 1 );
-
-    // "is permanent" flag (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( ServerInfo.bPermanentOnline ), 1 );
-
-    // name
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
-
-    // server internal address (formerly unused topic)
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8LInetAddr );
-
-    // city
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
-
-    // operating system (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( COSUtil::GetOperatingSystem() ), 1 );
-
-    // version
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8Version );
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_REGISTER_SERVER_EX, vecData, InetAddr );
+    // note that the server internal address is sent in the formerly unused topic
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_REGISTER_SERVER_EX,
+                                     CCLRegisterServerExMesLayout::Encode ( LInetAddr.iPort,
+                                                                            ServerInfo.eCountry,
+                                                                            ServerInfo.iMaxNumClients,
+                                                                            ServerInfo.bPermanentOnline,
+                                                                            ServerInfo.strName.toUtf8(),
+                                                                            LInetAddr.InetAddr.toString().toUtf8(),
+                                                                            ServerInfo.strCity.toUtf8(),
+                                                                            COSUtil::GetOperatingSystem(),
+                                                                            QString ( VERSION ).toUtf8() ),
+                                     InetAddr );
 }
 
 bool CProtocol::EvaluateCLRegisterServerExMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int             iPos     = 0; // init position pointer
-    const int       iDataLen = vecData.Size();
-    QString         sLocHost; // temp string for server internal address
     CHostAddress    LInetAddr;
     CServerCoreInfo RecServerInfo;
-
-    // check size (the first 6 bytes)
-    if ( iDataLen < 6 )
-    {
-        return true; // return error code
-    }
-
-    // port number (2 bytes)
-    LInetAddr.iPort = static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) );
-
-    // country (2 bytes)
-    RecServerInfo.eCountry = GetCountryFromStream ( vecData, iPos );
-
-    // maximum number of connected clients (1 byte)
-    RecServerInfo.iMaxNumClients = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // "is permanent" flag (1 byte)
-    RecServerInfo.bPermanentOnline = static_cast<bool> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // server name
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_NAME, RecServerInfo.strName ) )
-    {
-        return true; // return error code
-    }
-
-    // server internal address
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_IP_ADDRESS, sLocHost ) )
-    {
-        return true; // return error code
-    }
-
-    if ( sLocHost.isEmpty() )
-    {
-        // old server, empty "topic", register as local host
-        LInetAddr.InetAddr.setAddress ( QHostAddress::LocalHost );
-    }
-    else if ( !LInetAddr.InetAddr.setAddress ( sLocHost ) )
-    {
-        return true; // return error code
-    }
-
-    // server city
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, RecServerInfo.strCity ) )
-    {
-        return true; // return error code
-    }
-
-    // check size (the next 1 byte)
-    if ( iDataLen < iPos + 1 )
-    {
-        return true; // return error code
-    }
-
-    // operating system (1 byte)
-    const COSUtil::EOpSystemType eOSType = static_cast<COSUtil::EOpSystemType> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // version text
-    QString strVersion;
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_VERSION_TEXT, strVersion ) )
+    uint32_t        iPort;
+    uint32_t        iMaxNumClients;
+    uint32_t        iPermanentOnline;
+    uint32_t        iOSType;
+    QString         sLocHost; // temp string for server internal address
+    QString         strVersion;
+
+    // check size and extract data
+    if ( CCLRegisterServerExMesLayout::Decode ( vecData,
+                                                iPort,
+                                                RecServerInfo.eCountry,
+                                                iMaxNumClients,
+                                                iPermanentOnline,
+                                                RecServerInfo.strName,
+                                                sLocHost,
+                                                RecServerInfo.strCity,
+                                                iOSType,
+                                                strVersion ) ||
+         GetServerInternalAddress ( sLocHost, LInetAddr.InetAddr ) )
     {
         return true; // return error code
     }
 
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
-    }
+    LInetAddr.iPort                = static_cast<quint16> ( iPort );
+    RecServerInfo.iMaxNumClients   = static_cast<int> ( iMaxNumClients );
+    RecServerInfo.bPermanentOnline = static_cast<bool> ( iPermanentOnline );
 
     // invoke message action
-    emit CLRegisterServerExReceived ( InetAddr, LInetAddr, RecServerInfo, eOSType, strVersion );
+    emit CLRegisterServerExReceived ( InetAddr, LInetAddr, RecServerInfo, static_cast<COSUtil::EOpSystemType> ( iOSType ), strVersion );
 
     return false; // no error
 }
@@ -2007,57 +1982,21 @@ bool CProtocol::EvaluateCLUnregisterServerMes ( const CHostAddress& InetAddr )
 
 void CProtocol::CreateCLServerListMes ( const CHostAddress& InetAddr, const CVector<CServerInfo> vecServerInfo )
 {
-    const int iNumServers = vecServerInfo.Size();
-
-    // build data vector
+    const int        iNumServers = vecServerInfo.Size();
     CVector<uint8_t> vecData ( 0 );
-    int              iPos = 0; // init position pointer
 
     for ( int i = 0; i < iNumServers; i++ )
     {
-        // convert server list strings to utf-8
-        const QByteArray strUTF8Name  = vecServerInfo[i].strName.toUtf8();
-        const QByteArray strUTF8Empty = QString ( "" ).toUtf8();
-        const QByteArray strUTF8City  = vecServerInfo[i].strCity.toUtf8();
-
-        // size of current list entry
-        const int iCurListEntrLen = 4 +                      // IP address
-                                    2 +                      // port number
-                                    2 +                      // country
-                                    1 +                      // maximum number of connected clients
-                                    1 +                      // is permanent flag
-                                    2 + strUTF8Name.size() + // name utf-8 str. size / str.
-                                    2 +                      // empty string
-                                    2 + strUTF8City.size();  // city utf-8 str. size / str.
-
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
-
-        // IP address (4 bytes)
-        // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.InetAddr.toIPv4Address() ), 4 );
-
-        // port number (2 bytes)
         // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.iPort ), 2 );
-
-        // country (2 bytes)
-        PutCountryOnStream ( vecData, iPos, vecServerInfo[i].eCountry );
-
-        // maximum number of connected clients (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].iMaxNumClients ), 1 );
-
-        // "is permanent" flag (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].bPermanentOnline ), 1 );
-
-        // name
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
-
-        // empty string
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Empty );
-
-        // city
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
+        CCLServerListEntryLayout::Append ( vecData,
+                                           vecServerInfo[i].HostAddr.InetAddr.toIPv4Address(),
+                                           vecServerInfo[i].HostAddr.iPort,
+                                           vecServerInfo[i].eCountry,
+                                           vecServerInfo[i].iMaxNumClients,
+                                           vecServerInfo[i].bPermanentOnline,
+                                           vecServerInfo[i].strName.toUtf8(),
+                                           QByteArray(),
+                                           vecServerInfo[i].strCity.toUtf8() );
     }
 
     CreateAndImmSendConLessMessage ( PROTMESSID_CLM_SERVER_LIST, vecData, InetAddr );
@@ -2065,68 +2004,36 @@ void CProtocol::CreateCLServerListMes ( const CHostAddress& InetAddr, const CVec
 
 bool CProtocol::EvaluateCLServerListMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int                  iPos     = 0; // init position pointer
-    const int            iDataLen = vecData.Size();
+    int                  iPos = 0; // init position pointer
     CVector<CServerInfo> vecServerInfo ( 0 );
 
-    while ( iPos < iDataLen )
+    // read entries until the end of the message is reached
+    while ( iPos < vecData.Size() )
     {
-        // check size (the next 10 bytes)
-        if ( ( iDataLen - iPos ) < 10 )
-        {
-            return true; // return error code
-        }
-
-        // IP address (4 bytes)
-        const quint32 iIpAddr = static_cast<quint32> ( GetValFromStream ( vecData, iPos, 4 ) );
-
-        // port number (2 bytes)
-        const quint16 iPort = static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) );
-
-        // country (2 bytes)
-        const QLocale::Country eCountry = GetCountryFromStream ( vecData, iPos );
-
-        // maximum number of connected clients (1 byte)
-        const int iMaxNumClients = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+        uint32_t         iIpAddr;
+        uint32_t         iPort;
+        QLocale::Country eCountry;
+        uint32_t         iMaxNumClients;
+        uint32_t         iPermanentOnline;
+        QString          strName;
+        QString          strEmpty;
+        QString          strCity;
 
-        // "is permanent" flag (1 byte)
-        const bool bPermanentOnline = static_cast<bool> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-        // server name
-        QString strName;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_NAME, strName ) )
-        {
-            return true; // return error code
-        }
-
-        // empty
-        QString strEmpty;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_IP_ADDRESS, strEmpty ) )
-        {
-            return true; // return error code
-        }
-
-        // server city
-        QString strCity;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, strCity ) )
+        if ( CCLServerListEntryLayout::Get ( vecData, iPos, iIpAddr, iPort, eCountry, iMaxNumClients, iPermanentOnline, strName, strEmpty, strCity ) )
         {
             return true; // return error code
         }
 
         // add server information to vector
-        vecServerInfo.Add ( CServerInfo ( CHostAddress ( QHostAddress ( iIpAddr ), iPort ),
-                                          CHostAddress ( QHostAddress ( iIpAddr ), iPort ),
+        const CHostAddress HostAddr ( QHostAddress ( static_cast<quint32> ( iIpAddr ) ), static_cast<quint16> ( iPort ) );
+
+        vecServerInfo.Add ( CServerInfo ( HostAddr,
+                                          HostAddr,
                                           strName,
                                           eCountry,
                                           strCity,
-                                          iMaxNumClients,
-                                          bPermanentOnline ) );
-    }
-
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
+                                          static_cast<int> ( iMaxNumClients ),
+                                          static_cast<bool> ( iPermanentOnline ) ) );
     }
 
     // invoke message action
@@ -2137,35 +2044,16 @@ bool CProtocol::EvaluateCLServerListMes ( const CHostAddress& InetAddr, const CV
 
 void CProtocol::CreateCLRedServerListMes ( const CHostAddress& InetAddr, const CVector<CServerInfo> vecServerInfo )
 {
-    const int iNumServers = vecServerInfo.Size();
-
-    // build data vector
+    const int        iNumServers = vecServerInfo.Size();
     CVector<uint8_t> vecData ( 0 );
-    int              iPos = 0; // init position pointer
 
     for ( int i = 0; i < iNumServers; i++ )
     {
-        // convert server list strings to utf-8
-        const QByteArray strUTF8Name = vecServerInfo[i].strName.toUtf8();
-
-        // size of current list entry
-        const int iCurListEntrLen = 4 +                     // IP address
-                                    2 +                     // port number
-                                    1 + strUTF8Name.size(); // name utf-8 str. size / str.
-
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
-
-        // IP address (4 bytes)
-        // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.InetAddr.toIPv4Address() ), 4 );
-
-        // port number (2 bytes)
         // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.iPort ), 2 );
-
-        // name (note that the string length indicator is 1 in this special case)
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name, 1 );
+        CCLRedServerListEntryLayout::Append ( vecData,
+                                              vecServerInfo[i].HostAddr.InetAddr.toIPv4Address(),
+                                              vecServerInfo[i].HostAddr.iPort,
+                                              vecServerInfo[i].strName.toUtf8() );
     }
 
     CreateAndImmSendConLessMessage ( PROTMESSID_CLM_RED_SERVER_LIST, vecData, InetAddr );
@@ -2173,34 +2061,26 @@ void CProtocol::CreateCLRedServerListMes ( const CHostAddress& InetAddr, const C
 
 bool CProtocol::EvaluateCLRedServerListMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int                  iPos     = 0; // init position pointer
-    const int            iDataLen = vecData.Size();
+    int                  iPos = 0; // init position pointer
     CVector<CServerInfo> vecServerInfo ( 0 );
 
-    while ( iPos < iDataLen )
+    // read entries until the end of the message is reached
+    while ( iPos < vecData.Size() )
     {
-        // check size (the next 6 bytes)
-        if ( ( iDataLen - iPos ) < 6 )
-        {
-            return true; // return error code
-        }
+        uint32_t iIpAddr;
+        uint32_t iPort;
+        QString  strName;
 
-        // IP address (4 bytes)
-        const quint32 iIpAddr = static_cast<quint32> ( GetValFromStream ( vecData, iPos, 4 ) );
-
-        // port number (2 bytes)
-        const quint16 iPort = static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) );
-
-        // server name (note that the string length indicator is 1 in this special case)
-        QString strName;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_NAME, strName, 1 ) )
+        if ( CCLRedServerListEntryLayout::Get ( vecData, iPos, iIpAddr, iPort, strName ) )
         {
             return true; // return error code
         }
 
         // add server information to vector
-        vecServerInfo.Add ( CServerInfo ( CHostAddress ( QHostAddress ( iIpAddr ), iPort ),
-                                          CHostAddress ( QHostAddress ( iIpAddr ), iPort ),
+        const CHostAddress HostAddr ( QHostAddress ( static_cast<quint32> ( iIpAddr ) ), static_cast<quint16> ( iPort ) );
+
+        vecServerInfo.Add ( CServerInfo ( HostAddr,
+                                          HostAddr,
                                           strName,
                                           QLocale::AnyCountry, // set to any country since the information is not transmitted
                                           "",                  // empty city name since the information is not transmitted
@@ -2208,12 +2088,6 @@ bool CProtocol::EvaluateCLRedServerListMes ( const CHostAddress& InetAddr, const
                                           false ) );           // assume not permanent since the information is not transmitted
     }
 
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
-    }
-
     // invoke message action
     emit CLRedServerListReceived ( InetAddr, vecServerInfo );
 
@@ -2235,35 +2109,26 @@ bool CProtocol::EvaluateCLReqServerListMes ( const CHostAddress& InetAddr )
 
 void CProtocol::CreateCLSendEmptyMesMes ( const CHostAddress& InetAddr, const CHostAddress& TargetInetAddr )
 {
-    int iPos = 0; // init position pointer
-
-    // build data vector (6 bytes long)
-    CVector<uint8_t> vecData ( 6 );
-
-    // IP address (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( TargetInetAddr.InetAddr.toIPv4Address() ), 4 );
-
-    // port number (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( TargetInetAddr.iPort ), 2 );
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_SEND_EMPTY_MESSAGE, vecData, InetAddr );
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_SEND_EMPTY_MESSAGE,
+                                     CCLSendEmptyMesMesLayout::Encode ( TargetInetAddr.InetAddr.toIPv4Address(), TargetInetAddr.iPort ),
+                                     InetAddr );
 }
 
 bool CProtocol::EvaluateCLSendEmptyMesMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    uint32_t iVals[CCLSendEmptyMesMesLayout::iNumFields];
 
-    // check size
-    if ( vecData.Size() != 6 )
+    // check size and extract data
+    if ( CCLSendEmptyMesMesLayout::Decode ( vecData, iVals ) )
     {
         return true; // return error code
     }
 
     // IP address (4 bytes)
-    const quint32 iIpAddr = static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+    const quint32 iIpAddr = static_cast<quint32> ( iVals[0] );
 
     // port number (2 bytes)
-    const quint16 iPort = static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+    const quint16 iPort = static_cast<quint16> ( iVals[1] );
 
     // invoke message action
     emit CLSendEmptyMes ( CHostAddress ( QHostAddress ( iIpAddr ), iPort ) );
@@ -2293,59 +2158,24 @@ bool CProtocol::EvaluateCLDisconnectionMes ( const CHostAddress& InetAddr )
 
 void CProtocol::CreateCLVersionAndOSMes ( const CHostAddress& InetAddr )
 {
-    int iPos = 0; // init position pointer
-
-    // get the version number string
-    const QString strVerion = VERSION;
-
-    // convert version string to utf-8
-    const QByteArray strUTF8Version = strVerion.toUtf8();
-
-    // size of current message body
-    const int iEntrLen = 1 +                        // operating system
-                         2 + strUTF8Version.size(); // version utf-8 str. size / str.
-
-    // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
-
-    // operating system (1 byte)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( COSUtil::GetOperatingSystem() ), 1 );
-
-    // version
-    PutStringUTF8OnStream ( vecData, iPos, strUTF8Version );
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_VERSION_AND_OS, vecData, InetAddr );
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_VERSION_AND_OS,
+                                     CVersionAndOSMesLayout::Encode ( COSUtil::GetOperatingSystem(), QString ( VERSION ).toUtf8() ),
+                                     InetAddr );
 }
 
 bool CProtocol::EvaluateCLVersionAndOSMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int       iPos     = 0; // init position pointer
-    const int iDataLen = vecData.Size();
+    uint32_t iOSType;
+    QString  strVersion;
 
-    // check size (the first 1 byte)
-    if ( iDataLen < 1 )
-    {
-        return true; // return error code
-    }
-
-    // operating system (1 byte)
-    const COSUtil::EOpSystemType eOSType = static_cast<COSUtil::EOpSystemType> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-    // version text
-    QString strVersion;
-    if ( GetStringFromStream ( vecData, iPos, MAX_LEN_VERSION_TEXT, strVersion ) )
-    {
-        return true; // return error code
-    }
-
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
+    // check size and extract data
+    if ( CVersionAndOSMesLayout::Decode ( vecData, iOSType, strVersion ) )
     {
         return true; // return error code
     }
 
     // invoke message action
-    emit CLVersionAndOSReceived ( InetAddr, eOSType, strVersion );
+    emit CLVersionAndOSReceived ( InetAddr, static_cast<COSUtil::EOpSystemType> ( iOSType ), strVersion );
 
     return false; // no error
 }
@@ -2365,104 +2195,20 @@ bool CProtocol::EvaluateCLReqVersionAndOSMes ( const CHostAddress& InetAddr )
 
 void CProtocol::CreateCLConnClientsListMes ( const CHostAddress& InetAddr, const CVector<CChannelInfo>& vecChanInfo )
 {
-    const int iNumClients = vecChanInfo.Size();
-
-    // build data vector
     CVector<uint8_t> vecData ( 0 );
     int              iPos = 0; // init position pointer
 
-    for ( int i = 0; i < iNumClients; i++ )
-    {
-        // convert strings to utf-8
-        const QByteArray strUTF8Name = vecChanInfo[i].strName.toUtf8();
-        const QByteArray strUTF8City = vecChanInfo[i].strCity.toUtf8();
-
-        // size of current list entry
-        const int iCurListEntrLen = 1 +                      // chan ID
-                                    2 +                      // country
-                                    4 +                      // instrument
-                                    1 +                      // skill level
-                                    4 +                      // IP address
-                                    2 + strUTF8Name.size() + // utf-8 str. size / str.
-                                    2 + strUTF8City.size();  // utf-8 str. size / str.
-
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
-
-        // channel ID (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iChanID ), 1 );
-
-        // country (2 bytes)
-        PutCountryOnStream ( vecData, iPos, vecChanInfo[i].eCountry );
-
-        // instrument (4 bytes)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iInstrument ), 4 );
-
-        // skill level (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].eSkillLevel ), 1 );
-
-        // used to be IP address before #316 (4 bytes)
-        PutValOnStream ( vecData, iPos, 0, 4 );
-
-        // name
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
-
-        // city
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
-    }
+    PutChanInfoListOnStream ( vecData, iPos, vecChanInfo );
 
     CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CONN_CLIENTS_LIST, vecData, InetAddr );
 }
 
 bool CProtocol::EvaluateCLConnClientsListMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int                   iPos     = 0; // init position pointer
-    const int             iDataLen = vecData.Size();
+    int                   iPos = 0; // init position pointer
     CVector<CChannelInfo> vecChanInfo ( 0 );
 
-    while ( iPos < iDataLen )
-    {
-        // check size (the next 12 bytes)
-        if ( ( iDataLen - iPos ) < 12 )
-        {
-            return true; // return error code
-        }
-
-        // channel ID (1 byte)
-        const int iChanID = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-        // country (2 bytes)
-        const QLocale::Country eCountry = GetCountryFromStream ( vecData, iPos );
-
-        // instrument (4 bytes)
-        const int iInstrument = static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
-
-        // skill level (1 byte)
-        const ESkillLevel eSkillLevel = static_cast<ESkillLevel> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-        // used to be IP address, zero since #316 (4 bytes)
-        iPos += 4;
-
-        // name
-        QString strCurName;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_FADER_TAG, strCurName ) )
-        {
-            return true; // return error code
-        }
-
-        // city
-        QString strCurCity;
-        if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, strCurCity ) )
-        {
-            return true; // return error code
-        }
-
-        // add channel information to vector
-        vecChanInfo.Add ( CChannelInfo ( iChanID, strCurName, eCountry, strCurCity, iInstrument, eSkillLevel ) );
-    }
-
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
+    if ( GetChanInfoListFromStream ( vecData, iPos, vecChanInfo ) )
     {
         return true; // return error code
     }
@@ -2487,11 +2233,30 @@ bool CProtocol::EvaluateCLReqConnClientsListMes ( const CHostAddress& InetAddr )
 }
 
 void CProtocol::CreateCLChannelLevelListMes ( const CHostAddress& InetAddr, const CVector<uint16_t>& vecLevelList, const int iNumClients )
+{
+    CVector<uint8_t> vecData;
+
+    GenCLChannelLevelListMesBody ( vecData, vecLevelList, iNumClients );
+
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST, vecData, InetAddr );
+}
+
+CProtocol::CBroadcastMes CProtocol::PrepCLChannelLevelListMes ( const CVector<uint16_t>& vecLevelList, const int iNumClients )
+{
+    CVector<uint8_t> vecData;
+
+    GenCLChannelLevelListMesBody ( vecData, vecLevelList, iNumClients );
+
+    return CBroadcastMes ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST, vecData );
+}
+
+void CProtocol::GenCLChannelLevelListMesBody ( CVector<uint8_t>& vecData, const CVector<uint16_t>& vecLevelList, const int iNumClients )
 {
     // This must be a multiple of bytes at four bits per client
-    const int        iNumBytes = ( iNumClients + 1 ) / 2;
-    CVector<uint8_t> vecData ( iNumBytes );
-    int              iPos = 0; // init position pointer
+    const int iNumBytes = ( iNumClients + 1 ) / 2;
+    int       iPos      = 0; // init position pointer
+
+    vecData.Init ( iNumBytes );
 
     for ( int i = 0, j = 0; i < iNumClients; i += 2 /* pack two per byte */, j++ )
     {
@@ -2501,8 +2266,6 @@ void CProtocol::CreateCLChannelLevelListMes ( const CHostAddress& InetAddr, cons
 
         PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( byte ), 1 );
     }
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST, vecData, InetAddr );
 }
 
 bool CProtocol::EvaluateCLChannelLevelListMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
@@ -2512,7 +2275,8 @@ bool CProtocol::EvaluateCLChannelLevelListMes ( const CHostAddress& InetAddr, co
                                          // may have one too many entries, last being 0xF
     int iVecLen = iDataLen * 2;          // one ushort per channel
 
-    if ( iVecLen > MAX_NUM_CHANNELS )
+    // an odd number of channels is padded with one unused entry
+    if ( iVecLen > MAX_NUM_SERVER_CHANNELS + 1 )
     {
         return true; // return error code
     }
@@ -2546,26 +2310,21 @@ bool CProtocol::EvaluateCLChannelLevelListMes ( const CHostAddress& InetAddr, co
 
 void CProtocol::CreateCLRegisterServerResp ( const CHostAddress& InetAddr, const ESvrRegResult eResult )
 {
-    int              iPos = 0; // init position pointer
-    CVector<uint8_t> vecData ( 1 );
-
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( eResult ), 1 );
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_REGISTER_SERVER_RESP, vecData, InetAddr );
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_REGISTER_SERVER_RESP, CCLRegisterServerRespMesLayout::Encode ( eResult ), InetAddr );
 }
 
 bool CProtocol::EvaluateCLRegisterServerResp ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData )
 {
-    int       iPos     = 0; // init position pointer
-    const int iDataLen = vecData.Size();
+    uint32_t iVals[CCLRegisterServerRespMesLayout::iNumFields];
 
-    if ( iDataLen != 1 )
+    // check size and extract data
+    if ( CCLRegisterServerRespMesLayout::Decode ( vecData, iVals ) )
     {
         return true;
     }
 
     // server registration result (1 byte)
-    const int iSvrRegResult = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+    const int iSvrRegResult = static_cast<int> ( iVals[0] );
 
     if ( ( iSvrRegResult != SRR_REGISTERED ) && ( iSvrRegResult != SRR_SERVER_LIST_FULL ) && ( iSvrRegResult != SRR_VERSION_TOO_OLD ) &&
          ( iSvrRegResult != SRR_NOT_FULFILL_REQIREMENTS ) )
@@ -2582,13 +2341,13 @@ bool CProtocol::EvaluateCLRegisterServerResp ( const CHostAddress& InetAddr, con
 /******************************************************************************\
 * Message generation and parsing                                               *
 \******************************************************************************/
-bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
-                                    const int               iNumBytesIn,
-                                    CVector<uint8_t>&       vecbyMesBodyData,
-                                    int&                    iCnt,
-                                    int&                    iID )
+bool CProtocol::ParseMessageFrame ( const uint8_t* pbyData, const int iNumBytesIn, int& iCnt, int& iID, int& iLenBy )
 {
-    int i;
+    /*
+        note: the frame is checked directly in the given buffer, no memory is
+        allocated here (this function is called in the socket thread for each
+        received packet, i.e., also for all audio packets)
+    */
     int iCurPos;
 
     // vector must be at least "MESS_LEN_WITHOUT_DATA_BYTE" bytes long
@@ -2601,7 +2360,7 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
     iCurPos = 0; // start from beginning
 
     // 2 bytes TAG
-    const int iTag = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
+    const int iTag = static_cast<int> ( GetValFromBuffer ( pbyData, iCurPos, 2 ) );
 
     // check if tag is correct
     if ( iTag != 0 )
@@ -2610,13 +2369,13 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
     }
 
     // 2 bytes ID
-    iID = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
+    iID = static_cast<int> ( GetValFromBuffer ( pbyData, iCurPos, 2 ) );
 
     // 1 byte cnt
-    iCnt = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 1 ) );
+    iCnt = static_cast<int> ( GetValFromBuffer ( pbyData, iCurPos, 1 ) );
 
     // 2 bytes length
-    const int iLenBy = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
+    iLenBy = static_cast<int> ( GetValFromBuffer ( pbyData, iCurPos, 2 ) );
 
     // make sure the length is correct
     if ( iLenBy != iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE )
@@ -2629,32 +2388,16 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
 
     const int iLenCRCCalc = MESS_HEADER_LENGTH_BYTE + iLenBy;
 
-    iCurPos = 0; // start from the beginning
+    CRCObj.AddBytes ( pbyData, iLenCRCCalc );
 
-    for ( i = 0; i < iLenCRCCalc; i++ )
-    {
-        CRCObj.AddByte ( static_cast<uint8_t> ( GetValFromStream ( vecbyData, iCurPos, 1 ) ) );
-    }
+    iCurPos = iLenCRCCalc; // CRC follows header and data
 
-    if ( CRCObj.GetCRC() != GetValFromStream ( vecbyData, iCurPos, 2 ) )
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION // a fuzzer cannot generate valid CRCs
+    if ( CRCObj.GetCRC() != GetValFromBuffer ( pbyData, iCurPos, 2 ) )
     {
         return true; // return error code
     }
-
-    // Extract actual data -----------------------------------------------------
-
-    //### TODO: BEGIN ###//
-    // this memory allocation is done in the real time thread but should be
-    // done in the low priority protocol management thread
-    vecbyMesBodyData.Init ( iLenBy );
-    //### TODO: END ###//
-
-    iCurPos = MESS_HEADER_LENGTH_BYTE; // start from beginning of data
-
-    for ( i = 0; i < iLenBy; i++ )
-    {
-        vecbyMesBodyData[i] = static_cast<uint8_t> ( GetValFromStream ( vecbyData, iCurPos, 1 ) );
-    }
+#endif
 
     return false; // no error
 }
@@ -2694,83 +2437,43 @@ bool CProtocol::ParseSplitMessageContainer ( const CVector<uint8_t>& vecbyData,
         return true; // return error code
     }
 
-    for ( int i = 0; i < iCurPartSize; i++ )
-    {
-        vecbyMesBodyData[iSplitMessageDataIndex + i] = static_cast<uint8_t> ( GetValFromStream ( vecbyData, iPos, 1 ) );
-    }
+    std::copy ( vecbyData.begin() + iPos, vecbyData.end(), vecbyMesBodyData.begin() + iSplitMessageDataIndex );
 
     return false; // no error
 }
 
-uint32_t CProtocol::GetValFromStream ( const CVector<uint8_t>& vecIn, int& iPos, const int iNumOfBytes )
-{
-    /*
-        note: iPos is automatically incremented in this function
-    */
-    // 4 bytes maximum since we return uint32
-    Q_ASSERT ( ( iNumOfBytes > 0 ) && ( iNumOfBytes <= 4 ) );
-    Q_ASSERT ( vecIn.Size() >= iPos + iNumOfBytes );
-
-    uint32_t iRet = 0;
-
-    for ( int i = 0; i < iNumOfBytes; i++ )
-    {
-        iRet |= vecIn[iPos] << ( i * 8 /* size of byte */ );
-        iPos++;
-    }
-
-    return iRet;
-}
-
-bool CProtocol::GetStringFromStream ( const CVector<uint8_t>& vecIn, int& iPos, const int iMaxStringLen, QString& strOut, const int iNumberOfBytsLen )
+bool CProtocol::GetChanInfoListFromStream ( const CVector<uint8_t>& vecIn, int& iPos, CVector<CChannelInfo>& vecChanInfo )
 {
     /*
-        note: iPos is automatically incremented in this function
+        note: reads entries until the end of the vector is reached
     */
-    const int iInLen = vecIn.Size();
-
-    // check if at least iNumberOfBytsLen bytes are available
-    if ( ( iInLen - iPos ) < iNumberOfBytsLen )
+    while ( iPos < vecIn.Size() )
     {
-        return true; // return error code
-    }
-
-    // number of bytes for utf-8 string (1 or 2 bytes)
-    const int iStrUTF8Len = static_cast<int> ( GetValFromStream ( vecIn, iPos, iNumberOfBytsLen ) );
-
-    // (note that iPos was incremented by 2 in the above code!)
-    if ( ( iInLen - iPos ) < iStrUTF8Len )
-    {
-        return true; // return error code
-    }
-
-    // string (n bytes)
-    QByteArray sStringUTF8;
+        uint32_t         iChanID;
+        QLocale::Country eCountry;
+        uint32_t         iInstrument;
+        uint32_t         iSkillLevel;
+        uint32_t         iUnusedIpAddr;
+        QString          strCurName;
+        QString          strCurCity;
 
-    for ( int i = 0; i < iStrUTF8Len; i++ )
-    {
-        // byte-by-byte copying of the string data
-        sStringUTF8.append ( static_cast<char> ( GetValFromStream ( vecIn, iPos, 1 ) ) );
-    }
-
-    // convert utf-8 byte array in the return string
-    strOut = QString::fromUtf8 ( sStringUTF8 );
+        if ( CChanInfoListEntryLayout::Get ( vecIn, iPos, iChanID, eCountry, iInstrument, iSkillLevel, iUnusedIpAddr, strCurName, strCurCity ) )
+        {
+            return true; // return error code
+        }
 
-    // check length of actual string
-    if ( strOut.size() > iMaxStringLen )
-    {
-        return true; // return error code
+        // add channel information to vector
+        vecChanInfo.Add ( CChannelInfo ( static_cast<int> ( iChanID ),
+                                         strCurName,
+                                         eCountry,
+                                         strCurCity,
+                                         static_cast<int> ( iInstrument ),
+                                         static_cast<ESkillLevel> ( iSkillLevel ) ) );
     }
 
     return false; // no error
 }
 
-QLocale::Country CProtocol::GetCountryFromStream ( const CVector<uint8_t>& vecIn, int& iPos )
-{
-    unsigned short iCountryCode = GetValFromStream ( vecIn, iPos, 2 );
-    return CLocale::WireFormatCountryCodeToQtCountry ( iCountryCode );
-}
-
 void CProtocol::GenMessageFrame ( CVector<uint8_t>& vecOut, const int iCnt, const int iID, const CVector<uint8_t>& vecData )
 {
     int i;
@@ -2808,14 +2511,9 @@ void CProtocol::GenMessageFrame ( CVector<uint8_t>& vecOut, const int iCnt, cons
     // Encode CRC --------------------------------------------------------------
     CCRC CRCObj;
 
-    iCurPos = 0; // start from beginning
-
     const int iLenCRCCalc = MESS_HEADER_LENGTH_BYTE + iDataLenByte;
 
-    for ( i = 0; i < iLenCRCCalc; i++ )
-    {
-        CRCObj.AddByte ( static_cast<uint8_t> ( GetValFromStream ( vecOut, iCurPos, 1 ) ) );
-    }
+    CRCObj.AddBytes ( &vecOut[0], iLenCRCCalc );
 
     PutValOnStream ( vecOut, iCurPos, static_cast<uint32_t> ( CRCObj.GetCRC() ), 2 );
 }
@@ -2852,6 +2550,33 @@ void CProtocol::GenSplitMessageContainer ( CVector<uint8_t>&       vecOut,
     }
 }
 
+void CProtocol::GenSplitMessageParts ( CVector<CVector<uint8_t>>& vecvecOut, const int iID, const CVector<uint8_t>& vecData )
+{
+    const int iDataLen          = vecData.Size();
+    int       iStartIndexInData = 0; // init index
+
+    // calculate the number of split parts
+    const int iNumParts = static_cast<int> ( std::ceil ( static_cast<double> ( iDataLen ) / MESS_SPLIT_PART_SIZE_BYTES ) );
+
+    vecvecOut.Init ( iNumParts );
+
+    for ( int iSplitCnt = 0; iSplitCnt < iNumParts; iSplitCnt++ )
+    {
+        // the split part size may be smaller for the last part
+        int iCurPartSize = MESS_SPLIT_PART_SIZE_BYTES;
+
+        if ( iDataLen - iStartIndexInData < MESS_SPLIT_PART_SIZE_BYTES )
+        {
+            iCurPartSize = iDataLen - iStartIndexInData;
+        }
+
+        GenSplitMessageContainer ( vecvecOut[iSplitCnt], iID, iNumParts, iSplitCnt, vecData, iStartIndexInData, iCurPartSize );
+
+        // increment the start index of the source data by the last part size
+        iStartIndexInData += iCurPartSize;
+    }
+}
+
 void CProtocol::PutValOnStream ( CVector<uint8_t>& vecIn, int& iPos, const uint32_t iVal, const int iNumOfBytes )
 {
     /*
@@ -2868,24 +2593,25 @@ void CProtocol::PutValOnStream ( CVector<uint8_t>& vecIn, int& iPos, const uint3
     }
 }
 
-void CProtocol::PutStringUTF8OnStream ( CVector<uint8_t>& vecIn, int& iPos, const QByteArray& sStringUTF8, const int iNumberOfBytsLen )
+void CProtocol::PutChanInfoListOnStream ( CVector<uint8_t>& vecIn, int& iPos, const CVector<CChannelInfo>& vecChanInfo )
 {
-    // get the utf-8 string size
-    const int iStrUTF8Len = sStringUTF8.size();
-
-    // number of bytes for utf-8 string (iNumberOfBytsLen bytes)
-    PutValOnStream ( vecIn, iPos, static_cast<uint32_t> ( iStrUTF8Len ), iNumberOfBytsLen );
+    /*
+        note: the vector is enlarged as required, iPos must be at its end
+    */
+    const int iNumClients = vecChanInfo.Size();
 
-    // actual utf-8 string (n bytes)
-    for ( int j = 0; j < iStrUTF8Len; j++ )
+    for ( int i = 0; i < iNumClients; i++ )
     {
-        // byte-by-byte copying of the utf-8 string data
-        PutValOnStream ( vecIn, iPos, static_cast<uint32_t> ( sStringUTF8[j] ), 1 );
+        // the IP address is zero since #316
+        CChanInfoListEntryLayout::Append ( vecIn,
+                                           vecChanInfo[i].iChanID,
+                                           vecChanInfo[i].eCountry,
+                                           vecChanInfo[i].iInstrument,
+                                           vecChanInfo[i].eSkillLevel,
+                                           0,
+                                           vecChanInfo[i].strName.toUtf8(),
+                                           vecChanInfo[i].strCity.toUtf8() );
     }
-}
 
-void CProtocol::PutCountryOnStream ( CVector<uint8_t>& vecIn, int& iPos, QLocale::Country eCountry )
-{
-    unsigned short iCountryCode = CLocale::QtCountryToWireFormatCountryCode ( eCountry );
-    PutValOnStream ( vecIn, iPos, iCountryCode, 2 );
+    iPos = vecIn.Size();
 }
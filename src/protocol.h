@@ -62,6 +62,10 @@
 #define PROTMESSID_RECORDER_STATE           33 // contains the state of the jam recorder (ERecorderState)
 #define PROTMESSID_REQ_SPLIT_MESS_SUPPORT   34 // request support for split messages
 #define PROTMESSID_SPLIT_MESS_SUPPORTED     35 // split messages are supported
+#define PROTMESSID_REQ_CLIENTS_LIST_DELTA   36 // request support for delta client lists
+#define PROTMESSID_CLIENTS_LIST_DELTA_SUPP  37 // delta client lists are supported
+#define PROTMESSID_CONN_CLIENTS_LIST_DELTA  38 // changes of the connected client list
+#define PROTMESSID_NETW_FRAME_SIZE_FACT     39 // network frame size factor suggested by the server
 
 // message IDs of connection less messages (CLM)
 // DEFINITION -> start at 1000, end at 1999, see IsConnectionLessMessageID
@@ -99,15 +103,276 @@
 #define MAX_NUM_MESS_SPLIT_PARTS   ( MAX_SIZE_BYTES_NETW_BUF / MESS_SPLIT_PART_SIZE_BYTES )
 
 /* Classes ********************************************************************/
+// Fixed size message layout ---------------------------------------------------
+// sum of the field sizes of a message layout (evaluated at compile time)
+constexpr int ProtMesLayoutSize() { return 0; }
+
+template<typename... TRest>
+constexpr int ProtMesLayoutSize ( const int iFirst, const TRest... iRest )
+{
+    return iFirst + ProtMesLayoutSize ( iRest... );
+}
+
+/*
+    Describes a message body which consists of a fixed number of integer fields
+    (little endian, as PutValOnStream/GetValFromStream). The template arguments
+    are the number of bytes of each field. The body size is known at compile
+    time, and encoding as well as size check and decoding are generated from
+    the description so that the Create and Evaluate functions of a message
+    cannot disagree about the layout.
+*/
+template<int... iFieldBytes>
+class CProtMesLayout
+{
+public:
+    static const int iNumFields = sizeof...( iFieldBytes );
+    static const int iSize      = ProtMesLayoutSize ( iFieldBytes... );
+
+    template<typename... TVals>
+    static CVector<uint8_t> Encode ( const TVals... tVals )
+    {
+        static_assert ( sizeof...( TVals ) == iNumFields, "number of values does not match the message layout" );
+
+        const int        iBytes[] = { iFieldBytes... };
+        const uint32_t   iVals[]  = { static_cast<uint32_t> ( tVals )... };
+        CVector<uint8_t> vecData ( iSize );
+        int              iPos = 0;
+
+        for ( int iField = 0; iField < iNumFields; iField++ )
+        {
+            for ( int i = 0; i < iBytes[iField]; i++ )
+            {
+                vecData[iPos++] = static_cast<uint8_t> ( iVals[iField] >> ( i * 8 /* size of byte */ ) );
+            }
+        }
+
+        return vecData;
+    }
+
+    static bool Decode ( const CVector<uint8_t>& vecData, uint32_t ( &iVals )[iNumFields] )
+    {
+        // check size
+        if ( vecData.Size() != iSize )
+        {
+            return true; // return error code
+        }
+
+        const int iBytes[] = { iFieldBytes... };
+        int       iPos     = 0;
+
+        for ( int iField = 0; iField < iNumFields; iField++ )
+        {
+            iVals[iField] = 0;
+
+            for ( int i = 0; i < iBytes[iField]; i++ )
+            {
+                iVals[iField] |= static_cast<uint32_t> ( vecData[iPos++] ) << ( i * 8 /* size of byte */ );
+            }
+        }
+
+        return false; // no error
+    }
+};
+
+// Variable size message layout ------------------------------------------------
+/*
+    Field types of a variable size message layout. Each field type defines the
+    type of the value which is encoded (TEncVal) and decoded (TDecVal), the
+    encoded size of a value and how it is put on and read from the stream. Get
+    checks the remaining size of the stream and returns true on error.
+*/
+template<int iNumBytes>
+class CProtMesInt // integer (little endian)
+{
+public:
+    typedef uint32_t TEncVal;
+    typedef uint32_t TDecVal;
+
+    static int Size ( const uint32_t ) { return iNumBytes; }
+
+    static void Put ( CVector<uint8_t>& vecOut, int& iPos, const uint32_t iVal )
+    {
+        for ( int i = 0; i < iNumBytes; i++ )
+        {
+            vecOut[iPos++] = static_cast<uint8_t> ( iVal >> ( i * 8 /* size of byte */ ) );
+        }
+    }
+
+    static bool Get ( const CVector<uint8_t>& vecIn, int& iPos, uint32_t& iVal )
+    {
+        // check size
+        if ( ( vecIn.Size() - iPos ) < iNumBytes )
+        {
+            return true; // return error code
+        }
+
+        iVal = 0;
+
+        for ( int i = 0; i < iNumBytes; i++ )
+        {
+            iVal |= static_cast<uint32_t> ( vecIn[iPos++] ) << ( i * 8 /* size of byte */ );
+        }
+
+        return false; // no error
+    }
+};
+
+class CProtMesCountry // country (2 bytes, in the wire format country code)
+{
+public:
+    typedef QLocale::Country TEncVal;
+    typedef QLocale::Country TDecVal;
+
+    static int Size ( const QLocale::Country ) { return 2; }
+
+    static void Put ( CVector<uint8_t>& vecOut, int& iPos, const QLocale::Country eCountry )
+    {
+        CProtMesInt<2>::Put ( vecOut, iPos, CLocale::QtCountryToWireFormatCountryCode ( eCountry ) );
+    }
+
+    static bool Get ( const CVector<uint8_t>& vecIn, int& iPos, QLocale::Country& eCountry )
+    {
+        uint32_t iCountryCode;
+
+        if ( CProtMesInt<2>::Get ( vecIn, iPos, iCountryCode ) )
+        {
+            return true; // return error code
+        }
+
+        eCountry = CLocale::WireFormatCountryCodeToQtCountry ( static_cast<unsigned short> ( iCountryCode ) );
+
+        return false; // no error
+    }
+};
+
+template<int iMaxLen, int iLenBytes = 2>
+class CProtMesString // utf-8 string with a length indicator of iLenBytes bytes
+{
+public:
+    typedef QByteArray TEncVal; // utf-8 encoded string
+    typedef QString    TDecVal;
+
+    static int Size ( const QByteArray& strUTF8 ) { return iLenBytes + strUTF8.size(); }
+
+    static void Put ( CVector<uint8_t>& vecOut, int& iPos, const QByteArray& strUTF8 )
+    {
+        CProtMesInt<iLenBytes>::Put ( vecOut, iPos, static_cast<uint32_t> ( strUTF8.size() ) );
+
+        std::copy ( strUTF8.begin(), strUTF8.end(), vecOut.begin() + iPos );
+        iPos += strUTF8.size();
+    }
+
+    static bool Get ( const CVector<uint8_t>& vecIn, int& iPos, QString& strOut )
+    {
+        uint32_t iStrUTF8Len;
+
+        if ( CProtMesInt<iLenBytes>::Get ( vecIn, iPos, iStrUTF8Len ) || ( static_cast<uint32_t> ( vecIn.Size() - iPos ) < iStrUTF8Len ) )
+        {
+            return true; // return error code
+        }
+
+        // convert the utf-8 data directly from the stream in the return string
+        strOut = QString::fromUtf8 ( reinterpret_cast<const char*> ( vecIn.data() + iPos ), static_cast<int> ( iStrUTF8Len ) );
+        iPos += static_cast<int> ( iStrUTF8Len );
+
+        // check length of actual string
+        return strOut.size() > iMaxLen;
+    }
+};
+
+/*
+    Describes a message body (or an entry of a list message body) which consists
+    of the field types above, i.e. of integer and length-prefixed string
+    fields. As for CProtMesLayout, the Create and Evaluate functions share the
+    description. The size is computed from the values which are encoded and
+    each field is checked against the remaining data when it is decoded.
+*/
+template<typename... TFields>
+class CProtMesVarLayout
+{
+public:
+    static int Size ( const typename TFields::TEncVal&... Vals ) { return ProtMesLayoutSize ( TFields::Size ( Vals )... ); }
+
+    // appends an entry at the end of the data vector
+    static void Append ( CVector<uint8_t>& vecData, const typename TFields::TEncVal&... Vals )
+    {
+        int iPos = vecData.Size();
+
+        vecData.Enlarge ( Size ( Vals... ) );
+
+        // the elements of a braced list are evaluated in order
+        const int iUnused[] = { ( TFields::Put ( vecData, iPos, Vals ), 0 )... };
+        Q_UNUSED ( iUnused )
+    }
+
+    static CVector<uint8_t> Encode ( const typename TFields::TEncVal&... Vals )
+    {
+        CVector<uint8_t> vecData ( 0 );
+
+        Append ( vecData, Vals... );
+
+        return vecData;
+    }
+
+    // reads an entry starting at iPos, iPos is incremented
+    static bool Get ( const CVector<uint8_t>& vecData, int& iPos, typename TFields::TDecVal&... Vals )
+    {
+        bool bError = false;
+
+        // the elements of a braced list are evaluated in order, stop at the first error
+        const bool bUnused[] = { ( bError = bError || TFields::Get ( vecData, iPos, Vals ) )... };
+        Q_UNUSED ( bUnused )
+
+        return bError;
+    }
+
+    // reads a complete message body
+    static bool Decode ( const CVector<uint8_t>& vecData, typename TFields::TDecVal&... Vals )
+    {
+        int iPos = 0; // init position pointer
+
+        // all data must be read, the position must then be at the end
+        return Get ( vecData, iPos, Vals... ) || ( iPos != vecData.Size() );
+    }
+};
+
 class CProtocol : public QObject
 {
     Q_OBJECT
 
 public:
+    // Pre-serialized protocol message -----------------------------------------
+    // The server sends the same message (channel list, chat text, etc.) to all
+    // connected clients. To avoid encoding the identical message body for
+    // every client, the body (and, if required, the split message containers)
+    // is generated only once in this object. For connection less messages the
+    // complete frame is generated since the counter is zero per definition.
+    // Only the counter, the header and the CRC are generated per client.
+    class CBroadcastMes
+    {
+    public:
+        CBroadcastMes() : iID ( PROTMESSID_ILLEGAL ), vecData ( 0 ), vecvecSplitParts ( 0 ), vecCLFrame ( 0 ) {}
+        CBroadcastMes ( const int iNID, const CVector<uint8_t>& vecNData );
+
+        int                              GetID() const { return iID; }
+        const CVector<uint8_t>&          GetData() const { return vecData; }
+        const CVector<CVector<uint8_t>>& GetSplitParts() const { return vecvecSplitParts; }
+        const CVector<uint8_t>&          GetCLFrame() const { return vecCLFrame; }
+
+    protected:
+        int                       iID;
+        CVector<uint8_t>          vecData;
+        CVector<CVector<uint8_t>> vecvecSplitParts;
+        CVector<uint8_t>          vecCLFrame;
+    };
+
     CProtocol();
 
     void Reset();
     void SetSplitMessageSupported ( const bool bIn ) { bSplitMessageSupported = bIn; }
+    void SetConClientListDeltaSupported ( const bool bIn ) { bConClientListDeltaSupported = bIn; }
+    bool IsConClientListDeltaSupported() const { return bConClientListDeltaSupported; }
+    int  GetConClientListVersion() const { return iConClientListVersion; }
 
     void CreateJitBufMes ( const int iJitBufSize );
     void CreateReqJitBufMes();
@@ -124,6 +389,8 @@ public:
     void CreateReqNetwTranspPropsMes();
     void CreateReqSplitMessSupportMes();
     void CreateSplitMessSupportedMes();
+    void CreateReqConClientListDeltaSupportMes();
+    void CreateConClientListDeltaSupportedMes();
     void CreateLicenceRequiredMes ( const ELicenceType eLicenceType );
     void CreateOpusSupportedMes();
 
@@ -134,6 +401,7 @@ public:
 
     void CreateVersionAndOSMes();
     void CreateRecorderStateMes ( const ERecorderState eRecorderState );
+    void CreateNetwFrameSizeFactMes ( const int iNetwFrameSizeFact );
 
     void CreateCLPingMes ( const CHostAddress& InetAddr, const int iMs );
     void CreateCLPingWithNumClientsMes ( const CHostAddress& InetAddr, const int iMs, const int iNumClients );
@@ -154,11 +422,23 @@ public:
     void CreateCLChannelLevelListMes ( const CHostAddress& InetAddr, const CVector<uint16_t>& vecLevelList, const int iNumClients );
     void CreateCLRegisterServerResp ( const CHostAddress& InetAddr, const ESvrRegResult eResult );
 
-    static bool ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
-                                    const int               iNumBytesIn,
-                                    CVector<uint8_t>&       vecbyMesBodyData,
-                                    int&                    iRecCounter,
-                                    int&                    iRecID );
+    // messages which are sent to multiple recipients
+    static CBroadcastMes PrepConClientListMes ( const CVector<CChannelInfo>& vecChanInfo );
+    static CBroadcastMes PrepConClientListDeltaMes ( const int                    iBaseVersion,
+                                                     const int                    iNewVersion,
+                                                     const CVector<CChannelInfo>& vecOldChanInfo,
+                                                     const CVector<CChannelInfo>& vecNewChanInfo );
+    static CBroadcastMes PrepChatTextMes ( const QString& strChatText );
+    static CBroadcastMes PrepRecorderStateMes ( const ERecorderState eRecorderState );
+    static CBroadcastMes PrepCLChannelLevelListMes ( const CVector<uint16_t>& vecLevelList, const int iNumClients );
+
+    void SendBroadcastMes ( const CBroadcastMes& BroadcastMes );
+    void SendConClientListDeltaMes ( const CBroadcastMes& DeltaMes, const int iNewVersion );
+    void SendCLBroadcastMes ( const CHostAddress& InetAddr, const CBroadcastMes& BroadcastMes );
+
+    // checks the frame in place (no copy of the data), on success the message
+    // body with iLenBy bytes starts at pbyData + MESS_HEADER_LENGTH_BYTE
+    static bool ParseMessageFrame ( const uint8_t* pbyData, const int iNumBytesIn, int& iRecCounter, int& iRecID, int& iLenBy );
 
     void ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData, const int iRecCounter, const int iRecID );
 
@@ -173,34 +453,132 @@ protected:
     class CSendMessage
     {
     public:
-        CSendMessage() : vecMessage ( 0 ), iID ( PROTMESSID_ILLEGAL ), iCnt ( 0 ) {}
-        CSendMessage ( const CVector<uint8_t>& nMess, const int iNCnt, const int iNID ) : vecMessage ( nMess ), iID ( iNID ), iCnt ( iNCnt ) {}
+        CSendMessage() : vecMessage ( 0 ), iID ( PROTMESSID_ILLEGAL ), iCnt ( 0 ), iOrigID ( PROTMESSID_ILLEGAL ), iSplitCnt ( 0 ) {}
+        CSendMessage ( const CVector<uint8_t>& nMess, const int iNCnt, const int iNID, const int iNOrigID, const int iNSplitCnt ) :
+            vecMessage ( nMess ),
+            iID ( iNID ),
+            iCnt ( iNCnt ),
+            iOrigID ( iNOrigID ),
+            iSplitCnt ( iNSplitCnt )
+        {}
 
         CSendMessage& operator= ( const CSendMessage& NewSendMess )
         {
             vecMessage.Init ( NewSendMess.vecMessage.Size() );
             vecMessage = NewSendMess.vecMessage;
 
-            iID  = NewSendMess.iID;
-            iCnt = NewSendMess.iCnt;
+            iID       = NewSendMess.iID;
+            iCnt      = NewSendMess.iCnt;
+            iOrigID   = NewSendMess.iOrigID;
+            iSplitCnt = NewSendMess.iSplitCnt;
             return *this;
         }
 
         CVector<uint8_t> vecMessage;
         int              iID, iCnt;
-    };
-
-    void EnqueueMessage ( CVector<uint8_t>& vecMessage, const int iCnt, const int iID );
 
-    void GenMessageFrame ( CVector<uint8_t>& vecOut, const int iCnt, const int iID, const CVector<uint8_t>& vecData );
+        // for split messages the ID of the original message and the part number
+        int iOrigID, iSplitCnt;
+    };
 
-    void GenSplitMessageContainer ( CVector<uint8_t>&       vecOut,
-                                    const int               iID,
-                                    const int               iNumParts,
-                                    const int               iSplitCnt,
-                                    const CVector<uint8_t>& vecData,
-                                    const int               iStartIndexInData,
-                                    const int               iLengthOfDataPart );
+    void EnqueueMessage ( CVector<uint8_t>& vecMessage, const int iCnt, const int iID, const int iOrigID, const int iSplitCnt );
+
+    void EnqueueMessageFrame ( const int iID, const CVector<uint8_t>& vecData, const int iOrigID, const int iSplitCnt );
+
+    void RemoveQueuedMessages ( const int iOrigID );
+
+    // layouts of the fixed size message bodies (number of bytes of each field)
+    typedef CProtMesLayout<2>    CAcknMesLayout;                 // ID of acknowledged message
+    typedef CProtMesLayout<2>    CJitBufMesLayout;               // jitter buffer size
+    typedef CProtMesLayout<1>    CClientIDMesLayout;             // channel ID
+    typedef CProtMesLayout<1, 2> CChanGainMesLayout;             // channel ID, gain
+    typedef CProtMesLayout<1, 2> CChanPanMesLayout;              // channel ID, pan
+    typedef CProtMesLayout<1, 1> CMuteStateHasChangedMesLayout;  // channel ID, mute state
+    typedef CProtMesLayout<1>    CLicenceRequiredMesLayout;      // licence type
+    typedef CProtMesLayout<1>    CReqChannelLevelListMesLayout;  // opt in flag
+    typedef CProtMesLayout<1>    CRecorderStateMesLayout;        // recorder state
+    typedef CProtMesLayout<2>    CNetwFrameSizeFactMesLayout;    // network frame size factor
+    typedef CProtMesLayout<4>    CCLPingMesLayout;               // transmit time
+    typedef CProtMesLayout<4, 1> CCLPingWithNumClientsMesLayout; // transmit time, number of clients
+    typedef CProtMesLayout<4, 2> CCLSendEmptyMesMesLayout;       // IP address, port number
+    typedef CProtMesLayout<1>    CCLRegisterServerRespMesLayout; // registration result
+
+    // network frame size, block size factor, number of channels, sample rate, audio coding type, flags, audio coding argument
+    typedef CProtMesLayout<4, 2, 1, 4, 2, 2, 4> CNetwTranspPropsMesLayout;
+
+    // layouts of the variable size message bodies and of the entries of list messages
+    typedef CProtMesVarLayout<CProtMesString<MAX_LEN_CHAT_TEXT_PLUS_HTML>>           CChatTextMesLayout;     // chat text
+    typedef CProtMesVarLayout<CProtMesInt<1>, CProtMesString<MAX_LEN_VERSION_TEXT>> CVersionAndOSMesLayout; // operating system, version
+
+    // country, instrument, skill level, name, city
+    typedef CProtMesVarLayout<CProtMesCountry, CProtMesInt<4>, CProtMesInt<1>, CProtMesString<MAX_LEN_FADER_TAG>, CProtMesString<MAX_LEN_SERVER_CITY>>
+        CChanInfoMesLayout;
+
+    // channel ID, country, instrument, skill level, IP address (zero since #316), name, city
+    typedef CProtMesVarLayout<CProtMesInt<1>,
+                              CProtMesCountry,
+                              CProtMesInt<4>,
+                              CProtMesInt<1>,
+                              CProtMesInt<4>,
+                              CProtMesString<MAX_LEN_FADER_TAG>,
+                              CProtMesString<MAX_LEN_SERVER_CITY>>
+        CChanInfoListEntryLayout;
+
+    // port number, country, maximum number of clients, is permanent flag, name, server internal address, city
+    typedef CProtMesVarLayout<CProtMesInt<2>,
+                              CProtMesCountry,
+                              CProtMesInt<1>,
+                              CProtMesInt<1>,
+                              CProtMesString<MAX_LEN_SERVER_NAME>,
+                              CProtMesString<MAX_LEN_IP_ADDRESS>,
+                              CProtMesString<MAX_LEN_SERVER_CITY>>
+        CCLRegisterServerMesLayout;
+
+    // as CCLRegisterServerMesLayout, followed by operating system, version
+    typedef CProtMesVarLayout<CProtMesInt<2>,
+                              CProtMesCountry,
+                              CProtMesInt<1>,
+                              CProtMesInt<1>,
+                              CProtMesString<MAX_LEN_SERVER_NAME>,
+                              CProtMesString<MAX_LEN_IP_ADDRESS>,
+                              CProtMesString<MAX_LEN_SERVER_CITY>,
+                              CProtMesInt<1>,
+                              CProtMesString<MAX_LEN_VERSION_TEXT>>
+        CCLRegisterServerExMesLayout;
+
+    // IP address, port number, country, maximum number of clients, is permanent flag, name, empty string (formerly topic), city
+    typedef CProtMesVarLayout<CProtMesInt<4>,
+                              CProtMesInt<2>,
+                              CProtMesCountry,
+                              CProtMesInt<1>,
+                              CProtMesInt<1>,
+                              CProtMesString<MAX_LEN_SERVER_NAME>,
+                              CProtMesString<MAX_LEN_IP_ADDRESS>,
+                              CProtMesString<MAX_LEN_SERVER_CITY>>
+        CCLServerListEntryLayout;
+
+    // IP address, port number, name (note that the string length indicator is 1 in this special case)
+    typedef CProtMesVarLayout<CProtMesInt<4>, CProtMesInt<2>, CProtMesString<MAX_LEN_SERVER_NAME, 1>> CCLRedServerListEntryLayout;
+
+    static void GenMessageFrame ( CVector<uint8_t>& vecOut, const int iCnt, const int iID, const CVector<uint8_t>& vecData );
+
+    static void GenSplitMessageContainer ( CVector<uint8_t>&       vecOut,
+                                           const int               iID,
+                                           const int               iNumParts,
+                                           const int               iSplitCnt,
+                                           const CVector<uint8_t>& vecData,
+                                           const int               iStartIndexInData,
+                                           const int               iLengthOfDataPart );
+
+    static void GenSplitMessageParts ( CVector<CVector<uint8_t>>& vecvecOut, const int iID, const CVector<uint8_t>& vecData );
+
+    static void GenConClientListDeltaMesBody ( CVector<uint8_t>&            vecData,
+                                               const int                    iBaseVersion,
+                                               const int                    iNewVersion,
+                                               const CVector<CChannelInfo>& vecOldChanInfo,
+                                               const CVector<CChannelInfo>& vecNewChanInfo );
+    static void GenChatTextMesBody ( CVector<uint8_t>& vecData, const QString& strChatText );
+    static void GenCLChannelLevelListMesBody ( CVector<uint8_t>& vecData, const CVector<uint16_t>& vecLevelList, const int iNumClients );
 
     bool ParseSplitMessageContainer ( const CVector<uint8_t>& vecbyData,
                                       CVector<uint8_t>&       vecbyMesBodyData,
@@ -210,24 +588,48 @@ protected:
                                       int&                    iSplitCnt,
                                       int&                    iCurPartSize );
 
-    void PutValOnStream ( CVector<uint8_t>& vecIn, int& iPos, const uint32_t iVal, const int iNumOfBytes );
+    static void PutValOnStream ( CVector<uint8_t>& vecIn, int& iPos, const uint32_t iVal, const int iNumOfBytes );
 
-    void PutStringUTF8OnStream ( CVector<uint8_t>& vecIn,
-                                 int&              iPos,
-                                 const QByteArray& sStringUTF8,
-                                 const int         iNumberOfBytsLen = 2 ); // default is 2 bytes length indicator
+    static void PutChanInfoListOnStream ( CVector<uint8_t>& vecIn, int& iPos, const CVector<CChannelInfo>& vecChanInfo );
 
-    void PutCountryOnStream ( CVector<uint8_t>& vecIn, int& iPos, QLocale::Country eCountry );
+    static uint32_t GetValFromStream ( const CVector<uint8_t>& vecIn, int& iPos, const int iNumOfBytes )
+    {
+        Q_ASSERT ( vecIn.Size() >= iPos + iNumOfBytes );
 
-    static uint32_t GetValFromStream ( const CVector<uint8_t>& vecIn, int& iPos, const int iNumOfBytes );
+        return GetValFromBuffer ( vecIn.data(), iPos, iNumOfBytes );
+    }
 
-    bool GetStringFromStream ( const CVector<uint8_t>& vecIn,
-                               int&                    iPos,
-                               const int               iMaxStringLen,
-                               QString&                strOut,
-                               const int               iNumberOfBytsLen = 2 ); // default is 2 bytes length indicator
+    static uint32_t GetValFromBuffer ( const uint8_t* pbyIn, int& iPos, const int iNumOfBytes )
+    {
+        /*
+            note: iPos is automatically incremented in this function
+        */
+        // 4 bytes maximum since we return uint32, values are little endian
+        Q_ASSERT ( ( iNumOfBytes > 0 ) && ( iNumOfBytes <= 4 ) );
 
-    static QLocale::Country GetCountryFromStream ( const CVector<uint8_t>& vecIn, int& iPos );
+        const uint8_t* pbyVal = pbyIn + iPos;
+        uint32_t       iRet   = pbyVal[0];
+
+        switch ( iNumOfBytes )
+        {
+        case 4:
+            iRet |= static_cast<uint32_t> ( pbyVal[3] ) << 24;
+            // fall through
+        case 3:
+            iRet |= static_cast<uint32_t> ( pbyVal[2] ) << 16;
+            // fall through
+        case 2:
+            iRet |= static_cast<uint32_t> ( pbyVal[1] ) << 8;
+        }
+
+        iPos += iNumOfBytes;
+
+        return iRet;
+    }
+
+    static bool GetChanInfoListFromStream ( const CVector<uint8_t>& vecIn, int& iPos, CVector<CChannelInfo>& vecChanInfo );
+
+    static bool GetServerInternalAddress ( const QString& sLocHost, QHostAddress& InetAddr );
 
     void SendMessage();
 
@@ -250,9 +652,13 @@ protected:
     bool EvaluateReqNetwTranspPropsMes();
     bool EvaluateReqSplitMessSupportMes();
     bool EvaluateSplitMessSupportedMes();
+    bool EvaluateReqConClientListDeltaSupportMes();
+    bool EvaluateConClientListDeltaSupportedMes();
+    bool EvaluateConClientListDeltaMes ( const CVector<uint8_t>& vecData );
     bool EvaluateLicenceRequiredMes ( const CVector<uint8_t>& vecData );
     bool EvaluateVersionAndOSMes ( const CVector<uint8_t>& vecData );
     bool EvaluateRecorderStateMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateNetwFrameSizeFactMes ( const CVector<uint8_t>& vecData );
 
     bool EvaluateCLPingMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData );
     bool EvaluateCLPingWithNumClientsMes ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecData );
@@ -287,6 +693,13 @@ protected:
     int              iSplitMessageDataIndex;
     bool             bSplitMessageSupported;
 
+    // delta connected client list: on the server side this is the list
+    // version the client currently has, on the client side it is the version
+    // of the locally stored list (zero means "unversioned")
+    bool                  bConClientListDeltaSupported;
+    int                   iConClientListVersion;
+    CVector<CChannelInfo> vecConClientList;
+
 public slots:
     void OnTimerSendMess() { SendMessage(); }
 
@@ -313,9 +726,12 @@ signals:
     void ReqNetTranspProps();
     void ReqSplitMessSupport();
     void SplitMessSupported();
+    void ReqConClientListDeltaSupport();
+    void ConClientListDeltaSupported();
     void LicenceRequired ( ELicenceType eLicenceType );
     void VersionAndOSReceived ( COSUtil::EOpSystemType eOSType, QString strVersion );
     void RecorderStateReceived ( ERecorderState eRecorderState );
+    void NetwFrameSizeFactReceived ( int iNetwFrameSizeFact );
 
     void CLPingReceived ( CHostAddress InetAddr, int iMs );
     void CLPingWithNumClientsReceived ( CHostAddress InetAddr, int iMs, int iNumClients );
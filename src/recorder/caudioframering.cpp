@@ -0,0 +1,363 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "caudioframering.h"
+
+using namespace recorder;
+
+/**
+ * @brief CAudioFrameRing::CAudioFrameRing
+ *
+ * The ring memory is only allocated by Init(), i.e. when recording is actually configured.
+ */
+CAudioFrameRing::CAudioFrameRing() :
+    iMask ( 0 ),
+    iServerFrameSizeSamples ( 0 ),
+    iReadPos ( 0 ),
+    iWritePos ( 0 ),
+    iNumDroppedFrames ( 0 ),
+    iFrameStartPos ( 0 ),
+    iFrameWritePos ( 0 ),
+    bFrameOverflow ( false ),
+    iNumDisconnectPending ( 0 )
+{}
+
+/**
+ * @brief CAudioFrameRing::Init Allocate the ring and reset producer and consumer state
+ * @param iNewSizeBytes size of the ring, must be a power of two
+ * @param iNewServerFrameSizeSamples server frame size in samples per audio channel
+ * @param iNewMaxNumChannels number of server channels
+ */
+void CAudioFrameRing::Init ( const int iNewSizeBytes, const int iNewServerFrameSizeSamples, const int iNewMaxNumChannels )
+{
+    if ( vecbyRing.Size() != iNewSizeBytes )
+    {
+        vecbyRing.Init ( iNewSizeBytes );
+    }
+
+    iMask                   = static_cast<uint32_t> ( iNewSizeBytes - 1 );
+    iServerFrameSizeSamples = iNewServerFrameSizeSamples;
+    iFrameStartPos          = 0;
+    iFrameWritePos          = 0;
+    bFrameOverflow          = false;
+    iNumDisconnectPending   = 0;
+
+    iReadPos.store ( 0, std::memory_order_relaxed );
+    iWritePos.store ( 0, std::memory_order_relaxed );
+    iNumDroppedFrames.store ( 0, std::memory_order_relaxed );
+
+    vecbInfoWritten.Init ( iNewMaxNumChannels, false );
+    vecstrLastName.Init ( iNewMaxNumChannels );
+    vecLastAddress.Init ( iNewMaxNumChannels );
+    vecbDisconnectPending.Init ( iNewMaxNumChannels, false );
+}
+
+/**
+ * @brief CAudioFrameRing::WriteAt Copy data into the ring, wrapping around at the end
+ */
+void CAudioFrameRing::WriteAt ( const uint32_t iPos, const void* pData, const int iLen )
+{
+    const uint32_t iStart    = iPos & iMask;
+    const int      iFirstLen = std::min ( iLen, static_cast<int> ( iMask + 1 - iStart ) );
+
+    memcpy ( &vecbyRing[iStart], pData, iFirstLen );
+    memcpy ( &vecbyRing[0], static_cast<const uint8_t*> ( pData ) + iFirstLen, iLen - iFirstLen );
+}
+
+/**
+ * @brief CAudioFrameRing::ReadAt Copy data out of the ring, wrapping around at the end
+ */
+void CAudioFrameRing::ReadAt ( const uint32_t iPos, void* pData, const int iLen ) const
+{
+    const uint32_t iStart    = iPos & iMask;
+    const int      iFirstLen = std::min ( iLen, static_cast<int> ( iMask + 1 - iStart ) );
+
+    memcpy ( pData, &vecbyRing[iStart], iFirstLen );
+    memcpy ( static_cast<uint8_t*> ( pData ) + iFirstLen, &vecbyRing[0], iLen - iFirstLen );
+}
+
+/**
+ * @brief CAudioFrameRing::Write Append data to the current frame, flags an overflow if the ring is full
+ */
+void CAudioFrameRing::Write ( const void* pData, const int iLen )
+{
+    if ( bFrameOverflow )
+    {
+        return;
+    }
+
+    // the indices are free running, the unsigned difference is the used size
+    if ( iFrameWritePos + static_cast<uint32_t> ( iLen ) - iReadPos.load ( std::memory_order_acquire ) > iMask + 1 )
+    {
+        bFrameOverflow = true;
+        return;
+    }
+
+    WriteAt ( iFrameWritePos, pData, iLen );
+    iFrameWritePos += static_cast<uint32_t> ( iLen );
+}
+
+void CAudioFrameRing::PutEntryHeader ( const EEntryType eType, const int iChID, const int iNumAudChan, const int iPayloadLen )
+{
+    uint8_t vecbyHeader[iEntryHeaderSizeBytes];
+
+    const uint16_t iChID16       = static_cast<uint16_t> ( iChID );
+    const uint32_t iPayloadLen32 = static_cast<uint32_t> ( iPayloadLen );
+
+    vecbyHeader[0] = static_cast<uint8_t> ( eType );
+    vecbyHeader[1] = static_cast<uint8_t> ( iNumAudChan );
+    memcpy ( &vecbyHeader[2], &iChID16, 2 );
+    memcpy ( &vecbyHeader[4], &iPayloadLen32, 4 );
+
+    Write ( vecbyHeader, iEntryHeaderSizeBytes );
+}
+
+void CAudioFrameRing::PutClientInfo ( const int iChID, const QString& strName, const CHostAddress& Address )
+{
+    uint8_t vecbyAddress[iClientInfoFixedSizeBytes] = {};
+
+    if ( Address.InetAddr.protocol() == QAbstractSocket::IPv6Protocol )
+    {
+        const Q_IPV6ADDR IPv6Addr = Address.InetAddr.toIPv6Address();
+
+        vecbyAddress[0] = 1;
+        memcpy ( &vecbyAddress[1], &IPv6Addr, 16 );
+    }
+    else
+    {
+        const quint32 iIPv4Addr = Address.InetAddr.toIPv4Address();
+
+        memcpy ( &vecbyAddress[1], &iIPv4Addr, 4 );
+    }
+
+    memcpy ( &vecbyAddress[17], &Address.iPort, 2 );
+
+    const int iNameLenBytes = strName.size() * static_cast<int> ( sizeof ( QChar ) );
+
+    PutEntryHeader ( ET_CLIENT_INFO, iChID, 0, iClientInfoFixedSizeBytes + iNameLenBytes );
+    Write ( vecbyAddress, iClientInfoFixedSizeBytes );
+    Write ( strName.constData(), iNameLenBytes );
+}
+
+/**
+ * @brief CAudioFrameRing::BeginFrame Start a new frame record, disconnections of dropped frames are written first
+ */
+void CAudioFrameRing::BeginFrame()
+{
+    const uint32_t iFrameLen = 0;
+
+    bFrameOverflow = false;
+    iFrameStartPos = iWritePos.load ( std::memory_order_relaxed );
+    iFrameWritePos = iFrameStartPos;
+
+    // reserve space for the frame length
+    Write ( &iFrameLen, 4 );
+
+    if ( iNumDisconnectPending > 0 )
+    {
+        for ( int iChID = 0; iChID < vecbDisconnectPending.Size(); iChID++ )
+        {
+            if ( vecbDisconnectPending[iChID] )
+            {
+                PutEntryHeader ( ET_DISCONNECTED, iChID, 0, 0 );
+            }
+        }
+    }
+}
+
+/**
+ * @brief CAudioFrameRing::PutAudio Add the audio data of one client to the current frame
+ * @param iChID the client channel id
+ * @param strName the client name
+ * @param Address the client IP and port number
+ * @param iNumAudChan the client number of audio channels
+ * @param vecsData the frame data
+ *
+ * The client name and address are only added if they have changed since they were last sent for this channel.
+ */
+void CAudioFrameRing::PutAudio ( const int               iChID,
+                                 const QString&          strName,
+                                 const CHostAddress&     Address,
+                                 const int               iNumAudChan,
+                                 const CVector<int16_t>& vecsData )
+{
+    if ( !vecbInfoWritten[iChID] || !( vecLastAddress[iChID] == Address ) || vecstrLastName[iChID] != strName )
+    {
+        vecbInfoWritten[iChID] = true;
+        vecLastAddress[iChID]  = Address;
+        vecstrLastName[iChID]  = strName;
+
+        PutClientInfo ( iChID, strName, Address );
+    }
+
+    const int iDataLenBytes = iNumAudChan * iServerFrameSizeSamples * static_cast<int> ( sizeof ( int16_t ) );
+
+    PutEntryHeader ( ET_AUDIO, iChID, iNumAudChan, iDataLenBytes );
+    Write ( vecsData.data(), iDataLenBytes );
+}
+
+/**
+ * @brief CAudioFrameRing::PutDisconnected Add the disconnection of a client to the current frame
+ * @param iChID the client channel id
+ */
+void CAudioFrameRing::PutDisconnected ( const int iChID )
+{
+    vecbInfoWritten[iChID] = false;
+
+    // if the disconnection is still pending from a dropped frame, it was already written by BeginFrame()
+    if ( !vecbDisconnectPending[iChID] )
+    {
+        vecbDisconnectPending[iChID] = true;
+        iNumDisconnectPending++;
+
+        PutEntryHeader ( ET_DISCONNECTED, iChID, 0, 0 );
+    }
+}
+
+/**
+ * @brief CAudioFrameRing::EndFrame Publish the current frame record to the consumer or drop it if the ring is full
+ *
+ * If the frame is dropped, the client info is resent with the next frame and the disconnections stay pending.
+ */
+void CAudioFrameRing::EndFrame()
+{
+    if ( bFrameOverflow )
+    {
+        iNumDroppedFrames.fetch_add ( 1, std::memory_order_relaxed );
+        vecbInfoWritten.Reset ( false );
+        return;
+    }
+
+    const uint32_t iFrameLen = iFrameWritePos - iFrameStartPos - 4;
+
+    if ( iFrameLen == 0 )
+    {
+        // nothing to record in this frame
+        return;
+    }
+
+    WriteAt ( iFrameStartPos, &iFrameLen, 4 );
+
+    if ( iNumDisconnectPending > 0 )
+    {
+        vecbDisconnectPending.Reset ( false );
+        iNumDisconnectPending = 0;
+    }
+
+    iWritePos.store ( iFrameWritePos, std::memory_order_release );
+}
+
+/**
+ * @brief CAudioFrameRing::GetFrame Take the oldest frame record out of the ring
+ * @param vecbyFrame receives the entries of the frame
+ * @return true if a frame was available
+ */
+bool CAudioFrameRing::GetFrame ( CVector<uint8_t>& vecbyFrame )
+{
+    const uint32_t iCurReadPos = iReadPos.load ( std::memory_order_relaxed );
+
+    if ( iCurReadPos == iWritePos.load ( std::memory_order_acquire ) )
+    {
+        return false;
+    }
+
+    uint32_t iFrameLen;
+    ReadAt ( iCurReadPos, &iFrameLen, 4 );
+
+    vecbyFrame.resize ( iFrameLen );
+    ReadAt ( iCurReadPos + 4, vecbyFrame.data(), static_cast<int> ( iFrameLen ) );
+
+    iReadPos.store ( iCurReadPos + 4 + iFrameLen, std::memory_order_release );
+
+    return true;
+}
+
+/**
+ * @brief CAudioFrameRing::GetNextEntry Parse the next entry of a frame record
+ * @param vecbyFrame the frame record as returned by GetFrame()
+ * @param iPos position of the entry, advanced to the next entry
+ * @param Entry receives the entry type, channel and, for client info entries, the name and address
+ * @param vecsData receives the audio data for audio entries
+ * @return false if there are no more entries
+ */
+bool CAudioFrameRing::GetNextEntry ( const CVector<uint8_t>& vecbyFrame, int& iPos, SEntry& Entry, CVector<int16_t>& vecsData )
+{
+    if ( iPos + iEntryHeaderSizeBytes > vecbyFrame.Size() )
+    {
+        return false;
+    }
+
+    uint16_t iChID16;
+    uint32_t iPayloadLen;
+
+    memcpy ( &iChID16, &vecbyFrame[iPos + 2], 2 );
+    memcpy ( &iPayloadLen, &vecbyFrame[iPos + 4], 4 );
+
+    Entry.eType       = static_cast<EEntryType> ( vecbyFrame[iPos] );
+    Entry.iNumAudChan = vecbyFrame[iPos + 1];
+    Entry.iChID       = iChID16;
+
+    const uint8_t* pbyPayload = vecbyFrame.data() + iPos + iEntryHeaderSizeBytes;
+
+    iPos += iEntryHeaderSizeBytes + static_cast<int> ( iPayloadLen );
+
+    switch ( Entry.eType )
+    {
+    case ET_CLIENT_INFO:
+    {
+        quint16 iPort;
+        memcpy ( &iPort, &pbyPayload[17], 2 );
+
+        if ( pbyPayload[0] == 1 )
+        {
+            Q_IPV6ADDR IPv6Addr;
+            memcpy ( &IPv6Addr, &pbyPayload[1], 16 );
+            Entry.Address = CHostAddress ( QHostAddress ( IPv6Addr ), iPort );
+        }
+        else
+        {
+            quint32 iIPv4Addr;
+            memcpy ( &iIPv4Addr, &pbyPayload[1], 4 );
+            Entry.Address = CHostAddress ( QHostAddress ( iIPv4Addr ), iPort );
+        }
+
+        Entry.strName = QString ( reinterpret_cast<const QChar*> ( &pbyPayload[iClientInfoFixedSizeBytes] ),
+                                  ( static_cast<int> ( iPayloadLen ) - iClientInfoFixedSizeBytes ) / static_cast<int> ( sizeof ( QChar ) ) );
+        break;
+    }
+
+    case ET_AUDIO:
+        vecsData.resize ( iPayloadLen / sizeof ( int16_t ) );
+        memcpy ( vecsData.data(), pbyPayload, iPayloadLen );
+        break;
+
+    case ET_DISCONNECTED:
+        break;
+    }
+
+    return true;
+}
@@ -0,0 +1,121 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <QString>
+
+#include "../global.h"
+#include "../util.h"
+
+// size of the ring buffer between server and jam recorder, this holds about
+// half a second of audio for a fully loaded server with 150 stereo clients
+#define AUDIO_FRAME_RING_SIZE_BYTES ( 1 << 24 ) // 16 MB
+
+// interval in which the jam recorder thread collects the frames from the ring
+#define AUDIO_FRAME_RING_POLL_INTERVAL_MS 20
+
+namespace recorder
+{
+
+/**
+ * @brief Single producer, single consumer ring buffer carrying the audio frames from the server frame loop to the jam recorder thread.
+ *
+ * For each server frame one record is written which holds the PCM data of all recorded clients together with a compact channel
+ * map. The client name and address are only written when they change, and client disconnections are written in order with the
+ * audio data. The producer neither allocates memory nor posts a Qt event per frame. If the recorder falls behind and the ring
+ * is full, the frame is dropped.
+ */
+class CAudioFrameRing
+{
+public:
+    enum EEntryType
+    {
+        ET_CLIENT_INFO  = 0, // client name and address changed
+        ET_DISCONNECTED = 1, // client disconnected
+        ET_AUDIO        = 2  // PCM data of one server frame
+    };
+
+    struct SEntry
+    {
+        EEntryType   eType;
+        int          iChID;
+        int          iNumAudChan;
+        QString      strName;
+        CHostAddress Address;
+    };
+
+    CAudioFrameRing();
+
+    // note that Init() must not be called while a producer or consumer is active,
+    // the size must be a power of two
+    void Init ( const int iNewSizeBytes, const int iNewServerFrameSizeSamples, const int iNewMaxNumChannels );
+
+    // producer (server frame loop)
+    void BeginFrame();
+    void PutAudio ( const int iChID, const QString& strName, const CHostAddress& Address, const int iNumAudChan, const CVector<int16_t>& vecsData );
+    void PutDisconnected ( const int iChID );
+    void EndFrame();
+
+    // consumer (jam recorder thread)
+    bool GetFrame ( CVector<uint8_t>& vecbyFrame );
+    int  GetNumDroppedFrames() const { return iNumDroppedFrames.load ( std::memory_order_relaxed ); }
+
+    static bool GetNextEntry ( const CVector<uint8_t>& vecbyFrame, int& iPos, SEntry& Entry, CVector<int16_t>& vecsData );
+
+protected:
+    // each entry starts with a header: type (1 byte), number of audio channels (1 byte),
+    // channel ID (2 bytes) and payload length (4 bytes)
+    static const int iEntryHeaderSizeBytes = 8;
+
+    // client info payload: protocol (1 byte), IPv6 or mapped IPv4 address (16 bytes),
+    // port (2 bytes) and the UTF-16 name
+    static const int iClientInfoFixedSizeBytes = 19;
+
+    void WriteAt ( const uint32_t iPos, const void* pData, const int iLen );
+    void ReadAt ( const uint32_t iPos, void* pData, const int iLen ) const;
+    void Write ( const void* pData, const int iLen );
+    void PutEntryHeader ( const EEntryType eType, const int iChID, const int iNumAudChan, const int iPayloadLen );
+    void PutClientInfo ( const int iChID, const QString& strName, const CHostAddress& Address );
+
+    CVector<uint8_t>      vecbyRing;
+    uint32_t              iMask;
+    int                   iServerFrameSizeSamples;
+    std::atomic<uint32_t> iReadPos;
+    std::atomic<uint32_t> iWritePos;
+    std::atomic<int>      iNumDroppedFrames;
+
+    // producer state
+    uint32_t              iFrameStartPos;
+    uint32_t              iFrameWritePos;
+    bool                  bFrameOverflow;
+    CVector<int>          vecbInfoWritten;
+    CVector<QString>      vecstrLastName;
+    CVector<CHostAddress> vecLastAddress;
+    CVector<int>          vecbDisconnectPending;
+    int                   iNumDisconnectPending;
+};
+
+} // namespace recorder
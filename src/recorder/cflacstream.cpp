@@ -0,0 +1,615 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include <algorithm>
+
+#include "cflacstream.h"
+
+using namespace recorder;
+
+#define FLAC_MAX_FIXED_ORDER     4
+#define FLAC_MAX_PARTITION_ORDER 8
+#define FLAC_MAX_RICE_PARAM      14
+
+/******************************************************************************\
+* Helpers                                                                      *
+\******************************************************************************/
+
+/*
+    FLAC checksums: CRC-8 with the polynomial 0x07 for the frame header and
+    CRC-16 with the polynomial 0x8005 for the whole frame, both with initial
+    value 0 and processed MSB first.
+*/
+class CFlacCRCTables
+{
+public:
+    CFlacCRCTables()
+    {
+        for ( int iByte = 0; iByte < 256; iByte++ )
+        {
+            uint32_t iReg8  = static_cast<uint32_t> ( iByte );
+            uint32_t iReg16 = static_cast<uint32_t> ( iByte ) << 8;
+
+            for ( int i = 0; i < 8; i++ )
+            {
+                iReg8  = ( iReg8 & 0x80 ) ? ( ( iReg8 << 1 ) ^ 0x07 ) : ( iReg8 << 1 );
+                iReg16 = ( iReg16 & 0x8000 ) ? ( ( iReg16 << 1 ) ^ 0x8005 ) : ( iReg16 << 1 );
+            }
+
+            iTab8[iByte]  = static_cast<uint8_t> ( iReg8 );
+            iTab16[iByte] = static_cast<uint16_t> ( iReg16 );
+        }
+    }
+
+    uint8_t  GetCRC8 ( const uint8_t* pbyData, const int iNumBytes ) const
+    {
+        uint8_t iCRC = 0;
+        for ( int i = 0; i < iNumBytes; i++ )
+        {
+            iCRC = iTab8[iCRC ^ pbyData[i]];
+        }
+        return iCRC;
+    }
+
+    uint16_t GetCRC16 ( const uint8_t* pbyData, const int iNumBytes ) const
+    {
+        uint16_t iCRC = 0;
+        for ( int i = 0; i < iNumBytes; i++ )
+        {
+            iCRC = static_cast<uint16_t> ( ( iCRC << 8 ) ^ iTab16[( iCRC >> 8 ) ^ pbyData[i]] );
+        }
+        return iCRC;
+    }
+
+    uint8_t  iTab8[256];
+    uint16_t iTab16[256];
+};
+
+static const CFlacCRCTables FlacCRCTables;
+
+// MSB first bit writer
+class CFlacBitWriter
+{
+public:
+    CFlacBitWriter ( QByteArray& baNOut ) : out ( baNOut ), iBitBuf ( 0 ), iNumBits ( 0 ) {}
+
+    void Put ( const uint32_t iValue, const int iBits )
+    {
+        const uint64_t iMask = ( static_cast<uint64_t> ( 1 ) << iBits ) - 1;
+
+        iBitBuf = ( iBitBuf << iBits ) | ( iValue & iMask );
+        iNumBits += iBits;
+
+        while ( iNumBits >= 8 )
+        {
+            iNumBits -= 8;
+            out.append ( static_cast<char> ( iBitBuf >> iNumBits ) );
+        }
+    }
+
+    void PutUnary ( uint32_t iNumZeros )
+    {
+        for ( ; iNumZeros >= 32; iNumZeros -= 32 )
+        {
+            Put ( 0, 32 );
+        }
+        Put ( 1, iNumZeros + 1 );
+    }
+
+    void PutRice ( const int32_t iValue, const int iParam )
+    {
+        // fold the sign into the least significant bit
+        const uint32_t iFolded = ( static_cast<uint32_t> ( iValue ) << 1 ) ^ static_cast<uint32_t> ( iValue >> 31 );
+
+        PutUnary ( iFolded >> iParam );
+        Put ( iFolded, iParam );
+    }
+
+    void AlignToByte()
+    {
+        if ( iNumBits > 0 )
+        {
+            Put ( 0, 8 - iNumBits );
+        }
+    }
+
+protected:
+    QByteArray& out;
+    uint64_t    iBitBuf;
+    int         iNumBits;
+};
+
+// encoding parameters of one subframe
+class CFlacSubframe
+{
+public:
+    enum EType
+    {
+        ST_CONSTANT,
+        ST_VERBATIM,
+        ST_FIXED
+    };
+
+    CFlacSubframe() : eType ( ST_VERBATIM ), iOrder ( 0 ), iPartitionOrder ( 0 ), iNumBits ( 0 ) {}
+
+    EType   eType;
+    int     iOrder;
+    int     iPartitionOrder;
+    int     iRiceParams[1 << FLAC_MAX_PARTITION_ORDER];
+    int64_t iNumBits;
+};
+
+static void GetFixedResidual ( const int32_t* piData, const int iNumSamples, const int iOrder, int32_t* piResidual )
+{
+    for ( int i = iOrder; i < iNumSamples; i++ )
+    {
+        switch ( iOrder )
+        {
+        case 0:
+            piResidual[i] = piData[i];
+            break;
+        case 1:
+            piResidual[i] = piData[i] - piData[i - 1];
+            break;
+        case 2:
+            piResidual[i] = piData[i] - 2 * piData[i - 1] + piData[i - 2];
+            break;
+        case 3:
+            piResidual[i] = piData[i] - 3 * piData[i - 1] + 3 * piData[i - 2] - piData[i - 3];
+            break;
+        default:
+            piResidual[i] = piData[i] - 4 * piData[i - 1] + 6 * piData[i - 2] - 4 * piData[i - 3] + piData[i - 4];
+            break;
+        }
+    }
+}
+
+// returns the estimated number of bits for a Rice coded partition and the best parameter
+static int64_t GetRicePartitionBits ( const uint64_t iSumFolded, const int iCount, int& iBestParam )
+{
+    int64_t iBestBits = -1;
+
+    for ( int iParam = 0; iParam <= FLAC_MAX_RICE_PARAM; iParam++ )
+    {
+        const int64_t iBits = 4 + static_cast<int64_t> ( iCount ) * ( iParam + 1 ) + static_cast<int64_t> ( iSumFolded >> iParam );
+
+        if ( ( iBestBits < 0 ) || ( iBits < iBestBits ) )
+        {
+            iBestBits  = iBits;
+            iBestParam = iParam;
+        }
+    }
+
+    return iBestBits;
+}
+
+static void AnalyseSubframe ( const int32_t* piData, const int iNumSamples, const int iBps, int32_t* piResidual, CFlacSubframe& Subframe )
+{
+    bool bConstant = true;
+
+    for ( int i = 1; bConstant && ( i < iNumSamples ); i++ )
+    {
+        bConstant = ( piData[i] == piData[0] );
+    }
+
+    if ( bConstant )
+    {
+        Subframe.eType    = CFlacSubframe::ST_CONSTANT;
+        Subframe.iNumBits = 8 + iBps;
+        return;
+    }
+
+    Subframe.eType    = CFlacSubframe::ST_VERBATIM;
+    Subframe.iNumBits = 8 + static_cast<int64_t> ( iNumSamples ) * iBps;
+
+    uint64_t vecSumFolded[1 << FLAC_MAX_PARTITION_ORDER];
+
+    for ( int iOrder = 0; ( iOrder <= FLAC_MAX_FIXED_ORDER ) && ( iOrder < iNumSamples ); iOrder++ )
+    {
+        GetFixedResidual ( piData, iNumSamples, iOrder, piResidual );
+
+        // finest partition order for which the first partition still holds residual samples
+        int iMaxPartitionOrder = 0;
+
+        while ( ( iMaxPartitionOrder < FLAC_MAX_PARTITION_ORDER ) && ( iNumSamples % ( 1 << ( iMaxPartitionOrder + 1 ) ) == 0 ) &&
+                ( ( iNumSamples >> ( iMaxPartitionOrder + 1 ) ) > iOrder ) )
+        {
+            iMaxPartitionOrder++;
+        }
+
+        // sums of the folded residuals for the finest partitions, coarser partitions are merged from these
+        const int iFinestSize = iNumSamples >> iMaxPartitionOrder;
+
+        for ( int iPart = 0; iPart < ( 1 << iMaxPartitionOrder ); iPart++ )
+        {
+            uint64_t iSum = 0;
+
+            for ( int i = std::max ( iPart * iFinestSize, iOrder ); i < ( iPart + 1 ) * iFinestSize; i++ )
+            {
+                iSum += ( static_cast<uint32_t> ( piResidual[i] ) << 1 ) ^ static_cast<uint32_t> ( piResidual[i] >> 31 );
+            }
+
+            vecSumFolded[iPart] = iSum;
+        }
+
+        for ( int iPartitionOrder = iMaxPartitionOrder; iPartitionOrder >= 0; iPartitionOrder-- )
+        {
+            const int iNumParts = 1 << iPartitionOrder;
+            const int iPartSize = iNumSamples >> iPartitionOrder;
+            int       vecParams[1 << FLAC_MAX_PARTITION_ORDER];
+
+            // header: subframe type, warm-up samples, coding method and partition order
+            int64_t iBits = 8 + static_cast<int64_t> ( iOrder ) * iBps + 2 + 4;
+
+            for ( int iPart = 0; iPart < iNumParts; iPart++ )
+            {
+                iBits += GetRicePartitionBits ( vecSumFolded[iPart], iPart == 0 ? iPartSize - iOrder : iPartSize, vecParams[iPart] );
+            }
+
+            if ( iBits < Subframe.iNumBits )
+            {
+                Subframe.eType           = CFlacSubframe::ST_FIXED;
+                Subframe.iOrder          = iOrder;
+                Subframe.iPartitionOrder = iPartitionOrder;
+                Subframe.iNumBits        = iBits;
+                std::copy ( vecParams, vecParams + iNumParts, Subframe.iRiceParams );
+            }
+
+            // merge pairs of partitions for the next coarser partition order
+            for ( int iPart = 0; iPart < iNumParts / 2; iPart++ )
+            {
+                vecSumFolded[iPart] = vecSumFolded[2 * iPart] + vecSumFolded[2 * iPart + 1];
+            }
+        }
+    }
+}
+
+static void WriteSubframe ( CFlacBitWriter&      Writer,
+                            const int32_t*       piData,
+                            const int            iNumSamples,
+                            const int            iBps,
+                            int32_t*             piResidual,
+                            const CFlacSubframe& Subframe )
+{
+    switch ( Subframe.eType )
+    {
+    case CFlacSubframe::ST_CONSTANT:
+        Writer.Put ( 0x00, 8 );
+        Writer.Put ( static_cast<uint32_t> ( piData[0] ), iBps );
+        break;
+
+    case CFlacSubframe::ST_VERBATIM:
+        Writer.Put ( 0x02, 8 );
+        for ( int i = 0; i < iNumSamples; i++ )
+        {
+            Writer.Put ( static_cast<uint32_t> ( piData[i] ), iBps );
+        }
+        break;
+
+    case CFlacSubframe::ST_FIXED:
+    {
+        const int iNumParts = 1 << Subframe.iPartitionOrder;
+        const int iPartSize = iNumSamples >> Subframe.iPartitionOrder;
+
+        Writer.Put ( ( 0x08 | Subframe.iOrder ) << 1, 8 );
+
+        for ( int i = 0; i < Subframe.iOrder; i++ )
+        {
+            Writer.Put ( static_cast<uint32_t> ( piData[i] ), iBps );
+        }
+
+        GetFixedResidual ( piData, iNumSamples, Subframe.iOrder, piResidual );
+
+        // Rice coding with 4 bit parameters
+        Writer.Put ( 0, 2 );
+        Writer.Put ( static_cast<uint32_t> ( Subframe.iPartitionOrder ), 4 );
+
+        for ( int iPart = 0; iPart < iNumParts; iPart++ )
+        {
+            const int iParam = Subframe.iRiceParams[iPart];
+
+            Writer.Put ( static_cast<uint32_t> ( iParam ), 4 );
+
+            for ( int i = std::max ( iPart * iPartSize, Subframe.iOrder ); i < ( iPart + 1 ) * iPartSize; i++ )
+            {
+                Writer.PutRice ( piResidual[i], iParam );
+            }
+        }
+        break;
+    }
+    }
+}
+
+static void PutFrameNumber ( CFlacBitWriter& Writer, const uint32_t iFrameNumber )
+{
+    // UTF-8 like coding of the frame number
+    if ( iFrameNumber < 0x80 )
+    {
+        Writer.Put ( iFrameNumber, 8 );
+        return;
+    }
+
+    int iNumContBytes = 1;
+
+    while ( ( iNumContBytes < 5 ) && ( iFrameNumber >= ( 1u << ( 5 * iNumContBytes + 6 ) ) ) )
+    {
+        iNumContBytes++;
+    }
+
+    const uint32_t iLeadMark = ( 0xFF00 >> ( iNumContBytes + 1 ) ) & 0xFF;
+
+    Writer.Put ( iLeadMark | ( iFrameNumber >> ( 6 * iNumContBytes ) ), 8 );
+
+    for ( int i = iNumContBytes - 1; i >= 0; i-- )
+    {
+        Writer.Put ( 0x80 | ( ( iFrameNumber >> ( 6 * i ) ) & 0x3F ), 8 );
+    }
+}
+
+/******************************************************************************\
+* Implementation of recorder.CFlacStream methods                               *
+\******************************************************************************/
+
+/**
+ * @brief CFlacStream::Headers Create the stream marker and the STREAMINFO block
+ * @param iNumChannels 1 for mono, 2 for stereo
+ * @return the data to be written at the start of the file
+ */
+QByteArray CFlacStream::Headers ( const int iNumChannels )
+{
+    QByteArray     out ( "fLaC" );
+    CFlacBitWriter Writer ( out );
+
+    // last metadata block, type STREAMINFO, 34 bytes
+    Writer.Put ( 1, 1 );
+    Writer.Put ( 0, 7 );
+    Writer.Put ( 34, 24 );
+
+    out.append ( StreamInfo ( iNumChannels, 0 ) );
+
+    return out;
+}
+
+/**
+ * @brief CFlacStream::StreamInfo Create the STREAMINFO block data
+ *
+ * The frame sizes and the MD5 signature are left unknown (zero).
+ */
+QByteArray CFlacStream::StreamInfo ( const int iNumChannels, const int64_t iNumSamples )
+{
+    QByteArray     out;
+    CFlacBitWriter Writer ( out );
+
+    Writer.Put ( RECORDING_FLAC_BLOCK_SIZE_SAMPLES, 16 );
+    Writer.Put ( RECORDING_FLAC_BLOCK_SIZE_SAMPLES, 16 );
+    Writer.Put ( 0, 24 );
+    Writer.Put ( 0, 24 );
+    Writer.Put ( 48000, 20 );
+    Writer.Put ( static_cast<uint32_t> ( iNumChannels - 1 ), 3 );
+    Writer.Put ( 16 - 1, 5 );
+    Writer.Put ( static_cast<uint32_t> ( iNumSamples >> 32 ), 4 );
+    Writer.Put ( static_cast<uint32_t> ( iNumSamples ), 32 );
+
+    out.append ( QByteArray ( 16, 0 ) );
+
+    return out;
+}
+
+/**
+ * @brief CFlacStream::EncodeFrame Encode one block of PCM data into a FLAC frame
+ * @param vecsData Interleaved PCM samples, RECORDING_FLAC_BLOCK_SIZE_SAMPLES per channel except for the last block
+ * @param iNumChannels 1 for mono, 2 for stereo
+ * @param iFrameNumber Sequential number of the block in the stream
+ * @return the encoded frame
+ *
+ * This function has no state, so blocks may be encoded concurrently.
+ */
+QByteArray CFlacStream::EncodeFrame ( const CVector<int16_t> vecsData, const int iNumChannels, const uint32_t iFrameNumber )
+{
+    const int iNumSamples = vecsData.Size() / iNumChannels;
+
+    // de-interleave, for stereo also compute mid and side channels
+    CVector<CVector<int32_t>> vecvecData ( iNumChannels == 2 ? 4 : 1 );
+    CVector<int32_t>          vecResidual ( iNumSamples );
+
+    for ( int iCh = 0; iCh < vecvecData.Size(); iCh++ )
+    {
+        vecvecData[iCh].Init ( iNumSamples );
+    }
+
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        for ( int iCh = 0; iCh < iNumChannels; iCh++ )
+        {
+            vecvecData[iCh][i] = vecsData[i * iNumChannels + iCh];
+        }
+
+        if ( iNumChannels == 2 )
+        {
+            vecvecData[2][i] = ( vecvecData[0][i] + vecvecData[1][i] ) >> 1; // mid
+            vecvecData[3][i] = vecvecData[0][i] - vecvecData[1][i];          // side
+        }
+    }
+
+    // the side channel needs one more bit
+    CFlacSubframe vecSubframes[4];
+    const int     vecBps[4] = { 16, 16, 16, 17 };
+
+    for ( int iCh = 0; iCh < vecvecData.Size(); iCh++ )
+    {
+        AnalyseSubframe ( &vecvecData[iCh][0], iNumSamples, vecBps[iCh], &vecResidual[0], vecSubframes[iCh] );
+    }
+
+    // channel assignment: 0 mono, 1 independent stereo, 10 mid/side stereo
+    int iChanAssignment = iNumChannels - 1;
+    int iFirstSubframe  = 0;
+
+    if ( ( iNumChannels == 2 ) && ( vecSubframes[2].iNumBits + vecSubframes[3].iNumBits < vecSubframes[0].iNumBits + vecSubframes[1].iNumBits ) )
+    {
+        iChanAssignment = 10;
+        iFirstSubframe  = 2;
+    }
+
+    QByteArray out;
+    out.reserve ( iNumSamples * iNumChannels * 2 + 64 );
+
+    CFlacBitWriter Writer ( out );
+
+    // frame header: sync code with fixed block size, block size, 48 kHz, channel assignment, 16 bit
+    const bool bFullBlock = ( iNumSamples == RECORDING_FLAC_BLOCK_SIZE_SAMPLES );
+
+    Writer.Put ( 0xFFF8, 16 );
+    Writer.Put ( bFullBlock ? 0x0C : 0x07, 4 );
+    Writer.Put ( 0x0A, 4 );
+    Writer.Put ( static_cast<uint32_t> ( iChanAssignment ), 4 );
+    Writer.Put ( 0x04, 3 );
+    Writer.Put ( 0, 1 );
+    PutFrameNumber ( Writer, iFrameNumber );
+
+    if ( !bFullBlock )
+    {
+        Writer.Put ( static_cast<uint32_t> ( iNumSamples - 1 ), 16 );
+    }
+
+    Writer.Put ( FlacCRCTables.GetCRC8 ( reinterpret_cast<const uint8_t*> ( out.constData() ), out.size() ), 8 );
+
+    for ( int iCh = iFirstSubframe; iCh < iFirstSubframe + iNumChannels; iCh++ )
+    {
+        WriteSubframe ( Writer, &vecvecData[iCh][0], iNumSamples, vecBps[iCh], &vecResidual[0], vecSubframes[iCh] );
+    }
+
+    Writer.AlignToByte();
+    Writer.Put ( FlacCRCTables.GetCRC16 ( reinterpret_cast<const uint8_t*> ( out.constData() ), out.size() ), 16 );
+
+    return out;
+}
+
+/**
+ * @brief CFlacStream::Finalise Set the total number of samples in the STREAMINFO block
+ * @param pDevice The device the stream was written to, positioned at its end
+ * @param iNumChannels 1 for mono, 2 for stereo
+ * @param iNumSamples Number of samples per channel in the stream
+ */
+void CFlacStream::Finalise ( QIODevice* pDevice, const int iNumChannels, const int64_t iNumSamples )
+{
+    // stream marker and metadata block header precede the STREAMINFO data
+    static const int64_t streamInfoOffset = 8;
+
+    const int64_t currentPos = pDevice->pos();
+
+    pDevice->seek ( streamInfoOffset );
+    pDevice->write ( StreamInfo ( iNumChannels, iNumSamples ) );
+    pDevice->seek ( currentPos );
+}
+
+/**
+ * @brief CFlacStream::GetNumSamples Get the length of a stream which was not finalised
+ * @param pDevice The device holding the stream, opened for reading
+ * @return Number of samples per channel up to the end of the last frame, -1 if no frame header is found
+ *
+ * The length is taken from the frame number and block size of the last frame header. A frame is never larger than
+ * verbatim stereo data, so the last frame header is searched in the tail of the stream only.
+ */
+int64_t CFlacStream::GetNumSamples ( QIODevice* pDevice )
+{
+    static const int64_t iTailSizeBytes = 16 * RECORDING_FLAC_BLOCK_SIZE_SAMPLES;
+
+    const int64_t iTailStart = std::max ( static_cast<int64_t> ( 0 ), pDevice->size() - iTailSizeBytes );
+
+    if ( !pDevice->seek ( iTailStart ) )
+    {
+        return -1;
+    }
+
+    const QByteArray baTail = pDevice->read ( iTailSizeBytes );
+    const uint8_t*   pbyTail = reinterpret_cast<const uint8_t*> ( baTail.constData() );
+    const int        iSize   = baTail.size();
+
+    for ( int iStart = iSize - 2; iStart >= 0; iStart-- )
+    {
+        // sync code, block size code (4096 or 16 bit at the end of the header) with 48 kHz and 16 bit
+        if ( ( pbyTail[iStart] != 0xFF ) || ( pbyTail[iStart + 1] != 0xF8 ) || ( iStart + 4 >= iSize ) )
+        {
+            continue;
+        }
+
+        const bool bFullBlock = ( pbyTail[iStart + 2] == 0xCA );
+
+        if ( ( !bFullBlock && ( pbyTail[iStart + 2] != 0x7A ) ) || ( ( pbyTail[iStart + 3] & 0x0F ) != 0x08 ) )
+        {
+            continue;
+        }
+
+        // UTF-8 like coded frame number
+        int      iPos          = iStart + 4;
+        uint32_t iFrameNumber  = pbyTail[iPos];
+        int      iNumContBytes = 0;
+
+        if ( iFrameNumber >= 0x80 )
+        {
+            while ( ( iNumContBytes < 6 ) && ( ( iFrameNumber << ( iNumContBytes + 1 ) ) & 0x80 ) )
+            {
+                iNumContBytes++;
+            }
+
+            if ( ( iNumContBytes == 0 ) || ( iNumContBytes > 5 ) )
+            {
+                continue;
+            }
+
+            iFrameNumber &= 0x3F >> iNumContBytes;
+        }
+
+        bool bValid = ( iPos + iNumContBytes + ( bFullBlock ? 0 : 2 ) + 1 < iSize );
+
+        for ( int i = 0; bValid && ( i < iNumContBytes ); i++ )
+        {
+            iPos++;
+            bValid       = ( ( pbyTail[iPos] & 0xC0 ) == 0x80 );
+            iFrameNumber = ( iFrameNumber << 6 ) | ( pbyTail[iPos] & 0x3F );
+        }
+
+        if ( !bValid )
+        {
+            continue;
+        }
+
+        iPos++;
+
+        int iNumSamples = RECORDING_FLAC_BLOCK_SIZE_SAMPLES;
+
+        if ( !bFullBlock )
+        {
+            iNumSamples = ( ( pbyTail[iPos] << 8 ) | pbyTail[iPos + 1] ) + 1;
+            iPos += 2;
+        }
+
+        if ( FlacCRCTables.GetCRC8 ( pbyTail + iStart, iPos - iStart ) == pbyTail[iPos] )
+        {
+            return static_cast<int64_t> ( iFrameNumber ) * RECORDING_FLAC_BLOCK_SIZE_SAMPLES + iNumSamples;
+        }
+    }
+
+    return -1;
+}
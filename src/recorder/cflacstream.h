@@ -0,0 +1,60 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include "../util.h"
+
+// number of samples per audio channel in one FLAC frame (streamable subset)
+#define RECORDING_FLAC_BLOCK_SIZE_SAMPLES 4096
+
+namespace recorder
+{
+
+/**
+ * @brief Lossless FLAC encoding of 16 bit PCM at 48 kHz.
+ *
+ * Each block is encoded into an independent FLAC frame using the fixed linear predictors and Rice coded residuals, with
+ * mid/side stereo where it is smaller. As the frames do not depend on each other, blocks can be encoded in parallel and
+ * written in frame number order.
+ */
+class CFlacStream
+{
+public:
+    static QByteArray Headers ( const int iNumChannels );
+
+    static QByteArray EncodeFrame ( const CVector<int16_t> vecsData, const int iNumChannels, const uint32_t iFrameNumber );
+
+    static void Finalise ( QIODevice* pDevice, const int iNumChannels, const int64_t iNumSamples );
+
+    static int64_t GetNumSamples ( QIODevice* pDevice );
+
+private:
+    static QByteArray StreamInfo ( const int iNumChannels, const int64_t iNumSamples );
+};
+
+} // namespace recorder
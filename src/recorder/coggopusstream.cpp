@@ -0,0 +1,380 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "coggopusstream.h"
+
+using namespace recorder;
+
+/*
+    Ogg page checksum: CRC-32 with the polynomial 0x04C11DB7, initial value 0,
+    processed MSB first and without final inversion.
+*/
+class COggCRCTable
+{
+public:
+    COggCRCTable()
+    {
+        for ( int iByte = 0; iByte < 256; iByte++ )
+        {
+            uint32_t iReg = static_cast<uint32_t> ( iByte ) << 24;
+
+            for ( int i = 0; i < 8; i++ )
+            {
+                iReg = ( iReg & 0x80000000 ) ? ( ( iReg << 1 ) ^ 0x04C11DB7 ) : ( iReg << 1 );
+            }
+
+            iTab[iByte] = iReg;
+        }
+    }
+
+    uint32_t iTab[256];
+};
+
+static const COggCRCTable OggCRCTable;
+
+static void PutLittleEndian ( QByteArray& out, const uint64_t iValue, const int iNumBytes )
+{
+    for ( int i = 0; i < iNumBytes; i++ )
+    {
+        out.append ( static_cast<char> ( ( iValue >> ( 8 * i ) ) & 0xFF ) );
+    }
+}
+
+static uint64_t GetLittleEndian ( const uint8_t* pbyData, const int iNumBytes )
+{
+    uint64_t iValue = 0;
+
+    for ( int i = iNumBytes - 1; i >= 0; i-- )
+    {
+        iValue = ( iValue << 8 ) | pbyData[i];
+    }
+
+    return iValue;
+}
+
+/**
+ * @brief COggOpusStream::COggOpusStream
+ * @param iNNumChannels 1 for mono, 2 for stereo
+ * @param iNSerialNo The Ogg bitstream serial number
+ */
+COggOpusStream::COggOpusStream ( const int iNNumChannels, const uint32_t iNSerialNo ) :
+    pEncoder ( nullptr ),
+    iNumChannels ( iNNumChannels ),
+    iSerialNo ( iNSerialNo ),
+    iPreSkip ( 0 ),
+    vecsFrame ( RECORDING_OPUS_FRAME_SIZE_SAMPLES * iNNumChannels ),
+    iFrameFill ( 0 ),
+    iNumSamplesIn ( 0 ),
+    iNumSamplesEncoded ( 0 ),
+    vecbyPacket ( RECORDING_OPUS_MAX_PACKET_SIZE_BYTES ),
+    iPageGranulePos ( 0 ),
+    iPageSeqNo ( 0 )
+{
+    int iOpusError;
+
+    pEncoder = opus_encoder_create ( 48000, iNumChannels, OPUS_APPLICATION_AUDIO, &iOpusError );
+
+    if ( pEncoder == nullptr )
+    {
+        throw CGenErr ( "Could not create the Opus encoder for recording" );
+    }
+
+    opus_int32 iLookAhead = 0;
+
+    opus_encoder_ctl ( pEncoder, OPUS_SET_BITRATE ( RECORDING_OPUS_BITRATE_BPS_PER_CHANNEL * iNumChannels ) );
+    opus_encoder_ctl ( pEncoder, OPUS_SET_COMPLEXITY ( RECORDING_OPUS_COMPLEXITY ) );
+    opus_encoder_ctl ( pEncoder, OPUS_GET_LOOKAHEAD ( &iLookAhead ) );
+
+    // the decoder discards the encoder delay at the start of the stream
+    iPreSkip = iLookAhead;
+}
+
+COggOpusStream::~COggOpusStream()
+{
+    if ( pEncoder != nullptr )
+    {
+        opus_encoder_destroy ( pEncoder );
+    }
+}
+
+/**
+ * @brief COggOpusStream::Headers Emit the identification and comment header pages
+ * @param out Buffer to which the pages are appended
+ */
+void COggOpusStream::Headers ( QByteArray& out )
+{
+    // identification header: version, channel count, pre-skip, input sample rate,
+    // output gain and channel mapping family
+    QByteArray baHeader ( "OpusHead" );
+
+    baHeader.append ( static_cast<char> ( 1 ) );
+    baHeader.append ( static_cast<char> ( iNumChannels ) );
+    PutLittleEndian ( baHeader, static_cast<uint64_t> ( iPreSkip ), 2 );
+    PutLittleEndian ( baHeader, 48000, 4 );
+    PutLittleEndian ( baHeader, 0, 2 );
+    baHeader.append ( static_cast<char> ( 0 ) );
+
+    AddPacket ( reinterpret_cast<const uint8_t*> ( baHeader.constData() ), baHeader.size(), out );
+    PutPage ( 0x02, out ); // beginning of stream
+
+    const QByteArray baVendor ( opus_get_version_string() );
+
+    QByteArray baTags ( "OpusTags" );
+    PutLittleEndian ( baTags, static_cast<uint64_t> ( baVendor.size() ), 4 );
+    baTags.append ( baVendor );
+    PutLittleEndian ( baTags, 0, 4 ); // no user comments
+
+    AddPacket ( reinterpret_cast<const uint8_t*> ( baTags.constData() ), baTags.size(), out );
+    PutPage ( 0x00, out );
+}
+
+/**
+ * @brief COggOpusStream::Encode Encode PCM data
+ * @param psData Interleaved PCM samples
+ * @param iNumSamples Number of samples per audio channel
+ * @param out Buffer to which complete pages are appended
+ */
+void COggOpusStream::Encode ( const int16_t* psData, const int iNumSamples, QByteArray& out )
+{
+    for ( int i = 0; i < iNumSamples; )
+    {
+        const int iNumCopy = std::min ( iNumSamples - i, RECORDING_OPUS_FRAME_SIZE_SAMPLES - iFrameFill );
+
+        std::copy ( psData + i * iNumChannels, psData + ( i + iNumCopy ) * iNumChannels, vecsFrame.begin() + iFrameFill * iNumChannels );
+
+        iFrameFill += iNumCopy;
+        i += iNumCopy;
+
+        if ( iFrameFill == RECORDING_OPUS_FRAME_SIZE_SAMPLES )
+        {
+            EncodeFrame ( out );
+        }
+    }
+
+    iNumSamplesIn += iNumSamples;
+}
+
+/**
+ * @brief COggOpusStream::Finish Encode the remaining data and emit the last page
+ * @param out Buffer to which the pages are appended
+ *
+ * The last frame is padded with silence and the final granule position trims the stream to the samples passed in.
+ */
+void COggOpusStream::Finish ( QByteArray& out )
+{
+    const int64_t iEndGranulePos = iPreSkip + iNumSamplesIn;
+
+    while ( iNumSamplesEncoded < iEndGranulePos )
+    {
+        std::fill ( vecsFrame.begin() + iFrameFill * iNumChannels, vecsFrame.end(), 0 );
+        iFrameFill = RECORDING_OPUS_FRAME_SIZE_SAMPLES;
+
+        if ( EncodeFrame ( out ) )
+        {
+            // the remaining samples are lost
+            break;
+        }
+    }
+
+    // the final granule position may only trim the last packet, it must not point past it
+    iPageGranulePos = std::min ( iEndGranulePos, iNumSamplesEncoded );
+    PutPage ( 0x04, out ); // end of stream
+}
+
+/**
+ * @brief COggOpusStream::GetNumSamples Get the length of a stream which was not finished
+ * @param pDevice The device holding the stream, opened for reading
+ * @return Number of samples per channel up to the end of the last complete page, -1 if no such page is found
+ *
+ * The pre-skip is taken from the identification header and the granule position from the last complete page with a
+ * correct checksum. Pages are small, so the last page is searched in the tail of the stream only.
+ */
+int64_t COggOpusStream::GetNumSamples ( QIODevice* pDevice )
+{
+    static const int     iPageHeaderSizeBytes = 27;
+    static const int64_t iTailSizeBytes       = 16 * RECORDING_OGG_MAX_PAGE_DATA_SIZE_BYTES;
+
+    // identification header in the first page: "OpusHead", version, channel count, pre-skip
+    if ( !pDevice->seek ( 0 ) )
+    {
+        return -1;
+    }
+
+    const QByteArray baHead  = pDevice->read ( iPageHeaderSizeBytes + 1 + 12 );
+    const uint8_t*   pbyHead = reinterpret_cast<const uint8_t*> ( baHead.constData() );
+
+    if ( ( baHead.size() < iPageHeaderSizeBytes + 1 + 12 ) || !baHead.startsWith ( "OggS" ) || ( pbyHead[26] != 1 ) ||
+         ( baHead.mid ( iPageHeaderSizeBytes + 1, 8 ) != "OpusHead" ) )
+    {
+        return -1;
+    }
+
+    const int64_t iPreSkip   = static_cast<int64_t> ( GetLittleEndian ( pbyHead + iPageHeaderSizeBytes + 1 + 10, 2 ) );
+    const int64_t iTailStart = std::max ( static_cast<int64_t> ( 0 ), pDevice->size() - iTailSizeBytes );
+
+    if ( !pDevice->seek ( iTailStart ) )
+    {
+        return -1;
+    }
+
+    const QByteArray baTail  = pDevice->read ( iTailSizeBytes );
+    const uint8_t*   pbyTail = reinterpret_cast<const uint8_t*> ( baTail.constData() );
+    const int        iSize   = baTail.size();
+
+    for ( int iStart = iSize - iPageHeaderSizeBytes; iStart >= 0; iStart-- )
+    {
+        if ( ( memcmp ( pbyTail + iStart, "OggS", 4 ) != 0 ) || ( pbyTail[iStart + 4] != 0 ) ||
+             ( iStart + iPageHeaderSizeBytes + pbyTail[iStart + 26] > iSize ) )
+        {
+            continue;
+        }
+
+        // the page must be complete
+        int iPageSize = iPageHeaderSizeBytes + pbyTail[iStart + 26];
+
+        for ( int i = 0; i < pbyTail[iStart + 26]; i++ )
+        {
+            iPageSize += pbyTail[iStart + iPageHeaderSizeBytes + i];
+        }
+
+        if ( iStart + iPageSize > iSize )
+        {
+            continue;
+        }
+
+        // checksum with the checksum field taken as zero
+        uint32_t iCRC = 0;
+
+        for ( int i = 0; i < iPageSize; i++ )
+        {
+            const uint8_t byData = ( ( i >= 22 ) && ( i < 26 ) ) ? 0 : pbyTail[iStart + i];
+
+            iCRC = ( iCRC << 8 ) ^ OggCRCTable.iTab[( ( iCRC >> 24 ) ^ byData ) & 0xFF];
+        }
+
+        const int64_t iGranulePos = static_cast<int64_t> ( GetLittleEndian ( pbyTail + iStart + 6, 8 ) );
+
+        // a granule position of -1 marks a page on which no packet ends
+        if ( ( iCRC != GetLittleEndian ( pbyTail + iStart + 22, 4 ) ) || ( iGranulePos < 0 ) )
+        {
+            continue;
+        }
+
+        return std::max ( static_cast<int64_t> ( 0 ), iGranulePos - iPreSkip );
+    }
+
+    return -1;
+}
+
+/**
+ * @brief COggOpusStream::EncodeFrame Encode the collected frame and add the packet to the stream
+ * @param out Buffer to which completed pages are appended
+ * @return true if no packet could be written
+ *
+ * The granule position must match the packets in the stream. If the frame cannot be encoded, a frame of silence is written
+ * instead so the recording keeps its timing. Only if that fails too, the frame is dropped without advancing the granule position.
+ */
+bool COggOpusStream::EncodeFrame ( QByteArray& out )
+{
+    opus_int32 iLen = opus_encode ( pEncoder, &vecsFrame[0], RECORDING_OPUS_FRAME_SIZE_SAMPLES, &vecbyPacket[0], vecbyPacket.Size() );
+
+    if ( iLen < 0 )
+    {
+        std::fill ( vecsFrame.begin(), vecsFrame.end(), 0 );
+
+        iLen = opus_encode ( pEncoder, &vecsFrame[0], RECORDING_OPUS_FRAME_SIZE_SAMPLES, &vecbyPacket[0], vecbyPacket.Size() );
+    }
+
+    iFrameFill = 0;
+
+    if ( iLen < 0 )
+    {
+        return true; // return error code
+    }
+
+    iNumSamplesEncoded += RECORDING_OPUS_FRAME_SIZE_SAMPLES;
+
+    AddPacket ( &vecbyPacket[0], iLen, out );
+
+    iPageGranulePos = iNumSamplesEncoded;
+
+    return false;
+}
+
+void COggOpusStream::AddPacket ( const uint8_t* pbyPacket, const int iLen, QByteArray& out )
+{
+    const int iNumSegments = iLen / 255 + 1;
+
+    // start a new page if the packet does not fit into the current one
+    if ( !vecbyPageSegments.empty() &&
+         ( vecbyPageSegments.Size() + iNumSegments > 255 || baPageData.size() + iLen > RECORDING_OGG_MAX_PAGE_DATA_SIZE_BYTES ) )
+    {
+        PutPage ( 0x00, out );
+    }
+
+    // lacing values: 255 for each full segment, the last one is less than 255
+    for ( int i = 0; i < iNumSegments - 1; i++ )
+    {
+        vecbyPageSegments.Add ( 255 );
+    }
+    vecbyPageSegments.Add ( static_cast<uint8_t> ( iLen % 255 ) );
+
+    baPageData.append ( reinterpret_cast<const char*> ( pbyPacket ), iLen );
+}
+
+void COggOpusStream::PutPage ( const uint8_t byFlags, QByteArray& out )
+{
+    const int iPageStart = out.size();
+
+    out.append ( "OggS" );
+    out.append ( static_cast<char> ( 0 ) ); // stream structure version
+    out.append ( static_cast<char> ( byFlags ) );
+    PutLittleEndian ( out, static_cast<uint64_t> ( iPageGranulePos ), 8 );
+    PutLittleEndian ( out, iSerialNo, 4 );
+    PutLittleEndian ( out, iPageSeqNo, 4 );
+    PutLittleEndian ( out, 0, 4 ); // checksum, set below
+    out.append ( static_cast<char> ( vecbyPageSegments.Size() ) );
+    out.append ( reinterpret_cast<const char*> ( vecbyPageSegments.data() ), vecbyPageSegments.Size() );
+    out.append ( baPageData );
+
+    const uint8_t* pbyPage = reinterpret_cast<const uint8_t*> ( out.constData() );
+    uint32_t       iCRC    = 0;
+
+    for ( int i = iPageStart; i < out.size(); i++ )
+    {
+        iCRC = ( iCRC << 8 ) ^ OggCRCTable.iTab[( ( iCRC >> 24 ) ^ pbyPage[i] ) & 0xFF];
+    }
+
+    for ( int i = 0; i < 4; i++ )
+    {
+        out[iPageStart + 22 + i] = static_cast<char> ( ( iCRC >> ( 8 * i ) ) & 0xFF );
+    }
+
+    iPageSeqNo++;
+    vecbyPageSegments.clear();
+    baPageData.truncate ( 0 );
+}
@@ -0,0 +1,88 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#ifdef USE_OPUS_SHARED_LIB
+#    include "opus/opus.h"
+#else
+#    include "opus.h"
+#endif
+
+#include "../util.h"
+
+// Opus encoder settings for recording (RFC 7845 Ogg encapsulation)
+#define RECORDING_OPUS_FRAME_SIZE_SAMPLES      960   // 20 ms at 48 kHz
+#define RECORDING_OPUS_BITRATE_BPS_PER_CHANNEL 64000 // 64 kbps per audio channel
+#define RECORDING_OPUS_COMPLEXITY              5
+#define RECORDING_OPUS_MAX_PACKET_SIZE_BYTES   1500
+#define RECORDING_OGG_MAX_PAGE_DATA_SIZE_BYTES 4096
+
+namespace recorder
+{
+
+/**
+ * @brief Encodes the PCM frames of one client into an Ogg/Opus stream.
+ *
+ * The Ogg pages are appended to a caller supplied buffer so that the file writes can be done in large blocks. The stream
+ * is trimmed to exactly the number of samples passed in, so the recorded length matches the frame count of the client.
+ */
+class COggOpusStream
+{
+public:
+    COggOpusStream ( const int iNNumChannels, const uint32_t iNSerialNo );
+    virtual ~COggOpusStream();
+
+    void Headers ( QByteArray& out );
+    void Encode ( const int16_t* psData, const int iNumSamples, QByteArray& out );
+    void Finish ( QByteArray& out );
+
+    static int64_t GetNumSamples ( QIODevice* pDevice );
+
+private:
+    bool EncodeFrame ( QByteArray& out );
+    void AddPacket ( const uint8_t* pbyPacket, const int iLen, QByteArray& out );
+    void PutPage ( const uint8_t byFlags, QByteArray& out );
+
+    OpusEncoder*   pEncoder;
+    const int      iNumChannels;
+    const uint32_t iSerialNo;
+    int            iPreSkip;
+
+    CVector<int16_t> vecsFrame;
+    int              iFrameFill;
+    int64_t          iNumSamplesIn;
+    int64_t          iNumSamplesEncoded;
+
+    // current Ogg page
+    CVector<uint8_t> vecbyPacket;
+    CVector<uint8_t> vecbyPageSegments;
+    QByteArray       baPageData;
+    int64_t          iPageGranulePos;
+    uint32_t         iPageSeqNo;
+};
+
+} // namespace recorder
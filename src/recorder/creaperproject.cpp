@@ -51,14 +51,15 @@ using namespace recorder;
 // Reaper Project writer -------------------------------------------------------
 
 /**
- * @brief CReaperItem::CReaperItem Construct a Reaper RPP "<ITEM>" for a given RIFF WAVE file
+ * @brief CReaperItem::CReaperItem Construct a Reaper RPP "<ITEM>" for a given RIFF WAVE, Ogg/Opus or FLAC file
  * @param name the item name
- * @param trackItem the details of where the item is in the track, along with the RIFF WAVE filename
+ * @param trackItem the details of where the item is in the track, along with the RIFF WAVE, Ogg/Opus or FLAC filename
  * @param iid the sequential item id
  */
 CReaperItem::CReaperItem ( const QString& name, const STrackItem& trackItem, const qint32& iid, int frameSize )
 {
-    QString wavName = trackItem.fileName; // assume RPP in same location...
+    QString wavName    = trackItem.fileName; // assume RPP in same location...
+    QString sourceType = wavName.endsWith ( ".opus" ) ? "OPUS" : wavName.endsWith ( ".flac" ) ? "FLAC" : "WAVE";
 
     QTextStream sOut ( &out );
 
@@ -72,7 +73,7 @@ CReaperItem::CReaperItem ( const QString& name, const STrackItem& trackItem, con
          << "      NAME " << name << '\n'
          << "      GUID " << guid.toString() << '\n'
 
-         << "      <SOURCE WAVE" << '\n'
+         << "      <SOURCE " << sourceType << '\n'
          << "        FILE " << '"' << wavName << '"' << '\n'
          << "      >" << '\n'
 
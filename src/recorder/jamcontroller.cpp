@@ -26,12 +26,14 @@
 
 using namespace recorder;
 
-CJamController::CJamController ( CServer* pNServer ) :
+CJamController::CJamController ( CServer* pNServer, const ERecordingFormat eNRecordingFormat, const ERecordingMixdown eNRecordingMixdown ) :
     pServer ( pNServer ),
     bRecorderInitialised ( false ),
     bEnableRecording ( false ),
     strRecordingDir ( "" ),
     pthJamRecorder ( nullptr ),
+    eRecordingFormat ( eNRecordingFormat ),
+    eRecordingMixdown ( eNRecordingMixdown ),
     pJamRecorder ( nullptr )
 {}
 
@@ -73,7 +75,7 @@ void CJamController::SetEnableRecording ( bool bNewEnableRecording, bool isRunni
     }
 }
 
-void CJamController::SetRecordingDir ( QString newRecordingDir, int iServerFrameSizeSamples, bool bDisableRecording )
+void CJamController::SetRecordingDir ( QString newRecordingDir, int iServerFrameSizeSamples, int iMaxNumChannels, bool bDisableRecording )
 {
     if ( bRecorderInitialised && pthJamRecorder != nullptr )
     {
@@ -89,7 +91,15 @@ void CJamController::SetRecordingDir ( QString newRecordingDir, int iServerFrame
 
     if ( !newRecordingDir.isEmpty() )
     {
-        pJamRecorder         = new recorder::CJamRecorder ( newRecordingDir, iServerFrameSizeSamples );
+        // the previous recorder thread has finished, so neither side is using the ring
+        AudioFrameRing.Init ( AUDIO_FRAME_RING_SIZE_BYTES, iServerFrameSizeSamples, iMaxNumChannels );
+
+        pJamRecorder         = new recorder::CJamRecorder ( newRecordingDir,
+                                                    iServerFrameSizeSamples,
+                                                    iMaxNumChannels,
+                                                    eRecordingFormat,
+                                                    eRecordingMixdown,
+                                                    &AudioFrameRing );
         strRecorderErrMsg    = pJamRecorder->Init();
         bRecorderInitialised = ( strRecorderErrMsg == QString() );
         bEnableRecording     = bRecorderInitialised && !bDisableRecording;
@@ -116,6 +126,8 @@ void CJamController::SetRecordingDir ( QString newRecordingDir, int iServerFrame
         pJamRecorder->moveToThread ( pthJamRecorder );
 
         // QT signals
+        QObject::connect ( pthJamRecorder, &QThread::started, pJamRecorder, &CJamRecorder::OnStarted );
+
         QObject::connect ( pthJamRecorder, &QThread::finished, pJamRecorder, &QObject::deleteLater );
 
         QObject::connect ( QCoreApplication::instance(),
@@ -138,11 +150,6 @@ void CJamController::SetRecordingDir ( QString newRecordingDir, int iServerFrame
         // from the server to the recorder
         QObject::connect ( this, &CJamController::Stopped, pJamRecorder, &CJamRecorder::OnEnd );
 
-        QObject::connect ( this, &CJamController::ClientDisconnected, pJamRecorder, &CJamRecorder::OnDisconnected );
-
-        qRegisterMetaType<CVector<int16_t>> ( "CVector<int16_t>" );
-        QObject::connect ( this, &CJamController::AudioFrame, pJamRecorder, &CJamRecorder::OnFrame );
-
         // from the recorder to the server
         QObject::connect ( pJamRecorder, &CJamRecorder::RecordingSessionStarted, this, &CJamController::RecordingSessionStarted );
 
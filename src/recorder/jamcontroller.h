@@ -35,7 +35,7 @@ class CJamController : public QObject
 {
     Q_OBJECT
 public:
-    explicit CJamController ( CServer* pNServer );
+    CJamController ( CServer* pNServer, const ERecordingFormat eNRecordingFormat, const ERecordingMixdown eNRecordingMixdown );
 
     bool           GetRecorderInitialised() { return bRecorderInitialised; }
     QString        GetRecorderErrMsg() { return strRecorderErrMsg; }
@@ -43,21 +43,37 @@ public:
     void           RequestNewRecording();
     void           SetEnableRecording ( bool bNewEnableRecording, bool isRunning );
     QString        GetRecordingDir() { return strRecordingDir; }
-    void           SetRecordingDir ( QString newRecordingDir, int iServerFrameSizeSamples, bool bDisableRecording );
+    void           SetRecordingDir ( QString newRecordingDir, int iServerFrameSizeSamples, int iMaxNumChannels, bool bDisableRecording );
     ERecorderState GetRecorderState();
 
+    // audio hand-off from the server frame loop, see CAudioFrameRing
+    void BeginFrame() { AudioFrameRing.BeginFrame(); }
+    void PutAudioFrame ( const int               iChID,
+                         const QString&          strName,
+                         const CHostAddress&     Address,
+                         const int               iNumAudChan,
+                         const CVector<int16_t>& vecsData )
+    {
+        AudioFrameRing.PutAudio ( iChID, strName, Address, iNumAudChan, vecsData );
+    }
+    void PutClientDisconnected ( const int iChID ) { AudioFrameRing.PutDisconnected ( iChID ); }
+    void EndFrame() { AudioFrameRing.EndFrame(); }
+
 private:
     void OnRecordingFailed ( QString error );
 
     CServer* pServer;
 
-    bool     bRecorderInitialised;
-    bool     bEnableRecording;
-    QString  strRecordingDir;
-    QThread* pthJamRecorder;
+    bool              bRecorderInitialised;
+    bool              bEnableRecording;
+    QString           strRecordingDir;
+    QThread*          pthJamRecorder;
+    ERecordingFormat  eRecordingFormat;
+    ERecordingMixdown eRecordingMixdown;
 
-    CJamRecorder* pJamRecorder;
-    QString       strRecorderErrMsg;
+    CJamRecorder*   pJamRecorder;
+    QString         strRecorderErrMsg;
+    CAudioFrameRing AudioFrameRing;
 
 signals:
     void RestartRecorder();
@@ -65,12 +81,6 @@ signals:
     void RecordingSessionStarted ( QString sessionDir );
     void EndRecorderThread();
     void Stopped();
-    void ClientDisconnected ( int iChID );
-    void AudioFrame ( const int              iChID,
-                      const QString          stChName,
-                      const CHostAddress     RecHostAddr,
-                      const int              iNumAudChan,
-                      const CVector<int16_t> vecsData );
 };
 
 } // namespace recorder
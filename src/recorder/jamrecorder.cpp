@@ -37,34 +37,99 @@ using namespace recorder;
  * @param name The client's current name
  * @param address IP and Port
  * @param recordBaseDir Session recording directory
+ * @param eRecordingFormat WAV, Ogg/Opus or FLAC
+ * @param pNIOThreadPool The I/O thread which writes the received frames
+ * @param pNEncoderThreadPool The threads which encode FLAC and Ogg/Opus blocks
+ * @param piNNumIOPendingBytes The number of bytes queued for the I/O thread
+ * @param strFileNameBase File name to use instead of the client name and address, if not empty
  *
- * Creates a file for the raw PCM data and sets up a QDataStream to which to write received frames.
- * The data is stored Little Endian.
+ * Creates a file for the recording and sets up the WAV, Ogg/Opus or FLAC headers. Received frames are collected into blocks
+ * which are written to the file by the I/O thread. WAV data is stored Little Endian.
+ *
+ * The file is opened by the I/O thread, so it is only ever used by that thread. The headers and blocks are queued behind the
+ * open without waiting for it, a file which could not be opened is reported by OpenFailed() and its writes are skipped.
  */
-CJamClient::CJamClient ( const qint64 frame, const int _numChannels, const QString name, const CHostAddress address, const QDir recordBaseDir ) :
+CJamClient::CJamClient ( const qint64           frame,
+                         const int              _numChannels,
+                         const QString          name,
+                         const CHostAddress     address,
+                         const QDir             recordBaseDir,
+                         const ERecordingFormat eRecordingFormat,
+                         CThreadPool*           pNIOThreadPool,
+                         CThreadPool*           pNEncoderThreadPool,
+                         std::atomic<qint64>*   piNNumIOPendingBytes,
+                         const QString          strFileNameBase ) :
     startFrame ( frame ),
     numChannels ( static_cast<uint16_t> ( _numChannels ) ),
     name ( name ),
     address ( address ),
-    out ( nullptr )
+    opusOut ( nullptr ),
+    pIOThreadPool ( pNIOThreadPool ),
+    pIOFile ( nullptr ),
+    piNumIOPendingBytes ( piNNumIOPendingBytes ),
+    pEncoderThreadPool ( pNEncoderThreadPool ),
+    bFlac ( eRecordingFormat == RF_FLAC ),
+    iEncodeBlockSize ( 0 ),
+    iEncodeBlockFill ( 0 ),
+    iFlacFrameNumber ( 0 ),
+    iFlacNumSamples ( 0 )
 {
+    const QString extension = RecordingFormatToFileExtension ( eRecordingFormat );
+
     // At this point we may not have much of a name
-    QString fileName = ClientName() + "-" + QString::number ( frame ) + "-" + QString::number ( _numChannels );
+    QString fileName = ( strFileNameBase.isEmpty() ? ClientName() : strFileNameBase ) + "-" + QString::number ( frame ) + "-" +
+                       QString::number ( _numChannels );
     QString affix    = "";
-    while ( recordBaseDir.exists ( fileName + affix + ".wav" ) )
+    while ( recordBaseDir.exists ( fileName + affix + extension ) )
     {
         affix = affix.length() == 0 ? "_1" : "_" + QString::number ( affix.remove ( 0, 1 ).toInt() + 1 );
     }
-    fileName = fileName + affix + ".wav";
+    fileName = fileName + affix + extension;
+    filename = recordBaseDir.absoluteFilePath ( fileName );
+
+    SJamIOFile*    pIO          = new SJamIOFile ( filename );
+    const bool     bWave        = eRecordingFormat == RF_WAV;
+    const uint16_t iNumChannels = numChannels;
+
+    pIOFile = pIO;
+
+    pIOThreadPool->enqueue ( [pIO, bWave, iNumChannels] {
+        pIO->pFile = new QFile ( pIO->strFilePath );
+        if ( !pIO->pFile->open ( QFile::OpenMode ( QIODevice::OpenModeFlag::ReadWrite ) ) ) // need to allow rewriting headers
+        {
+            qWarning() << "CJamClient: could not write to recording file" << pIO->strFilePath;
+            delete pIO->pFile;
+            pIO->pFile = nullptr;
+            pIO->bOpenFailed.store ( true, std::memory_order_relaxed );
+            return;
+        }
+
+        if ( bWave )
+        {
+            pIO->pOut = new CWaveStream ( pIO->pFile, iNumChannels );
+        }
+    } );
 
-    wavFile = new QFile ( recordBaseDir.absoluteFilePath ( fileName ) );
-    if ( !wavFile->open ( QFile::OpenMode ( QIODevice::OpenModeFlag::ReadWrite ) ) ) // need to allow rewriting headers
+    block.reserve ( JAM_CLIENT_WRITE_BLOCK_SIZE_BYTES );
+
+    // the encoded FLAC frames and Ogg pages are written directly, so the headers have to go first
+    if ( eRecordingFormat == RF_OPUS )
     {
-        throw CGenErr ( "Could not write to WAV file " + wavFile->fileName() );
+        opusOut = new COggOpusStream ( numChannels, static_cast<uint32_t> ( qHash ( fileName ) ) );
+        opusOut->Headers ( block );
+        WriteBlock();
+
+        iEncodeBlockSize = JAM_CLIENT_OPUS_BLOCK_SIZE_SAMPLES;
+    }
+    else if ( bFlac )
+    {
+        block.append ( CFlacStream::Headers ( numChannels ) );
+        WriteBlock();
+
+        iEncodeBlockSize = RECORDING_FLAC_BLOCK_SIZE_SAMPLES;
     }
-    out = new CWaveStream ( wavFile, numChannels );
 
-    filename = wavFile->fileName();
+    vecsEncodeBlock.Init ( iEncodeBlockSize * numChannels );
 }
 
 /**
@@ -76,30 +141,234 @@ void CJamClient::Frame ( const QString _name, const CVector<int16_t>& pcm, int i
 {
     name = _name;
 
-    for ( int i = 0; i < numChannels * iServerFrameSizeSamples; i++ )
+    if ( iEncodeBlockSize > 0 )
+    {
+        for ( int i = 0; i < iServerFrameSizeSamples; )
+        {
+            const int iNumCopy = std::min ( iServerFrameSizeSamples - i, iEncodeBlockSize - iEncodeBlockFill );
+
+            std::copy ( pcm.begin() + i * numChannels,
+                        pcm.begin() + ( i + iNumCopy ) * numChannels,
+                        vecsEncodeBlock.begin() + iEncodeBlockFill * numChannels );
+
+            iEncodeBlockFill += iNumCopy;
+            i += iNumCopy;
+
+            if ( iEncodeBlockFill == iEncodeBlockSize )
+            {
+                EncodeBlock();
+            }
+        }
+    }
+    else
+    {
+        const int iNumSamples = numChannels * iServerFrameSizeSamples;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        block.append ( reinterpret_cast<const char*> ( &pcm[0] ), iNumSamples * static_cast<int> ( sizeof ( int16_t ) ) );
+#else
+        for ( int i = 0; i < iNumSamples; i++ )
+        {
+            const int16_t sample = qToLittleEndian ( pcm[i] );
+            block.append ( reinterpret_cast<const char*> ( &sample ), sizeof ( int16_t ) );
+        }
+#endif
+    }
+
+    if ( block.size() >= JAM_CLIENT_WRITE_BLOCK_SIZE_BYTES )
     {
-        *out << pcm[i];
+        WriteBlock();
     }
 
     frameCount++;
 }
 
+/**
+ * @brief CJamClient::WriteBlock Hand the collected data over to the I/O thread
+ */
+void CJamClient::WriteBlock()
+{
+    if ( block.isEmpty() )
+    {
+        return;
+    }
+
+    SJamIOFile*          pIO          = pIOFile;
+    const QByteArray     data         = block;
+    std::atomic<qint64>* piNumPending = piNumIOPendingBytes;
+
+    piNumPending->fetch_add ( data.size(), std::memory_order_relaxed );
+
+    pIOThreadPool->enqueue ( [pIO, data, piNumPending] {
+        if ( pIO->pFile )
+        {
+            pIO->pFile->write ( data );
+        }
+        piNumPending->fetch_sub ( data.size(), std::memory_order_relaxed );
+    } );
+
+    // the I/O thread holds a reference to the data, so start a new block
+    block = QByteArray();
+    block.reserve ( JAM_CLIENT_WRITE_BLOCK_SIZE_BYTES );
+}
+
+/**
+ * @brief CJamClient::EncodeBlock Hand the collected PCM data over to the encoder threads
+ *
+ * The I/O thread waits for the encoded data, so it is written in order while several blocks are encoded in parallel.
+ */
+void CJamClient::EncodeBlock()
+{
+    if ( iEncodeBlockFill == 0 )
+    {
+        return;
+    }
+
+    // only the last block of a stream may be shorter
+    const CVector<int16_t> vecsData ( vecsEncodeBlock.begin(), vecsEncodeBlock.begin() + iEncodeBlockFill * numChannels );
+
+    if ( bFlac )
+    {
+        EncodeFlacBlock ( vecsData );
+    }
+    else if ( opusOut )
+    {
+        EncodeOpusBlock ( vecsData );
+    }
+
+    iEncodeBlockFill = 0;
+}
+
+/**
+ * @brief CJamClient::EncodeFlacBlock Encode a block as one FLAC frame
+ * @param vecsData the interleaved PCM data of the block
+ */
+void CJamClient::EncodeFlacBlock ( const CVector<int16_t>& vecsData )
+{
+    WriteEncoded ( pEncoderThreadPool->enqueue ( CFlacStream::EncodeFrame, vecsData, numChannels, iFlacFrameNumber ).share(),
+                   vecsData.Size() * static_cast<qint64> ( sizeof ( int16_t ) ) );
+
+    iFlacNumSamples += vecsData.Size() / numChannels;
+    iFlacFrameNumber++;
+}
+
+/**
+ * @brief CJamClient::EncodeOpusBlock Encode a block into Ogg pages
+ * @param vecsData the interleaved PCM data of the block
+ *
+ * The encoder state and the granule position carry over from one block to the next, so each block waits until the
+ * previous block of the stream is encoded. The blocks of the other clients are encoded in the meantime.
+ */
+void CJamClient::EncodeOpusBlock ( const CVector<int16_t>& vecsData )
+{
+    COggOpusStream*                      pStream     = opusOut;
+    const std::shared_future<QByteArray> previous    = opusEncoded;
+    const int                            iNumSamples = vecsData.Size() / numChannels;
+
+    opusEncoded = pEncoderThreadPool
+                      ->enqueue ( [pStream, previous, vecsData, iNumSamples]() -> QByteArray {
+                          if ( previous.valid() )
+                          {
+                              previous.wait();
+                          }
+
+                          QByteArray out;
+                          pStream->Encode ( &vecsData[0], iNumSamples, out );
+                          return out;
+                      } )
+                      .share();
+
+    WriteEncoded ( opusEncoded, vecsData.Size() * static_cast<qint64> ( sizeof ( int16_t ) ) );
+}
+
+/**
+ * @brief CJamClient::WriteEncoded Have the I/O thread write a block once it is encoded
+ * @param encoded the encoded block
+ * @param iNumBytes the size of the PCM data, the size of the encoded data is not known yet
+ */
+void CJamClient::WriteEncoded ( const std::shared_future<QByteArray>& encoded, const qint64 iNumBytes )
+{
+    SJamIOFile*          pIO          = pIOFile;
+    std::atomic<qint64>* piNumPending = piNumIOPendingBytes;
+
+    piNumPending->fetch_add ( iNumBytes, std::memory_order_relaxed );
+
+    pIOThreadPool->enqueue ( [pIO, encoded, piNumPending, iNumBytes] {
+        if ( pIO->pFile )
+        {
+            pIO->pFile->write ( encoded.get() );
+        }
+        piNumPending->fetch_sub ( iNumBytes, std::memory_order_relaxed );
+    } );
+}
+
 /**
  * @brief CJamClient::Disconnect Clean up after a disconnected client
+ *
+ * The remaining data is written and the WAV or FLAC headers are finalised by the I/O thread, after all previous blocks.
+ * For Ogg/Opus the last page is encoded after the remaining data and the stream is deleted by the encoder thread.
  */
 void CJamClient::Disconnect()
 {
-    if ( out )
+    WriteBlock();
+    EncodeBlock();
+
+    if ( opusOut )
     {
-        static_cast<CWaveStream*> ( out )->finalise();
-        delete out;
-        out = nullptr;
+        COggOpusStream*                      pStream  = opusOut;
+        const std::shared_future<QByteArray> previous = opusEncoded;
+
+        opusEncoded = pEncoderThreadPool
+                          ->enqueue ( [pStream, previous]() -> QByteArray {
+                              if ( previous.valid() )
+                              {
+                                  previous.wait();
+                              }
+
+                              QByteArray out;
+                              pStream->Finish ( out );
+                              delete pStream;
+                              return out;
+                          } )
+                          .share();
+
+        WriteEncoded ( opusEncoded, 0 );
+
+        opusEncoded = std::shared_future<QByteArray>();
+        opusOut     = nullptr;
     }
 
-    wavFile->close();
+    const bool bFinaliseFlac = bFlac;
+
+    bFlac = false;
+
+    SJamIOFile*  pIO              = pIOFile;
+    const int    iNumFlacChannels = numChannels;
+    const qint64 iNumFlacSamples  = iFlacNumSamples;
+
+    pIOThreadPool->enqueue ( [pIO, bFinaliseFlac, iNumFlacChannels, iNumFlacSamples] {
+        if ( pIO->pOut )
+        {
+            pIO->pOut->finalise();
+            delete pIO->pOut;
+        }
+
+        if ( pIO->pFile )
+        {
+            if ( bFinaliseFlac )
+            {
+                CFlacStream::Finalise ( pIO->pFile, iNumFlacChannels, iNumFlacSamples );
+            }
+
+            pIO->pFile->close();
 
-    delete wavFile;
-    wavFile = nullptr;
+            delete pIO->pFile;
+        }
+
+        delete pIO;
+    } );
+
+    pIOFile = nullptr;
 }
 
 /**
@@ -147,15 +416,37 @@ QString CJamClient::TranslateChars ( const QString& input ) const
 /**
  * @brief CJamSession::CJamSession Construct a new jam recording session
  * @param recordBaseDir The recording base directory
+ * @param iMaxNumChannels The number of server channels
+ * @param eNRecordingFormat The file format of the client recordings
+ * @param eNRecordingMixdown Whether to record a mix of all clients as well
+ * @param pNIOThreadPool The I/O thread which writes the client recordings
+ * @param pNEncoderThreadPool The threads which encode FLAC client recordings, if used
+ * @param piNNumIOPendingBytes The number of bytes queued for the I/O thread
  *
- * Each session is stored into its own subdirectory of the recording base directory.
+ * Each session is stored into its own subdirectory of the recording base directory. The session index lists the start
+ * and stop of each client track, so the project files can be created without scanning the directory. Like the client
+ * recordings, the session index is opened by the I/O thread without waiting for it, see TakeOpenError().
  */
-CJamSession::CJamSession ( QDir recordBaseDir ) :
+CJamSession::CJamSession ( QDir                    recordBaseDir,
+                           const int               iMaxNumChannels,
+                           const ERecordingFormat  eNRecordingFormat,
+                           const ERecordingMixdown eNRecordingMixdown,
+                           CThreadPool*            pNIOThreadPool,
+                           CThreadPool*            pNEncoderThreadPool,
+                           std::atomic<qint64>*    piNNumIOPendingBytes ) :
     sessionDir ( QDir ( recordBaseDir.absoluteFilePath ( "Jam-" + QDateTime().currentDateTimeUtc().toString ( "yyyyMMdd-HHmmsszzz" ) ) ) ),
     currentFrame ( 0 ),
-    chIdDisconnected ( -1 ),
-    vecptrJamClients ( MAX_NUM_CHANNELS ),
-    jamClientConnections()
+    vecptrJamClients ( iMaxNumChannels ),
+    jamClientConnections(),
+    eRecordingFormat ( eNRecordingFormat ),
+    pIOThreadPool ( pNIOThreadPool ),
+    pEncoderThreadPool ( pNEncoderThreadPool ),
+    piNumIOPendingBytes ( piNNumIOPendingBytes ),
+    pIndexFile ( nullptr ),
+    bOpenErrorTaken ( false ),
+    eRecordingMixdown ( eNRecordingMixdown ),
+    pMixdown ( nullptr ),
+    bMixdownFrame ( false )
 {
     QFileInfo fi ( sessionDir.absolutePath() );
     fi.setCaching ( false );
@@ -173,6 +464,21 @@ CJamSession::CJamSession ( QDir recordBaseDir ) :
         throw CGenErr ( sessionDir.absolutePath() + " is a directory but cannot be written to" );
     }
 
+    SJamIOFile* pIO = new SJamIOFile ( sessionDir.absoluteFilePath ( Name() + JAM_SESSION_INDEX_FILE_SUFFIX ) );
+
+    pIndexFile = pIO;
+
+    pIOThreadPool->enqueue ( [pIO] {
+        pIO->pFile = new QFile ( pIO->strFilePath );
+        if ( !pIO->pFile->open ( QFile::WriteOnly | QFile::Append ) )
+        {
+            qWarning() << "CJamSession: could not write to session index" << pIO->strFilePath;
+            delete pIO->pFile;
+            pIO->pFile = nullptr;
+            pIO->bOpenFailed.store ( true, std::memory_order_relaxed );
+        }
+    } );
+
     // Explicitly set all the pointers to "empty"
     vecptrJamClients.fill ( nullptr );
 }
@@ -191,6 +497,20 @@ CJamSession::~CJamSession()
             jamClientConnections[i] = nullptr;
         }
     }
+
+    // the index may still have records queued for the I/O thread
+    SJamIOFile* pIO = pIndexFile;
+
+    pIOThreadPool->enqueue ( [pIO] {
+        if ( pIO->pFile )
+        {
+            pIO->pFile->close();
+
+            delete pIO->pFile;
+        }
+
+        delete pIO;
+    } );
 }
 
 /**
@@ -199,8 +519,21 @@ CJamSession::~CJamSession()
  */
 void CJamSession::DisconnectClient ( int iChID )
 {
+    if ( vecptrJamClients[iChID] == nullptr )
+    {
+        // no frame of this client was recorded in this session
+        return;
+    }
+
     vecptrJamClients[iChID]->Disconnect();
 
+    WriteIndex ( { { "event", "stop" },
+                   { "file", QFileInfo ( vecptrJamClients[iChID]->FileName() ).fileName() },
+                   { "name", vecptrJamClients[iChID]->ClientName() },
+                   { "channels", vecptrJamClients[iChID]->NumAudioChannels() },
+                   { "frame", vecptrJamClients[iChID]->StartFrame() },
+                   { "length", vecptrJamClients[iChID]->FrameCount() } } );
+
     jamClientConnections.append ( new CJamClientConnection ( vecptrJamClients[iChID]->NumAudioChannels(),
                                                              vecptrJamClients[iChID]->StartFrame(),
                                                              vecptrJamClients[iChID]->FrameCount(),
@@ -209,7 +542,6 @@ void CJamSession::DisconnectClient ( int iChID )
 
     delete vecptrJamClients[iChID];
     vecptrJamClients[iChID] = nullptr;
-    chIdDisconnected        = iChID;
 }
 
 /**
@@ -225,24 +557,17 @@ void CJamSession::DisconnectClient ( int iChID )
  *
  * Also manages the overall current frame counter for the session.
  */
-void CJamSession::Frame ( const int              iChID,
-                          const QString          name,
-                          const CHostAddress     address,
-                          const int              numAudioChannels,
-                          const CVector<int16_t> data,
-                          int                    iServerFrameSizeSamples )
+void CJamSession::Frame ( const int               iChID,
+                          const QString&          name,
+                          const CHostAddress&     address,
+                          const int               numAudioChannels,
+                          const CVector<int16_t>& data,
+                          int                     iServerFrameSizeSamples )
 {
-    if ( iChID == chIdDisconnected )
-    {
-        // DisconnectClient has just been called for this channel - this frame is "too late"
-        chIdDisconnected = -1;
-        return;
-    }
-
     if ( vecptrJamClients[iChID] == nullptr )
     {
         // then we have not seen this client this session
-        vecptrJamClients[iChID] = new CJamClient ( currentFrame, numAudioChannels, name, address, sessionDir );
+        NewClient ( iChID, name, address, numAudioChannels );
     }
     else if ( numAudioChannels != vecptrJamClients[iChID]->NumAudioChannels() ||
               address.InetAddr != vecptrJamClients[iChID]->ClientAddress().InetAddr ||
@@ -255,7 +580,7 @@ void CJamSession::Frame ( const int              iChID,
         }
         else
         {
-            vecptrJamClients[iChID] = new CJamClient ( currentFrame, numAudioChannels, name, address, sessionDir );
+            NewClient ( iChID, name, address, numAudioChannels );
         }
     }
 
@@ -267,6 +592,11 @@ void CJamSession::Frame ( const int              iChID,
 
     vecptrJamClients[iChID]->Frame ( name, data, iServerFrameSizeSamples );
 
+    if ( eRecordingMixdown != RM_NONE )
+    {
+        MixFrame ( numAudioChannels, data, iServerFrameSizeSamples );
+    }
+
     // If _any_ connected client frame steps past currentFrame, increase currentFrame
     if ( vecptrJamClients[iChID]->StartFrame() + vecptrJamClients[iChID]->FrameCount() > currentFrame )
     {
@@ -274,8 +604,178 @@ void CJamSession::Frame ( const int              iChID,
     }
 }
 
+/**
+ * @brief CJamSession::NewClient Start a new track for a client and add it to the session index
+ * @param iChID the client channel id
+ * @param name the client name
+ * @param address the client IP and port number
+ * @param numAudioChannels the client number of audio channels
+ */
+void CJamSession::NewClient ( const int iChID, const QString& name, const CHostAddress& address, const int numAudioChannels )
+{
+    vecptrJamClients[iChID] = new CJamClient ( currentFrame,
+                                               numAudioChannels,
+                                               name,
+                                               address,
+                                               sessionDir,
+                                               eRecordingFormat,
+                                               pIOThreadPool,
+                                               pEncoderThreadPool,
+                                               piNumIOPendingBytes );
+
+    WriteIndex ( { { "event", "start" },
+                   { "file", QFileInfo ( vecptrJamClients[iChID]->FileName() ).fileName() },
+                   { "name", vecptrJamClients[iChID]->ClientName() },
+                   { "channels", numAudioChannels },
+                   { "frame", currentFrame } } );
+}
+
+/**
+ * @brief CJamSession::WriteIndex Append a record to the session index
+ * @param record the track start or stop details
+ *
+ * The record is written by the I/O thread, after the data of the track it refers to.
+ */
+void CJamSession::WriteIndex ( const QJsonObject& record )
+{
+    SJamIOFile*      pIO  = pIndexFile;
+    const QByteArray line = QJsonDocument ( record ).toJson ( QJsonDocument::Compact ) + '\n';
+
+    pIOThreadPool->enqueue ( [pIO, line] {
+        if ( pIO->pFile )
+        {
+            pIO->pFile->write ( line );
+            pIO->pFile->flush();
+        }
+    } );
+}
+
+/**
+ * @brief CJamSession::TakeOpenError Check whether the I/O thread could not open a file of the session
+ * @param strError set to the error, if any
+ * @return true the first time a file of the session could not be opened
+ */
+bool CJamSession::TakeOpenError ( QString& strError )
+{
+    if ( bOpenErrorTaken )
+    {
+        return false;
+    }
+
+    if ( pIndexFile->bOpenFailed.load ( std::memory_order_relaxed ) )
+    {
+        strError = "Could not write to session index " + pIndexFile->strFilePath;
+    }
+    else if ( pMixdown && pMixdown->OpenFailed() )
+    {
+        strError = "Could not write to recording file " + pMixdown->FileName();
+    }
+    else
+    {
+        for ( CJamClient* pJamClient : vecptrJamClients )
+        {
+            if ( pJamClient && pJamClient->OpenFailed() )
+            {
+                strError = "Could not write to recording file " + pJamClient->FileName();
+                break;
+            }
+        }
+    }
+
+    bOpenErrorTaken = !strError.isEmpty();
+
+    return bOpenErrorTaken;
+}
+
+/**
+ * @brief CJamSession::MixFrame Add a client frame to the mixdown of the current server frame
+ * @param numAudioChannels the client number of audio channels
+ * @param data the frame data
+ *
+ * All clients are mixed at unity gain. Mono clients are panned to the centre, stereo clients keep their stereo image
+ * unless all clients are to be panned to the centre.
+ */
+void CJamSession::MixFrame ( const int numAudioChannels, const CVector<int16_t>& data, const int iServerFrameSizeSamples )
+{
+    int i, k;
+
+    if ( !bMixdownFrame )
+    {
+        if ( pMixdown == nullptr )
+        {
+            // the mixdown starts with the first client frame of the session
+            pMixdown = new CJamClient ( currentFrame,
+                                        2,
+                                        "Mixdown",
+                                        CHostAddress(),
+                                        sessionDir,
+                                        eRecordingFormat,
+                                        pIOThreadPool,
+                                        pEncoderThreadPool,
+                                        piNumIOPendingBytes,
+                                        "Mixdown" );
+            vecsMixdown.Init ( 2 * iServerFrameSizeSamples );
+        }
+
+        // init mixdown vector with zeros since we mix all clients on that vector
+        vecfMixdown.Init ( 2 * iServerFrameSizeSamples, 0 );
+        bMixdownFrame = true;
+    }
+
+    if ( numAudioChannels == 1 )
+    {
+        // mono: copy same mono data in both stereo audio channels
+        for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
+        {
+            vecfMixdown[k] += data[i];
+            vecfMixdown[k + 1] += data[i];
+        }
+    }
+    else if ( eRecordingMixdown == RM_CENTRE )
+    {
+        // stereo: apply stereo-to-mono attenuation
+        for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
+        {
+            const float fMono = ( static_cast<float> ( data[k] ) + data[k + 1] ) / 2;
+
+            vecfMixdown[k] += fMono;
+            vecfMixdown[k + 1] += fMono;
+        }
+    }
+    else
+    {
+        // stereo
+        for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
+        {
+            vecfMixdown[i] += data[i];
+        }
+    }
+}
+
+/**
+ * @brief CJamSession::EndFrame Write the mixdown once all client frames of a server frame have been processed
+ */
+void CJamSession::EndFrame ( const int iServerFrameSizeSamples )
+{
+    if ( !bMixdownFrame )
+    {
+        return;
+    }
+
+    // convert from float to short with clipping
+    for ( int i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
+    {
+        vecsMixdown[i] = Float2Short ( vecfMixdown[i] );
+    }
+
+    pMixdown->Frame ( "Mixdown", vecsMixdown, iServerFrameSizeSamples );
+    bMixdownFrame = false;
+}
+
 /**
  * @brief CJamSession::End Clean up any "hanging" clients when the server thinks they all left
+ *
+ * The mixdown is not a track of the session, so it is not added to the client connections.
  */
 void CJamSession::End()
 {
@@ -287,6 +787,13 @@ void CJamSession::End()
             vecptrJamClients[iChID] = nullptr;
         }
     }
+
+    if ( pMixdown != nullptr )
+    {
+        pMixdown->Disconnect();
+        delete pMixdown;
+        pMixdown = nullptr;
+    }
 }
 
 /**
@@ -316,15 +823,24 @@ QMap<QString, QList<STrackItem>> CJamSession::Tracks()
 }
 
 /**
- * @brief CJamSession::TracksFromSessionDir Replica of CJamSession::Tracks but using the directory contents to construct the track item map
+ * @brief CJamSession::TracksFromSessionDir Replica of CJamSession::Tracks but using the session index or directory to construct the track item map
  * @param sessionDirName the directory name to scan
  * @return a map of (latest) client name to connection items
+ *
+ * The directory is only scanned for sessions recorded without an index.
  */
 QMap<QString, QList<STrackItem>> CJamSession::TracksFromSessionDir ( const QString& sessionDirName, int iServerFrameSizeSamples )
 {
     QMap<QString, QList<STrackItem>> tracks;
 
     const QDir sessionDir ( sessionDirName );
+    QFile      indexFile ( sessionDir.absoluteFilePath ( sessionDir.dirName() + JAM_SESSION_INDEX_FILE_SUFFIX ) );
+
+    if ( indexFile.open ( QFile::ReadOnly ) )
+    {
+        return TracksFromSessionIndex ( sessionDir, indexFile, iServerFrameSizeSamples );
+    }
+
     foreach ( auto entry, sessionDir.entryList ( { "*.pcm" } ) )
     {
 
@@ -352,6 +868,82 @@ QMap<QString, QList<STrackItem>> CJamSession::TracksFromSessionDir ( const QStri
     return tracks;
 }
 
+/**
+ * @brief CJamSession::TracksFromSessionIndex Construct the track item map from the session index
+ * @param sessionDir the session directory
+ * @param indexFile the opened session index
+ * @return a map of (latest) client name to connection items
+ *
+ * Tracks that were never stopped, e.g. when the server did not shut down cleanly, only have their start recorded. For
+ * those the length is taken from the WAV file size or from the last FLAC frame or Ogg page in the file.
+ */
+QMap<QString, QList<STrackItem>> CJamSession::TracksFromSessionIndex ( const QDir& sessionDir, QFile& indexFile, int iServerFrameSizeSamples )
+{
+    QMap<QString, QList<STrackItem>> tracks;
+    QMap<QString, QJsonObject>       started;
+
+    while ( !indexFile.atEnd() )
+    {
+        const QJsonObject record = QJsonDocument::fromJson ( indexFile.readLine() ).object();
+        const QString     file   = record["file"].toString();
+
+        if ( record["event"].toString() == "start" )
+        {
+            started.insert ( file, record );
+        }
+        else if ( record["event"].toString() == "stop" )
+        {
+            started.remove ( file );
+
+            tracks[record["name"].toString()].append ( STrackItem ( record["channels"].toInt(),
+                                                                    static_cast<qint64> ( record["frame"].toDouble() ),
+                                                                    static_cast<qint64> ( record["length"].toDouble() ),
+                                                                    sessionDir.absoluteFilePath ( file ) ) );
+        }
+    }
+
+    foreach ( auto record, started )
+    {
+        const QString    file = record["file"].toString();
+        const QFileInfo  fiEntry ( sessionDir.absoluteFilePath ( file ) );
+        const int        numChannels = record["channels"].toInt();
+        ERecordingFormat eFormat;
+        QFile            trackFile ( fiEntry.absoluteFilePath() );
+        qint64           numSamples = -1;
+
+        if ( !GetRecordingFormatFromFileName ( file, eFormat ) && ( numChannels > 0 ) && trackFile.open ( QFile::ReadOnly ) )
+        {
+            switch ( eFormat )
+            {
+            case RF_WAV:
+                numSamples = ( trackFile.size() - 44 ) / ( numChannels * static_cast<int> ( sizeof ( int16_t ) ) );
+                break;
+
+            case RF_OPUS:
+                numSamples = COggOpusStream::GetNumSamples ( &trackFile );
+                break;
+
+            case RF_FLAC:
+                numSamples = CFlacStream::GetNumSamples ( &trackFile );
+                break;
+            }
+        }
+
+        if ( numSamples < 0 )
+        {
+            qWarning() << "CJamSession::TracksFromSessionIndex():" << file << "was not stopped, length unknown.";
+            continue;
+        }
+
+        const qint64 length = numSamples / iServerFrameSizeSamples;
+
+        tracks[record["name"].toString()].append (
+            STrackItem ( numChannels, static_cast<qint64> ( record["frame"].toDouble() ), length, fiEntry.absoluteFilePath() ) );
+    }
+
+    return tracks;
+}
+
 /* ********************************************************************************************************
  * CJamRecorder
  * ********************************************************************************************************/
@@ -395,16 +987,22 @@ QString CJamRecorder::Init()
 void CJamRecorder::Start()
 {
     // Ensure any previous cleaning up has been done.
-    OnEnd();
+    End();
 
     QString error;
 
     {
-        // needs to be after OnEnd() as that also locks
+        // needs to be after End() as that also locks
         QMutexLocker mutexLocker ( &ChIdMutex );
         try
         {
-            currentSession = new CJamSession ( recordBaseDir );
+            currentSession = new CJamSession ( recordBaseDir,
+                                               iMaxNumChannels,
+                                               eRecordingFormat,
+                                               eRecordingMixdown,
+                                               &IOThreadPool,
+                                               pEncoderThreadPool.get(),
+                                               &iNumIOPendingBytes );
             isRecording    = true;
         }
         catch ( const CGenErr& err )
@@ -424,9 +1022,9 @@ void CJamRecorder::Start()
 }
 
 /**
- * @brief CJamRecorder::OnEnd Finalise the recording and write the Reaper RPP file
+ * @brief CJamRecorder::End Finalise the recording and write the Reaper RPP file
  */
-void CJamRecorder::OnEnd()
+void CJamRecorder::End()
 {
     QMutexLocker mutexLocker ( &ChIdMutex );
     if ( isRecording )
@@ -434,6 +1032,9 @@ void CJamRecorder::OnEnd()
         isRecording = false;
         currentSession->End();
 
+        // wait until the I/O thread has finalised all files of the session
+        IOThreadPool.enqueue ( [] {} ).wait();
+
         ReaperProjectFromCurrentSession();
         AudacityLofFromCurrentSession();
 
@@ -442,11 +1043,35 @@ void CJamRecorder::OnEnd()
     }
 }
 
+/**
+ * @brief CJamRecorder::OnStarted Start polling the audio frame ring in the recorder thread
+ */
+void CJamRecorder::OnStarted()
+{
+    CTraceEvents::SetThreadName ( "recorder" );
+
+    TimerProcessFrames.start ( AUDIO_FRAME_RING_POLL_INTERVAL_MS );
+}
+
+/**
+ * @brief CJamRecorder::OnEnd Write out the frames still queued by the server and finalise the recording
+ *
+ * The queued frames belong to the ending session, so they never start a new one.
+ */
+void CJamRecorder::OnEnd()
+{
+    ProcessFrames ( false );
+    End();
+}
+
 /**
  * @brief CJamRecorder::OnTriggerSession End one session and start a new one
  */
 void CJamRecorder::OnTriggerSession()
 {
+    // the frames queued so far belong to the current session
+    ProcessFrames ( true );
+
     // This should magically get everything right...
     if ( isRecording )
     {
@@ -503,11 +1128,12 @@ void CJamRecorder::AudacityLofFromCurrentSession()
         QFile outf ( audacityLofFileName );
         if ( outf.open ( QFile::WriteOnly ) )
         {
-            QTextStream sOut ( &outf );
+            QTextStream                            sOut ( &outf );
+            const QMap<QString, QList<STrackItem>> tracks = currentSession->Tracks();
 
-            foreach ( auto trackName, currentSession->Tracks().keys() )
+            foreach ( auto trackName, tracks.keys() )
             {
-                foreach ( auto item, currentSession->Tracks()[trackName] )
+                foreach ( auto item, tracks[trackName] )
                 {
                     QFileInfo fi ( item.fileName );
                     sOut << "file " << '"' << fi.fileName() << '"';
@@ -562,19 +1188,102 @@ void CJamRecorder::SessionDirToReaper ( QString& strSessionDirName, int serverFr
 }
 
 /**
- * @brief CJamRecorder::OnDisconnected Handle disconnection of a client
+ * @brief CJamRecorder::ProcessFrames Take all frames queued by the server out of the audio frame ring and record them
+ * @param bAllowStart whether an audio frame may start a new session
+ *
+ * The client name and address are only sent by the server when they change, so the latest values are kept per channel.
+ *
+ * If the I/O thread cannot keep up, the audio of whole server frames is dropped so that all tracks stay aligned. The client
+ * info and disconnections of a dropped frame are still processed.
+ */
+void CJamRecorder::ProcessFrames ( const bool bAllowStart )
+{
+    CAudioFrameRing::SEntry Entry;
+    CTraceScope             TraceScope ( "recorder/process frames" );
+    int                     iNumIODroppedFrames = 0;
+
+    while ( pAudioFrameRing->GetFrame ( vecbyFrame ) )
+    {
+        const bool bDropAudio = iNumIOPendingBytes.load ( std::memory_order_relaxed ) > JAM_RECORDER_MAX_IO_PENDING_BYTES;
+        int        iPos       = 0;
+
+        if ( bDropAudio )
+        {
+            iNumIODroppedFrames++;
+        }
+
+        while ( CAudioFrameRing::GetNextEntry ( vecbyFrame, iPos, Entry, vecsData ) )
+        {
+            switch ( Entry.eType )
+            {
+            case CAudioFrameRing::ET_CLIENT_INFO:
+                vecstrChanName[Entry.iChID] = Entry.strName;
+                vecChanAddress[Entry.iChID] = Entry.Address;
+                break;
+
+            case CAudioFrameRing::ET_DISCONNECTED:
+                Disconnected ( Entry.iChID );
+                break;
+
+            case CAudioFrameRing::ET_AUDIO:
+                if ( bDropAudio )
+                {
+                    break;
+                }
+
+                Frame ( Entry.iChID, vecstrChanName[Entry.iChID], vecChanAddress[Entry.iChID], Entry.iNumAudChan, vecsData, bAllowStart );
+                break;
+            }
+        }
+
+        if ( !bDropAudio )
+        {
+            EndFrame();
+        }
+    }
+
+    const int iNewNumDroppedFrames = pAudioFrameRing->GetNumDroppedFrames();
+
+    if ( iNewNumDroppedFrames != iNumDroppedFrames )
+    {
+        qWarning() << "CJamRecorder::ProcessFrames:" << iNewNumDroppedFrames - iNumDroppedFrames << "frames dropped, recorder cannot keep up";
+        iNumDroppedFrames = iNewNumDroppedFrames;
+    }
+
+    if ( iNumIODroppedFrames > 0 )
+    {
+        qWarning() << "CJamRecorder::ProcessFrames:" << iNumIODroppedFrames << "frames dropped, recording disk cannot keep up";
+    }
+
+    // the files are opened by the I/O thread, so an error shows up after the frames were queued
+    QString error;
+    bool    bOpenFailed = false;
+
+    {
+        QMutexLocker mutexLocker ( &ChIdMutex );
+        bOpenFailed = isRecording && currentSession->TakeOpenError ( error );
+    }
+
+    if ( bOpenFailed )
+    {
+        emit RecordingFailed ( error );
+    }
+}
+
+/**
+ * @brief CJamRecorder::Disconnected Handle disconnection of a client
  * @param iChID the client channel id
  */
-void CJamRecorder::OnDisconnected ( int iChID )
+void CJamRecorder::Disconnected ( const int iChID )
 {
     QMutexLocker mutexLocker ( &ChIdMutex );
     if ( !isRecording )
     {
-        qWarning() << "CJamRecorder::OnDisconnected: channel" << iChID << "disconnected but not recording";
+        qWarning() << "CJamRecorder::Disconnected: channel" << iChID << "disconnected but not recording";
     }
     if ( currentSession == nullptr )
     {
-        qWarning() << "CJamRecorder::OnDisconnected: channel" << iChID << "disconnected but no currentSession";
+        qWarning() << "CJamRecorder::Disconnected: channel" << iChID << "disconnected but no currentSession";
         return;
     }
 
@@ -582,23 +1291,25 @@ void CJamRecorder::OnDisconnected ( int iChID )
 }
 
 /**
- * @brief CJamRecorder::OnFrame Handle a frame emitted for a client by the server
+ * @brief CJamRecorder::Frame Handle a frame queued for a client by the server
  * @param iChID the client channel id
  * @param name the client name
  * @param address the client IP and port number
  * @param numAudioChannels the client number of audio channels
  * @param data the frame data
+ * @param bAllowStart whether the frame may start a new session
  *
  * Ensures recording has started.
  */
-void CJamRecorder::OnFrame ( const int              iChID,
-                             const QString          name,
-                             const CHostAddress     address,
-                             const int              numAudioChannels,
-                             const CVector<int16_t> data )
+void CJamRecorder::Frame ( const int               iChID,
+                           const QString&          name,
+                           const CHostAddress&     address,
+                           const int               numAudioChannels,
+                           const CVector<int16_t>& data,
+                           const bool              bAllowStart )
 {
     // Make sure we are ready
-    if ( !isRecording )
+    if ( !isRecording && bAllowStart )
     {
         Start();
     }
@@ -615,3 +1326,15 @@ void CJamRecorder::OnFrame ( const int              iChID,
         currentSession->Frame ( iChID, name, address, numAudioChannels, data, iServerFrameSizeSamples );
     }
 }
+
+/**
+ * @brief CJamRecorder::EndFrame Complete the recording of a server frame once all its client frames are processed
+ */
+void CJamRecorder::EndFrame()
+{
+    QMutexLocker mutexLocker ( &ChIdMutex );
+    if ( isRecording )
+    {
+        currentSession->EndFrame ( iServerFrameSizeSamples );
+    }
+}
@@ -24,20 +24,59 @@
 
 #pragma once
 
+#include <atomic>
 #include <QDir>
 #include <QFile>
 #include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMutex>
+#include <QTimer>
+#include <QtEndian>
 
 #include "../util.h"
 #include "../channel.h"
+#include "../threadpool.h"
 
+#include "caudioframering.h"
+#include "cflacstream.h"
+#include "coggopusstream.h"
 #include "creaperproject.h"
 #include "cwavestream.h"
 
+// size of the blocks in which the PCM data of a client is written to disk
+#define JAM_CLIENT_WRITE_BLOCK_SIZE_BYTES ( 1 << 18 ) // 256 KB
+
+// maximum number of FLAC and Ogg/Opus encoder threads, the encoding must not
+// compete with the server for all cores
+#define JAM_RECORDER_MAX_NUM_ENCODER_THREADS 2u
+
+// size of the blocks in which the PCM data of a client is handed over to an
+// Ogg/Opus encoder thread
+#define JAM_CLIENT_OPUS_BLOCK_SIZE_SAMPLES ( 24 * RECORDING_OPUS_FRAME_SIZE_SAMPLES ) // 480 ms
+
+// maximum number of bytes queued for the I/O thread, if the disk cannot keep
+// up, whole server frames are dropped instead of growing the queue
+#define JAM_RECORDER_MAX_IO_PENDING_BYTES ( 1 << 26 ) // 64 MB
+
+// the session index holds one JSON object per line for each track start and stop
+#define JAM_SESSION_INDEX_FILE_SUFFIX "-index.jsonl"
+
 namespace recorder
 {
 
+// A file of the recording which is opened, written and closed by the I/O thread only. The recorder thread keeps the
+// pointer to queue the writes and learns about a file which could not be opened from the flag.
+struct SJamIOFile
+{
+    SJamIOFile ( const QString& strNFilePath ) : strFilePath ( strNFilePath ), pFile ( nullptr ), pOut ( nullptr ), bOpenFailed ( false ) {}
+
+    const QString     strFilePath;
+    QFile*            pFile;
+    CWaveStream*      pOut;
+    std::atomic<bool> bOpenFailed;
+};
+
 class CJamClientConnection : public QObject
 {
     Q_OBJECT
@@ -74,7 +113,16 @@ class CJamClient : public QObject
     Q_OBJECT
 
 public:
-    CJamClient ( const qint64 frame, const int numChannels, const QString name, const CHostAddress address, const QDir recordBaseDir );
+    CJamClient ( const qint64           frame,
+                 const int              numChannels,
+                 const QString          name,
+                 const CHostAddress     address,
+                 const QDir             recordBaseDir,
+                 const ERecordingFormat eRecordingFormat,
+                 CThreadPool*           pNIOThreadPool,
+                 CThreadPool*           pNEncoderThreadPool,
+                 std::atomic<qint64>*   piNNumIOPendingBytes,
+                 const QString          strFileNameBase = QString() );
 
     void Frame ( const QString name, const CVector<int16_t>& pcm, int iServerFrameSizeSamples );
 
@@ -94,18 +142,41 @@ public:
 
     QString FileName() { return filename; }
 
+    bool OpenFailed() const { return pIOFile && pIOFile->bOpenFailed.load ( std::memory_order_relaxed ); }
+
 private:
     QString TranslateChars ( const QString& input ) const;
+    void    WriteBlock();
+    void    EncodeBlock();
+    void    EncodeFlacBlock ( const CVector<int16_t>& vecsData );
+    void    EncodeOpusBlock ( const CVector<int16_t>& vecsData );
+    void    WriteEncoded ( const std::shared_future<QByteArray>& encoded, const qint64 iNumBytes );
 
     const qint64       startFrame;
     const uint16_t     numChannels;
     QString            name;
     const CHostAddress address;
 
-    QString      filename;
-    QFile*       wavFile;
-    QDataStream* out;
-    qint64       frameCount = 0;
+    QString         filename;
+    COggOpusStream* opusOut;
+    qint64          frameCount = 0;
+    QByteArray      block;
+    CThreadPool*    pIOThreadPool;
+
+    // the file is deleted by the I/O thread after it is closed
+    SJamIOFile*          pIOFile;
+    std::atomic<qint64>* piNumIOPendingBytes;
+
+    // FLAC and Ogg/Opus blocks are encoded by the encoder threads and written in order by the I/O thread, the Ogg/Opus
+    // stream is only used by the encoder threads, one block after the other
+    CThreadPool*                   pEncoderThreadPool;
+    bool                           bFlac;
+    CVector<int16_t>               vecsEncodeBlock;
+    int                            iEncodeBlockSize;
+    int                            iEncodeBlockFill;
+    uint32_t                       iFlacFrameNumber;
+    qint64                         iFlacNumSamples;
+    std::shared_future<QByteArray> opusEncoded;
 };
 
 class CJamSession : public QObject
@@ -113,16 +184,24 @@ class CJamSession : public QObject
     Q_OBJECT
 
 public:
-    CJamSession ( QDir recordBaseDir );
+    CJamSession ( QDir                    recordBaseDir,
+                  const int               iMaxNumChannels,
+                  const ERecordingFormat  eNRecordingFormat,
+                  const ERecordingMixdown eNRecordingMixdown,
+                  CThreadPool*            pNIOThreadPool,
+                  CThreadPool*            pNEncoderThreadPool,
+                  std::atomic<qint64>*    piNNumIOPendingBytes );
 
     virtual ~CJamSession();
 
-    void Frame ( const int              iChID,
-                 const QString          name,
-                 const CHostAddress     address,
-                 const int              numAudioChannels,
-                 const CVector<int16_t> data,
-                 int                    iServerFrameSizeSamples );
+    void Frame ( const int               iChID,
+                 const QString&          name,
+                 const CHostAddress&     address,
+                 const int               numAudioChannels,
+                 const CVector<int16_t>& data,
+                 int                     iServerFrameSizeSamples );
+
+    void EndFrame ( const int iServerFrameSizeSamples );
 
     void End();
 
@@ -136,17 +215,37 @@ public:
 
     void DisconnectClient ( int iChID );
 
+    bool TakeOpenError ( QString& strError );
+
     static QMap<QString, QList<STrackItem>> TracksFromSessionDir ( const QString& name, int iServerFrameSizeSamples );
 
 private:
     CJamSession();
 
+    void NewClient ( const int iChID, const QString& name, const CHostAddress& address, const int numAudioChannels );
+    void WriteIndex ( const QJsonObject& record );
+    void MixFrame ( const int numAudioChannels, const CVector<int16_t>& data, const int iServerFrameSizeSamples );
+
+    static QMap<QString, QList<STrackItem>> TracksFromSessionIndex ( const QDir& sessionDir, QFile& indexFile, int iServerFrameSizeSamples );
+
     const QDir sessionDir;
 
     qint64                       currentFrame;
-    int                          chIdDisconnected;
     QVector<CJamClient*>         vecptrJamClients;
     QList<CJamClientConnection*> jamClientConnections;
+    const ERecordingFormat       eRecordingFormat;
+    CThreadPool*                 pIOThreadPool;
+    CThreadPool*                 pEncoderThreadPool;
+    std::atomic<qint64>*         piNumIOPendingBytes;
+    SJamIOFile*                  pIndexFile;
+    bool                         bOpenErrorTaken;
+
+    // live mix of all clients, written like a client recording
+    const ERecordingMixdown eRecordingMixdown;
+    CJamClient*             pMixdown;
+    CVector<float>          vecfMixdown;
+    CVector<int16_t>        vecsMixdown;
+    bool                    bMixdownFrame;
 };
 
 class CJamRecorder : public QObject
@@ -154,12 +253,33 @@ class CJamRecorder : public QObject
     Q_OBJECT
 
 public:
-    CJamRecorder ( const QString strRecordingBaseDir, const int iServerFrameSizeSamples ) :
+    CJamRecorder ( const QString           strRecordingBaseDir,
+                   const int               iServerFrameSizeSamples,
+                   const int               iMaxNumChannels,
+                   const ERecordingFormat  eRecordingFormat,
+                   const ERecordingMixdown eRecordingMixdown,
+                   CAudioFrameRing*        pNAudioFrameRing ) :
         recordBaseDir ( strRecordingBaseDir ),
         iServerFrameSizeSamples ( iServerFrameSizeSamples ),
+        iMaxNumChannels ( iMaxNumChannels ),
+        eRecordingFormat ( eRecordingFormat ),
+        eRecordingMixdown ( eRecordingMixdown ),
         isRecording ( false ),
-        currentSession ( nullptr )
-    {}
+        currentSession ( nullptr ),
+        iNumIOPendingBytes ( 0 ),
+        pEncoderThreadPool (
+            ( eRecordingFormat == RF_FLAC ) || ( eRecordingFormat == RF_OPUS )
+                ? new CThreadPool ( std::max ( 1u, std::min ( JAM_RECORDER_MAX_NUM_ENCODER_THREADS, std::thread::hardware_concurrency() ) ), true )
+                : nullptr ),
+        IOThreadPool ( 1 ),
+        pAudioFrameRing ( pNAudioFrameRing ),
+        TimerProcessFrames ( this ),
+        vecstrChanName ( iMaxNumChannels ),
+        vecChanAddress ( iMaxNumChannels ),
+        iNumDroppedFrames ( 0 )
+    {
+        QObject::connect ( &TimerProcessFrames, &QTimer::timeout, this, &CJamRecorder::OnProcessFrames );
+    }
 
     /**
      * @brief Create recording directory, if necessary, and connect signal handlers
@@ -176,20 +296,56 @@ public:
 
 private:
     void Start();
+    void End();
     void ReaperProjectFromCurrentSession();
     void AudacityLofFromCurrentSession();
-
-    QDir         recordBaseDir;
-    int          iServerFrameSizeSamples;
-    bool         isRecording;
-    CJamSession* currentSession;
-    QMutex       ChIdMutex;
+    void ProcessFrames ( const bool bAllowStart );
+    void Disconnected ( const int iChID );
+    void Frame ( const int               iChID,
+                 const QString&          name,
+                 const CHostAddress&     address,
+                 const int               numAudioChannels,
+                 const CVector<int16_t>& data,
+                 const bool              bAllowStart );
+    void EndFrame();
+
+    QDir              recordBaseDir;
+    int               iServerFrameSizeSamples;
+    int               iMaxNumChannels;
+    ERecordingFormat  eRecordingFormat;
+    ERecordingMixdown eRecordingMixdown;
+    bool              isRecording;
+    CJamSession*      currentSession;
+    QMutex            ChIdMutex;
+
+    // bytes queued for the I/O thread, decremented by the I/O thread so it must outlive the thread pools
+    std::atomic<qint64> iNumIOPendingBytes;
+
+    // FLAC and Ogg/Opus encoding is done by up to two low priority threads, the I/O thread waits for the encoded blocks so it is
+    // destroyed first
+    std::unique_ptr<CThreadPool> pEncoderThreadPool;
+
+    // all file writes are done by a single I/O thread, in order
+    CThreadPool IOThreadPool;
+
+    CAudioFrameRing*      pAudioFrameRing;
+    QTimer                TimerProcessFrames;
+    CVector<uint8_t>      vecbyFrame;
+    CVector<int16_t>      vecsData;
+    CVector<QString>      vecstrChanName;
+    CVector<CHostAddress> vecChanAddress;
+    int                   iNumDroppedFrames;
 
 signals:
     void RecordingSessionStarted ( QString sessionDir );
     void RecordingFailed ( QString error );
 
 public slots:
+    /**
+     * @brief Handle recorder thread start, begins collecting frames from the audio frame ring.
+     */
+    void OnStarted();
+
     /**
      * @brief Handle last client leaving the server, ends the recording.
      */
@@ -206,15 +362,9 @@ public slots:
     void OnAboutToQuit();
 
     /**
-     * @brief Handle an existing client leaving the server.
-     * @param iChID channel number of client
-     */
-    void OnDisconnected ( int iChID );
-
-    /**
-     * @brief Handle a frame of data to process
+     * @brief Handle the poll timer, processes all frames queued by the server.
      */
-    void OnFrame ( const int iChID, const QString name, const CHostAddress address, const int numAudioChannels, const CVector<int16_t> data );
+    void OnProcessFrames() { ProcessFrames ( true ); }
 };
 
 } // namespace recorder
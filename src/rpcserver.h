@@ -57,6 +57,7 @@ public:
     static const int iErrInvalidRequest = -32600;
     static const int iErrMethodNotFound = -32601;
     static const int iErrInvalidParams  = -32602;
+    static const int iErrInternalError  = -32603;
     static const int iErrParseError     = -32700;
 
     // Our errors
@@ -25,33 +25,54 @@
 #include "server.h"
 
 // CServer implementation ******************************************************
-CServer::CServer ( const int          iNewMaxNumChan,
-                   const QString&     strLoggingFileName,
-                   const QString&     strServerBindIP,
-                   const quint16      iPortNumber,
-                   const quint16      iQosNumber,
-                   const QString&     strHTMLStatusFileName,
-                   const QString&     strDirectoryServer,
-                   const QString&     strServerListFileName,
-                   const QString&     strServerInfo,
-                   const QString&     strServerListFilter,
-                   const QString&     strServerPublicIP,
-                   const QString&     strNewWelcomeMessage,
-                   const QString&     strRecordingDirName,
-                   const bool         bNDisconnectAllClientsOnQuit,
-                   const bool         bNUseDoubleSystemFrameSize,
-                   const bool         bNUseMultithreading,
-                   const bool         bDisableRecording,
-                   const bool         bNDelayPan,
-                   const bool         bNEnableIPv6,
-                   const ELicenceType eNLicenceType ) :
+CServer::CServer ( const int               iNewMaxNumChan,
+                   const QString&          strLoggingFileName,
+                   const QString&          strServerBindIP,
+                   const quint16           iPortNumber,
+                   const quint16           iQosNumber,
+                   const QString&          strHTMLStatusFileName,
+                   const QString&          strDirectoryServer,
+                   const QString&          strServerListFileName,
+                   const QString&          strServerInfo,
+                   const QString&          strServerListFilter,
+                   const QString&          strServerPublicIP,
+                   const QString&          strNewWelcomeMessage,
+                   const QString&          strRecordingDirName,
+                   const bool              bNDisconnectAllClientsOnQuit,
+                   const bool              bNUseDoubleSystemFrameSize,
+                   const bool              bNUseMultithreading,
+                   const bool              bDisableRecording,
+                   const bool              bNDelayPan,
+                   const bool              bNEnableIPv6,
+                   const bool              bNOffline,
+                   const int               iNChanListUpdateDelayMs,
+                   const ERecordingFormat  eNRecordingFormat,
+                   const ERecordingMixdown eNRecordingMixdown,
+                   const ELicenceType      eNLicenceType ) :
     bUseDoubleSystemFrameSize ( bNUseDoubleSystemFrameSize ),
     bUseMultithreading ( bNUseMultithreading ),
+    vecChannels ( new CChannel[iNewMaxNumChan] ),
     iMaxNumChannels ( iNewMaxNumChan ),
     iCurNumChannels ( 0 ),
-    Socket ( this, iPortNumber, iQosNumber, strServerBindIP, bNEnableIPv6 ),
+    vecChannelOrder ( iNewMaxNumChan ),
+    vecChanListLastSent ( 0 ),
+    iChanListVersion ( 0 ),
+    iChanListUpdateDelayMs ( iNChanListUpdateDelayMs ),
+    Socket ( this, iPortNumber, iQosNumber, strServerBindIP, bNEnableIPv6, bNOffline ),
     Logging(),
     iFrameCount ( 0 ),
+    dAvgFrameNs ( 0 ),
+    dAvgSumChannelCostNs ( 0 ),
+    iAvgFrameNs ( 0 ),
+    iNewChannelFrameNs ( 0 ),
+    iProjectedFrameNs ( 0 ),
+    iMaxFrameLoadPercent ( 0 ),
+    iEncComplLevel ( 0 ),
+    dEncComplCtrlFrameNs ( 0 ),
+    iEncComplCtrlHoldFrames ( 0 ),
+    iEncComplCtrlLowLoadFrames ( 0 ),
+    iNumNetwFrameSizeSugg ( 0 ),
+    iNetwFrameSizeSuggHoldFrames ( 0 ),
     bWriteStatusHTMLFile ( false ),
     strServerHTMLFileListName ( strHTMLStatusFileName ),
     HighPrecisionTimer ( bNUseDoubleSystemFrameSize ),
@@ -64,11 +85,13 @@ CServer::CServer ( const int          iNewMaxNumChan,
                         iNewMaxNumChan,
                         bNEnableIPv6,
                         &ConnLessProtocol ),
-    JamController ( this ),
+    JamController ( this, eNRecordingFormat, eNRecordingMixdown ),
     bDisableRecording ( bDisableRecording ),
     bAutoRunMinimized ( false ),
     bDelayPan ( bNDelayPan ),
     bEnableIPv6 ( bNEnableIPv6 ),
+    bOffline ( bNOffline ),
+    bOfflineRunning ( false ),
     eLicenceType ( eNLicenceType ),
     bDisconnectAllClientsOnQuit ( bNDisconnectAllClientsOnQuit ),
     pSignalHandler ( CSignalHandler::getSingletonP() )
@@ -76,46 +99,30 @@ CServer::CServer ( const int          iNewMaxNumChan,
     int iOpusError;
     int i;
 
-    // create OPUS encoder/decoder for each channel (must be done before
-    // enabling the channels), create a mono and stereo encoder/decoder
-    // for each channel
-    for ( i = 0; i < iMaxNumChannels; i++ )
-    {
-        // init OPUS -----------------------------------------------------------
-        OpusMode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
-
-        Opus64Mode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
-
-        // init audio encoders and decoders
-        OpusEncoderMono[i]     = opus_custom_encoder_create ( OpusMode[i], 1, &iOpusError );   // mono encoder legacy
-        OpusDecoderMono[i]     = opus_custom_decoder_create ( OpusMode[i], 1, &iOpusError );   // mono decoder legacy
-        OpusEncoderStereo[i]   = opus_custom_encoder_create ( OpusMode[i], 2, &iOpusError );   // stereo encoder legacy
-        OpusDecoderStereo[i]   = opus_custom_decoder_create ( OpusMode[i], 2, &iOpusError );   // stereo decoder legacy
-        Opus64EncoderMono[i]   = opus_custom_encoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono encoder OPUS64
-        Opus64DecoderMono[i]   = opus_custom_decoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono decoder OPUS64
-        Opus64EncoderStereo[i] = opus_custom_encoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo encoder OPUS64
-        Opus64DecoderStereo[i] = opus_custom_decoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo decoder OPUS64
+    // init OPUS, the modes are shared by all encoders and decoders (the codecs
+    // themselves are created when the channels need them)
+    OpusMode   = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
+    Opus64Mode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
 
-        // we require a constant bit rate
-        opus_custom_encoder_ctl ( OpusEncoderMono[i], OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i], OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_VBR ( 0 ) );
+    // reserve the worst case memory for the codec pools so that returning a
+    // codec to its pool does not allocate memory in the time-critical thread
+    // (each pool may hold one spare codec in addition to the codecs of all
+    // channels)
+    vecpOpusCodecs.reserve ( NUM_OPUS_CODEC_POOLS * ( iMaxNumChannels + 1 ) );
 
-        // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i], OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
+    for ( i = 0; i < NUM_OPUS_CODEC_POOLS; i++ )
+    {
+        vecpOpusCodecPools[i].reserve ( iMaxNumChannels + 1 );
+        bOpusCodecRequested[i] = false;
+    }
 
-        // we want as low delay as possible
-        opus_custom_encoder_ctl ( OpusEncoderMono[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+    vecpChanOpusCodec.Init ( iMaxNumChannels, nullptr );
 
-        // set encoder low complexity for legacy 128 samples frame size
-        opus_custom_encoder_ctl ( OpusEncoderMono[i], OPUS_SET_COMPLEXITY ( 1 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_COMPLEXITY ( 1 ) );
+    DoubleFrameSizeConvBufIn.Init ( iMaxNumChannels );
+    DoubleFrameSizeConvBufOut.Init ( iMaxNumChannels );
 
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
         // init double-to-normal frame size conversion buffers -----------------
         // use worst case memory initialization to avoid allocating memory in
         // the time-critical thread
@@ -142,6 +149,10 @@ CServer::CServer ( const int          iNewMaxNumChan,
         iServerFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
     }
 
+    // init the frame timing statistics
+    ResetFrameTiming();
+    FrameTimingTimer.start();
+
     // To avoid audio clitches, in the entire realtime timer audio processing
     // routine including the ProcessData no memory must be allocated. Since we
     // do not know the required sizes for the vectors, we allocate memory for
@@ -156,16 +167,32 @@ CServer::CServer ( const int          iNewMaxNumChan,
     vecvecsSendData.Init ( iMaxNumChannels );
     vecvecfIntermediateProcBuf.Init ( iMaxNumChannels );
     vecvecbyCodedData.Init ( iMaxNumChannels );
+    vecvecvecbyRecCodedData.Init ( iMaxNumChannels );
+    vecRecCeltNumCodedBytes.Init ( iMaxNumChannels );
+    vecNumRecCodedBlocks.Init ( iMaxNumChannels );
+    vecIsSilentFrame.Init ( iMaxNumChannels );
+    vecvecActiveSources.Init ( iMaxNumChannels );
     vecNumAudioChannels.Init ( iMaxNumChannels );
     vecNumFrameSizeConvBlocks.Init ( iMaxNumChannels );
     vecUseDoubleSysFraSizeConvBuf.Init ( iMaxNumChannels );
     vecAudioComprType.Init ( iMaxNumChannels );
+    vecChannelFrameNs.Init ( iMaxNumChannels, 0 );
+    vecdChannelCostNs.Init ( iMaxNumChannels, 0 );
+    vecChannelCostNs.reset ( new std::atomic<int64_t>[iMaxNumChannels] );
+    vecpLastOpusEncoder.Init ( iMaxNumChannels, nullptr );
+    vecLastOpusBitRate.Init ( iMaxNumChannels, 0 );
+    vecLastOpusComplexity.Init ( iMaxNumChannels, 0 );
+    vecNetwFrameSizeSugg.reset ( new std::atomic<int>[iMaxNumChannels] );
 
     for ( i = 0; i < iMaxNumChannels; i++ )
     {
+        vecChannelCostNs[i].store ( 0, std::memory_order_relaxed );
+        vecNetwFrameSizeSugg[i].store ( 0, std::memory_order_relaxed );
+
         // init vectors storing information of all channels
         vecvecfGains[i].Init ( iMaxNumChannels );
         vecvecfPannings[i].Init ( iMaxNumChannels );
+        vecvecActiveSources[i].Init ( iMaxNumChannels );
 
         // we always use stereo audio buffers (which is the worst case)
         vecvecsData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
@@ -180,6 +207,11 @@ CServer::CServer ( const int          iNewMaxNumChan,
 
         // allocate worst case memory for the coded data
         vecvecbyCodedData[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+
+        // with the double system frame size, up to two coded blocks are received per frame
+        vecvecvecbyRecCodedData[i].Init ( 2 );
+        vecvecvecbyRecCodedData[i][0].Init ( MAX_SIZE_BYTES_NETW_BUF );
+        vecvecvecbyRecCodedData[i][1].Init ( MAX_SIZE_BYTES_NETW_BUF );
     }
 
     // allocate worst case memory for the channel levels
@@ -223,6 +255,7 @@ CServer::CServer ( const int          iNewMaxNumChan,
     // entire life time of the software)
     for ( i = 0; i < iMaxNumChannels; i++ )
     {
+        vecChannels[i].SetMaxNumChannels ( iMaxNumChannels );
         vecChannels[i].SetEnable ( true );
         vecChannelOrder[i] = i;
     }
@@ -248,10 +281,20 @@ CServer::CServer ( const int          iNewMaxNumChan,
         }
     }
 
+    // channel list update timer: changes of the channel list which happen
+    // within a short time (e.g. a burst of new connections) are collected
+    // and sent as one single list update
+    TimerChanListUpdate.setSingleShot ( true );
+
     // Connections -------------------------------------------------------------
     // connect timer timeout signal
     QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout, this, &CServer::OnTimer );
 
+    // the OPUS codecs are always created by the main thread, never in the frame processing
+    QObject::connect ( this, &CServer::OpusCodecRequested, this, &CServer::OnOpusCodecRequested, Qt::QueuedConnection );
+
+    QObject::connect ( &TimerChanListUpdate, &QTimer::timeout, this, &CServer::CreateAndSendChanListForAllConChannels );
+
     QObject::connect ( &ConnLessProtocol, &CProtocol::CLMessReadyForSending, this, &CServer::OnSendCLProtMessage );
 
     QObject::connect ( &ConnLessProtocol, &CProtocol::CLPingReceived, this, &CServer::OnCLPingReceived );
@@ -290,82 +333,76 @@ CServer::CServer ( const int          iNewMaxNumChan,
 
     QObject::connect ( this, &CServer::Stopped, &JamController, &recorder::CJamController::Stopped );
 
-    QObject::connect ( this, &CServer::ClientDisconnected, &JamController, &recorder::CJamController::ClientDisconnected );
-
-    qRegisterMetaType<CVector<int16_t>> ( "CVector<int16_t>" );
-    QObject::connect ( this, &CServer::AudioFrame, &JamController, &recorder::CJamController::AudioFrame );
-
     QObject::connect ( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &CServer::OnAboutToQuit );
 
     QObject::connect ( pSignalHandler, &CSignalHandler::HandledSignal, this, &CServer::OnHandledSignal );
 
-    connectChannelSignalsToServerSlots<MAX_NUM_CHANNELS>();
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
+        ConnectChannelSignals ( i );
+    }
 
     // start the socket (it is important to start the socket after all
     // initializations and connections)
     Socket.Start();
 }
 
-template<unsigned int slotId>
-inline void CServer::connectChannelSignalsToServerSlots()
+// The channel signals do not tell which channel they come from, therefore the
+// channel ID is bound to the slot of each connection.
+void CServer::ConnectChannelSignals ( const int iChID )
 {
-    int iCurChanID = slotId - 1;
-
-    void ( CServer::*pOnSendProtMessCh ) ( CVector<uint8_t> ) = &CServerSlots<slotId>::OnSendProtMessCh;
-
-    void ( CServer::*pOnReqConnClientsListCh )() = &CServerSlots<slotId>::OnReqConnClientsListCh;
-
-    void ( CServer::*pOnChatTextReceivedCh ) ( QString ) = &CServerSlots<slotId>::OnChatTextReceivedCh;
-
-    void ( CServer::*pOnMuteStateHasChangedCh ) ( int, bool ) = &CServerSlots<slotId>::OnMuteStateHasChangedCh;
-
-    void ( CServer::*pOnServerAutoSockBufSizeChangeCh ) ( int ) = &CServerSlots<slotId>::OnServerAutoSockBufSizeChangeCh;
+    CChannel* pChannel = &vecChannels[iChID];
 
     // send message
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::MessReadyForSending, this, pOnSendProtMessCh );
+    QObject::connect ( pChannel, &CChannel::MessReadyForSending, this, [this, iChID] ( CVector<uint8_t> vecMessage ) {
+        SendProtMessage ( iChID, vecMessage );
+    } );
 
     // request connected clients list
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ReqConnClientsList, this, pOnReqConnClientsListCh );
+    QObject::connect ( pChannel, &CChannel::ReqConnClientsList, this, [this, iChID]() { CreateAndSendChanListForThisChan ( iChID ); } );
+
+    // the client supports the delta connected client list and all channel IDs
+    QObject::connect ( pChannel, &CChannel::ConClientListDeltaSupported, this, [this, iChID]() {
+        if ( iChID >= MAX_NUM_CHANNELS )
+        {
+            vecChannels[iChID].CreateClientIDMes ( iChID );
+        }
+    } );
 
     // channel info has changed
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ChanInfoHasChanged, this, &CServer::CreateAndSendChanListForAllConChannels );
+    QObject::connect ( pChannel, &CChannel::ChanInfoHasChanged, this, &CServer::OnChanListChanged );
 
     // chat text received
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ChatTextReceived, this, pOnChatTextReceivedCh );
+    QObject::connect ( pChannel, &CChannel::ChatTextReceived, this, [this, iChID] ( QString strChatText ) {
+        CreateAndSendChatTextForAllConChannels ( iChID, strChatText );
+    } );
 
     // other mute state has changed
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::MuteStateHasChanged, this, pOnMuteStateHasChangedCh );
+    QObject::connect ( pChannel, &CChannel::MuteStateHasChanged, this, [this, iChID] ( int iOtherChanID, bool bIsMuted ) {
+        CreateOtherMuteStateChanged ( iChID, iOtherChanID, bIsMuted );
+    } );
 
     // auto socket buffer size change
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ServerAutoSockBufSizeChange, this, pOnServerAutoSockBufSizeChangeCh );
-
-    connectChannelSignalsToServerSlots<slotId - 1>();
+    QObject::connect ( pChannel, &CChannel::ServerAutoSockBufSizeChange, this, [this, iChID] ( int iNNumFra ) {
+        CreateAndSendJitBufMessage ( iChID, iNNumFra );
+    } );
 }
 
-template<>
-inline void CServer::connectChannelSignalsToServerSlots<0>()
-{}
-
 void CServer::CreateAndSendJitBufMessage ( const int iCurChanID, const int iNNumFra ) { vecChannels[iCurChanID].CreateJitBufMes ( iNNumFra ); }
 
 CServer::~CServer()
 {
-    for ( int i = 0; i < iMaxNumChannels; i++ )
+    // free audio encoders and decoders
+    for ( SOpusCodec* pOpusCodec : vecpOpusCodecs )
     {
-        // free audio encoders and decoders
-        opus_custom_encoder_destroy ( OpusEncoderMono[i] );
-        opus_custom_decoder_destroy ( OpusDecoderMono[i] );
-        opus_custom_encoder_destroy ( OpusEncoderStereo[i] );
-        opus_custom_decoder_destroy ( OpusDecoderStereo[i] );
-        opus_custom_encoder_destroy ( Opus64EncoderMono[i] );
-        opus_custom_decoder_destroy ( Opus64DecoderMono[i] );
-        opus_custom_encoder_destroy ( Opus64EncoderStereo[i] );
-        opus_custom_decoder_destroy ( Opus64DecoderStereo[i] );
-
-        // free audio modes
-        opus_custom_mode_destroy ( OpusMode[i] );
-        opus_custom_mode_destroy ( Opus64Mode[i] );
+        opus_custom_encoder_destroy ( pOpusCodec->pEncoder );
+        opus_custom_decoder_destroy ( pOpusCodec->pDecoder );
+        delete pOpusCodec;
     }
+
+    // free audio modes
+    opus_custom_mode_destroy ( OpusMode );
+    opus_custom_mode_destroy ( Opus64Mode );
 }
 
 void CServer::SendProtMessage ( int iChID, CVector<uint8_t> vecMessage )
@@ -380,8 +417,13 @@ void CServer::OnNewConnection ( int iChID, int iTotChans, CHostAddress RecHostAd
     QMutexLocker locker ( &Mutex );
 
     // inform the client about its own ID at the server (note that this
-    // must be the first message to be sent for a new connection)
-    vecChannels[iChID].CreateClientIDMes ( iChID );
+    // must be the first message to be sent for a new connection), an ID
+    // which old clients do not support is only sent after the client has
+    // announced the support
+    if ( iChID < MAX_NUM_CHANNELS )
+    {
+        vecChannels[iChID].CreateClientIDMes ( iChID );
+    }
 
     // Send an empty channel list in order to force clients to reset their
     // audio mixer state. This is required to trigger clients to re-send their
@@ -391,6 +433,9 @@ void CServer::OnNewConnection ( int iChID, int iTotChans, CHostAddress RecHostAd
     // query support for split messages in the client
     vecChannels[iChID].CreateReqSplitMessSupportMes();
 
+    // query support for delta connected client lists in the client
+    vecChannels[iChID].CreateReqConClientListDeltaSupportMes();
+
     // on a new connection we query the network transport properties for the
     // audio packets (to use the correct network block size and audio
     // compression properties, etc.)
@@ -453,6 +498,23 @@ void CServer::OnNewConnection ( int iChID, int iTotChans, CHostAddress RecHostAd
     Logging.AddNewConnection ( RecHostAddr.InetAddr, iTotChans );
 }
 
+void CServer::OnChanListChanged()
+{
+    if ( iChanListUpdateDelayMs == 0 )
+    {
+        CreateAndSendChanListForAllConChannels();
+        return;
+    }
+
+    // the update window starts with the first change and is not extended by
+    // further changes so that the list is never delayed for more than the
+    // configured time
+    if ( !TimerChanListUpdate.isActive() )
+    {
+        TimerChanListUpdate.start ( iChanListUpdateDelayMs );
+    }
+}
+
 void CServer::OnServerFull ( CHostAddress RecHostAddr )
 {
     // note: no mutex required here
@@ -540,8 +602,15 @@ void CServer::Start()
     // only start if not already running
     if ( !IsRunning() )
     {
-        // start timer
-        HighPrecisionTimer.Start();
+        // start timer (the frames of an offline server are processed by the packet trace replay)
+        if ( bOffline )
+        {
+            bOfflineRunning = true;
+        }
+        else
+        {
+            HighPrecisionTimer.Start();
+        }
 
         // emit start signal
         emit Started();
@@ -557,7 +626,14 @@ void CServer::Stop()
     if ( IsRunning() )
     {
         // stop timer
-        HighPrecisionTimer.Stop();
+        if ( bOffline )
+        {
+            bOfflineRunning = false;
+        }
+        else
+        {
+            HighPrecisionTimer.Stop();
+        }
 
         // logging (add "server stopped" logging entry)
         Logging.AddServerStopped();
@@ -567,12 +643,403 @@ void CServer::Stop()
     }
 }
 
+void CServer::ResetFrameTiming()
+{
+    for ( int i = 0; i < SFP_NUM_PHASES; i++ )
+    {
+        FramePhaseNs[i].store ( 0, std::memory_order_relaxed );
+        FrameTimingHistograms[i].Reset();
+    }
+
+    iNumFrameDeadlineMisses.store ( 0, std::memory_order_relaxed );
+}
+
+bool CServer::IsFrameLoadAdmissible() const
+{
+    if ( iMaxFrameLoadPercent <= 0 )
+    {
+        return true;
+    }
+
+    return iProjectedFrameNs.load ( std::memory_order_relaxed ) * 100 <= GetFrameDeadlineNs() * iMaxFrameLoadPercent;
+}
+
+/// @brief Update the moving averages of the frame time and of the cost of each connected channel
+///
+/// The frame time is projected from the channel costs, scaled by the ratio of the average frame time to the average
+/// sum of the channel costs (which accounts for the work outside of the channels and for multithreading). A new
+/// connection starts its average with its first frame, so it is part of the projection immediately. One more
+/// channel is assumed to cost the mean of the connected channels.
+void CServer::UpdateFrameLoad ( const int iNumClients, const int64_t iFrameNs )
+{
+    int64_t iSumChannelFrameNs = 0;
+    double  dSumChannelCostNs  = 0;
+    int     iNumCostChannels   = 0;
+
+    for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
+    {
+        const int iCurChanID     = vecChanIDsCurConChan[iChanCnt];
+        double&   dChannelCostNs = vecdChannelCostNs[iCurChanID];
+
+        // the cost of a channel which was disconnected in this frame is already reset
+        if ( !vecChannels[iCurChanID].IsConnected() )
+        {
+            continue;
+        }
+
+        // the average of a new connection starts with its first frame
+        if ( dChannelCostNs == 0 )
+        {
+            dChannelCostNs = static_cast<double> ( vecChannelFrameNs[iChanCnt] );
+        }
+        else
+        {
+            dChannelCostNs += ( vecChannelFrameNs[iChanCnt] - dChannelCostNs ) * FRAME_LOAD_AVG_WEIGHT;
+        }
+
+        vecChannelCostNs[iCurChanID].store ( static_cast<int64_t> ( dChannelCostNs ), std::memory_order_relaxed );
+
+        iSumChannelFrameNs += vecChannelFrameNs[iChanCnt];
+        dSumChannelCostNs += dChannelCostNs;
+        iNumCostChannels++;
+    }
+
+    if ( ( dAvgFrameNs == 0 ) || ( dAvgSumChannelCostNs == 0 ) )
+    {
+        dAvgFrameNs          = static_cast<double> ( iFrameNs );
+        dAvgSumChannelCostNs = static_cast<double> ( iSumChannelFrameNs );
+    }
+    else
+    {
+        dAvgFrameNs += ( iFrameNs - dAvgFrameNs ) * FRAME_LOAD_AVG_WEIGHT;
+        dAvgSumChannelCostNs += ( iSumChannelFrameNs - dAvgSumChannelCostNs ) * FRAME_LOAD_AVG_WEIGHT;
+    }
+
+    if ( ( iNumCostChannels == 0 ) || ( dAvgSumChannelCostNs <= 0 ) )
+    {
+        return;
+    }
+
+    const double dFramePerChannelCost = dAvgFrameNs / dAvgSumChannelCostNs;
+    const double dNewChannelFrameNs   = dFramePerChannelCost * dSumChannelCostNs / iNumCostChannels;
+
+    iAvgFrameNs.store ( static_cast<int64_t> ( dAvgFrameNs ), std::memory_order_relaxed );
+    iNewChannelFrameNs.store ( static_cast<int64_t> ( dNewChannelFrameNs ), std::memory_order_relaxed );
+    iProjectedFrameNs.store ( static_cast<int64_t> ( dFramePerChannelCost * dSumChannelCostNs + dNewChannelFrameNs ), std::memory_order_relaxed );
+}
+
+/// @brief Lower or raise the encoder complexity level depending on the frame time
+void CServer::UpdateEncoderComplexityLevel ( const int64_t iFrameNs )
+{
+    int iLevel = iEncComplLevel.load ( std::memory_order_relaxed );
+
+    // the short moving average follows load spikes but ignores single slow frames
+    dEncComplCtrlFrameNs += ( iFrameNs - dEncComplCtrlFrameNs ) * ENC_COMPL_CTRL_FRAME_AVG_WEIGHT;
+
+    const double dLoadPercent = dEncComplCtrlFrameNs * 100 / GetFrameDeadlineNs();
+
+    iEncComplCtrlHoldFrames++;
+
+    if ( dLoadPercent < ENC_COMPL_CTRL_LOW_LOAD_PERCENT )
+    {
+        iEncComplCtrlLowLoadFrames++;
+    }
+    else
+    {
+        iEncComplCtrlLowLoadFrames = 0;
+    }
+
+    if ( ( dLoadPercent > ENC_COMPL_CTRL_HIGH_LOAD_PERCENT ) && ( iLevel < ENC_COMPL_CTRL_MAX_LEVEL ) &&
+         ( iEncComplCtrlHoldFrames >= ENC_COMPL_CTRL_DECREASE_HOLD_FRAMES ) )
+    {
+        iLevel++;
+        iEncComplCtrlHoldFrames = 0;
+    }
+    else if ( ( iLevel > 0 ) && ( iNumNetwFrameSizeSugg == 0 ) && ( iEncComplCtrlLowLoadFrames >= ENC_COMPL_CTRL_INCREASE_HOLD_FRAMES ) )
+    {
+        iLevel--;
+        iEncComplCtrlHoldFrames    = 0;
+        iEncComplCtrlLowLoadFrames = 0;
+    }
+
+    iEncComplLevel.store ( iLevel, std::memory_order_relaxed );
+    CTraceEvents::Counter ( "server/encoder complexity level", iLevel );
+}
+
+/// @brief Suggest a larger network frame size factor to one more client under high load or withdraw a suggestion under low load
+///
+/// Uses the load average of the encoder complexity control, so it must be called after UpdateEncoderComplexityLevel().
+void CServer::UpdateNetwFrameSizeSuggestions ( const int iNumClients )
+{
+    const double dLoadPercent    = dEncComplCtrlFrameNs * 100 / GetFrameDeadlineNs();
+    int          iSuggestChanID  = INVALID_CHANNEL_ID;
+    int          iWithdrawChanID = INVALID_CHANNEL_ID;
+    int          iMaxBufDelaySam = 0;
+    int          iMinBufDelaySam = 0;
+
+    iNetwFrameSizeSuggHoldFrames++;
+    iNumNetwFrameSizeSugg = 0;
+
+    for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
+    {
+        const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
+        CChannel& Channel    = vecChannels[iCurChanID];
+
+        // the jitter buffer size is given in coded frames
+        const int iFrameSizeSam = ( Channel.GetAudioCompressionType() == CT_OPUS ) ? DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES : SYSTEM_FRAME_SIZE_SAMPLES;
+        const int iBufDelaySam  = Channel.GetSockBufNumFrames() * iFrameSizeSam;
+
+        if ( vecNetwFrameSizeSugg[iCurChanID].load ( std::memory_order_relaxed ) != 0 )
+        {
+            iNumNetwFrameSizeSugg++;
+
+            if ( ( iWithdrawChanID == INVALID_CHANNEL_ID ) || ( iBufDelaySam < iMinBufDelaySam ) )
+            {
+                iWithdrawChanID = iCurChanID;
+                iMinBufDelaySam = iBufDelaySam;
+            }
+        }
+        else if ( ( Channel.GetNetwFrameSizeFact() < FRAME_SIZE_FACTOR_SAFE ) &&
+                  ( ( iSuggestChanID == INVALID_CHANNEL_ID ) || ( iBufDelaySam > iMaxBufDelaySam ) ) )
+        {
+            iSuggestChanID  = iCurChanID;
+            iMaxBufDelaySam = iBufDelaySam;
+        }
+    }
+
+    const bool bMaxEncComplLevel = ( iEncComplLevel.load ( std::memory_order_relaxed ) == ENC_COMPL_CTRL_MAX_LEVEL );
+
+    if ( ( dLoadPercent > ENC_COMPL_CTRL_HIGH_LOAD_PERCENT ) && bMaxEncComplLevel &&
+         ( iNetwFrameSizeSuggHoldFrames >= NETW_FRAME_SIZE_SUGG_HOLD_FRAMES ) && ( iSuggestChanID != INVALID_CHANNEL_ID ) )
+    {
+        // the frame size factors are powers of two, so the doubled factor is a valid factor
+        const int iSuggNetwFrameSizeFact = 2 * vecChannels[iSuggestChanID].GetNetwFrameSizeFact();
+
+        vecNetwFrameSizeSugg[iSuggestChanID].store ( iSuggNetwFrameSizeFact, std::memory_order_relaxed );
+        vecChannels[iSuggestChanID].CreateNetwFrameSizeFactMes ( iSuggNetwFrameSizeFact );
+
+        iNumNetwFrameSizeSugg++;
+        iNetwFrameSizeSuggHoldFrames = 0;
+    }
+    else if ( ( iWithdrawChanID != INVALID_CHANNEL_ID ) && ( iEncComplCtrlLowLoadFrames >= NETW_FRAME_SIZE_SUGG_WITHDRAW_FRAMES ) )
+    {
+        vecNetwFrameSizeSugg[iWithdrawChanID].store ( 0, std::memory_order_relaxed );
+        vecChannels[iWithdrawChanID].CreateNetwFrameSizeFactMes ( 0 );
+
+        iNumNetwFrameSizeSugg--;
+        iEncComplCtrlLowLoadFrames = 0;
+    }
+
+    CTraceEvents::Counter ( "server/frame size suggestions", iNumNetwFrameSizeSugg );
+}
+
+int CServer::GetEncoderComplexity ( const EAudComprType eAudComprType ) const
+{
+    const int iComplexity = ( eAudComprType == CT_OPUS ) ? SERVER_OPUS_COMPLEXITY : SERVER_OPUS64_COMPLEXITY;
+
+    return std::max ( 0, iComplexity - iEncComplLevel.load ( std::memory_order_relaxed ) * ENC_COMPL_CTRL_STEP );
+}
+
+SOpusCodec* CServer::CreateOpusCodec ( const EAudComprType eAudComprType, const int iNumAudioChannels )
+{
+    int         iOpusError;
+    SOpusCodec* pOpusCodec = new SOpusCodec;
+
+    OpusCustomMode* pOpusMode = ( eAudComprType == CT_OPUS64 ) ? Opus64Mode : OpusMode;
+
+    pOpusCodec->eAudComprType     = eAudComprType;
+    pOpusCodec->iNumAudioChannels = iNumAudioChannels;
+    pOpusCodec->pEncoder          = opus_custom_encoder_create ( pOpusMode, iNumAudioChannels, &iOpusError );
+    pOpusCodec->pDecoder          = opus_custom_decoder_create ( pOpusMode, iNumAudioChannels, &iOpusError );
+
+    // we require a constant bit rate
+    opus_custom_encoder_ctl ( pOpusCodec->pEncoder, OPUS_SET_VBR ( 0 ) );
+
+    // we want as low delay as possible
+    opus_custom_encoder_ctl ( pOpusCodec->pEncoder, OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+    if ( eAudComprType == CT_OPUS64 )
+    {
+        // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
+        opus_custom_encoder_ctl ( pOpusCodec->pEncoder, OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
+    }
+    else
+    {
+        // set encoder low complexity for legacy 128 samples frame size
+        opus_custom_encoder_ctl ( pOpusCodec->pEncoder, OPUS_SET_COMPLEXITY ( SERVER_OPUS_COMPLEXITY ) );
+    }
+
+    return pOpusCodec;
+}
+
+void CServer::RequestOpusCodec ( const EAudComprType eAudComprType, const int iNumAudioChannels )
+{
+    bool& bRequested = bOpusCodecRequested[GetOpusCodecPoolIdx ( eAudComprType, iNumAudioChannels )];
+
+    // only one codec of a pool is created at a time
+    if ( !bRequested )
+    {
+        bRequested = true;
+        emit OpusCodecRequested ( eAudComprType, iNumAudioChannels );
+    }
+}
+
+void CServer::OnOpusCodecRequested ( int iAudComprType, int iNumAudioChannels )
+{
+    const EAudComprType eAudComprType = static_cast<EAudComprType> ( iAudComprType );
+
+    // creating the codec takes much longer than a frame, so it is done without the mutex
+    SOpusCodec* pOpusCodec = CreateOpusCodec ( eAudComprType, iNumAudioChannels );
+
+    QMutexLocker locker ( &Mutex );
+
+    const int iPoolIdx = GetOpusCodecPoolIdx ( eAudComprType, iNumAudioChannels );
+
+    vecpOpusCodecs.push_back ( pOpusCodec );
+    vecpOpusCodecPools[iPoolIdx].push_back ( pOpusCodec );
+    bOpusCodecRequested[iPoolIdx] = false;
+}
+
+void CServer::UpdateChannelOpusCodec ( const int iChID )
+{
+    SOpusCodec*         pCurOpusCodec     = vecpChanOpusCodec[iChID];
+    const bool          bIsConnected      = vecChannels[iChID].IsConnected();
+    const EAudComprType eAudComprType     = vecChannels[iChID].GetAudioCompressionType();
+    const int           iNumAudioChannels = vecChannels[iChID].GetNumAudioChannels();
+    const bool          bIsOpus           = ( eAudComprType == CT_OPUS ) || ( eAudComprType == CT_OPUS64 );
+    const bool          bNeedsOpusCodec   = bIsConnected && bIsOpus && ( iNumAudioChannels >= 1 ) && ( iNumAudioChannels <= 2 );
+
+    // nothing to do if the codec of the channel matches its transport properties
+    if ( pCurOpusCodec == nullptr )
+    {
+        if ( !bNeedsOpusCodec )
+        {
+            return;
+        }
+    }
+    else if ( bNeedsOpusCodec && ( pCurOpusCodec->eAudComprType == eAudComprType ) && ( pCurOpusCodec->iNumAudioChannels == iNumAudioChannels ) )
+    {
+        return;
+    }
+
+    // return the previous codec to its pool
+    if ( pCurOpusCodec != nullptr )
+    {
+        vecpOpusCodecPools[GetOpusCodecPoolIdx ( pCurOpusCodec->eAudComprType, pCurOpusCodec->iNumAudioChannels )].push_back ( pCurOpusCodec );
+        vecpChanOpusCodec[iChID] = nullptr;
+    }
+
+    if ( bNeedsOpusCodec )
+    {
+        CVector<SOpusCodec*>& vecpOpusCodecPool = vecpOpusCodecPools[GetOpusCodecPoolIdx ( eAudComprType, iNumAudioChannels )];
+
+        if ( !vecpOpusCodecPool.empty() )
+        {
+            // a codec used by a previous channel must not carry over its state
+            SOpusCodec* pOpusCodec = vecpOpusCodecPool.back();
+            vecpOpusCodecPool.pop_back();
+
+            opus_custom_encoder_ctl ( pOpusCodec->pEncoder, OPUS_RESET_STATE );
+            opus_custom_decoder_ctl ( pOpusCodec->pDecoder, OPUS_RESET_STATE );
+
+            vecpChanOpusCodec[iChID] = pOpusCodec;
+
+            // the encoder settings must be applied to the new codec
+            vecpLastOpusEncoder[iChID] = nullptr;
+        }
+
+        // keep a spare codec in the pool for the next channel, if the pool was
+        // empty the channel is not coded until the codec is created
+        if ( vecpOpusCodecPool.empty() )
+        {
+            RequestOpusCodec ( eAudComprType, iNumAudioChannels );
+        }
+    }
+}
+
+OpusCustomEncoder* CServer::GetChannelOpusEncoder ( const int iChanCnt ) const
+{
+    const SOpusCodec* pOpusCodec = vecpChanOpusCodec[vecChanIDsCurConChan[iChanCnt]];
+
+    // the codec is selected at the beginning of the frame, if the transport properties
+    // of the channel have changed since then, the channel is not coded in this frame
+    if ( ( pOpusCodec != nullptr ) && ( pOpusCodec->eAudComprType == vecAudioComprType[iChanCnt] ) &&
+         ( pOpusCodec->iNumAudioChannels == vecNumAudioChannels[iChanCnt] ) )
+    {
+        return pOpusCodec->pEncoder;
+    }
+
+    return nullptr;
+}
+
+OpusCustomDecoder* CServer::GetChannelOpusDecoder ( const int iChanCnt ) const
+{
+    const SOpusCodec* pOpusCodec = vecpChanOpusCodec[vecChanIDsCurConChan[iChanCnt]];
+
+    if ( ( pOpusCodec != nullptr ) && ( pOpusCodec->eAudComprType == vecAudioComprType[iChanCnt] ) &&
+         ( pOpusCodec->iNumAudioChannels == vecNumAudioChannels[iChanCnt] ) )
+    {
+        return pOpusCodec->pDecoder;
+    }
+
+    return nullptr;
+}
+
+void CServer::ResetFrameLoad()
+{
+    vecdChannelCostNs.Reset ( 0 );
+
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        vecChannelCostNs[i].store ( 0, std::memory_order_relaxed );
+    }
+
+    dAvgFrameNs          = 0;
+    dAvgSumChannelCostNs = 0;
+
+    iAvgFrameNs.store ( 0, std::memory_order_relaxed );
+    iNewChannelFrameNs.store ( 0, std::memory_order_relaxed );
+    iProjectedFrameNs.store ( 0, std::memory_order_relaxed );
+
+    // the next session starts with the full encoder complexity
+    iEncComplLevel.store ( 0, std::memory_order_relaxed );
+    dEncComplCtrlFrameNs       = 0;
+    iEncComplCtrlHoldFrames    = 0;
+    iEncComplCtrlLowLoadFrames = 0;
+
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        vecNetwFrameSizeSugg[i].store ( 0, std::memory_order_relaxed );
+    }
+
+    iNumNetwFrameSizeSugg        = 0;
+    iNetwFrameSizeSuggHoldFrames = 0;
+}
+
+int64_t CServer::GetFrameDeadlineNs() const
+{
+    // the server frame must be processed within the duration of the audio it contains
+    return static_cast<int64_t> ( iServerFrameSizeSamples ) * 1000000000 / SYSTEM_SAMPLE_RATE_HZ;
+}
+
+/// @brief Add the time since iStartNs to the given phase of the current frame
+/// @return the current time which can be used as the start of the next phase
+int64_t CServer::AddFramePhaseTime ( const EServerFramePhase ePhase, const int64_t iStartNs )
+{
+    static const char* const strTraceNames[SFP_NUM_PHASES] =
+        { "server/channel scan", "server/decode", "server/levels", "server/mix", "server/encode", "server/send", "server/recorder", "server/frame" };
+
+    const int64_t iNowNs = FrameTimingTimer.nsecsElapsed();
+
+    FramePhaseNs[ePhase].fetch_add ( iNowNs - iStartNs, std::memory_order_relaxed );
+    CTraceEvents::Complete ( strTraceNames[ePhase], iNowNs - iStartNs );
+
+    return iNowNs;
+}
+
 void CServer::OnTimer()
 {
-    //### TEST: BEGIN ###//
-    // uncomment next line to do a timer Jitter measurement
-    // static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure();
-    //### TEST: END ###//
+    const int64_t iFrameStartNs = FrameTimingTimer.nsecsElapsed();
 
     // Get data from all connected clients -------------------------------------
     // some inits
@@ -589,6 +1056,10 @@ void CServer::OnTimer()
         // first, get number and IDs of connected channels
         for ( int i = 0; i < iMaxNumChannels; i++ )
         {
+            // take the OPUS codec for the current transport properties of the
+            // channel or return it if the channel is no longer connected
+            UpdateChannelOpusCodec ( i );
+
             if ( vecChannels[i].IsConnected() )
             {
                 // add ID and increment counter (note that the vector length is
@@ -600,6 +1071,8 @@ void CServer::OnTimer()
             }
         }
 
+        AddFramePhaseTime ( SFP_CHANNEL_SCAN, iFrameStartNs );
+
         // use multithreading for any non-zero number of clients
         // (overhead is low and it is worth doing for all numbers)
         bUseMT = bUseMultithreading && iNumClients > 0;
@@ -640,7 +1113,7 @@ void CServer::OnTimer()
         if ( bChannelIsNowDisconnected )
         {
             // update channel list for all currently connected clients
-            CreateAndSendChanListForAllConChannels();
+            OnChanListChanged();
         }
     }
 
@@ -649,9 +1122,30 @@ void CServer::OnTimer()
     // one client is connected.
     if ( iNumClients > 0 )
     {
+        int64_t iTimeNs = FrameTimingTimer.nsecsElapsed();
+
         // calculate levels for all connected clients
         const bool bSendChannelLevels = CreateLevelsForAllConChannels ( iNumClients, vecNumAudioChannels, vecvecsData, vecChannelLevels );
 
+        // the channel level list is identical for all clients, generate it once
+        CProtocol::CBroadcastMes ChannelLevelListMes;
+
+        if ( bSendChannelLevels )
+        {
+            ChannelLevelListMes = CProtocol::PrepCLChannelLevelListMes ( vecChannelLevels, iNumClients );
+        }
+
+        iTimeNs = AddFramePhaseTime ( SFP_LEVELS, iTimeNs );
+
+        // the audio data for recording purpose is collected in one frame record
+        const bool bRecording = JamController.GetRecordingEnabled();
+
+        if ( bRecording )
+        {
+            JamController.BeginFrame();
+            iTimeNs = AddFramePhaseTime ( SFP_RECORDER, iTimeNs );
+        }
+
         for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
         {
             // get actual ID of current channel
@@ -663,17 +1157,31 @@ void CServer::OnTimer()
             // send channel levels if they are ready
             if ( bSendChannelLevels )
             {
-                ConnLessProtocol.CreateCLChannelLevelListMes ( vecChannels[iCurChanID].GetAddress(), vecChannelLevels, iNumClients );
+                iTimeNs = FrameTimingTimer.nsecsElapsed();
+                ConnLessProtocol.SendCLBroadcastMes ( vecChannels[iCurChanID].GetAddress(), ChannelLevelListMes );
+                AddFramePhaseTime ( SFP_SEND, iTimeNs );
             }
 
-            // export the audio data for recording purpose
-            if ( JamController.GetRecordingEnabled() )
+            // export the audio data for recording purpose, a channel which is
+            // no longer connected was disconnected while decoding this frame
+            if ( bRecording )
             {
-                emit AudioFrame ( iCurChanID,
-                                  vecChannels[iCurChanID].GetName(),
-                                  vecChannels[iCurChanID].GetAddress(),
-                                  vecNumAudioChannels[iChanCnt],
-                                  vecvecsData[iChanCnt] );
+                iTimeNs = FrameTimingTimer.nsecsElapsed();
+
+                if ( vecChannels[iCurChanID].IsConnected() )
+                {
+                    JamController.PutAudioFrame ( iCurChanID,
+                                                  vecChannels[iCurChanID].GetName(),
+                                                  vecChannels[iCurChanID].GetAddress(),
+                                                  vecNumAudioChannels[iChanCnt],
+                                                  vecvecsData[iChanCnt] );
+                }
+                else
+                {
+                    JamController.PutClientDisconnected ( iCurChanID );
+                }
+
+                AddFramePhaseTime ( SFP_RECORDER, iTimeNs );
             }
 
             // processing without multithreading
@@ -685,6 +1193,13 @@ void CServer::OnTimer()
             }
         }
 
+        if ( bRecording )
+        {
+            iTimeNs = FrameTimingTimer.nsecsElapsed();
+            JamController.EndFrame();
+            AddFramePhaseTime ( SFP_RECORDER, iTimeNs );
+        }
+
         // processing with multithreading
         if ( bUseMT )
         {
@@ -718,9 +1233,34 @@ void CServer::OnTimer()
                 }
             }
         }
+
+        // add the frame to the timing statistics
+        const int64_t iFrameNs = FrameTimingTimer.nsecsElapsed() - iFrameStartNs;
+
+        FramePhaseNs[SFP_FRAME].store ( iFrameNs, std::memory_order_relaxed );
+        CTraceEvents::Complete ( "server/frame", iFrameNs );
+        CTraceEvents::Counter ( "server/clients", iNumClients );
+
+        if ( iFrameNs > GetFrameDeadlineNs() )
+        {
+            iNumFrameDeadlineMisses.fetch_add ( 1, std::memory_order_relaxed );
+        }
+
+        UpdateFrameLoad ( iNumClients, iFrameNs );
+        UpdateEncoderComplexityLevel ( iFrameNs );
+        UpdateNetwFrameSizeSuggestions ( iNumClients );
+
+        for ( int i = 0; i < SFP_NUM_PHASES; i++ )
+        {
+            FrameTimingHistograms[i].Add ( FramePhaseNs[i].exchange ( 0, std::memory_order_relaxed ) );
+        }
     }
     else
     {
+        // frames without clients are not part of the timing statistics
+        FramePhaseNs[SFP_CHANNEL_SCAN].store ( 0, std::memory_order_relaxed );
+        ResetFrameLoad();
+
         // Disable server if no clients are connected. In this case the server
         // does not consume any significant CPU when no client is connected.
         Stop();
@@ -755,10 +1295,14 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
     int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
     OpusCustomDecoder* CurOpusDecoder;
     unsigned char*     pCurCodedData;
+    const int64_t      iStartNs = FrameTimingTimer.nsecsElapsed();
 
     // get actual ID of current channel
     const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
 
+    // no complete coded data received yet in this frame
+    vecNumRecCodedBlocks[iChanCnt] = 0;
+
     // get and store number of audio channels and compression type
     vecNumAudioChannels[iChanCnt] = vecChannels[iCurChanID].GetNumAudioChannels();
     vecAudioComprType[iChanCnt]   = vecChannels[iCurChanID].GetAudioCompressionType();
@@ -783,35 +1327,15 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
     }
 
     // select the opus decoder and raw audio frame length
+    CurOpusDecoder = GetChannelOpusDecoder ( iChanCnt );
+
     if ( vecAudioComprType[iChanCnt] == CT_OPUS )
     {
         iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
-
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
-        {
-            CurOpusDecoder = OpusDecoderMono[iCurChanID];
-        }
-        else
-        {
-            CurOpusDecoder = OpusDecoderStereo[iCurChanID];
-        }
     }
     else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
     {
         iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
-
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
-        {
-            CurOpusDecoder = Opus64DecoderMono[iCurChanID];
-        }
-        else
-        {
-            CurOpusDecoder = Opus64DecoderStereo[iCurChanID];
-        }
-    }
-    else
-    {
-        CurOpusDecoder = nullptr;
     }
 
     // get gains of all connected channels
@@ -848,21 +1372,18 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
         // get current number of OPUS coded bytes
         const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetCeltNumCodedBytes();
 
+        vecRecCeltNumCodedBytes[iChanCnt] = iCeltNumCodedBytes;
+
         for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
         {
             // get data
-            const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( vecvecbyCodedData[iChanCnt], iCeltNumCodedBytes );
+            const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( vecvecvecbyRecCodedData[iChanCnt][iB], iCeltNumCodedBytes );
 
             // if channel was just disconnected, set flag that connected
-            // client list is sent to all other clients
-            // and emit the client disconnected signal
+            // client list is sent to all other clients (the jam recorder
+            // is informed from the frame loop in OnTimer)
             if ( eGetStat == GS_CHAN_NOW_DISCONNECTED )
             {
-                if ( JamController.GetRecordingEnabled() )
-                {
-                    emit ClientDisconnected ( iCurChanID ); // TODO do this outside the mutex lock?
-                }
-
                 FreeChannel ( iCurChanID ); // note that the channel is now not in use
 
                 // note that no mutex is needed for this shared resource since it is not a
@@ -871,13 +1392,15 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
                 bChannelIsNowDisconnected = true;
 
                 // since the channel is no longer in use, we should return
+                vecChannelFrameNs[iChanCnt] = AddFramePhaseTime ( SFP_DECODE, iStartNs ) - iStartNs;
                 return;
             }
 
             // get pointer to coded data
             if ( eGetStat == GS_BUFFER_OK )
             {
-                pCurCodedData = &vecvecbyCodedData[iChanCnt][0];
+                pCurCodedData = &vecvecvecbyRecCodedData[iChanCnt][iB][0];
+                vecNumRecCodedBlocks[iChanCnt]++;
             }
             else
             {
@@ -907,78 +1430,83 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
         }
     }
 
+    // check the frame for digital silence while it is still in the cache, a silent source does not
+    // change a mix (the loop has no early exit so that the compiler can vectorize it)
+    const int16_t* psData      = &vecvecsData[iChanCnt][0];
+    const int      iNumSamples = iServerFrameSizeSamples * vecNumAudioChannels[iChanCnt];
+    int16_t        sOrSamples  = 0;
+
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        sOrSamples |= psData[i];
+    }
+
+    vecIsSilentFrame[iChanCnt] = ( sOrSamples == 0 );
+
+    vecChannelFrameNs[iChanCnt] = AddFramePhaseTime ( SFP_DECODE, iStartNs ) - iStartNs;
+
     Q_UNUSED ( iUnused )
 }
 
 /// @brief Mix all audio data from all clients together, encode and transmit
 void CServer::MixEncodeTransmitData ( const int iChanCnt, const int iNumClients )
 {
-    int               i, j, k, iUnused;
+    int               j, iUnused;
     CVector<float>&   vecfIntermProcBuf = vecvecfIntermediateProcBuf[iChanCnt]; // use reference for faster access
     CVector<int16_t>& vecsSendData      = vecvecsSendData[iChanCnt];            // use reference for faster access
+    const int64_t     iStartNs          = FrameTimingTimer.nsecsElapsed();
+    int64_t           iTimeNs           = iStartNs;
 
     // get actual ID of current channel
     const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
 
+    // if the mix is just one unchanged source, forward its received coded data instead of
+    // mixing and encoding again, which also avoids another generation of coding loss
+    const int iPassthroughChanCnt = GetPassthroughSource ( iChanCnt, iNumClients );
+
+    if ( iPassthroughChanCnt != INVALID_INDEX )
+    {
+        for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
+        {
+            // the sequence number of the current channel is applied on sending
+            vecChannels[iCurChanID].PrepAndSendPacket ( &Socket,
+                                                        vecvecvecbyRecCodedData[iPassthroughChanCnt][iB],
+                                                        vecRecCeltNumCodedBytes[iPassthroughChanCnt] );
+        }
+
+        vecChannelFrameNs[iChanCnt] += AddFramePhaseTime ( SFP_SEND, iTimeNs ) - iStartNs;
+        return;
+    }
+
     // init intermediate processing vector with zeros since we mix all channels on that vector
     vecfIntermProcBuf.Reset ( 0 );
 
+    // collect the sources which contribute to the mix (with delay panning, the previous frame of a
+    // silent source may still be mixed in)
+    CVector<int>& vecActiveSources = vecvecActiveSources[iChanCnt]; // use reference for faster access
+    int           iNumActive       = 0;
+
+    for ( j = 0; j < iNumClients; j++ )
+    {
+        if ( ( vecvecfGains[iChanCnt][j] != 0.0f ) && ( bDelayPan || !vecIsSilentFrame[j] ) )
+        {
+            vecActiveSources[iNumActive++] = j;
+        }
+    }
+
     // distinguish between stereo and mono mode
     if ( vecNumAudioChannels[iChanCnt] == 1 )
     {
         // Mono target channel -------------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
+        for ( int iActive = 0; iActive < iNumActive; iActive++ )
         {
-            // get a reference to the audio data and gain of the current client
-            const CVector<int16_t>& vecsData = vecvecsData[j];
-            const float             fGain    = vecvecfGains[iChanCnt][j];
+            j = vecActiveSources[iActive];
 
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( fGain == 1.0f )
-            {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono
-                    for ( i = 0; i < iServerFrameSizeSamples; i++ )
-                    {
-                        vecfIntermProcBuf[i] += vecsData[i];
-                    }
-                }
-                else
-                {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        vecfIntermProcBuf[i] += ( static_cast<float> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
-                    }
-                }
-            }
-            else
-            {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono
-                    for ( i = 0; i < iServerFrameSizeSamples; i++ )
-                    {
-                        vecfIntermProcBuf[i] += vecsData[i] * fGain;
-                    }
-                }
-                else
-                {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        vecfIntermProcBuf[i] += fGain * ( static_cast<float> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
-                    }
-                }
-            }
+            MixUtils::AddToMono ( vecfIntermProcBuf, vecvecsData[j], vecNumAudioChannels[j], vecvecfGains[iChanCnt][j], iServerFrameSizeSamples );
         }
 
         // convert from double to short with clipping
-        for ( i = 0; i < iServerFrameSizeSamples; i++ )
-        {
-            vecsSendData[i] = Float2Short ( vecfIntermProcBuf[i] );
-        }
+        MixUtils::ConvertToShort ( vecfIntermProcBuf, vecsSendData, iServerFrameSizeSamples );
     }
     else
     {
@@ -986,158 +1514,60 @@ void CServer::MixEncodeTransmitData ( const int iChanCnt, const int iNumClients
 
         const int maxPanDelay = MAX_DELAY_PANNING_SAMPLES;
 
-        int iPanDelL = 0, iPanDelR = 0, iPanDel;
-        int iLpan, iRpan, iPan;
-
-        for ( j = 0; j < iNumClients; j++ )
+        for ( int iActive = 0; iActive < iNumActive; iActive++ )
         {
-            // get a reference to the audio data and gain/pan of the current client
-            const CVector<int16_t>& vecsData  = vecvecsData[j];
-            const CVector<int16_t>& vecsData2 = vecvecsData2[j];
+            j = vecActiveSources[iActive];
 
             const float fGain = vecvecfGains[iChanCnt][j];
-            const float fPan  = bDelayPan ? 0.5f : vecvecfPannings[iChanCnt][j];
-
-            // calculate combined gain/pan for each stereo channel where we define
-            // the panning that center equals full gain for both channels
-            const float fGainL = MathUtils::GetLeftPan ( fPan, false ) * fGain;
-            const float fGainR = MathUtils::GetRightPan ( fPan, false ) * fGain;
 
             if ( bDelayPan )
             {
-                iPanDel  = lround ( (float) ( 2 * maxPanDelay - 2 ) * ( vecvecfPannings[iChanCnt][j] - 0.5f ) );
-                iPanDelL = ( iPanDel > 0 ) ? iPanDel : 0;
-                iPanDelR = ( iPanDel < 0 ) ? -iPanDel : 0;
-            }
-
-            if ( vecNumAudioChannels[j] == 1 )
-            {
-                // mono: copy same mono data in both out stereo audio channels
-                for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                {
-                    // left/right channel
-                    if ( bDelayPan )
-                    {
-                        // pan address shift
-
-                        // left channel
-                        iLpan = i - iPanDelL;
-                        if ( iLpan < 0 )
-                        {
-                            // get from second
-                            iLpan = iLpan + iServerFrameSizeSamples;
-                            vecfIntermProcBuf[k] += vecsData2[iLpan] * fGainL;
-                        }
-                        else
-                        {
-                            vecfIntermProcBuf[k] += vecsData[iLpan] * fGainL;
-                        }
-
-                        // right channel
-                        iRpan = i - iPanDelR;
-                        if ( iRpan < 0 )
-                        {
-                            // get from second
-                            iRpan = iRpan + iServerFrameSizeSamples;
-                            vecfIntermProcBuf[k + 1] += vecsData2[iRpan] * fGainR;
-                        }
-                        else
-                        {
-                            vecfIntermProcBuf[k + 1] += vecsData[iRpan] * fGainR;
-                        }
-                    }
-                    else
-                    {
-                        vecfIntermProcBuf[k] += vecsData[i] * fGainL;
-                        vecfIntermProcBuf[k + 1] += vecsData[i] * fGainR;
-                    }
-                }
+                // the pan is applied as a delay of one channel at full gain
+                const int iPanDel  = lround ( (float) ( 2 * maxPanDelay - 2 ) * ( vecvecfPannings[iChanCnt][j] - 0.5f ) );
+                const int iPanDelL = ( iPanDel > 0 ) ? iPanDel : 0;
+                const int iPanDelR = ( iPanDel < 0 ) ? -iPanDel : 0;
+
+                MixUtils::AddToStereoDelayPan ( vecfIntermProcBuf,
+                                                vecvecsData[j],
+                                                vecvecsData2[j],
+                                                vecNumAudioChannels[j],
+                                                fGain,
+                                                iPanDelL,
+                                                iPanDelR,
+                                                iServerFrameSizeSamples );
             }
             else
             {
-                // stereo
-                for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
-                {
-                    // left/right channel
-                    if ( bDelayPan )
-                    {
-                        // pan address shift
-                        if ( ( i & 1 ) == 0 )
-                        {
-                            iPan = i - 2 * iPanDelL; // if even : left channel
-                        }
-                        else
-                        {
-                            iPan = i - 2 * iPanDelR; // if odd  : right channel
-                        }
-                        // interleaved channels
-                        if ( iPan < 0 )
-                        {
-                            // get from second
-                            iPan = iPan + 2 * iServerFrameSizeSamples;
-                            vecfIntermProcBuf[i] += vecsData2[iPan] * fGain;
-                        }
-                        else
-                        {
-                            vecfIntermProcBuf[i] += vecsData[iPan] * fGain;
-                        }
-                    }
-                    else
-                    {
-                        if ( ( i & 1 ) == 0 )
-                        {
-                            // if even : left channel
-                            vecfIntermProcBuf[i] += vecsData[i] * fGainL;
-                        }
-                        else
-                        {
-                            // if odd  : right channel
-                            vecfIntermProcBuf[i] += vecsData[i] * fGainR;
-                        }
-                    }
-                }
+                // calculate combined gain/pan for each stereo channel where we define
+                // the panning that center equals full gain for both channels
+                const float fPan   = vecvecfPannings[iChanCnt][j];
+                const float fGainL = MathUtils::GetLeftPan ( fPan, false ) * fGain;
+                const float fGainR = MathUtils::GetRightPan ( fPan, false ) * fGain;
+
+                MixUtils::AddToStereo ( vecfIntermProcBuf, vecvecsData[j], vecNumAudioChannels[j], fGainL, fGainR, iServerFrameSizeSamples );
             }
         }
 
         // convert from double to short with clipping
-        for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
-        {
-            vecsSendData[i] = Float2Short ( vecfIntermProcBuf[i] );
-        }
+        MixUtils::ConvertToShort ( vecfIntermProcBuf, vecsSendData, 2 * iServerFrameSizeSamples );
     }
 
+    iTimeNs = AddFramePhaseTime ( SFP_MIX, iTimeNs );
+
     int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
-    OpusCustomEncoder* pCurOpusEncoder         = nullptr;
+    OpusCustomEncoder* pCurOpusEncoder         = GetChannelOpusEncoder ( iChanCnt );
 
     // get current number of CELT coded bytes
     const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetCeltNumCodedBytes();
 
-    // select the opus encoder and raw audio frame length
+    // select the raw audio frame length
     if ( vecAudioComprType[iChanCnt] == CT_OPUS )
     {
         iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
-
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
-        {
-            pCurOpusEncoder = OpusEncoderMono[iCurChanID];
-        }
-        else
-        {
-            pCurOpusEncoder = OpusEncoderStereo[iCurChanID];
-        }
     }
     else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
     {
         iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
-
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
-        {
-            pCurOpusEncoder = Opus64EncoderMono[iCurChanID];
-        }
-        else
-        {
-            pCurOpusEncoder = Opus64EncoderStereo[iCurChanID];
-        }
     }
 
     // If the server frame size is smaller than the received OPUS frame size, we need a conversion
@@ -1157,12 +1587,25 @@ void CServer::MixEncodeTransmitData ( const int iChanCnt, const int iNumClients
         // OPUS encoding
         if ( pCurOpusEncoder != nullptr )
         {
-            //### TODO: BEGIN ###//
-            // find a better place than this: the setting does not change all the time so for speed
-            // optimization it would be better to set it only if the network frame size is changed
-            opus_custom_encoder_ctl ( pCurOpusEncoder,
-                                      OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples ) ) );
-            //### TODO: END ###//
+            // the encoder settings are only applied if they have changed, the encoder
+            // changes if the client changes the codec or the number of audio channels
+            const int  iBitRate    = CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples );
+            const int  iComplexity = GetEncoderComplexity ( vecAudioComprType[iChanCnt] );
+            const bool bNewEncoder = ( pCurOpusEncoder != vecpLastOpusEncoder[iCurChanID] );
+
+            if ( bNewEncoder || ( iBitRate != vecLastOpusBitRate[iCurChanID] ) )
+            {
+                opus_custom_encoder_ctl ( pCurOpusEncoder, OPUS_SET_BITRATE ( iBitRate ) );
+                vecLastOpusBitRate[iCurChanID] = iBitRate;
+            }
+
+            if ( bNewEncoder || ( iComplexity != vecLastOpusComplexity[iCurChanID] ) )
+            {
+                opus_custom_encoder_ctl ( pCurOpusEncoder, OPUS_SET_COMPLEXITY ( iComplexity ) );
+                vecLastOpusComplexity[iCurChanID] = iComplexity;
+            }
+
+            vecpLastOpusEncoder[iCurChanID] = pCurOpusEncoder;
 
             for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
             {
@@ -1174,21 +1617,83 @@ void CServer::MixEncodeTransmitData ( const int iChanCnt, const int iNumClients
                                                &vecvecbyCodedData[iChanCnt][0],
                                                iCeltNumCodedBytes );
 
+                iTimeNs = AddFramePhaseTime ( SFP_ENCODE, iTimeNs );
+
                 // send separate mix to current clients
                 vecChannels[iCurChanID].PrepAndSendPacket ( &Socket, vecvecbyCodedData[iChanCnt], iCeltNumCodedBytes );
+
+                iTimeNs = AddFramePhaseTime ( SFP_SEND, iTimeNs );
             }
         }
     }
 
+    vecChannelFrameNs[iChanCnt] += iTimeNs - iStartNs;
+
     Q_UNUSED ( iUnused )
 }
 
-CVector<CChannelInfo> CServer::CreateChannelList()
+/// @brief Find the source of a mix which can be forwarded without decoding and encoding
+/// @return the index of the source among the connected channels or INVALID_INDEX
+///
+/// This is the case if the mix consists of exactly one source at unity gain and centre pan, which was received
+/// completely in this frame with the same codec, number of audio channels and coded frame size the current channel uses.
+int CServer::GetPassthroughSource ( const int iChanCnt, const int iNumClients )
+{
+    // with the frame size conversion buffers, receiving and sending are not aligned
+    if ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] != 0 )
+    {
+        return INVALID_INDEX;
+    }
+
+    int iSourceChanCnt = INVALID_INDEX;
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        if ( vecvecfGains[iChanCnt][j] != 0.0f )
+        {
+            if ( iSourceChanCnt != INVALID_INDEX )
+            {
+                // more than one source in the mix
+                return INVALID_INDEX;
+            }
+
+            iSourceChanCnt = j;
+        }
+    }
+
+    if ( iSourceChanCnt == INVALID_INDEX )
+    {
+        return INVALID_INDEX;
+    }
+
+    // the mix must leave the source audio unchanged (for a mono target the panning is not applied)
+    const float fPan     = vecvecfPannings[iChanCnt][iSourceChanCnt];
+    const bool  bCentred = ( MathUtils::GetLeftPan ( fPan, false ) == 1.0f ) && ( MathUtils::GetRightPan ( fPan, false ) == 1.0f );
+
+    if ( ( vecvecfGains[iChanCnt][iSourceChanCnt] != 1.0f ) || ( ( vecNumAudioChannels[iChanCnt] == 2 ) && !bCentred ) )
+    {
+        return INVALID_INDEX;
+    }
+
+    // the current channel must be able to decode the coded data of the source
+    if ( ( vecAudioComprType[iSourceChanCnt] != vecAudioComprType[iChanCnt] ) ||
+         ( vecNumAudioChannels[iSourceChanCnt] != vecNumAudioChannels[iChanCnt] ) ||
+         ( vecRecCeltNumCodedBytes[iSourceChanCnt] != vecChannels[vecChanIDsCurConChan[iChanCnt]].GetCeltNumCodedBytes() ) ||
+         ( vecNumRecCodedBlocks[iSourceChanCnt] != vecNumFrameSizeConvBlocks[iChanCnt] ) )
+    {
+        return INVALID_INDEX;
+    }
+
+    return iSourceChanCnt;
+}
+
+CVector<CChannelInfo> CServer::CreateChannelList ( const bool bAllChanIDs )
 {
     CVector<CChannelInfo> vecChanInfo ( 0 );
+    const int             iMaxChanID = bAllChanIDs ? iMaxNumChannels : std::min ( iMaxNumChannels, MAX_NUM_CHANNELS );
 
     // look for free channels
-    for ( int i = 0; i < iMaxNumChannels; i++ )
+    for ( int i = 0; i < iMaxChanID; i++ )
     {
         if ( vecChannels[i].IsConnected() )
         {
@@ -1202,19 +1707,56 @@ CVector<CChannelInfo> CServer::CreateChannelList()
 
 void CServer::CreateAndSendChanListForAllConChannels()
 {
+    QMutexLocker locker ( &MutexChanList );
+
     // create channel list
     CVector<CChannelInfo> vecChanInfo ( CreateChannelList() );
 
+    // the list version wraps around but never gets zero (which is reserved)
+    const int iNewVersion = ( iChanListVersion % 0xFFFF ) + 1;
+
+    // encode the messages only once for all clients: the complete list for
+    // old clients (without the channel IDs they do not support) and the
+    // changes for clients supporting delta lists (clients which do not have
+    // the last sent list get the complete list in the delta message format)
+    const CProtocol::CBroadcastMes ChanListMes = CProtocol::PrepConClientListMes ( CreateChannelList ( false ) );
+
+    const CProtocol::CBroadcastMes ChanListDeltaMes =
+        CProtocol::PrepConClientListDeltaMes ( iChanListVersion, iNewVersion, vecChanListLastSent, vecChanInfo );
+
+    CProtocol::CBroadcastMes ChanListFullDeltaMes;
+    bool                     bFullDeltaMesReady = false;
+
     // now send connected channels list to all connected clients
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
         if ( vecChannels[i].IsConnected() )
         {
             // send message
-            vecChannels[i].CreateConClientListMes ( vecChanInfo );
+            if ( !vecChannels[i].IsConClientListDeltaSupported() )
+            {
+                vecChannels[i].SendBroadcastMes ( ChanListMes );
+            }
+            else if ( ( iChanListVersion != 0 ) && ( vecChannels[i].GetConClientListVersion() == iChanListVersion ) )
+            {
+                vecChannels[i].SendConClientListDeltaMes ( ChanListDeltaMes, iNewVersion );
+            }
+            else
+            {
+                if ( !bFullDeltaMesReady )
+                {
+                    ChanListFullDeltaMes = CProtocol::PrepConClientListDeltaMes ( 0, iNewVersion, CVector<CChannelInfo> ( 0 ), vecChanInfo );
+                    bFullDeltaMesReady   = true;
+                }
+
+                vecChannels[i].SendConClientListDeltaMes ( ChanListFullDeltaMes, iNewVersion );
+            }
         }
     }
 
+    vecChanListLastSent = vecChanInfo;
+    iChanListVersion    = iNewVersion;
+
     // create status HTML file if enabled
     if ( bWriteStatusHTMLFile )
     {
@@ -1224,11 +1766,25 @@ void CServer::CreateAndSendChanListForAllConChannels()
 
 void CServer::CreateAndSendChanListForThisChan ( const int iCurChanID )
 {
-    // create channel list
-    CVector<CChannelInfo> vecChanInfo ( CreateChannelList() );
+    if ( vecChannels[iCurChanID].IsConClientListDeltaSupported() )
+    {
+        QMutexLocker locker ( &MutexChanList );
 
-    // now send connected channels list to the channel with the ID "iCurChanID"
-    vecChannels[iCurChanID].CreateConClientListMes ( vecChanInfo );
+        // send the complete list which all other clients currently have so
+        // that the next delta list can be applied (resync)
+        vecChannels[iCurChanID].SendConClientListDeltaMes (
+            CProtocol::PrepConClientListDeltaMes ( 0, iChanListVersion, CVector<CChannelInfo> ( 0 ), vecChanListLastSent ),
+            iChanListVersion );
+    }
+    else
+    {
+        // create channel list (a client without delta list support does not
+        // support all channel IDs)
+        CVector<CChannelInfo> vecChanInfo ( CreateChannelList ( false ) );
+
+        // now send connected channels list to the channel with the ID "iCurChanID"
+        vecChannels[iCurChanID].CreateConClientListMes ( vecChanInfo );
+    }
 }
 
 void CServer::CreateAndSendChatTextForAllConChannels ( const int iCurChanID, const QString& strChatText )
@@ -1244,13 +1800,16 @@ void CServer::CreateAndSendChatTextForAllConChannels ( const int iCurChanID, con
     const QString strActualMessageText = "<font color=\"" + sCurColor + "\">(" + QTime::currentTime().toString ( "hh:mm:ss AP" ) + ") <b>" +
                                          ChanName.toHtmlEscaped() + "</b></font> " + strChatText.toHtmlEscaped();
 
+    // the message is identical for all clients, encode it only once
+    const CProtocol::CBroadcastMes ChatTextMes = CProtocol::PrepChatTextMes ( strActualMessageText );
+
     // Send chat text to all connected clients ---------------------------------
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
         if ( vecChannels[i].IsConnected() )
         {
             // send message
-            vecChannels[i].CreateChatTextMes ( strActualMessageText );
+            vecChannels[i].SendBroadcastMes ( ChatTextMes );
         }
     }
 }
@@ -1258,7 +1817,7 @@ void CServer::CreateAndSendChatTextForAllConChannels ( const int iCurChanID, con
 void CServer::CreateAndSendRecorderStateForAllConChannels()
 {
     // get recorder state
-    ERecorderState eRecorderState = JamController.GetRecorderState();
+    const CProtocol::CBroadcastMes RecorderStateMes = CProtocol::PrepRecorderStateMes ( JamController.GetRecorderState() );
 
     // now send recorder state to all connected clients
     for ( int i = 0; i < iMaxNumChannels; i++ )
@@ -1266,14 +1825,14 @@ void CServer::CreateAndSendRecorderStateForAllConChannels()
         if ( vecChannels[i].IsConnected() )
         {
             // send message
-            vecChannels[i].CreateRecorderStateMes ( eRecorderState );
+            vecChannels[i].SendBroadcastMes ( RecorderStateMes );
         }
     }
 }
 
 void CServer::CreateOtherMuteStateChanged ( const int iCurChanID, const int iOtherChanID, const bool bIsMuted )
 {
-    if ( vecChannels[iOtherChanID].IsConnected() )
+    if ( vecChannels[iOtherChanID].IsConnected() && IsChanIDSupported ( iCurChanID, iOtherChanID ) )
     {
         // send message
         vecChannels[iOtherChanID].CreateMuteStateHasChangedMes ( iCurChanID, bIsMuted );
@@ -1325,11 +1884,15 @@ int CServer::FindChannel ( const CHostAddress& CheckAddr, const bool bAllowNew )
     }
 
     // existing channel not found - return if we cannot create a new channel
-    if ( !bAllowNew || iCurNumChannels >= iMaxNumChannels )
+    if ( !bAllowNew || ( iCurNumChannels >= iMaxNumChannels ) || !IsFrameLoadAdmissible() )
     {
         return INVALID_CHANNEL_ID;
     }
 
+    // reserve the cost of the new channel until it is part of the frame load
+    // so that clients connecting at the same time are accounted
+    iProjectedFrameNs.fetch_add ( iNewChannelFrameNs.load ( std::memory_order_relaxed ), std::memory_order_relaxed );
+
     // allocate a new channel
     i          = iCurNumChannels++; // save index of free channel and increment count
     iNewChanID = vecChannelOrder[i];
@@ -1358,6 +1921,9 @@ void CServer::InitChannel ( const int iNewChanID, const CHostAddress& InetAddr )
     // reset channel info
     vecChannels[iNewChanID].ResetInfo();
 
+    // the suggestion of the network frame size factor was sent to the previous client
+    vecNetwFrameSizeSugg[iNewChanID].store ( 0, std::memory_order_relaxed );
+
     // reset the channel gains/pans of current channel, at the same
     // time reset gains/pans of this channel ID for all other channels
     for ( int i = 0; i < iMaxNumChannels; i++ )
@@ -1386,6 +1952,11 @@ void CServer::FreeChannel ( const int iCurChanID )
         {
             --iCurNumChannels;
 
+            // the next connection on this channel starts a new average of the channel cost (this is called from the
+            // frame processing, which is the only user of the average)
+            vecdChannelCostNs[iCurChanID] = 0;
+            vecChannelCostNs[iCurChanID].store ( 0, std::memory_order_relaxed );
+
             // move channel IDs down by one starting at the freed channel and working up the active channels
             // and then the free channels until its position in the free list is reached
             while ( i < iCurNumChannels || ( i + 1 < iMaxNumChannels && vecChannelOrder[i + 1] < iCurChanID ) )
@@ -1422,7 +1993,7 @@ void CServer::DumpChannels ( const QString& title )
     }
 }
 
-void CServer::OnProtocolCLMessageReceived ( int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress RecHostAddr )
+void CServer::OnProtocolCLMessageReceived ( int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress RecHostAddr )
 {
     QMutexLocker locker ( &Mutex );
 
@@ -1430,7 +2001,7 @@ void CServer::OnProtocolCLMessageReceived ( int iRecID, CVector<uint8_t> vecbyMe
     ConnLessProtocol.ParseConnectionLessMessageBody ( vecbyMesBodyData, iRecID, RecHostAddr );
 }
 
-void CServer::OnProtocolMessageReceived ( int iRecCounter, int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress RecHostAddr )
+void CServer::OnProtocolMessageReceived ( int iRecCounter, int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress RecHostAddr )
 {
     QMutexLocker locker ( &Mutex );
 
@@ -26,9 +26,11 @@
 
 #include <QObject>
 #include <QDateTime>
+#include <QTimer>
 #include <QHostAddress>
 #include <QFileInfo>
 #include <algorithm>
+#include <memory>
 #ifdef USE_OPUS_SHARED_LIB
 #    include "opus/opus_custom.h"
 #else
@@ -48,69 +50,107 @@
 
 /* Definitions ****************************************************************/
 // no valid channel number
-#define INVALID_CHANNEL_ID ( MAX_NUM_CHANNELS + 1 )
+#define INVALID_CHANNEL_ID ( MAX_NUM_SERVER_CHANNELS + 1 )
+
+// weight of a new frame in the moving averages of the frame load
+#define FRAME_LOAD_AVG_WEIGHT ( 1.0 / 64 )
+
+// OPUS encoder complexity at normal load (the legacy 128 samples frame size
+// uses a low complexity, OPUS64 uses the default of the OPUS custom encoder)
+#define SERVER_OPUS_COMPLEXITY   1
+#define SERVER_OPUS64_COMPLEXITY 5
+
+// Encoder complexity control: if the frame time gets close to the deadline,
+// the complexity of all encoders is lowered step by step, if the load stays low
+// for a while, the complexity is raised again step by step. The thresholds are
+// in percent of the frame deadline.
+#define ENC_COMPL_CTRL_FRAME_AVG_WEIGHT     ( 1.0 / 8 )
+#define ENC_COMPL_CTRL_HIGH_LOAD_PERCENT    85
+#define ENC_COMPL_CTRL_LOW_LOAD_PERCENT     60
+#define ENC_COMPL_CTRL_DECREASE_HOLD_FRAMES 32  // minimum number of frames between two steps down
+#define ENC_COMPL_CTRL_INCREASE_HOLD_FRAMES 750 // number of low load frames before a step up
+#define ENC_COMPL_CTRL_STEP                 2   // complexity reduction per level
+#define ENC_COMPL_CTRL_MAX_LEVEL            3
+
+// Adaptive packetisation: if the load stays high although the encoder complexity
+// is at its lowest level, twice its network frame size factor is suggested to
+// one more client at a time, which halves the packet rate of this client in both
+// directions. The client with the largest jitter buffer delay is selected since
+// the additional packet delay matters least for it. If the load stays low, the
+// suggestions are withdrawn one at a time (smallest jitter buffer delay first)
+// before the encoder complexity is raised again.
+#define NETW_FRAME_SIZE_SUGG_HOLD_FRAMES     375 // minimum number of frames between two suggestions
+#define NETW_FRAME_SIZE_SUGG_WITHDRAW_FRAMES 375 // number of low load frames before a suggestion is withdrawn
+
+// number of OPUS codec pools (OPUS and OPUS64, each mono and stereo)
+#define NUM_OPUS_CODEC_POOLS 4
+
+// phases of the processing of one server frame for the timing statistics, the
+// mix, encode and send times are summed over all channels and threads
+enum EServerFramePhase
+{
+    SFP_CHANNEL_SCAN = 0, // find connected channels (including the mutex wait)
+    SFP_DECODE       = 1, // get received data and OPUS decode
+    SFP_LEVELS       = 2, // calculate the channel levels
+    SFP_MIX          = 3, // mix all sources for each channel
+    SFP_ENCODE       = 4, // OPUS encode
+    SFP_SEND         = 5, // send audio and channel level packets
+    SFP_RECORDER     = 6, // hand the audio data over to the jam recorder
+    SFP_FRAME        = 7, // entire frame processing
+    SFP_NUM_PHASES   = 8
+};
 
 /* Classes ********************************************************************/
-template<unsigned int slotId>
-class CServerSlots : public CServerSlots<slotId - 1>
+// index of the OPUS codec pool for a codec type and number of audio channels
+inline int GetOpusCodecPoolIdx ( const EAudComprType eAudComprType, const int iNumAudioChannels )
 {
-public:
-    void OnSendProtMessCh ( CVector<uint8_t> mess ) { SendProtMessage ( slotId - 1, mess ); }
-    void OnReqConnClientsListCh() { CreateAndSendChanListForThisChan ( slotId - 1 ); }
-
-    void OnChatTextReceivedCh ( QString strChatText ) { CreateAndSendChatTextForAllConChannels ( slotId - 1, strChatText ); }
-
-    void OnMuteStateHasChangedCh ( int iChanID, bool bIsMuted ) { CreateOtherMuteStateChanged ( slotId - 1, iChanID, bIsMuted ); }
-
-    void OnServerAutoSockBufSizeChangeCh ( int iNNumFra ) { CreateAndSendJitBufMessage ( slotId - 1, iNNumFra ); }
-
-protected:
-    virtual void SendProtMessage ( int iChID, CVector<uint8_t> vecMessage ) = 0;
-
-    virtual void CreateAndSendChanListForThisChan ( const int iCurChanID ) = 0;
+    return ( ( eAudComprType == CT_OPUS64 ) ? 2 : 0 ) + ( iNumAudioChannels - 1 );
+}
 
-    virtual void CreateAndSendChatTextForAllConChannels ( const int iCurChanID, const QString& strChatText ) = 0;
-
-    virtual void CreateOtherMuteStateChanged ( const int iCurChanID, const int iOtherChanID, const bool bIsMuted ) = 0;
-
-    virtual void CreateAndSendJitBufMessage ( const int iCurChanID, const int iNNumFra ) = 0;
+// OPUS encoder and decoder for one codec type and number of audio channels
+struct SOpusCodec
+{
+    EAudComprType      eAudComprType;
+    int                iNumAudioChannels;
+    OpusCustomEncoder* pEncoder;
+    OpusCustomDecoder* pDecoder;
 };
 
-template<>
-class CServerSlots<0>
-{};
-
-class CServer : public QObject, public CServerSlots<MAX_NUM_CHANNELS>
+class CServer : public QObject
 {
     Q_OBJECT
 
 public:
-    CServer ( const int          iNewMaxNumChan,
-              const QString&     strLoggingFileName,
-              const QString&     strServerBindIP,
-              const quint16      iPortNumber,
-              const quint16      iQosNumber,
-              const QString&     strHTMLStatusFileName,
-              const QString&     strDirectoryServer,
-              const QString&     strServerListFileName,
-              const QString&     strServerInfo,
-              const QString&     strServerListFilter,
-              const QString&     strServerPublicIP,
-              const QString&     strNewWelcomeMessage,
-              const QString&     strRecordingDirName,
-              const bool         bNDisconnectAllClientsOnQuit,
-              const bool         bNUseDoubleSystemFrameSize,
-              const bool         bNUseMultithreading,
-              const bool         bDisableRecording,
-              const bool         bNDelayPan,
-              const bool         bNEnableIPv6,
-              const ELicenceType eNLicenceType );
+    CServer ( const int               iNewMaxNumChan,
+              const QString&          strLoggingFileName,
+              const QString&          strServerBindIP,
+              const quint16           iPortNumber,
+              const quint16           iQosNumber,
+              const QString&          strHTMLStatusFileName,
+              const QString&          strDirectoryServer,
+              const QString&          strServerListFileName,
+              const QString&          strServerInfo,
+              const QString&          strServerListFilter,
+              const QString&          strServerPublicIP,
+              const QString&          strNewWelcomeMessage,
+              const QString&          strRecordingDirName,
+              const bool              bNDisconnectAllClientsOnQuit,
+              const bool              bNUseDoubleSystemFrameSize,
+              const bool              bNUseMultithreading,
+              const bool              bDisableRecording,
+              const bool              bNDelayPan,
+              const bool              bNEnableIPv6,
+              const bool              bNOffline,
+              const int               iNChanListUpdateDelayMs,
+              const ERecordingFormat  eNRecordingFormat,
+              const ERecordingMixdown eNRecordingMixdown,
+              const ELicenceType      eNLicenceType );
 
     virtual ~CServer();
 
     void Start();
     void Stop();
-    bool IsRunning() { return HighPrecisionTimer.isActive(); }
+    bool IsRunning() { return bOffline ? bOfflineRunning : HighPrecisionTimer.isActive(); }
 
     bool PutAudioData ( const CVector<uint8_t>& vecbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID );
 
@@ -126,8 +166,16 @@ public:
     // IPv6 Enabled
     bool IsIPv6Enabled() { return bEnableIPv6; }
 
+    // packet trace capture and replay (an offline server is driven by the replay instead of the timer)
+    bool StartPacketTraceCapture ( const QString& strFileName ) { return Socket.StartTraceCapture ( strFileName ); }
+    void PutReplayPacket ( const CVector<uint8_t>& vecbyData, const int iNumBytes, const CHostAddress& HostAddr )
+    {
+        Socket.PutReceivedPacket ( vecbyData, iNumBytes, HostAddr );
+    }
+
     // GUI settings ------------------------------------------------------------
-    int GetClientNumAudioChannels ( const int iChanNum ) { return vecChannels[iChanNum].GetNumAudioChannels(); }
+    int                     GetClientNumAudioChannels ( const int iChanNum ) { return vecChannels[iChanNum].GetNumAudioChannels(); }
+    const CChannelNetStats& GetClientNetStats ( const int iChanNum ) { return vecChannels[iChanNum].GetNetStats(); }
 
     void           SetDirectoryType ( const EDirectoryType eNCSAT ) { ServerListManager.SetDirectoryType ( eNCSAT ); }
     EDirectoryType GetDirectoryType() { return ServerListManager.GetDirectoryType(); }
@@ -149,7 +197,7 @@ public:
     void    RequestNewRecording() { JamController.RequestNewRecording(); }
     void    SetRecordingDir ( QString newRecordingDir )
     {
-        JamController.SetRecordingDir ( newRecordingDir, iServerFrameSizeSamples, bDisableRecording );
+        JamController.SetRecordingDir ( newRecordingDir, iServerFrameSizeSamples, iMaxNumChannels, bDisableRecording );
     }
     QString GetRecordingDir() { return JamController.GetRecordingDir(); }
 
@@ -168,15 +216,54 @@ public:
     void SetEnableDelayPanning ( bool bDelayPanningOn ) { bDelayPan = bDelayPanningOn; }
     bool IsDelayPanningEnabled() { return bDelayPan; }
 
+    // frame timing statistics
+    const CTimingHistogram& GetFrameTimingHistogram ( const EServerFramePhase ePhase ) const { return FrameTimingHistograms[ePhase]; }
+    int64_t                 GetNumFrameDeadlineMisses() const { return iNumFrameDeadlineMisses.load ( std::memory_order_relaxed ); }
+    int64_t                 GetFrameDeadlineNs() const;
+    void                    ResetFrameTiming();
+
+    // admission control, new connections are refused if the projected frame
+    // time exceeds the given percentage of the frame deadline (0 disables it)
+    void    SetMaxFrameLoad ( const int iNewMaxFrameLoadPercent ) { iMaxFrameLoadPercent = iNewMaxFrameLoadPercent; }
+    int     GetMaxFrameLoad() const { return iMaxFrameLoadPercent; }
+    int64_t GetAvgFrameNs() const { return iAvgFrameNs.load ( std::memory_order_relaxed ); }
+    int64_t GetProjectedFrameNs() const { return iProjectedFrameNs.load ( std::memory_order_relaxed ); }
+    int64_t GetClientCostNs ( const int iChanNum ) const { return vecChannelCostNs[iChanNum].load ( std::memory_order_relaxed ); }
+
+    // current encoder complexity reduction level (0 is full quality)
+    int GetEncoderComplexityLevel() const { return iEncComplLevel.load ( std::memory_order_relaxed ); }
+
+    // network frame size factor suggested to a client due to high load (0 if none)
+    int GetClientNetwFrameSizeSugg ( const int iChanNum ) const { return vecNetwFrameSizeSugg[iChanNum].load ( std::memory_order_relaxed ); }
+
 protected:
     // access functions for actual channels
     bool IsConnected ( const int iChanNum ) { return vecChannels[iChanNum].IsConnected(); }
 
     int                   FindChannel ( const CHostAddress& CheckAddr, const bool bAllowNew = false );
+    bool                  IsFrameLoadAdmissible() const;
+    void                  UpdateFrameLoad ( const int iNumClients, const int64_t iFrameNs );
+    void                  ResetFrameLoad();
+    void                  UpdateEncoderComplexityLevel ( const int64_t iFrameNs );
+    void                  UpdateNetwFrameSizeSuggestions ( const int iNumClients );
+    int                   GetEncoderComplexity ( const EAudComprType eAudComprType ) const;
+    SOpusCodec*           CreateOpusCodec ( const EAudComprType eAudComprType, const int iNumAudioChannels );
+    void                  RequestOpusCodec ( const EAudComprType eAudComprType, const int iNumAudioChannels );
+    void                  UpdateChannelOpusCodec ( const int iChID );
+    OpusCustomEncoder*    GetChannelOpusEncoder ( const int iChanCnt ) const;
+    OpusCustomDecoder*    GetChannelOpusDecoder ( const int iChanCnt ) const;
     void                  InitChannel ( const int iNewChanID, const CHostAddress& InetAddr );
     void                  FreeChannel ( const int iCurChanID );
     void                  DumpChannels ( const QString& title );
-    CVector<CChannelInfo> CreateChannelList();
+    CVector<CChannelInfo> CreateChannelList ( const bool bAllChanIDs = true );
+
+    // Clients before the delta connected client list index arrays of
+    // MAX_NUM_CHANNELS entries with the channel ID. The support of higher
+    // channel IDs is announced together with the delta list support.
+    bool IsChanIDSupported ( const int iChanID, const int iRecChanID ) const
+    {
+        return ( iChanID < MAX_NUM_CHANNELS ) || vecChannels[iRecChanID].IsConClientListDeltaSupported();
+    }
 
     virtual void CreateAndSendChanListForAllConChannels();
     virtual void CreateAndSendChanListForThisChan ( const int iCurChanID );
@@ -189,8 +276,7 @@ protected:
 
     virtual void SendProtMessage ( int iChID, CVector<uint8_t> vecMessage );
 
-    template<unsigned int slotId>
-    inline void connectChannelSignalsToServerSlots();
+    void ConnectChannelSignals ( const int iChID );
 
     void WriteHTMLChannelList();
     void WriteHTMLServerQuit();
@@ -203,6 +289,10 @@ protected:
 
     void MixEncodeTransmitData ( const int iChanCnt, const int iNumClients );
 
+    int GetPassthroughSource ( const int iChanCnt, const int iNumClients );
+
+    int64_t AddFramePhaseTime ( const EServerFramePhase ePhase, const int64_t iStartNs );
+
     virtual void customEvent ( QEvent* pEvent );
 
     void CreateAndSendRecorderStateForAllConChannels();
@@ -222,32 +312,41 @@ protected:
                                          CVector<uint16_t>&              vecLevelsOut );
 
     // do not use the vector class since CChannel does not have appropriate
-    // copy constructor/operator
-    CChannel vecChannels[MAX_NUM_CHANNELS];
-    int      iMaxNumChannels;
+    // copy constructor/operator, the channels are allocated for the configured
+    // number of channels
+    std::unique_ptr<CChannel[]> vecChannels;
+    int                         iMaxNumChannels;
 
-    int    iCurNumChannels;
-    int    vecChannelOrder[MAX_NUM_CHANNELS];
-    QMutex MutexChanOrder;
+    int          iCurNumChannels;
+    CVector<int> vecChannelOrder;
+    QMutex       MutexChanOrder;
 
     CProtocol ConnLessProtocol;
     QMutex    Mutex;
+
+    // connected client list as last sent to all clients (base of delta lists)
+    CVector<CChannelInfo> vecChanListLastSent;
+    int                   iChanListVersion;
+    QMutex                MutexChanList;
+    QTimer                TimerChanListUpdate;
+    int                   iChanListUpdateDelayMs;
+
     QMutex    MutexWelcomeMessage;
     bool      bChannelIsNowDisconnected;
 
-    // audio encoder/decoder
-    OpusCustomMode*    Opus64Mode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* Opus64EncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* Opus64DecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* Opus64EncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* Opus64DecoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomMode*    OpusMode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* OpusEncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* OpusDecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* OpusEncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* OpusDecoderStereo[MAX_NUM_CHANNELS];
-    CConvBuf<int16_t>  DoubleFrameSizeConvBufIn[MAX_NUM_CHANNELS];
-    CConvBuf<int16_t>  DoubleFrameSizeConvBufOut[MAX_NUM_CHANNELS];
+    // audio encoder/decoder: the OPUS modes are shared by all codecs, a channel
+    // takes a codec matching its transport properties from the pool of the codec
+    // type and returns it if the properties change or if it is disconnected (the
+    // codecs are created by the main thread whenever a pool runs empty, a channel
+    // waits without a codec until one is available)
+    OpusCustomMode*            OpusMode;
+    OpusCustomMode*            Opus64Mode;
+    CVector<SOpusCodec*>       vecpOpusCodecs; // all created codecs
+    CVector<SOpusCodec*>       vecpOpusCodecPools[NUM_OPUS_CODEC_POOLS];
+    bool                       bOpusCodecRequested[NUM_OPUS_CODEC_POOLS];
+    CVector<SOpusCodec*>       vecpChanOpusCodec; // codec per channel ID
+    CVector<CConvBuf<int16_t>> DoubleFrameSizeConvBufIn;
+    CVector<CConvBuf<int16_t>> DoubleFrameSizeConvBufOut;
 
     CVector<QString> vstrChatColors;
     CVector<int>     vecChanIDsCurConChan;
@@ -264,6 +363,15 @@ protected:
     CVector<CVector<float>>   vecvecfIntermediateProcBuf;
     CVector<CVector<uint8_t>> vecvecbyCodedData;
 
+    // received coded data, kept for forwarding it unchanged
+    CVector<CVector<CVector<uint8_t>>> vecvecvecbyRecCodedData;
+    CVector<int>                       vecRecCeltNumCodedBytes;
+    CVector<int>                       vecNumRecCodedBlocks;
+
+    // sources which contribute to a mix, silent frames and zero gains are skipped
+    CVector<int>          vecIsSilentFrame;
+    CVector<CVector<int>> vecvecActiveSources;
+
     // Channel levels
     CVector<uint16_t> vecChannelLevels;
 
@@ -276,6 +384,42 @@ protected:
     // channel level update frame interval counter
     int iFrameCount;
 
+    // frame timing statistics, the phase times of the current frame are
+    // collected from all threads and added to the histograms at the end of
+    // the frame
+    QElapsedTimer        FrameTimingTimer;
+    std::atomic<int64_t> FramePhaseNs[SFP_NUM_PHASES];
+    CTimingHistogram     FrameTimingHistograms[SFP_NUM_PHASES];
+    std::atomic<int64_t> iNumFrameDeadlineMisses;
+
+    // frame load for the admission control, the cost of a channel is the time
+    // for decoding its stream and for mixing, encoding and sending its mix
+    CVector<int64_t>                        vecChannelFrameNs; // cost in the current frame per connected channel
+    CVector<double>                         vecdChannelCostNs; // moving average of the cost per channel ID
+    std::unique_ptr<std::atomic<int64_t>[]> vecChannelCostNs;  // moving average as read by the JSON-RPC
+    double                                  dAvgFrameNs;
+    double                                  dAvgSumChannelCostNs;
+    std::atomic<int64_t>                    iAvgFrameNs;
+    std::atomic<int64_t>                    iNewChannelFrameNs; // projected frame time increase by one more channel
+    std::atomic<int64_t>                    iProjectedFrameNs;
+    int                                     iMaxFrameLoadPercent;
+
+    // encoder complexity control and the encoder settings last applied per
+    // channel, so that the settings are only changed if required
+    std::atomic<int>            iEncComplLevel;
+    double                      dEncComplCtrlFrameNs;
+    int                         iEncComplCtrlHoldFrames;
+    int                         iEncComplCtrlLowLoadFrames;
+    CVector<OpusCustomEncoder*> vecpLastOpusEncoder;
+    CVector<int>                vecLastOpusBitRate;
+    CVector<int>                vecLastOpusComplexity;
+
+    // network frame size factors suggested per channel ID for adaptive packetisation
+    // (atomic since they are reset for a new connection and read by the JSON-RPC)
+    std::unique_ptr<std::atomic<int>[]> vecNetwFrameSizeSugg;
+    int                                 iNumNetwFrameSizeSugg;
+    int                                 iNetwFrameSizeSuggHoldFrames;
+
     // HTML file server status
     bool    bWriteStatusHTMLFile;
     QString strServerHTMLFileListName;
@@ -298,6 +442,10 @@ protected:
     // enable IPv6
     bool bEnableIPv6;
 
+    // no network, the packets are put by the packet trace replay
+    bool bOffline;
+    bool bOfflineRunning;
+
     // messaging
     QString      strWelcomeMessage;
     ELicenceType eLicenceType;
@@ -310,13 +458,7 @@ protected:
 signals:
     void Started();
     void Stopped();
-    void ClientDisconnected ( const int iChID );
     void SvrRegStatusChanged();
-    void AudioFrame ( const int              iChID,
-                      const QString          stChName,
-                      const CHostAddress     RecHostAddr,
-                      const int              iNumAudChan,
-                      const CVector<int16_t> vecsData );
 
     void CLVersionAndOSReceived ( CHostAddress InetAddr, COSUtil::EOpSystemType eOSType, QString strVersion );
 
@@ -326,18 +468,25 @@ signals:
     void RecordingSessionStarted ( QString sessionDir );
     void EndRecorderThread();
 
+    // a pool of OPUS codecs is empty, the codec is created outside of the frame processing
+    void OpusCodecRequested ( int iAudComprType, int iNumAudioChannels );
+
 public slots:
     void OnTimer();
 
+    void OnOpusCodecRequested ( int iAudComprType, int iNumAudioChannels );
+
     void OnNewConnection ( int iChID, int iTotChans, CHostAddress RecHostAddr );
 
+    void OnChanListChanged();
+
     void OnServerFull ( CHostAddress RecHostAddr );
 
     void OnSendCLProtMessage ( CHostAddress InetAddr, CVector<uint8_t> vecMessage );
 
-    void OnProtocolCLMessageReceived ( int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress RecHostAddr );
+    void OnProtocolCLMessageReceived ( int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress RecHostAddr );
 
-    void OnProtocolMessageReceived ( int iRecCounter, int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress RecHostAddr );
+    void OnProtocolMessageReceived ( int iRecCounter, int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress RecHostAddr );
 
     void OnCLPingReceived ( CHostAddress InetAddr, int iMs ) { ConnLessProtocol.CreateCLPingMes ( InetAddr, iMs ); }
 
@@ -385,5 +534,3 @@ public slots:
 
     void OnHandledSignal ( int sigNum );
 };
-
-Q_DECLARE_METATYPE ( CVector<int16_t> )
@@ -62,6 +62,20 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
     /// @result {string} result.clients[*].name - The client’s name.
     /// @result {number} result.clients[*].jitterBufferSize - The client’s jitter buffer size.
     /// @result {number} result.clients[*].channels - The number of audio channels of the client.
+    /// @result {number} result.clients[*].costUs - The average processing time of the client per frame in microseconds.
+    /// @result {number} result.clients[*].frameSizeFactor - The network frame size factor of the client.
+    /// @result {number} result.clients[*].suggestedFrameSizeFactor - The frame size factor suggested to the client due to high load (0 if none).
+    /// @result {object} result.clients[*].network - The network statistics of the client since it connected.
+    /// @result {number} result.clients[*].network.packets - The number of received audio packets.
+    /// @result {number} result.clients[*].network.lost - The number of lost packets (only known if the client sends sequence numbers).
+    /// @result {number} result.clients[*].network.duplicates - The number of packets received more than once.
+    /// @result {number} result.clients[*].network.reordered - The number of packets received after a later packet.
+    /// @result {number} result.clients[*].network.late - The number of packets received after their play out time.
+    /// @result {number} result.clients[*].network.overruns - The number of packets which did not fit into the jitter buffer.
+    /// @result {number} result.clients[*].network.underruns - The number of frames for which the jitter buffer had no data.
+    /// @result {number} result.clients[*].network.jitterUs - The inter-arrival jitter in microseconds (see RFC 3550).
+    /// @result {number} result.clients[*].network.bufferedFrames - The number of frames currently in the jitter buffer.
+    /// @result {number} result.clients[*].network.upstreamKbps - The received audio bit rate in kbit/s (without IP/UDP headers).
     pRpcServer->HandleMethod ( "jamulusserver/getClients", [=] ( const QJsonObject& params, QJsonObject& response ) {
         QJsonArray            clients;
         CVector<CHostAddress> vecHostAddresses;
@@ -87,6 +101,10 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
                 { "name", vecsName[i] },
                 { "jitterBufferSize", veciJitBufNumFrames[i] },
                 { "channels", pServer->GetClientNumAudioChannels ( i ) },
+                { "costUs", static_cast<double> ( pServer->GetClientCostNs ( i ) ) / 1000 },
+                { "frameSizeFactor", veciNetwFrameSizeFact[i] },
+                { "suggestedFrameSizeFactor", pServer->GetClientNetwFrameSizeSugg ( i ) },
+                { "network", SerializeNetStats ( pServer->GetClientNetStats ( i ) ) },
             };
             clients.append ( client );
         }
@@ -99,6 +117,63 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
         Q_UNUSED ( params );
     } );
 
+    /// @rpc_method jamulusserver/getPerformance
+    /// @brief Returns timing statistics of the server frame processing since the server start or the last reset.
+    /// @param {boolean} params.reset - Optional. If true, the statistics are reset after reading them.
+    /// @result {number} result.frameDeadlineUs - The time available for processing one frame in microseconds.
+    /// @result {number} result.frames - The number of processed frames (frames without connected clients are not counted).
+    /// @result {number} result.deadlineMisses - The number of frames which took longer than the frame deadline.
+    /// @result {number} result.deadlineMissRate - The ratio of deadline misses to processed frames.
+    /// @result {number} result.averageFrameUs - The moving average of the frame processing time in microseconds.
+    /// @result {number} result.projectedFrameUs - The projected frame processing time with one more client in microseconds.
+    /// @result {number} result.maxFrameLoad - The percentage of the frame deadline above which new clients are refused (0 if disabled).
+    /// @result {number} result.encoderComplexityLevel - The encoder complexity reduction due to high load (0 is full quality).
+    /// @result {object} result.phases - The timing per frame phase (channelScan, decode, levels, mix, encode, send, recorder, frame).
+    ///  The decode, mix, encode and send times are summed over all channels and threads.
+    /// @result {number} result.phases.*.p50Us - The median time per frame in microseconds.
+    /// @result {number} result.phases.*.p99Us - The 99th percentile of the time per frame in microseconds.
+    /// @result {number} result.phases.*.maxUs - The maximum time per frame in microseconds.
+    /// @result {number} result.phases.*.meanUs - The mean time per frame in microseconds.
+    pRpcServer->HandleMethod ( "jamulusserver/getPerformance", [=] ( const QJsonObject& params, QJsonObject& response ) {
+        auto jsonReset = params["reset"];
+        if ( !jsonReset.isUndefined() && !jsonReset.isBool() )
+        {
+            response["error"] = CRpcServer::CreateJsonRpcError ( CRpcServer::iErrInvalidParams, "Invalid params: reset is not a boolean" );
+            return;
+        }
+
+        QJsonObject phases;
+
+        for ( int i = 0; i < SFP_NUM_PHASES; i++ )
+        {
+            const EServerFramePhase ePhase = static_cast<EServerFramePhase> ( i );
+
+            phases[SerializeFramePhase ( ePhase )] = SerializeTimingHistogram ( pServer->GetFrameTimingHistogram ( ePhase ) );
+        }
+
+        const int64_t iNumFrames         = pServer->GetFrameTimingHistogram ( SFP_FRAME ).GetCount();
+        const int64_t iNumDeadlineMisses = pServer->GetNumFrameDeadlineMisses();
+
+        QJsonObject result{
+            { "frameDeadlineUs", static_cast<double> ( pServer->GetFrameDeadlineNs() ) / 1000 },
+            { "frames", static_cast<double> ( iNumFrames ) },
+            { "deadlineMisses", static_cast<double> ( iNumDeadlineMisses ) },
+            { "deadlineMissRate", ( iNumFrames > 0 ) ? static_cast<double> ( iNumDeadlineMisses ) / iNumFrames : 0.0 },
+            { "averageFrameUs", static_cast<double> ( pServer->GetAvgFrameNs() ) / 1000 },
+            { "projectedFrameUs", static_cast<double> ( pServer->GetProjectedFrameNs() ) / 1000 },
+            { "maxFrameLoad", pServer->GetMaxFrameLoad() },
+            { "encoderComplexityLevel", pServer->GetEncoderComplexityLevel() },
+            { "phases", phases },
+        };
+
+        if ( jsonReset.toBool() )
+        {
+            pServer->ResetFrameTiming();
+        }
+
+        response["result"] = result;
+    } );
+
     /// @rpc_method jamulusserver/getServerProfile
     /// @brief Returns the server registration profile and status.
     /// @param {object} params - No parameters (empty object).
@@ -208,6 +283,101 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
         response["result"] = "acknowledged";
         Q_UNUSED ( params );
     } );
+
+    /// @rpc_method jamulusserver/startTrace
+    /// @brief Starts recording the trace events of the server threads, previously recorded events are discarded.
+    /// @param {object} params - No parameters (empty object).
+    /// @result {string} result - Always "ok".
+    pRpcServer->HandleMethod ( "jamulusserver/startTrace", [=] ( const QJsonObject& params, QJsonObject& response ) {
+        CTraceEvents::Disable();
+        CTraceEvents::Enable();
+        response["result"] = "ok";
+        Q_UNUSED ( params );
+    } );
+
+    /// @rpc_method jamulusserver/stopTrace
+    /// @brief Stops recording the trace events and writes them in the Chrome trace event format.
+    /// @param {string} params.fileName - The file to write, it can be opened in chrome://tracing or https://ui.perfetto.dev.
+    /// @result {string} result - Always "ok".
+    pRpcServer->HandleMethod ( "jamulusserver/stopTrace", [=] ( const QJsonObject& params, QJsonObject& response ) {
+        auto jsonFileName = params["fileName"];
+        if ( !jsonFileName.isString() )
+        {
+            response["error"] = CRpcServer::CreateJsonRpcError ( CRpcServer::iErrInvalidParams, "Invalid params: fileName is not a string" );
+            return;
+        }
+
+        CTraceEvents::Disable();
+
+        if ( !CTraceEvents::WriteChromeTrace ( jsonFileName.toString() ) )
+        {
+            response["error"] = CRpcServer::CreateJsonRpcError ( CRpcServer::iErrInternalError, "Cannot write the trace file" );
+            return;
+        }
+
+        response["result"] = "ok";
+    } );
+}
+
+QString CServerRpc::SerializeFramePhase ( EServerFramePhase eFramePhase )
+{
+    switch ( eFramePhase )
+    {
+    case SFP_CHANNEL_SCAN:
+        return "channelScan";
+
+    case SFP_DECODE:
+        return "decode";
+
+    case SFP_LEVELS:
+        return "levels";
+
+    case SFP_MIX:
+        return "mix";
+
+    case SFP_ENCODE:
+        return "encode";
+
+    case SFP_SEND:
+        return "send";
+
+    case SFP_RECORDER:
+        return "recorder";
+
+    case SFP_FRAME:
+        return "frame";
+
+    case SFP_NUM_PHASES:
+        break;
+    }
+
+    return QString ( "unknown(%1)" ).arg ( eFramePhase );
+}
+
+QJsonObject CServerRpc::SerializeTimingHistogram ( const CTimingHistogram& TimingHistogram )
+{
+    return QJsonObject{
+        { "p50Us", static_cast<double> ( TimingHistogram.GetPercentileNs ( 50 ) ) / 1000 },
+        { "p99Us", static_cast<double> ( TimingHistogram.GetPercentileNs ( 99 ) ) / 1000 },
+        { "maxUs", static_cast<double> ( TimingHistogram.GetMaxNs() ) / 1000 },
+        { "meanUs", TimingHistogram.GetMeanNs() / 1000 },
+    };
+}
+
+QJsonObject CServerRpc::SerializeNetStats ( const CChannelNetStats& NetStats )
+{
+    return QJsonObject{
+        { "packets", static_cast<double> ( NetStats.iNumPackets.load ( std::memory_order_relaxed ) ) },
+        { "lost", static_cast<double> ( NetStats.iNumLost.load ( std::memory_order_relaxed ) ) },
+        { "duplicates", static_cast<double> ( NetStats.iNumDuplicates.load ( std::memory_order_relaxed ) ) },
+        { "reordered", static_cast<double> ( NetStats.iNumReordered.load ( std::memory_order_relaxed ) ) },
+        { "late", static_cast<double> ( NetStats.iNumLate.load ( std::memory_order_relaxed ) ) },
+        { "overruns", static_cast<double> ( NetStats.iNumOverruns.load ( std::memory_order_relaxed ) ) },
+        { "underruns", static_cast<double> ( NetStats.iNumUnderruns.load ( std::memory_order_relaxed ) ) },
+        { "jitterUs", NetStats.iJitterUs.load ( std::memory_order_relaxed ) },
+        { "bufferedFrames", NetStats.iNumBufferedFrames.load ( std::memory_order_relaxed ) },
+        { "upstreamKbps", NetStats.iUpstreamKbps.load ( std::memory_order_relaxed ) },
+    };
 }
 
 QJsonValue CServerRpc::SerializeRegistrationStatus ( ESvrRegStatus eSvrRegStatus )
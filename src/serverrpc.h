@@ -35,5 +35,8 @@ class CServerRpc : public QObject
 
 public:
     CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* parent = nullptr );
-    static QJsonValue SerializeRegistrationStatus ( ESvrRegStatus eSvrRegStatus );
+    static QJsonValue  SerializeRegistrationStatus ( ESvrRegStatus eSvrRegStatus );
+    static QString     SerializeFramePhase ( EServerFramePhase eFramePhase );
+    static QJsonObject SerializeTimingHistogram ( const CTimingHistogram& TimingHistogram );
+    static QJsonObject SerializeNetStats ( const CChannelNetStats& NetStats );
 };
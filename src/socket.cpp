@@ -44,7 +44,9 @@ CSocket::CSocket ( CChannel* pNewChannel, const quint16 iPortNumber, const quint
     pChannel ( pNewChannel ),
     bIsClient ( true ),
     bJitterBufferOK ( true ),
-    bEnableIPv6 ( bEnableIPv6 )
+    bEnableIPv6 ( bEnableIPv6 ),
+    bOffline ( false ),
+    bTraceCapture ( false )
 {
     Init ( iPortNumber, iQosNumber, strServerBindIP );
 
@@ -56,11 +58,18 @@ CSocket::CSocket ( CChannel* pNewChannel, const quint16 iPortNumber, const quint
     QObject::connect ( this, static_cast<void ( CSocket::* )()> ( &CSocket::NewConnection ), pChannel, &CChannel::OnNewConnection );
 }
 
-CSocket::CSocket ( CServer* pNServP, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 ) :
+CSocket::CSocket ( CServer*       pNServP,
+                   const quint16  iPortNumber,
+                   const quint16  iQosNumber,
+                   const QString& strServerBindIP,
+                   bool           bEnableIPv6,
+                   bool           bNOffline ) :
     pServer ( pNServP ),
     bIsClient ( false ),
     bJitterBufferOK ( true ),
-    bEnableIPv6 ( bEnableIPv6 )
+    bEnableIPv6 ( bEnableIPv6 ),
+    bOffline ( bNOffline ),
+    bTraceCapture ( false )
 {
     Init ( iPortNumber, iQosNumber, strServerBindIP );
 
@@ -89,6 +98,13 @@ void CSocket::Init ( const quint16 iNewPortNumber, const quint16 iNewQosNumber,
     iQosNumber      = iNewQosNumber;
     strServerBindIP = strNewServerBindIP;
 
+    // an offline socket only needs the receive buffer
+    if ( bOffline )
+    {
+        vecbyRecBuf.Init ( MAX_SIZE_BYTES_NETW_BUF );
+        return;
+    }
+
 #ifdef _WIN32
     // for the Windows socket usage we have to start it up first
 
@@ -227,6 +243,11 @@ void CSocket::Init ( const quint16 iNewPortNumber, const quint16 iNewQosNumber,
 
 void CSocket::Close()
 {
+    if ( bOffline )
+    {
+        return;
+    }
+
 #ifdef _WIN32
     // closesocket will cause recvfrom to return with an error because the
     // socket is closed -> then the thread can safely be shut down
@@ -242,6 +263,11 @@ void CSocket::Close()
 
 CSocket::~CSocket()
 {
+    if ( bOffline )
+    {
+        return;
+    }
+
     // cleanup the socket (on Windows the WSA cleanup must also be called)
 #ifdef _WIN32
     closesocket ( UdpSocket );
@@ -257,6 +283,12 @@ void CSocket::SendPacket ( const CVector<uint8_t>& vecbySendBuf, const CHostAddr
 
     uSockAddr UdpSocketAddr;
 
+    // a replayed packet trace must not be answered to the recorded addresses
+    if ( bOffline )
+    {
+        return;
+    }
+
     memset ( &UdpSocketAddr, 0, sizeof ( UdpSocketAddr ) );
 
     QMutexLocker locker ( &Mutex );
@@ -381,6 +413,8 @@ void CSocket::OnDataReceived()
         return;
     }
 
+    CTraceScope TraceScope ( "socket/receive" );
+
     if ( UdpSocketAddr.sa.sa_family == AF_INET6 )
     {
         if ( IN6_IS_ADDR_V4MAPPED ( &( UdpSocketAddr.sa6.sin6_addr ) ) )
@@ -401,14 +435,64 @@ void CSocket::OnDataReceived()
         RecHostAddr.iPort = ntohs ( UdpSocketAddr.sa4.sin_port );
     }
 
-    // check if this is a protocol message
-    int              iRecCounter;
-    int              iRecID;
-    CVector<uint8_t> vecbyMesBodyData;
+    // the datagram is only copied into the ring buffer of the capture, the file is
+    // written by the capture thread
+    if ( bTraceCapture.load ( std::memory_order_acquire ) )
+    {
+        pTraceCapture->Put ( RecHostAddr, &vecbyRecBuf[0], static_cast<int> ( iNumBytesRead ) );
+    }
 
-    if ( !CProtocol::ParseMessageFrame ( vecbyRecBuf, iNumBytesRead, vecbyMesBodyData, iRecCounter, iRecID ) )
+    ProcessReceivedPacket ( iNumBytesRead );
+}
+
+void CSocket::PutReceivedPacket ( const CVector<uint8_t>& vecbyData, const int iNumBytes, const CHostAddress& HostAddr )
+{
+    // the packet is processed as if it was received from the network
+    std::copy ( vecbyData.begin(), vecbyData.begin() + iNumBytes, vecbyRecBuf.begin() );
+    RecHostAddr = HostAddr;
+
+    ProcessReceivedPacket ( iNumBytes );
+}
+
+bool CSocket::StartTraceCapture ( const QString& strFileName )
+{
+    // the capture is used by the receive thread without locking, so it is never replaced
+    if ( bTraceCapture )
     {
-        // this is a protocol message, check the type of the message
+        return false;
+    }
+
+    pTraceCapture.reset ( new CPacketTraceCapture() );
+
+    if ( !pTraceCapture->Start ( strFileName ) )
+    {
+        pTraceCapture.reset();
+        return false;
+    }
+
+    bTraceCapture.store ( true, std::memory_order_release );
+
+    return true;
+}
+
+void CSocket::ProcessReceivedPacket ( const long iNumBytesRead )
+{
+    // check if this is a protocol message (the frame is checked directly in
+    // the receive buffer)
+    int iRecCounter;
+    int iRecID;
+    int iRecLenBy;
+
+    if ( !CProtocol::ParseMessageFrame ( &vecbyRecBuf[0], iNumBytesRead, iRecCounter, iRecID, iRecLenBy ) )
+    {
+        // this is a protocol message, copy the message body out of the receive
+        // buffer since the data is processed in another thread
+        const uint8_t*   pbyMesBody = &vecbyRecBuf[MESS_HEADER_LENGTH_BYTE];
+        CVector<uint8_t> vecbyMesBodyData;
+
+        vecbyMesBodyData.assign ( pbyMesBody, pbyMesBody + iRecLenBy );
+
+        // check the type of the message
         if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
         {
             //### TODO: BEGIN ###//
@@ -28,9 +28,11 @@
 #include <QThread>
 #include <QMutex>
 #include <vector>
+#include <memory>
 #include "global.h"
 #include "protocol.h"
 #include "util.h"
+#include "packettrace.h"
 #ifndef _WIN32
 #    include <netinet/in.h>
 #    include <sys/socket.h>
@@ -54,7 +56,12 @@ class CSocket : public QObject
 
 public:
     CSocket ( CChannel* pNewChannel, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 );
-    CSocket ( CServer* pNServP, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 );
+    CSocket ( CServer*       pNServP,
+              const quint16  iPortNumber,
+              const quint16  iQosNumber,
+              const QString& strServerBindIP,
+              bool           bEnableIPv6,
+              bool           bNOffline );
 
     virtual ~CSocket();
 
@@ -63,8 +70,15 @@ public:
     bool GetAndResetbJitterBufferOKFlag();
     void Close();
 
+    // an offline socket does not use the network, the received packets are put by the packet trace replay
+    bool IsOffline() const { return bOffline; }
+    void PutReceivedPacket ( const CVector<uint8_t>& vecbyData, const int iNumBytes, const CHostAddress& HostAddr );
+
+    bool StartTraceCapture ( const QString& strFileName );
+
 protected:
     void    Init ( const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP );
+    void    ProcessReceivedPacket ( const long iNumBytesRead );
     quint16 iPortNumber;
     quint16 iQosNumber;
     QString strServerBindIP;
@@ -91,6 +105,12 @@ protected:
 
     bool bEnableIPv6;
 
+    bool bOffline;
+
+    // packet trace capture of the received datagrams (can only be started once)
+    std::atomic<bool>                    bTraceCapture;
+    std::unique_ptr<CPacketTraceCapture> pTraceCapture;
+
 public:
     void OnDataReceived();
 
@@ -104,9 +124,9 @@ signals:
 
     void InvalidPacketReceived ( CHostAddress RecHostAddr );
 
-    void ProtocolMessageReceived ( int iRecCounter, int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress HostAdr );
+    void ProtocolMessageReceived ( int iRecCounter, int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress HostAdr );
 
-    void ProtocolCLMessageReceived ( int iRecID, CVector<uint8_t> vecbyMesBodyData, CHostAddress HostAdr );
+    void ProtocolCLMessageReceived ( int iRecID, const CVector<uint8_t>& vecbyMesBodyData, CHostAddress HostAdr );
 };
 
 /* Socket which runs in a separate high priority thread --------------------- */
@@ -131,8 +151,13 @@ public:
         Init();
     }
 
-    CHighPrioSocket ( CServer* pNewServer, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 ) :
-        Socket ( pNewServer, iPortNumber, iQosNumber, strServerBindIP, bEnableIPv6 )
+    CHighPrioSocket ( CServer*       pNewServer,
+                      const quint16  iPortNumber,
+                      const quint16  iQosNumber,
+                      const QString& strServerBindIP,
+                      bool           bEnableIPv6,
+                      bool           bOffline ) :
+        Socket ( pNewServer, iPortNumber, iQosNumber, strServerBindIP, bEnableIPv6, bOffline )
     {
         Init();
     }
@@ -142,14 +167,24 @@ public:
     void Start()
     {
         // starts the high priority socket receive thread (with using blocking
-        // socket request call)
-        NetworkWorkerThread.start ( QThread::TimeCriticalPriority );
+        // socket request call), an offline socket has nothing to receive
+        if ( !Socket.IsOffline() )
+        {
+            NetworkWorkerThread.start ( QThread::TimeCriticalPriority );
+        }
     }
 
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf, const CHostAddress& HostAddr ) { Socket.SendPacket ( vecbySendBuf, HostAddr ); }
 
     bool GetAndResetbJitterBufferOKFlag() { return Socket.GetAndResetbJitterBufferOKFlag(); }
 
+    void PutReceivedPacket ( const CVector<uint8_t>& vecbyData, const int iNumBytes, const CHostAddress& HostAddr )
+    {
+        Socket.PutReceivedPacket ( vecbyData, iNumBytes, HostAddr );
+    }
+
+    bool StartTraceCapture ( const QString& strFileName ) { return Socket.StartTraceCapture ( strFileName ); }
+
 protected:
     class CSocketThread : public QThread
     {
@@ -176,6 +211,8 @@ protected:
     protected:
         void run()
         {
+            CTraceEvents::SetThreadName ( "socket" );
+
             // make sure the socket pointer is initialized (should be always the
             // case)
             if ( pSocket != nullptr )
@@ -0,0 +1,609 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+   Encode tests of the FLAC recording format. Known PCM buffers are encoded
+   with CFlacStream and the stream is checked by an independent decoder: the
+   STREAMINFO block, the CRC-8 of each frame header and the CRC-16 of each
+   frame (both computed bit by bit) and the decoded samples which must be
+   identical to the input. If the flac command line tool is installed, the
+   streams are also tested with "flac -t".
+
+   Build and run headless:
+       qmake KoordTest.pro && make && ./KoordTest
+*/
+
+#include <QBuffer>
+#include <QDir>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <cmath>
+#include "global.h"
+#include "util.h"
+#include "recorder/cflacstream.h"
+#include "tests.h"
+
+using namespace recorder;
+
+/* Decoder ********************************************************************/
+// MSB first bit reader, reads zeros after the end of the data
+class CFlacBitReader
+{
+public:
+    CFlacBitReader ( const QByteArray& baNIn, const int iBytePos ) : in ( baNIn ), iBitPos ( 8 * static_cast<int64_t> ( iBytePos ) ) {}
+
+    bool IsOverrun() const { return iBitPos > 8 * static_cast<int64_t> ( in.size() ); }
+    int  GetBytePos() const { return static_cast<int> ( iBitPos >> 3 ); }
+    void AlignToByte() { iBitPos = ( iBitPos + 7 ) & ~static_cast<int64_t> ( 7 ); }
+
+    uint32_t Get ( const int iBits )
+    {
+        uint32_t iValue = 0;
+
+        for ( int i = 0; i < iBits; i++, iBitPos++ )
+        {
+            const int64_t iByte = iBitPos >> 3;
+            const int     iBit =
+                ( iByte < in.size() ) ? ( static_cast<uint8_t> ( in[static_cast<int> ( iByte )] ) >> ( 7 - ( iBitPos & 7 ) ) ) & 1 : 0;
+
+            iValue = ( iValue << 1 ) | static_cast<uint32_t> ( iBit );
+        }
+
+        return iValue;
+    }
+
+    int32_t GetSigned ( const int iBits )
+    {
+        if ( iBits == 0 )
+        {
+            return 0;
+        }
+
+        return static_cast<int32_t> ( Get ( iBits ) << ( 32 - iBits ) ) >> ( 32 - iBits );
+    }
+
+    int32_t GetRice ( const int iParam )
+    {
+        uint32_t iNumZeros = 0;
+
+        while ( !IsOverrun() && ( Get ( 1 ) == 0 ) )
+        {
+            iNumZeros++;
+        }
+
+        const uint32_t iFolded = ( iNumZeros << iParam ) | Get ( iParam );
+
+        return static_cast<int32_t> ( iFolded >> 1 ) ^ -static_cast<int32_t> ( iFolded & 1 );
+    }
+
+protected:
+    const QByteArray& in;
+    int64_t           iBitPos;
+};
+
+// CRC with initial value zero, processed bit by bit MSB first
+static uint32_t GetBitSerialCRC ( const QByteArray& baData, const int iStart, const int iEnd, const int iWidth, const uint32_t iPoly )
+{
+    const uint32_t iTopBit = 1u << ( iWidth - 1 );
+    const uint32_t iMask   = ( 1u << iWidth ) - 1;
+    uint32_t       iReg    = 0;
+
+    for ( int i = iStart; i < iEnd; i++ )
+    {
+        for ( int iBit = 7; iBit >= 0; iBit-- )
+        {
+            const bool bFeedback = ( ( iReg & iTopBit ) != 0 ) != ( ( ( static_cast<uint8_t> ( baData[i] ) >> iBit ) & 1 ) != 0 );
+
+            iReg = ( ( iReg << 1 ) & iMask ) ^ ( bFeedback ? iPoly : 0 );
+        }
+    }
+
+    return iReg;
+}
+
+static bool DecodeSubframe ( CFlacBitReader& Reader, const int iBlockSize, const int iBps, CVector<int32_t>& vecData, QString& strError )
+{
+    vecData.Init ( iBlockSize );
+
+    if ( Reader.Get ( 1 ) != 0 )
+    {
+        strError = "subframe padding bit is set";
+        return false;
+    }
+
+    const uint32_t iType = Reader.Get ( 6 );
+
+    if ( Reader.Get ( 1 ) != 0 )
+    {
+        strError = "unexpected wasted bits";
+        return false;
+    }
+
+    if ( iType == 0 ) // constant
+    {
+        const int32_t iValue = Reader.GetSigned ( iBps );
+
+        for ( int i = 0; i < iBlockSize; i++ )
+        {
+            vecData[i] = iValue;
+        }
+
+        return true;
+    }
+
+    if ( iType == 1 ) // verbatim
+    {
+        for ( int i = 0; i < iBlockSize; i++ )
+        {
+            vecData[i] = Reader.GetSigned ( iBps );
+        }
+
+        return true;
+    }
+
+    if ( ( iType < 8 ) || ( iType > 12 ) )
+    {
+        strError = QString ( "unexpected subframe type %1" ).arg ( iType );
+        return false;
+    }
+
+    // fixed predictor
+    const int iOrder = static_cast<int> ( iType - 8 );
+
+    for ( int i = 0; i < iOrder; i++ )
+    {
+        vecData[i] = Reader.GetSigned ( iBps );
+    }
+
+    const uint32_t iMethod = Reader.Get ( 2 );
+
+    if ( iMethod > 1 )
+    {
+        strError = "reserved residual coding method";
+        return false;
+    }
+
+    const int iParamBits       = ( iMethod == 0 ) ? 4 : 5;
+    const int iEscapeParam     = ( 1 << iParamBits ) - 1;
+    const int iPartitionOrder  = static_cast<int> ( Reader.Get ( 4 ) );
+    const int iPartSize        = iBlockSize >> iPartitionOrder;
+    int       iSample          = iOrder;
+    CVector<int32_t> vecResidual ( iBlockSize, 0 );
+
+    if ( ( iPartSize << iPartitionOrder != iBlockSize ) || ( iPartSize < iOrder ) )
+    {
+        strError = "invalid partition order";
+        return false;
+    }
+
+    for ( int iPart = 0; iPart < ( 1 << iPartitionOrder ); iPart++ )
+    {
+        const int iParam = static_cast<int> ( Reader.Get ( iParamBits ) );
+        const int iEnd   = ( iPart + 1 ) * iPartSize;
+
+        if ( iParam == iEscapeParam )
+        {
+            const int iRawBits = static_cast<int> ( Reader.Get ( 5 ) );
+
+            for ( ; iSample < iEnd; iSample++ )
+            {
+                vecResidual[iSample] = Reader.GetSigned ( iRawBits );
+            }
+        }
+        else
+        {
+            for ( ; iSample < iEnd; iSample++ )
+            {
+                vecResidual[iSample] = Reader.GetRice ( iParam );
+            }
+        }
+    }
+
+    for ( int i = iOrder; i < iBlockSize; i++ )
+    {
+        switch ( iOrder )
+        {
+        case 0:
+            vecData[i] = vecResidual[i];
+            break;
+        case 1:
+            vecData[i] = vecResidual[i] + vecData[i - 1];
+            break;
+        case 2:
+            vecData[i] = vecResidual[i] + 2 * vecData[i - 1] - vecData[i - 2];
+            break;
+        case 3:
+            vecData[i] = vecResidual[i] + 3 * vecData[i - 1] - 3 * vecData[i - 2] + vecData[i - 3];
+            break;
+        default:
+            vecData[i] = vecResidual[i] + 4 * vecData[i - 1] - 6 * vecData[i - 2] + 4 * vecData[i - 3] - vecData[i - 4];
+            break;
+        }
+    }
+
+    return true;
+}
+
+// decodes the frame at iPos (which is then moved behind the frame), the
+// interleaved samples are appended to vecsOut
+static bool DecodeFrame ( const QByteArray&  baStream,
+                          int&               iPos,
+                          const int          iNumChannels,
+                          const uint32_t     iExpFrameNumber,
+                          CVector<int16_t>&  vecsOut,
+                          QString&           strError )
+{
+    CFlacBitReader Reader ( baStream, iPos );
+
+    if ( Reader.Get ( 16 ) != 0xFFF8 )
+    {
+        strError = "no frame sync code with fixed block size";
+        return false;
+    }
+
+    const uint32_t iBlockSizeCode  = Reader.Get ( 4 );
+    const uint32_t iSampleRateCode = Reader.Get ( 4 );
+    const uint32_t iChanAssignment = Reader.Get ( 4 );
+    const uint32_t iSampleSizeCode = Reader.Get ( 3 );
+
+    if ( ( iSampleRateCode != 0x0A ) || ( iSampleSizeCode != 0x04 ) || ( Reader.Get ( 1 ) != 0 ) )
+    {
+        strError = "frame header is not 48 kHz, 16 bit";
+        return false;
+    }
+
+    // frame number (UTF-8 like coding)
+    uint32_t iFrameNumber = Reader.Get ( 8 );
+
+    if ( iFrameNumber & 0x80 )
+    {
+        int iNumLeadingOnes = 0;
+
+        while ( ( iNumLeadingOnes < 8 ) && ( iFrameNumber & ( 0x80 >> iNumLeadingOnes ) ) )
+        {
+            iNumLeadingOnes++;
+        }
+
+        iFrameNumber &= ( 1u << ( 7 - iNumLeadingOnes ) ) - 1;
+
+        for ( int i = 1; i < iNumLeadingOnes; i++ )
+        {
+            iFrameNumber = ( iFrameNumber << 6 ) | ( Reader.Get ( 8 ) & 0x3F );
+        }
+    }
+
+    if ( iFrameNumber != iExpFrameNumber )
+    {
+        strError = QString ( "frame number %1 instead of %2" ).arg ( iFrameNumber ).arg ( iExpFrameNumber );
+        return false;
+    }
+
+    int iBlockSize;
+
+    if ( iBlockSizeCode == 0x0C )
+    {
+        iBlockSize = 4096;
+    }
+    else if ( iBlockSizeCode == 0x07 )
+    {
+        iBlockSize = static_cast<int> ( Reader.Get ( 16 ) ) + 1;
+    }
+    else
+    {
+        strError = QString ( "unexpected block size code %1" ).arg ( iBlockSizeCode );
+        return false;
+    }
+
+    // the header is a multiple of bytes, the CRC-8 covers it from the sync code on
+    const uint32_t iHeaderCRC = GetBitSerialCRC ( baStream, iPos, Reader.GetBytePos(), 8, 0x07 );
+
+    if ( Reader.Get ( 8 ) != iHeaderCRC )
+    {
+        strError = "frame header CRC-8 mismatch";
+        return false;
+    }
+
+    const int iNumFrameChannels = ( iChanAssignment < 8 ) ? static_cast<int> ( iChanAssignment ) + 1 : 2;
+
+    if ( ( iNumFrameChannels != iNumChannels ) || ( iChanAssignment > 10 ) )
+    {
+        strError = QString ( "unexpected channel assignment %1" ).arg ( iChanAssignment );
+        return false;
+    }
+
+    CVector<CVector<int32_t>> vecvecData ( iNumChannels );
+
+    for ( int iCh = 0; iCh < iNumChannels; iCh++ )
+    {
+        // the side channel has one more bit
+        const bool bIsSide = ( ( iChanAssignment == 8 ) && ( iCh == 1 ) ) || ( ( iChanAssignment == 9 ) && ( iCh == 0 ) ) ||
+                             ( ( iChanAssignment == 10 ) && ( iCh == 1 ) );
+
+        if ( !DecodeSubframe ( Reader, iBlockSize, bIsSide ? 17 : 16, vecvecData[iCh], strError ) )
+        {
+            return false;
+        }
+    }
+
+    Reader.AlignToByte();
+
+    const uint32_t iFrameCRC = GetBitSerialCRC ( baStream, iPos, Reader.GetBytePos(), 16, 0x8005 );
+
+    if ( Reader.Get ( 16 ) != iFrameCRC )
+    {
+        strError = "frame CRC-16 mismatch";
+        return false;
+    }
+
+    if ( Reader.IsOverrun() )
+    {
+        strError = "frame exceeds the stream";
+        return false;
+    }
+
+    iPos = Reader.GetBytePos();
+
+    // undo the inter channel decorrelation
+    for ( int i = 0; i < iBlockSize; i++ )
+    {
+        if ( iChanAssignment == 8 ) // left/side
+        {
+            vecvecData[1][i] = vecvecData[0][i] - vecvecData[1][i];
+        }
+        else if ( iChanAssignment == 9 ) // side/right
+        {
+            vecvecData[0][i] = vecvecData[0][i] + vecvecData[1][i];
+        }
+        else if ( iChanAssignment == 10 ) // mid/side
+        {
+            const int32_t iMid  = vecvecData[0][i] * 2 | ( vecvecData[1][i] & 1 );
+            const int32_t iSide = vecvecData[1][i];
+
+            vecvecData[0][i] = ( iMid + iSide ) >> 1;
+            vecvecData[1][i] = ( iMid - iSide ) >> 1;
+        }
+
+        for ( int iCh = 0; iCh < iNumChannels; iCh++ )
+        {
+            vecsOut.Add ( static_cast<int16_t> ( vecvecData[iCh][i] ) );
+        }
+    }
+
+    return true;
+}
+
+/* Tests **********************************************************************/
+// encodes the interleaved samples like the jam recorder does it: the headers,
+// one frame per block and the total number of samples set at the end
+static QByteArray EncodeStream ( const CVector<int16_t>& vecsIn, const int iNumChannels )
+{
+    const int  iBlockSize = RECORDING_FLAC_BLOCK_SIZE_SAMPLES * iNumChannels;
+    QByteArray baStream;
+    QBuffer    Buffer ( &baStream );
+
+    Buffer.open ( QIODevice::ReadWrite );
+    Buffer.write ( CFlacStream::Headers ( iNumChannels ) );
+
+    for ( int iStart = 0, iFrame = 0; iStart < vecsIn.Size(); iStart += iBlockSize, iFrame++ )
+    {
+        CVector<int16_t> vecsBlock;
+
+        vecsBlock.assign ( vecsIn.begin() + iStart, vecsIn.begin() + std::min ( iStart + iBlockSize, vecsIn.Size() ) );
+
+        Buffer.write ( CFlacStream::EncodeFrame ( vecsBlock, iNumChannels, static_cast<uint32_t> ( iFrame ) ) );
+    }
+
+    CFlacStream::Finalise ( &Buffer, iNumChannels, vecsIn.Size() / iNumChannels );
+    Buffer.close();
+
+    return baStream;
+}
+
+static bool CheckStreamInfo ( const QByteArray& baStream, const int iNumChannels, const int64_t iNumSamples, QString& strError )
+{
+    // stream marker and the header of the last (and only) metadata block: STREAMINFO, 34 bytes
+    if ( !baStream.startsWith ( QByteArray ( "fLaC\x80\x00\x00\x22", 8 ) ) )
+    {
+        strError = "no stream marker or STREAMINFO header";
+        return false;
+    }
+
+    CFlacBitReader Reader ( baStream, 8 );
+
+    const uint32_t iMinBlockSize  = Reader.Get ( 16 );
+    const uint32_t iMaxBlockSize  = Reader.Get ( 16 );
+    const uint32_t iMinFrameSize  = Reader.Get ( 24 );
+    const uint32_t iMaxFrameSize  = Reader.Get ( 24 );
+    const uint32_t iSampleRate    = Reader.Get ( 20 );
+    const uint32_t iNumChannelsM1 = Reader.Get ( 3 );
+    const uint32_t iBpsM1         = Reader.Get ( 5 );
+    const int64_t  iTotalSamples  = ( static_cast<int64_t> ( Reader.Get ( 4 ) ) << 32 ) | Reader.Get ( 32 );
+
+    if ( ( iMinBlockSize != RECORDING_FLAC_BLOCK_SIZE_SAMPLES ) || ( iMaxBlockSize != RECORDING_FLAC_BLOCK_SIZE_SAMPLES ) || ( iMinFrameSize != 0 ) ||
+         ( iMaxFrameSize != 0 ) || ( iSampleRate != 48000 ) || ( iNumChannelsM1 != static_cast<uint32_t> ( iNumChannels - 1 ) ) || ( iBpsM1 != 15 ) ||
+         ( iTotalSamples != iNumSamples ) )
+    {
+        strError = "unexpected STREAMINFO";
+        return false;
+    }
+
+    return true;
+}
+
+// runs "flac -t" on the stream, returns true if the tool is not installed
+static bool CheckWithFlacTool ( const QByteArray& baStream, QString& strError )
+{
+    const QString strFlac = QStandardPaths::findExecutable ( "flac" );
+
+    if ( strFlac.isEmpty() )
+    {
+        return true;
+    }
+
+    QTemporaryFile File ( QDir::tempPath() + "/KoordTest-XXXXXX.flac" );
+
+    if ( !File.open() || ( File.write ( baStream ) != baStream.size() ) || !File.flush() )
+    {
+        strError = "cannot write the temporary file";
+        return false;
+    }
+
+    QProcess Process;
+
+    Process.start ( strFlac, { "-t", "-s", File.fileName() } );
+
+    if ( !Process.waitForFinished ( 30000 ) || ( Process.exitStatus() != QProcess::NormalExit ) || ( Process.exitCode() != 0 ) )
+    {
+        strError = "flac -t: " + QString::fromLocal8Bit ( Process.readAllStandardError() ).trimmed();
+        return false;
+    }
+
+    return true;
+}
+
+static bool TestStream ( const QString& strName, const CVector<int16_t>& vecsIn, const int iNumChannels )
+{
+    const QByteArray baStream = EncodeStream ( vecsIn, iNumChannels );
+    CVector<int16_t> vecsDecoded;
+    QString          strError;
+    int              iPos   = 8 + 34; // behind STREAMINFO
+    uint32_t         iFrame = 0;
+    bool             bOk    = CheckStreamInfo ( baStream, iNumChannels, vecsIn.Size() / iNumChannels, strError );
+
+    while ( bOk && ( iPos < baStream.size() ) )
+    {
+        bOk = DecodeFrame ( baStream, iPos, iNumChannels, iFrame++, vecsDecoded, strError );
+    }
+
+    if ( bOk && ( vecsDecoded != vecsIn ) )
+    {
+        strError = "decoded samples differ from the input";
+        bOk      = false;
+    }
+
+    if ( bOk )
+    {
+        // the length of a stream which was not finalised is taken from its last frame
+        QByteArray baCopy = baStream;
+        QBuffer    Buffer ( &baCopy );
+
+        Buffer.open ( QIODevice::ReadOnly );
+
+        if ( CFlacStream::GetNumSamples ( &Buffer ) != vecsIn.Size() / iNumChannels )
+        {
+            strError = "wrong number of samples from the last frame header";
+            bOk      = false;
+        }
+    }
+
+    if ( bOk )
+    {
+        bOk = CheckWithFlacTool ( baStream, strError );
+    }
+
+    if ( bOk )
+    {
+        qInfo() << qUtf8Printable ( QString ( "PASS %1: %2 frames, %3 bytes (%4 %)" )
+                                        .arg ( strName )
+                                        .arg ( iFrame )
+                                        .arg ( baStream.size() )
+                                        .arg ( 100.0 * baStream.size() / ( 2 * vecsIn.Size() ), 0, 'f', 1 ) );
+    }
+    else
+    {
+        qCritical() << qUtf8Printable ( QString ( "FAIL %1: %2" ).arg ( strName, strError ) );
+    }
+
+    return bOk;
+}
+
+// a single frame with a frame number which needs the longest coding
+static bool TestFrameNumber()
+{
+    const uint32_t   iFrameNumber = 0x7FFFFFFF;
+    CVector<int16_t> vecsIn ( 2 * 100 );
+    CVector<int16_t> vecsDecoded;
+    QString          strError;
+    int              iPos = 0;
+
+    for ( int i = 0; i < vecsIn.Size(); i++ )
+    {
+        vecsIn[i] = static_cast<int16_t> ( i * 37 );
+    }
+
+    const QByteArray baFrame = CFlacStream::EncodeFrame ( vecsIn, 2, iFrameNumber );
+
+    if ( !DecodeFrame ( baFrame, iPos, 2, iFrameNumber, vecsDecoded, strError ) || ( vecsDecoded != vecsIn ) || ( iPos != baFrame.size() ) )
+    {
+        qCritical() << qUtf8Printable ( QString ( "FAIL frame number: %1" ).arg ( strError ) );
+        return false;
+    }
+
+    qInfo() << "PASS frame number";
+
+    return true;
+}
+
+/* Implementation *************************************************************/
+int RunFlacStreamTests()
+{
+    const int        iNumSamples = 3 * RECORDING_FLAC_BLOCK_SIZE_SAMPLES + 1000; // the last block is short
+    CVector<int16_t> vecsStereo ( 2 * iNumSamples );
+    CVector<int16_t> vecsStereoSame ( 2 * iNumSamples );
+    CVector<int16_t> vecsStereoExtreme ( 2 * iNumSamples );
+    CVector<int16_t> vecsMonoNoise ( iNumSamples );
+    CVector<int16_t> vecsMonoSilence ( iNumSamples, 0 );
+    int              iNumFailed = 0;
+
+    // same input data on every run
+    srand ( 1 );
+
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        const int16_t iSine = static_cast<int16_t> ( 20000 * sin ( 2 * 3.14159265358979 * 440 * i / 48000 ) );
+
+        vecsStereo[2 * i]            = static_cast<int16_t> ( iSine + rand() % 200 - 100 );
+        vecsStereo[2 * i + 1]        = static_cast<int16_t> ( iSine / 2 + rand() % 2000 - 1000 );
+        vecsStereoSame[2 * i]        = iSine;
+        vecsStereoSame[2 * i + 1]    = iSine;
+        vecsStereoExtreme[2 * i]     = ( i % 2 ) ? 32767 : -32768;
+        vecsStereoExtreme[2 * i + 1] = ( i % 2 ) ? -32768 : 32767;
+        vecsMonoNoise[i]             = static_cast<int16_t> ( rand() % 65536 - 32768 );
+    }
+
+    iNumFailed += !TestStream ( "stereo sine with noise", vecsStereo, 2 );
+    iNumFailed += !TestStream ( "stereo identical channels", vecsStereoSame, 2 );
+    iNumFailed += !TestStream ( "stereo full scale", vecsStereoExtreme, 2 );
+    iNumFailed += !TestStream ( "mono noise", vecsMonoNoise, 1 );
+    iNumFailed += !TestStream ( "mono silence", vecsMonoSilence, 1 );
+    iNumFailed += !TestFrameNumber();
+
+    if ( QStandardPaths::findExecutable ( "flac" ).isEmpty() )
+    {
+        qInfo() << "flac command line tool not found, the streams were not tested with flac -t";
+    }
+
+    return iNumFailed;
+}
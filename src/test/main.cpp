@@ -0,0 +1,46 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+   Headless tests, the process exits with a non-zero code if a test failed.
+
+   Build and run:
+       qmake KoordTest.pro && make && ./KoordTest
+*/
+
+#include <QCoreApplication>
+#include "tests.h"
+
+/* Implementation *************************************************************/
+int main ( int argc, char** argv )
+{
+    QCoreApplication App ( argc, argv );
+
+    int iNumFailed = 0;
+
+    iNumFailed += RunFlacStreamTests();
+    iNumFailed += RunNetStatsTests();
+
+    return iNumFailed == 0 ? 0 : 1;
+}
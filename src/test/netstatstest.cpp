@@ -0,0 +1,180 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+   Tests of the network statistics of a channel. Audio packets with one or
+   more blocks per packet are fed into CNetStatsCounter and the counted lost,
+   duplicate and reordered blocks and the jitter are checked against the
+   known stream.
+*/
+
+#include <QString>
+#include "global.h"
+#include "buffer.h"
+#include "tests.h"
+
+/* Helpers ********************************************************************/
+// audio stream with a fixed number of blocks per packet, the packets are
+// received exactly at their send time unless a delay is given
+class CNetStatsTestStream
+{
+public:
+    CNetStatsTestStream ( const int iNNumBlocksPerPacket, const bool bNUseSequenceNumber ) :
+        iNumBlocksPerPacket ( iNNumBlocksPerPacket ),
+        bUseSequenceNumber ( bNUseSequenceNumber ),
+        vecbyData ( iNNumBlocksPerPacket * ( iNumCodedBytes + 1 ) )
+    {}
+
+    // sends the packet which starts with the given block index
+    void Put ( const int64_t iFirstBlock, const int64_t iDelayNs = 0 )
+    {
+        const int iNumBytesPerBlock = iNumCodedBytes + ( bUseSequenceNumber ? 1 : 0 );
+        const int iNumBytes         = iNumBlocksPerPacket * iNumBytesPerBlock;
+
+        for ( int iBlock = 0; iBlock < iNumBlocksPerPacket; iBlock++ )
+        {
+            for ( int i = 0; i < iNumBytesPerBlock; i++ )
+            {
+                vecbyData[iBlock * iNumBytesPerBlock + i] = static_cast<uint8_t> ( i );
+            }
+
+            if ( bUseSequenceNumber )
+            {
+                // the sequence number wraps at 256
+                vecbyData[( iBlock + 1 ) * iNumBytesPerBlock - 1] = static_cast<uint8_t> ( iFirstBlock + iBlock );
+            }
+        }
+
+        // the packet is sent when its last block is complete
+        const int64_t iSendNs = ( iFirstBlock + iNumBlocksPerPacket - 1 ) * SYSTEM_FRAME_SIZE_SAMPLES * 1000000000 / SYSTEM_SAMPLE_RATE_HZ;
+
+        Counter.Update ( NetStats,
+                         vecbyData,
+                         iNumBytes,
+                         iNumCodedBytes,
+                         bUseSequenceNumber,
+                         SYSTEM_FRAME_SIZE_SAMPLES,
+                         CNetBuf::PR_OK,
+                         iSendNs + iDelayNs );
+    }
+
+    static constexpr int iNumCodedBytes = 28;
+
+    const int        iNumBlocksPerPacket;
+    const bool       bUseSequenceNumber;
+    CVector<uint8_t> vecbyData;
+    CChannelNetStats NetStats;
+    CNetStatsCounter Counter;
+};
+
+static bool CheckStats ( const QString&          strName,
+                         const CChannelNetStats& NetStats,
+                         const int64_t           iNumPackets,
+                         const int64_t           iNumLost,
+                         const int64_t           iNumDuplicates,
+                         const int64_t           iNumReordered,
+                         const bool              bOnTime = true )
+{
+    const QString strResult = QString ( "packets %1, lost %2, duplicates %3, reordered %4, jitter %5 us" )
+                                  .arg ( NetStats.iNumPackets.load() )
+                                  .arg ( NetStats.iNumLost.load() )
+                                  .arg ( NetStats.iNumDuplicates.load() )
+                                  .arg ( NetStats.iNumReordered.load() )
+                                  .arg ( NetStats.iJitterUs.load() );
+
+    // if all packets are received on time, there is no jitter
+    if ( ( NetStats.iNumPackets.load() != iNumPackets ) || ( NetStats.iNumLost.load() != iNumLost ) ||
+         ( NetStats.iNumDuplicates.load() != iNumDuplicates ) || ( NetStats.iNumReordered.load() != iNumReordered ) ||
+         ( bOnTime && ( NetStats.iJitterUs.load() != 0 ) ) )
+    {
+        qCritical() << qUtf8Printable ( QString ( "FAIL %1: %2" ).arg ( strName, strResult ) );
+        return false;
+    }
+
+    qInfo() << qUtf8Printable ( QString ( "PASS %1" ).arg ( strName ) );
+
+    return true;
+}
+
+/* Tests **********************************************************************/
+// in order stream, the sequence numbers wrap around several times
+static bool TestInOrder ( const int iNumBlocksPerPacket, const bool bUseSequenceNumber )
+{
+    CNetStatsTestStream Stream ( iNumBlocksPerPacket, bUseSequenceNumber );
+    const int           iNumPackets = 1000;
+
+    for ( int i = 0; i < iNumPackets; i++ )
+    {
+        Stream.Put ( static_cast<int64_t> ( i ) * iNumBlocksPerPacket );
+    }
+
+    return CheckStats ( QString ( "in order, %1 block(s) per packet%2" )
+                            .arg ( iNumBlocksPerPacket )
+                            .arg ( bUseSequenceNumber ? "" : ", no sequence numbers" ),
+                        Stream.NetStats,
+                        iNumPackets,
+                        0,
+                        0,
+                        0 );
+}
+
+// a missing packet is counted as lost until it is received late (and then
+// counted as reordered), a packet received twice is a duplicate
+static bool TestLostDuplicateReordered()
+{
+    CNetStatsTestStream Stream ( 2, true );
+    bool                bOk = true;
+
+    for ( int i = 0; i < 100; i++ )
+    {
+        if ( i != 90 )
+        {
+            Stream.Put ( 2 * i );
+        }
+    }
+
+    Stream.Put ( 2 * 99 );
+
+    bOk &= CheckStats ( "lost and duplicate packet", Stream.NetStats, 100, 2, 2, 0 );
+
+    // the missing packet is received after the last packet
+    Stream.Put ( 2 * 90, ( 99 - 90 ) * 2 * SYSTEM_FRAME_SIZE_SAMPLES * static_cast<int64_t> ( 1000000000 ) / SYSTEM_SAMPLE_RATE_HZ );
+
+    bOk &= CheckStats ( "reordered packet", Stream.NetStats, 101, 0, 2, 2, false );
+
+    return bOk;
+}
+
+/* Implementation *************************************************************/
+int RunNetStatsTests()
+{
+    int iNumFailed = 0;
+
+    iNumFailed += !TestInOrder ( 1, true );
+    iNumFailed += !TestInOrder ( 2, true );
+    iNumFailed += !TestInOrder ( 2, false );
+    iNumFailed += !TestLostDuplicateReordered();
+
+    return iNumFailed;
+}
@@ -27,13 +27,43 @@
 #include <QObject>
 #include <QTimer>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QUdpSocket>
 #include <QHostAddress>
+#include <QFile>
+#include <QtEndian>
+#include <memory>
+#include <vector>
 #include "global.h"
 #include "socket.h"
+#include "channel.h"
+#include "client.h"
 #include "protocol.h"
 #include "util.h"
 
+/* Definitions ****************************************************************/
+// number of message types of the random protocol message generator
+#define TESTBENCH_NUM_RANDOM_MESS_TYPES 43
+
+// load test: interval between two latency probes and between two reports
+#define LOAD_TEST_PROBE_INTERVAL_MS  500
+#define LOAD_TEST_REPORT_INTERVAL_MS 10000
+
+// load test: peak level of the probe burst and the detection threshold in the
+// received mix, the sum of all background signals stays below a quarter of the
+// full scale so that it never triggers the detection
+#define LOAD_TEST_PROBE_LEVEL     29000
+#define LOAD_TEST_PROBE_THRESHOLD 16000
+#define LOAD_TEST_BACKGROUND_GAIN 0.25f
+#define LOAD_TEST_TWO_PI          6.283185307179586
+
+enum ELoadTestSignal
+{
+    LS_SINE  = 0, // sine with a different frequency per client
+    LS_NOISE = 1, // white noise
+    LS_LOOP  = 2  // 16 bit, 48 kHz WAV file played in a loop
+};
+
 /* Classes ********************************************************************/
 class CTestbench : public QObject
 {
@@ -67,58 +97,161 @@ public:
         Timer.start ( 1 ); // 1 ms
     }
 
-protected:
-    int GenRandomIntInRange ( const int iStart, const int iEnd ) const
+    // CRC benchmark: checks that the table driven CRC gives the same result as
+    // the bit-serial reference implementation and compares their speed on
+    // random messages with typical protocol message sizes
+    static void RunCRCBenchmark()
     {
-        return static_cast<int> ( iStart + ( ( static_cast<double> ( iEnd - iStart + 1 ) * rand() ) / RAND_MAX ) );
-    }
+        const int iNumMessages = 100000;
+        const int iMaxMessLen  = MESS_SPLIT_PART_SIZE_BYTES + MESS_LEN_WITHOUT_DATA_BYTE;
 
-    QString GenRandomString() const
-    {
-        const int iLen      = GenRandomIntInRange ( 0, 111 );
-        QString   strReturn = "";
+        CVector<CVector<uint8_t>> vecvecMessages ( iNumMessages );
+        CVector<uint32_t>         vecRefCRC ( iNumMessages );
+        CVector<uint32_t>         vecCRC ( iNumMessages );
+        QElapsedTimer             ElapsedTimer;
 
-        for ( int i = 0; i < iLen; i++ )
+        for ( int iMess = 0; iMess < iNumMessages; iMess++ )
         {
-            strReturn += static_cast<char> ( GenRandomIntInRange ( 0, 255 ) );
+            vecvecMessages[iMess].Init ( rand() % iMaxMessLen + 1 );
+
+            for ( int i = 0; i < vecvecMessages[iMess].Size(); i++ )
+            {
+                vecvecMessages[iMess][i] = static_cast<uint8_t> ( rand() );
+            }
         }
 
-        return strReturn;
+        // bit-serial reference: x^16 + x^12 + x^5 + 1, register init with ones
+        ElapsedTimer.start();
+
+        for ( int iMess = 0; iMess < iNumMessages; iMess++ )
+        {
+            uint32_t iReg = 0xFFFF;
+
+            for ( int i = 0; i < vecvecMessages[iMess].Size(); i++ )
+            {
+                for ( int iBit = 7; iBit >= 0; iBit-- )
+                {
+                    const uint32_t iFeedback = ( ( iReg >> 15 ) ^ ( vecvecMessages[iMess][i] >> iBit ) ) & 1;
+
+                    iReg = ( ( iReg << 1 ) & 0xFFFF ) ^ ( iFeedback ? 0x1021 : 0 );
+                }
+            }
+
+            vecRefCRC[iMess] = ~iReg & 0xFFFF;
+        }
+
+        const qint64 iRefTimeNs = ElapsedTimer.nsecsElapsed();
+
+        // table driven CRC as used by the protocol
+        ElapsedTimer.start();
+
+        for ( int iMess = 0; iMess < iNumMessages; iMess++ )
+        {
+            CCRC CRCObj;
+
+            CRCObj.AddBytes ( &vecvecMessages[iMess][0], vecvecMessages[iMess].Size() );
+
+            vecCRC[iMess] = CRCObj.GetCRC();
+        }
+
+        const qint64 iTimeNs = ElapsedTimer.nsecsElapsed();
+
+        qInfo() << qUtf8Printable ( QString ( "CRC benchmark: results %1, bit-serial %2 ms, table driven %3 ms" )
+                                        .arg ( vecCRC == vecRefCRC ? "identical" : "DIFFERENT" )
+                                        .arg ( iRefTimeNs / 1000000.0 )
+                                        .arg ( iTimeNs / 1000000.0 ) );
     }
 
-    QHostAddress GenRandomIPv4Address() const
+    // protocol throughput benchmark: random messages of all message types are
+    // created with the testbench random generator, their frames are parsed and
+    // the message bodies are evaluated by a second protocol object
+    static void RunProtocolBenchmark()
     {
-        quint32 a = static_cast<quint32> ( 192 );
-        quint32 b = static_cast<quint32> ( 168 );
-        quint32 c = static_cast<quint32> ( GenRandomIntInRange ( 1, 253 ) );
-        quint32 d = static_cast<quint32> ( GenRandomIntInRange ( 1, 253 ) );
-        return QHostAddress ( a << 24 | b << 16 | c << 8 | d );
-    }
+        const int          iNumMessages = 100000;
+        const CHostAddress HostAddr ( QHostAddress ( QHostAddress::LocalHost ), DEFAULT_PORT_NUMBER );
+        const CHostAddress LocalHostAddr ( GenRandomIPv4Address(), DEFAULT_PORT_NUMBER );
+        CProtocol          SendProtocol;
+        CProtocol          RecProtocol;
+        QElapsedTimer      ElapsedTimer;
+        int                iNumFrames      = 0;
+        int                iNumFrameErrors = 0;
 
-    QString    sAddress;
-    quint16    iPort;
-    QString    sLAddress;
-    quint16    iLPort;
-    QTimer     Timer;
-    CProtocol  Protocol;
-    QUdpSocket UdpSocket;
+        auto ParseFrame = [&] ( const CHostAddress& InetAddr, const CVector<uint8_t>& vecMessage ) {
+            int iRecCounter;
+            int iRecID;
+            int iRecLenBy;
 
-public slots:
-    void OnTimer()
+            iNumFrames++;
+
+            if ( CProtocol::ParseMessageFrame ( &vecMessage[0], vecMessage.Size(), iRecCounter, iRecID, iRecLenBy ) )
+            {
+                iNumFrameErrors++;
+                return;
+            }
+
+            CVector<uint8_t> vecbyMesBodyData;
+
+            vecbyMesBodyData.assign ( vecMessage.begin() + MESS_HEADER_LENGTH_BYTE, vecMessage.begin() + MESS_HEADER_LENGTH_BYTE + iRecLenBy );
+
+            if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
+            {
+                RecProtocol.ParseConnectionLessMessageBody ( vecbyMesBodyData, iRecID, InetAddr );
+            }
+            else
+            {
+                RecProtocol.ParseMessageBody ( vecbyMesBodyData, iRecCounter, iRecID );
+
+                // the counters start again with the next message (see below)
+                RecProtocol.Reset();
+            }
+        };
+
+        QObject::connect ( &SendProtocol, &CProtocol::MessReadyForSending, [&] ( CVector<uint8_t> vecMessage ) {
+            ParseFrame ( HostAddr, vecMessage );
+
+            // reset protocol so that we do not have to wait for an acknowledge to
+            // send the next message
+            SendProtocol.Reset();
+        } );
+
+        QObject::connect ( &SendProtocol, &CProtocol::CLMessReadyForSending, [&] ( CHostAddress InetAddr, CVector<uint8_t> vecMessage ) {
+            ParseFrame ( InetAddr, vecMessage );
+        } );
+
+        ElapsedTimer.start();
+
+        for ( int iMess = 0; iMess < iNumMessages; iMess++ )
+        {
+            CreateRandomMessage ( SendProtocol, iMess % TESTBENCH_NUM_RANDOM_MESS_TYPES, HostAddr, LocalHostAddr );
+        }
+
+        const qint64 iTimeNs = ElapsedTimer.nsecsElapsed();
+
+        qInfo() << qUtf8Printable ( QString ( "Protocol benchmark: %1 messages of %2 types, %3 frames parsed, %4 frame errors, %5 messages/s" )
+                                        .arg ( iNumMessages )
+                                        .arg ( TESTBENCH_NUM_RANDOM_MESS_TYPES )
+                                        .arg ( iNumFrames )
+                                        .arg ( iNumFrameErrors )
+                                        .arg ( iTimeNs > 0 ? iNumMessages * 1.0e9 / iTimeNs : 0.0 ) );
+    }
+
+    // creates a protocol message of the given type (0 to
+    // TESTBENCH_NUM_RANDOM_MESS_TYPES - 1) with random content
+    static void CreateRandomMessage ( CProtocol&          Protocol,
+                                      const int           iMessType,
+                                      const CHostAddress& CurHostAddress,
+                                      const CHostAddress& CurLocalAddress )
     {
         CVector<CChannelInfo>  vecChanInfo ( 1 );
         CNetworkTransportProps NetTrProps;
         CServerCoreInfo        ServerInfo;
         CVector<CServerInfo>   vecServerInfo ( 1 );
         CVector<uint16_t>      vecLevelList ( 1 );
-        CHostAddress           CurHostAddress ( QHostAddress ( sAddress ), iPort );
-        CHostAddress           CurLocalAddress ( QHostAddress ( sLAddress ), iLPort );
         CChannelCoreInfo       ChannelCoreInfo;
         ELicenceType           eLicenceType;
         ESvrRegResult          eSvrRegResult;
 
-        // generate random protocol message
-        switch ( GenRandomIntInRange ( 0, 34 ) )
+        switch ( iMessType )
         {
         case 0: // PROTMESSID_JITT_BUF_SIZE
             Protocol.CreateJitBufMes ( GenRandomIntInRange ( 0, 10 ) );
@@ -132,6 +265,10 @@ public slots:
             Protocol.CreateChanGainMes ( GenRandomIntInRange ( 0, 20 ), GenRandomIntInRange ( -100, 100 ) );
             break;
 
+        case 3: // PROTMESSID_OPUS_SUPPORTED
+            Protocol.CreateOpusSupportedMes();
+            break;
+
         case 4: // PROTMESSID_CONN_CLIENTS_LIST
             vecChanInfo[0].iChanID = GenRandomIntInRange ( -2, 20 );
             vecChanInfo[0].strName = GenRandomString();
@@ -143,6 +280,10 @@ public slots:
             Protocol.CreateReqConnClientsList();
             break;
 
+        case 6: // PROTMESSID_VERSION_AND_OS
+            Protocol.CreateVersionAndOSMes();
+            break;
+
         case 7: // PROTMESSID_CHANNEL_INFOS
             ChannelCoreInfo.eCountry    = static_cast<QLocale::Country> ( GenRandomIntInRange ( 0, 100 ) );
             ChannelCoreInfo.eSkillLevel = static_cast<ESkillLevel> ( GenRandomIntInRange ( 0, 3 ) );
@@ -183,6 +324,10 @@ public slots:
             Protocol.CreateReqNetwTranspPropsMes();
             break;
 
+        case 13: // PROTMESSID_RECORDER_STATE
+            Protocol.CreateRecorderStateMes ( static_cast<ERecorderState> ( GenRandomIntInRange ( 0, 3 ) ) );
+            break;
+
         case 14: // PROTMESSID_CLM_PING_MS
             Protocol.CreateCLPingMes ( CurHostAddress, GenRandomIntInRange ( -2, 1000 ) );
             break;
@@ -249,13 +394,9 @@ public slots:
             Protocol.CreateAndImmSendAcknMess ( GenRandomIntInRange ( -10, 100 ), GenRandomIntInRange ( -100, 100 ) );
             break;
 
-        case 27:
-        {
-            // arbitrary "audio" packet (with random sizes)
-            CVector<uint8_t> vecMessage ( GenRandomIntInRange ( 1, 1000 ) );
-            OnSendProtMessage ( vecMessage );
+        case 27: // PROTMESSID_NETW_FRAME_SIZE_FACT
+            Protocol.CreateNetwFrameSizeFactMes ( GenRandomIntInRange ( -2, 10 ) );
             break;
-        }
 
         case 28: // PROTMESSID_CLM_CONN_CLIENTS_LIST
             vecChanInfo[0].iChanID = GenRandomIntInRange ( -2, 20 );
@@ -291,6 +432,113 @@ public slots:
         case 34: // PROTMESSID_CLIENT_ID
             Protocol.CreateClientIDMes ( GenRandomIntInRange ( -2, 20 ) );
             break;
+
+        case 35: // PROTMESSID_REQ_SPLIT_MESS_SUPPORT
+            Protocol.CreateReqSplitMessSupportMes();
+            break;
+
+        case 36: // PROTMESSID_SPLIT_MESS_SUPPORTED
+            Protocol.CreateSplitMessSupportedMes();
+            break;
+
+        case 37: // PROTMESSID_REQ_CLIENTS_LIST_DELTA
+            Protocol.CreateReqConClientListDeltaSupportMes();
+            break;
+
+        case 38: // PROTMESSID_CLIENTS_LIST_DELTA_SUPP
+            Protocol.CreateConClientListDeltaSupportedMes();
+            break;
+
+        case 39: // PROTMESSID_CONN_CLIENTS_LIST_DELTA
+        {
+            const int iNewVersion = GenRandomIntInRange ( 1, 1000 );
+
+            vecChanInfo[0].iChanID = GenRandomIntInRange ( -2, 20 );
+            vecChanInfo[0].strName = GenRandomString();
+
+            Protocol.SendConClientListDeltaMes ( CProtocol::PrepConClientListDeltaMes ( 0, iNewVersion, CVector<CChannelInfo> ( 0 ), vecChanInfo ),
+                                                 iNewVersion );
+            break;
+        }
+
+        case 40: // PROTMESSID_REQ_CHANNEL_LEVEL_LIST
+            Protocol.CreateReqChannelLevelListMes();
+            break;
+
+        case 41: // PROTMESSID_CLM_REGISTER_SERVER_EX
+            ServerInfo.bPermanentOnline = static_cast<bool> ( GenRandomIntInRange ( 0, 1 ) );
+            ServerInfo.eCountry         = static_cast<QLocale::Country> ( GenRandomIntInRange ( 0, 100 ) );
+            ServerInfo.iMaxNumClients   = GenRandomIntInRange ( -2, 10000 );
+            ServerInfo.strCity          = GenRandomString();
+            ServerInfo.strName          = GenRandomString();
+
+            Protocol.CreateCLRegisterServerExMes ( CurHostAddress, CurLocalAddress, ServerInfo );
+            break;
+
+        case 42: // PROTMESSID_CLM_RED_SERVER_LIST
+            vecServerInfo[0].HostAddr = CurHostAddress;
+            vecServerInfo[0].strName  = GenRandomString();
+
+            Protocol.CreateCLRedServerListMes ( CurHostAddress, vecServerInfo );
+            break;
+        }
+    }
+
+protected:
+    static int GenRandomIntInRange ( const int iStart, const int iEnd )
+    {
+        return static_cast<int> ( iStart + ( ( static_cast<double> ( iEnd - iStart + 1 ) * rand() ) / RAND_MAX ) );
+    }
+
+    static QString GenRandomString()
+    {
+        const int iLen      = GenRandomIntInRange ( 0, 111 );
+        QString   strReturn = "";
+
+        for ( int i = 0; i < iLen; i++ )
+        {
+            strReturn += static_cast<char> ( GenRandomIntInRange ( 0, 255 ) );
+        }
+
+        return strReturn;
+    }
+
+    static QHostAddress GenRandomIPv4Address()
+    {
+        quint32 a = static_cast<quint32> ( 192 );
+        quint32 b = static_cast<quint32> ( 168 );
+        quint32 c = static_cast<quint32> ( GenRandomIntInRange ( 1, 253 ) );
+        quint32 d = static_cast<quint32> ( GenRandomIntInRange ( 1, 253 ) );
+        return QHostAddress ( a << 24 | b << 16 | c << 8 | d );
+    }
+
+    QString    sAddress;
+    quint16    iPort;
+    QString    sLAddress;
+    quint16    iLPort;
+    QTimer     Timer;
+    CProtocol  Protocol;
+    QUdpSocket UdpSocket;
+
+public slots:
+    void OnTimer()
+    {
+        // generate random protocol message (the additional type is an
+        // arbitrary "audio" packet)
+        const int iMessType = GenRandomIntInRange ( 0, TESTBENCH_NUM_RANDOM_MESS_TYPES );
+
+        if ( iMessType == TESTBENCH_NUM_RANDOM_MESS_TYPES )
+        {
+            // arbitrary "audio" packet (with random sizes)
+            CVector<uint8_t> vecMessage ( GenRandomIntInRange ( 1, 1000 ) );
+            OnSendProtMessage ( vecMessage );
+        }
+        else
+        {
+            const CHostAddress CurHostAddress ( QHostAddress ( sAddress ), iPort );
+            const CHostAddress CurLocalAddress ( QHostAddress ( sLAddress ), iLPort );
+
+            CreateRandomMessage ( Protocol, iMessType, CurHostAddress, CurLocalAddress );
         }
     }
 
@@ -305,3 +553,609 @@ public slots:
 
     void OnSendCLMessage ( CHostAddress, CVector<uint8_t> vecMessage ) { OnSendProtMessage ( vecMessage ); }
 };
+
+/* Load test ------------------------------------------------------------------ */
+// One synthetic client of the load test. A client channel does the connection
+// handshake with the server (network transport properties, jitter buffer size,
+// channel info) exactly like a real client. Opus coded synthetic audio is sent
+// on every tick of the load generator and the received mix is decoded to
+// measure the packet loss, the network jitter and the end-to-end latency.
+class CTestbenchClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    CTestbenchClient ( const int               iNClientIndex,
+                       const int               iNNumClients,
+                       const CHostAddress&     NServerAddr,
+                       const ELoadTestSignal   eNSignal,
+                       const CVector<int16_t>& vecsNLoop,
+                       OpusCustomMode*         pOpusMode ) :
+        Channel ( false ), /* we need a client channel -> "false" */
+        ServerAddr ( NServerAddr ),
+        iClientIndex ( iNClientIndex ),
+        eSignal ( eNSignal ),
+        vecsLoop ( vecsNLoop ),
+        iLoopPos ( 0 ),
+        dPhase ( 0 ),
+        dPhaseInc ( LOAD_TEST_TWO_PI * ( 220 + 55 * ( iNClientIndex % 16 ) ) / SYSTEM_SAMPLE_RATE_HZ ),
+        fBackgroundGain ( LOAD_TEST_BACKGROUND_GAIN / iNNumClients ),
+        iCeltNumCodedBytes ( OPUS_NUM_BYTES_STEREO_NORMAL_QUALITY_DBLE_FRAMESIZE ),
+        iSendSequenceNumber ( 0 ),
+        iCurTick ( 0 ),
+        iFirstReceivedTick ( -1 ),
+        iLastArrivalNs ( -1 ),
+        iNumReceived ( 0 ),
+        iNumUnderruns ( 0 ),
+        dJitterMs ( 0 ),
+        iPendingProbeTick ( -1 ),
+        bProbeDetected ( true ),
+        iNumProbesDetected ( 0 ),
+        iNumProbesMissed ( 0 ),
+        dLatencySumMs ( 0 ),
+        dLatencyMinMs ( 0 ),
+        dLatencyMaxMs ( 0 )
+    {
+        int iOpusError;
+
+        OpusEncoder = opus_custom_encoder_create ( pOpusMode, 2, &iOpusError );
+        OpusDecoder = opus_custom_decoder_create ( pOpusMode, 2, &iOpusError );
+
+        // same encoder settings as the client uses for the 128 samples frame size
+        opus_custom_encoder_ctl ( OpusEncoder, OPUS_SET_VBR ( 0 ) );
+        opus_custom_encoder_ctl ( OpusEncoder, OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+        opus_custom_encoder_ctl ( OpusEncoder, OPUS_SET_COMPLEXITY ( 1 ) );
+        opus_custom_encoder_ctl ( OpusEncoder,
+                                  OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES ) ) );
+
+        vecsAudio.Init ( 2 * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+        vecCeltData.Init ( iCeltNumCodedBytes + 1 ); // including the sequence number
+        vecbyNetwData.Init ( iCeltNumCodedBytes );
+        vecbyRecBuf.Init ( MAX_SIZE_BYTES_NETW_BUF );
+
+        // each client starts at a different position of the loop (the product overflows an int for long loop files
+        // and many clients)
+        if ( vecsLoop.Size() > 0 )
+        {
+            iLoopPos = 2 * static_cast<int> ( static_cast<int64_t> ( vecsLoop.Size() / 2 ) * iClientIndex / iNNumClients );
+        }
+
+        ChannelInfo.strName = QString ( "Load test %1" ).arg ( iClientIndex + 1 );
+
+        // bind to any free port of the address family of the server
+        if ( ServerAddr.InetAddr.protocol() == QAbstractSocket::IPv6Protocol )
+        {
+            UdpSocket.bind ( QHostAddress ( QHostAddress::AnyIPv6 ), 0 );
+        }
+        else
+        {
+            UdpSocket.bind ( QHostAddress ( QHostAddress::AnyIPv4 ), 0 );
+        }
+
+        // fixed jitter buffer sizes on both sides so that results are comparable
+        Channel.SetAddress ( ServerAddr );
+        Channel.SetDoAutoSockBufSize ( false );
+        Channel.SetSockBufNumFrames ( DEF_NET_BUF_SIZE_NUM_BL );
+        Channel.SetAudioStreamProperties ( CT_OPUS, iCeltNumCodedBytes, 1, 2 );
+
+        QObject::connect ( &Channel, &CChannel::MessReadyForSending, this, &CTestbenchClient::OnSendProtMessage );
+
+        QObject::connect ( &Channel, &CChannel::ReqJittBufSize, this, &CTestbenchClient::OnReqJittBufSize );
+
+        QObject::connect ( &Channel, &CChannel::ReqChanInfo, this, &CTestbenchClient::OnReqChanInfo );
+
+        QObject::connect ( &ConnLessProtocol, &CProtocol::CLMessReadyForSending, this, &CTestbenchClient::OnSendCLProtMessage );
+
+        QObject::connect ( &UdpSocket, &QUdpSocket::readyRead, this, &CTestbenchClient::OnDataReceived );
+
+        ArrivalTimer.start();
+
+        Channel.SetEnable ( true );
+    }
+
+    virtual ~CTestbenchClient()
+    {
+        opus_custom_encoder_destroy ( OpusEncoder );
+        opus_custom_decoder_destroy ( OpusDecoder );
+    }
+
+    // called once per frame by the load generator, iProbeTick is the tick of
+    // the latest latency probe (sent by bSendProbe of one of the clients)
+    void Process ( const qint64 iTick, const bool bSendProbe, const qint64 iProbeTick )
+    {
+        iCurTick = iTick;
+
+        // Transmit signal -----------------------------------------------------
+        for ( int i = 0, j = 0; i < DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES; i++, j += 2 )
+        {
+            if ( bSendProbe )
+            {
+                // square wave burst of about 1.5 kHz
+                vecsAudio[j] = vecsAudio[j + 1] = ( ( i / 16 ) % 2 ) ? -LOAD_TEST_PROBE_LEVEL : LOAD_TEST_PROBE_LEVEL;
+            }
+            else if ( eSignal == LS_NOISE )
+            {
+                vecsAudio[j]     = Float2Short ( fBackgroundGain * ( 2.0f * rand() / RAND_MAX - 1 ) * _MAXSHORT );
+                vecsAudio[j + 1] = Float2Short ( fBackgroundGain * ( 2.0f * rand() / RAND_MAX - 1 ) * _MAXSHORT );
+            }
+            else if ( eSignal == LS_LOOP )
+            {
+                vecsAudio[j]     = Float2Short ( fBackgroundGain * vecsLoop[iLoopPos] );
+                vecsAudio[j + 1] = Float2Short ( fBackgroundGain * vecsLoop[iLoopPos + 1] );
+
+                iLoopPos = ( iLoopPos + 2 ) % vecsLoop.Size();
+            }
+            else
+            {
+                vecsAudio[j] = vecsAudio[j + 1] = Float2Short ( fBackgroundGain * sin ( dPhase ) * _MAXSHORT );
+
+                dPhase = fmod ( dPhase + dPhaseInc, LOAD_TEST_TWO_PI );
+            }
+        }
+
+        opus_custom_encode ( OpusEncoder, &vecsAudio[0], DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, &vecCeltData[0], iCeltNumCodedBytes );
+
+        // the channel enables the sequence number if the server supports it,
+        // it is appended to the coded data as the conversion buffer does
+        int iNumSendBytes = iCeltNumCodedBytes;
+
+        if ( Channel.GetNetworkTransportPropsFromCurrentSettings().eFlags == NF_WITH_COUNTER )
+        {
+            vecCeltData[iNumSendBytes++] = iSendSequenceNumber++;
+        }
+
+        // the first audio packets let the server open a channel for us
+        UdpSocket.writeDatagram ( (const char*) &vecCeltData[0], iNumSendBytes, ServerAddr.InetAddr, ServerAddr.iPort );
+
+        // Receive signal ------------------------------------------------------
+        const bool bReceiveDataOk = ( Channel.GetData ( vecbyNetwData, iCeltNumCodedBytes ) == GS_BUFFER_OK );
+
+        if ( ( iFirstReceivedTick >= 0 ) && !bReceiveDataOk )
+        {
+            iNumUnderruns++;
+        }
+
+        // lost packets are concealed by the decoder as a real client does
+        opus_custom_decode ( OpusDecoder,
+                             bReceiveDataOk ? &vecbyNetwData[0] : nullptr,
+                             iCeltNumCodedBytes,
+                             &vecsAudio[0],
+                             DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+
+        // a new probe was sent, the previous one is lost if we did not hear it
+        if ( iProbeTick != iPendingProbeTick )
+        {
+            if ( !bProbeDetected && ( iPendingProbeTick > iFirstReceivedTick ) && ( iFirstReceivedTick >= 0 ) )
+            {
+                iNumProbesMissed++;
+            }
+
+            iPendingProbeTick = iProbeTick;
+            bProbeDetected    = false;
+        }
+
+        if ( !bProbeDetected && bReceiveDataOk )
+        {
+            for ( int i = 0; i < 2 * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES; i++ )
+            {
+                if ( abs ( vecsAudio[i] ) > LOAD_TEST_PROBE_THRESHOLD )
+                {
+                    const double dLatencyMs = static_cast<double> ( ( iTick - iPendingProbeTick ) * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES + i / 2 ) *
+                                              1000 / SYSTEM_SAMPLE_RATE_HZ;
+
+                    if ( iNumProbesDetected == 0 )
+                    {
+                        dLatencyMinMs = dLatencyMaxMs = dLatencyMs;
+                    }
+
+                    dLatencyMinMs = std::min ( dLatencyMinMs, dLatencyMs );
+                    dLatencyMaxMs = std::max ( dLatencyMaxMs, dLatencyMs );
+                    dLatencySumMs += dLatencyMs;
+
+                    iNumProbesDetected++;
+                    bProbeDetected = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    void Disconnect()
+    {
+        Channel.SetEnable ( false );
+
+        ConnLessProtocol.CreateCLDisconnection ( ServerAddr );
+    }
+
+    // packet loss estimated from the number of packets the server has sent
+    // since the first one we received (the server sends one per frame)
+    double GetLossPercent() const
+    {
+        if ( iFirstReceivedTick < 0 )
+        {
+            return 100;
+        }
+
+        const qint64 iNumExpected = iCurTick - iFirstReceivedTick + 1;
+
+        return std::max ( 0.0, 100.0 * ( iNumExpected - iNumReceived ) / iNumExpected );
+    }
+
+    double GetJitterMs() const { return dJitterMs; }
+    double GetMeanLatencyMs() const { return iNumProbesDetected > 0 ? dLatencySumMs / iNumProbesDetected : 0; }
+    double GetMaxLatencyMs() const { return dLatencyMaxMs; }
+
+    QString GetReport() const
+    {
+        return QString ( "%1: received %2, loss %3 %, underruns %4, jitter %5 ms, latency %6/%7/%8 ms (min/mean/max), probes missed %9" )
+            .arg ( ChannelInfo.strName )
+            .arg ( iNumReceived )
+            .arg ( GetLossPercent(), 0, 'f', 2 )
+            .arg ( iNumUnderruns )
+            .arg ( dJitterMs, 0, 'f', 3 )
+            .arg ( dLatencyMinMs, 0, 'f', 1 )
+            .arg ( GetMeanLatencyMs(), 0, 'f', 1 )
+            .arg ( dLatencyMaxMs, 0, 'f', 1 )
+            .arg ( iNumProbesMissed );
+    }
+
+protected:
+    CChannel         Channel;
+    CProtocol        ConnLessProtocol;
+    CChannelCoreInfo ChannelInfo;
+    QUdpSocket       UdpSocket;
+    CHostAddress     ServerAddr;
+    QElapsedTimer    ArrivalTimer;
+
+    OpusCustomEncoder* OpusEncoder;
+    OpusCustomDecoder* OpusDecoder;
+
+    int                     iClientIndex;
+    ELoadTestSignal         eSignal;
+    const CVector<int16_t>& vecsLoop;
+    int                     iLoopPos;
+    double                  dPhase;
+    double                  dPhaseInc;
+    float                   fBackgroundGain;
+    int                     iCeltNumCodedBytes;
+    uint8_t                 iSendSequenceNumber;
+    CVector<int16_t>        vecsAudio;
+    CVector<uint8_t>        vecCeltData;
+    CVector<uint8_t>        vecbyNetwData;
+    CVector<uint8_t>        vecbyRecBuf;
+
+    // statistics
+    qint64 iCurTick;
+    qint64 iFirstReceivedTick;
+    qint64 iLastArrivalNs;
+    int    iNumReceived;
+    int    iNumUnderruns;
+    double dJitterMs;
+    qint64 iPendingProbeTick;
+    bool   bProbeDetected;
+    int    iNumProbesDetected;
+    int    iNumProbesMissed;
+    double dLatencySumMs;
+    double dLatencyMinMs;
+    double dLatencyMaxMs;
+
+public slots:
+    void OnDataReceived()
+    {
+        while ( UdpSocket.hasPendingDatagrams() )
+        {
+            QHostAddress SenderAddress;
+            quint16      iSenderPort;
+
+            const qint64 iNumBytesRead =
+                UdpSocket.readDatagram ( (char*) &vecbyRecBuf[0], MAX_SIZE_BYTES_NETW_BUF, &SenderAddress, &iSenderPort );
+
+            if ( iNumBytesRead <= 0 )
+            {
+                continue;
+            }
+
+            const CHostAddress RecHostAddr ( SenderAddress, iSenderPort );
+            int                iRecCounter;
+            int                iRecID;
+            int                iRecLenBy;
+
+            // same packet dispatching as the socket does for a client
+            if ( !CProtocol::ParseMessageFrame ( &vecbyRecBuf[0], iNumBytesRead, iRecCounter, iRecID, iRecLenBy ) )
+            {
+                if ( !CProtocol::IsConnectionLessMessageID ( iRecID ) )
+                {
+                    const uint8_t*   pbyMesBody = &vecbyRecBuf[MESS_HEADER_LENGTH_BYTE];
+                    CVector<uint8_t> vecbyMesBodyData;
+
+                    vecbyMesBodyData.assign ( pbyMesBody, pbyMesBody + iRecLenBy );
+
+                    Channel.PutProtocolData ( iRecCounter, iRecID, vecbyMesBodyData, RecHostAddr );
+                }
+            }
+            else
+            {
+                const EPutDataStat eStat = Channel.PutAudioData ( vecbyRecBuf, static_cast<int> ( iNumBytesRead ), RecHostAddr );
+
+                if ( eStat == PS_NEW_CONNECTION )
+                {
+                    OnNewConnection();
+                }
+
+                if ( ( eStat == PS_AUDIO_OK ) || ( eStat == PS_AUDIO_ERR ) || ( eStat == PS_NEW_CONNECTION ) )
+                {
+                    // interarrival jitter with the smoothing of RFC 3550
+                    const qint64 iArrivalNs = ArrivalTimer.nsecsElapsed();
+
+                    if ( iLastArrivalNs >= 0 )
+                    {
+                        const double dDeviationMs =
+                            ( iArrivalNs - iLastArrivalNs ) / 1000000.0 - 1000.0 * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES / SYSTEM_SAMPLE_RATE_HZ;
+
+                        dJitterMs += ( fabs ( dDeviationMs ) - dJitterMs ) / 16;
+                    }
+
+                    if ( iFirstReceivedTick < 0 )
+                    {
+                        iFirstReceivedTick = iCurTick;
+                    }
+
+                    iLastArrivalNs = iArrivalNs;
+                    iNumReceived++;
+                }
+            }
+        }
+    }
+
+    void OnNewConnection()
+    {
+        // same as the client does on a new connection
+        Channel.SetRemoteInfo ( ChannelInfo );
+        Channel.CreateReqConnClientsList();
+        OnReqJittBufSize();
+    }
+
+    void OnReqJittBufSize() { Channel.CreateJitBufMes ( DEF_NET_BUF_SIZE_NUM_BL ); }
+
+    void OnReqChanInfo() { Channel.SetRemoteInfo ( ChannelInfo ); }
+
+    void OnSendProtMessage ( CVector<uint8_t> vecMessage )
+    {
+        UdpSocket.writeDatagram ( (const char*) &vecMessage[0], vecMessage.Size(), ServerAddr.InetAddr, ServerAddr.iPort );
+    }
+
+    void OnSendCLProtMessage ( CHostAddress InetAddr, CVector<uint8_t> vecMessage )
+    {
+        UdpSocket.writeDatagram ( (const char*) &vecMessage[0], vecMessage.Size(), InetAddr.InetAddr, InetAddr.iPort );
+    }
+};
+
+// Load generator: simulates a number of full clients from one process against a
+// server (usually on the loopback interface) for capacity planning and to catch
+// regressions in the server throughput. All clients are driven by one high
+// precision timer at the 128 samples frame cadence. Latency probes are sent by
+// the clients in turn and every client measures when the probe arrives in its
+// own mix. The per client statistics are reported periodically and on exit.
+class CTestbenchLoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    CTestbenchLoadGenerator ( const QString& strServerAddress, const int iNNumClients, const QString& strSignal, const bool bEnableIPv6 ) :
+        HighPrecisionTimer ( true ), // 128 samples frame size
+        iTick ( 0 ),
+        iProbeTick ( -1 ),
+        iProbeIntervalTicks ( LOAD_TEST_PROBE_INTERVAL_MS * SYSTEM_SAMPLE_RATE_HZ / 1000 / DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES ),
+        iNumProbesSent ( 0 )
+    {
+        CHostAddress    ServerAddr;
+        ELoadTestSignal eSignal = LS_SINE;
+        int             iOpusError;
+
+        if ( !NetworkUtil::ParseNetworkAddress ( strServerAddress, ServerAddr, bEnableIPv6 ) )
+        {
+            qWarning() << qUtf8Printable ( QString ( "- load test: invalid server address %1, using localhost" ).arg ( strServerAddress ) );
+
+            ServerAddr = CHostAddress ( QHostAddress ( QHostAddress::LocalHost ), DEFAULT_PORT_NUMBER );
+        }
+
+        if ( strSignal == "noise" )
+        {
+            eSignal = LS_NOISE;
+        }
+        else if ( !strSignal.isEmpty() && ( strSignal != "sine" ) )
+        {
+            if ( LoadLoop ( strSignal, vecsLoop ) )
+            {
+                eSignal = LS_LOOP;
+            }
+            else
+            {
+                qWarning() << qUtf8Printable (
+                    QString ( "- load test: %1 is no 16 bit, 48 kHz WAV file, using a sine signal" ).arg ( strSignal ) );
+            }
+        }
+
+        OpusMode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
+
+        for ( int i = 0; i < iNNumClients; i++ )
+        {
+            vecpClients.push_back (
+                std::unique_ptr<CTestbenchClient> ( new CTestbenchClient ( i, iNNumClients, ServerAddr, eSignal, vecsLoop, OpusMode ) ) );
+        }
+
+        qInfo() << qUtf8Printable (
+            QString ( "- load test: %1 clients sending to %2" ).arg ( iNNumClients ).arg ( ServerAddr.toString() ) );
+
+        QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout, this, &CTestbenchLoadGenerator::OnTimer );
+
+        QObject::connect ( &ReportTimer, &QTimer::timeout, this, &CTestbenchLoadGenerator::OnReport );
+
+        QObject::connect ( CSignalHandler::getSingletonP(), &CSignalHandler::HandledSignal, this, &CTestbenchLoadGenerator::OnHandledSignal );
+
+        HighPrecisionTimer.Start();
+        ReportTimer.start ( LOAD_TEST_REPORT_INTERVAL_MS );
+    }
+
+    virtual ~CTestbenchLoadGenerator()
+    {
+        HighPrecisionTimer.Stop();
+
+        OnReport();
+
+        for ( auto& pClient : vecpClients )
+        {
+            pClient->Disconnect();
+        }
+
+        // the coders must be destroyed before the mode they use
+        vecpClients.clear();
+
+        opus_custom_mode_destroy ( OpusMode );
+    }
+
+protected:
+    // reads a 16 bit, 48 kHz mono or stereo WAV file as interleaved stereo
+    static bool LoadLoop ( const QString& strFileName, CVector<int16_t>& vecsStereo )
+    {
+        QFile File ( strFileName );
+
+        if ( !File.open ( QIODevice::ReadOnly ) )
+        {
+            return false;
+        }
+
+        const QByteArray data         = File.readAll();
+        const char*      pData        = data.constData();
+        int              iNumChannels = 0;
+        int              iPos         = 12;
+
+        if ( ( data.size() < 12 ) || !data.startsWith ( "RIFF" ) || ( data.mid ( 8, 4 ) != "WAVE" ) )
+        {
+            return false;
+        }
+
+        while ( iPos + 8 <= data.size() )
+        {
+            const QByteArray chunkId    = data.mid ( iPos, 4 );
+            const int        iChunkSize = static_cast<int> ( qFromLittleEndian<quint32> ( pData + iPos + 4 ) );
+
+            iPos += 8;
+
+            if ( ( iChunkSize < 0 ) || ( iPos + iChunkSize > data.size() ) )
+            {
+                return false;
+            }
+
+            if ( ( chunkId == "fmt " ) && ( iChunkSize >= 16 ) )
+            {
+                iNumChannels = qFromLittleEndian<quint16> ( pData + iPos + 2 );
+
+                if ( ( qFromLittleEndian<quint16> ( pData + iPos ) != 1 ) || ( iNumChannels < 1 ) || ( iNumChannels > 2 ) ||
+                     ( qFromLittleEndian<quint32> ( pData + iPos + 4 ) != SYSTEM_SAMPLE_RATE_HZ ) ||
+                     ( qFromLittleEndian<quint16> ( pData + iPos + 14 ) != 16 ) )
+                {
+                    return false;
+                }
+            }
+            else if ( ( chunkId == "data" ) && ( iNumChannels > 0 ) )
+            {
+                const int iNumFrames = iChunkSize / ( 2 * iNumChannels );
+
+                vecsStereo.Init ( 2 * iNumFrames );
+
+                for ( int i = 0; i < iNumFrames; i++ )
+                {
+                    const char* pFrame = pData + iPos + 2 * iNumChannels * i;
+
+                    vecsStereo[2 * i]     = qFromLittleEndian<qint16> ( pFrame );
+                    vecsStereo[2 * i + 1] = qFromLittleEndian<qint16> ( pFrame + 2 * ( iNumChannels - 1 ) );
+                }
+
+                return iNumFrames > 0;
+            }
+
+            // chunks are word aligned
+            iPos += iChunkSize + ( iChunkSize & 1 );
+        }
+
+        return false;
+    }
+
+    CHighPrecisionTimer                            HighPrecisionTimer;
+    QTimer                                         ReportTimer;
+    OpusCustomMode*                                OpusMode;
+    CVector<int16_t>                               vecsLoop;
+    std::vector<std::unique_ptr<CTestbenchClient>> vecpClients;
+    qint64                                         iTick;
+    qint64                                         iProbeTick;
+    int                                            iProbeIntervalTicks;
+    int                                            iNumProbesSent;
+
+public slots:
+    void OnTimer()
+    {
+        int iProbeClient = INVALID_INDEX;
+
+        // one probe at a time, sent by the clients in turn
+        if ( ( iTick % iProbeIntervalTicks ) == 0 )
+        {
+            iProbeClient = iNumProbesSent % static_cast<int> ( vecpClients.size() );
+            iProbeTick   = iTick;
+            iNumProbesSent++;
+        }
+
+        for ( int i = 0; i < static_cast<int> ( vecpClients.size() ); i++ )
+        {
+            vecpClients[i]->Process ( iTick, i == iProbeClient, iProbeTick );
+        }
+
+        iTick++;
+    }
+
+    void OnReport()
+    {
+        double dSumLossPercent = 0;
+        double dSumJitterMs    = 0;
+        double dSumLatencyMs   = 0;
+        double dMaxLatencyMs   = 0;
+
+        for ( const auto& pClient : vecpClients )
+        {
+            qInfo() << qUtf8Printable ( pClient->GetReport() );
+
+            dSumLossPercent += pClient->GetLossPercent();
+            dSumJitterMs += pClient->GetJitterMs();
+            dSumLatencyMs += pClient->GetMeanLatencyMs();
+            dMaxLatencyMs = std::max ( dMaxLatencyMs, pClient->GetMaxLatencyMs() );
+        }
+
+        const int iNumClients = std::max ( 1, static_cast<int> ( vecpClients.size() ) );
+
+        qInfo() << qUtf8Printable ( QString ( "Load test (%1 s): mean loss %2 %, mean jitter %3 ms, mean latency %4 ms, max latency %5 ms" )
+                                        .arg ( iTick * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES / SYSTEM_SAMPLE_RATE_HZ )
+                                        .arg ( dSumLossPercent / iNumClients, 0, 'f', 2 )
+                                        .arg ( dSumJitterMs / iNumClients, 0, 'f', 3 )
+                                        .arg ( dSumLatencyMs / iNumClients, 0, 'f', 1 )
+                                        .arg ( dMaxLatencyMs, 0, 'f', 1 ) );
+    }
+
+    void OnHandledSignal ( int sigNum )
+    {
+#ifdef _WIN32
+        QCoreApplication::instance()->exit();
+        Q_UNUSED ( sigNum )
+#else
+        switch ( sigNum )
+        {
+        case SIGINT:
+        case SIGTERM:
+            QCoreApplication::instance()->exit();
+            break;
+
+        default:
+            break;
+        }
+#endif
+    }
+};
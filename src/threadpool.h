@@ -34,12 +34,25 @@
 #include <future>
 #include <functional>
 #include <stdexcept>
+#ifdef _WIN32
+#    include <winsock2.h>
+#    include <windows.h>
+#else
+#    include <pthread.h>
+#    include <sched.h>
+#    if defined( __linux__ )
+#        include <sys/resource.h>
+#        include <sys/syscall.h>
+#        include <unistd.h>
+#    endif
+#endif
+#include "traceevents.h"
 
 class CThreadPool
 {
 public:
     CThreadPool() = default;
-    CThreadPool ( size_t );
+    CThreadPool ( size_t, const bool bLowPriority = false );
     template<class F, class... Args>
     auto enqueue ( F&& f, Args&&... args ) -> std::future<typename std::result_of<F ( Args... )>::type>;
     ~CThreadPool();
@@ -56,12 +69,41 @@ private:
     bool                    stop;
 };
 
+// lowers the priority of the calling thread (background work which must not
+// compete with the audio threads of the server)
+inline void SetCurrentThreadLowPriority()
+{
+#ifdef _WIN32
+    SetThreadPriority ( GetCurrentThread(), THREAD_PRIORITY_LOWEST );
+#elif defined( __linux__ )
+    // the static priority of SCHED_OTHER threads is always zero, the nice value
+    // is per thread on Linux
+    setpriority ( PRIO_PROCESS, static_cast<id_t> ( syscall ( SYS_gettid ) ), 10 );
+#else
+    int         iPolicy;
+    sched_param Param;
+
+    if ( pthread_getschedparam ( pthread_self(), &iPolicy, &Param ) == 0 )
+    {
+        Param.sched_priority = sched_get_priority_min ( iPolicy );
+        pthread_setschedparam ( pthread_self(), iPolicy, &Param );
+    }
+#endif
+}
+
 // the constructor just launches some amount of workers
-inline CThreadPool::CThreadPool ( size_t threads ) : stop ( false )
+inline CThreadPool::CThreadPool ( size_t threads, const bool bLowPriority ) : stop ( false )
 {
     for ( size_t i = 0; i < threads; ++i )
     {
-        workers.emplace_back ( [this] {
+        workers.emplace_back ( [this, bLowPriority] {
+            CTraceEvents::SetThreadName ( "thread pool" );
+
+            if ( bLowPriority )
+            {
+                SetCurrentThreadLowPriority();
+            }
+
             for ( ;; )
             {
                 std::function<void()> task;
@@ -79,6 +121,7 @@ inline CThreadPool::CThreadPool ( size_t threads ) : stop ( false )
                     this->tasks.pop();
                 }
 
+                CTraceScope TraceScope ( "thread pool/task" );
                 task();
             }
         } );
@@ -0,0 +1,226 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include "global.h"
+#include "traceevents.h"
+
+/* Implementation *************************************************************/
+static QElapsedTimer StartedClock()
+{
+    QElapsedTimer Timer;
+    Timer.start();
+    return Timer;
+}
+
+std::atomic<bool>         CTraceEvents::bEnabled ( false );
+std::atomic<int>          CTraceEvents::iGeneration ( 0 );
+std::atomic<int64_t>      CTraceEvents::iStartNs ( 0 );
+std::atomic<int>          CTraceEvents::iNumThreads ( 0 );
+CTraceEvents::SThreadRing CTraceEvents::ThreadRings[TRACE_EVENTS_MAX_NUM_THREADS];
+const QElapsedTimer       CTraceEvents::Clock = StartedClock();
+
+// ring buffer of the calling thread (INVALID_INDEX if not yet assigned, -2 if
+// all ring buffers are in use) and the name given for the calling thread
+static thread_local int         iCurThreadRing   = INVALID_INDEX;
+static thread_local const char* strCurThreadName = nullptr;
+
+void CTraceEvents::Enable()
+{
+    if ( IsEnabled() )
+    {
+        return;
+    }
+
+    // the memory is allocated once so that no allocation is needed while recording
+    // (no thread records events before the tracing was enabled the first time)
+    if ( ThreadRings[0].vecEvents.empty() )
+    {
+        for ( int i = 0; i < TRACE_EVENTS_MAX_NUM_THREADS; i++ )
+        {
+            ThreadRings[i].vecEvents.resize ( TRACE_EVENTS_RING_SIZE );
+            ThreadRings[i].iNumEvents.store ( 0, std::memory_order_relaxed );
+            ThreadRings[i].iGeneration.store ( 0, std::memory_order_relaxed );
+        }
+    }
+
+    // the events of previous generations are discarded by the owning threads (an
+    // event which is still being recorded into a previous generation is discarded
+    // with the ring buffer)
+    iStartNs.store ( Now(), std::memory_order_relaxed );
+    iGeneration.fetch_add ( 1, std::memory_order_release );
+
+    bEnabled.store ( true, std::memory_order_release );
+}
+
+void CTraceEvents::Disable() { bEnabled.store ( false, std::memory_order_release ); }
+
+void CTraceEvents::SetThreadName ( const char* strName )
+{
+    strCurThreadName = strName;
+
+    if ( iCurThreadRing >= 0 )
+    {
+        ThreadRings[iCurThreadRing].strThreadName = strName;
+    }
+}
+
+CTraceEvents::SThreadRing* CTraceEvents::GetThreadRing()
+{
+    // the ring buffer of a thread is kept for the lifetime of the application
+    if ( iCurThreadRing == INVALID_INDEX )
+    {
+        const int iNewThreadRing = iNumThreads.fetch_add ( 1, std::memory_order_relaxed );
+
+        if ( iNewThreadRing < TRACE_EVENTS_MAX_NUM_THREADS )
+        {
+            ThreadRings[iNewThreadRing].strThreadName = strCurThreadName;
+            iCurThreadRing                            = iNewThreadRing;
+        }
+        else
+        {
+            // only the first thread without a ring buffer reports it
+            if ( iNewThreadRing == TRACE_EVENTS_MAX_NUM_THREADS )
+            {
+                qWarning() << "trace events: more than" << TRACE_EVENTS_MAX_NUM_THREADS << "threads, the events of further threads are not recorded";
+            }
+
+            iCurThreadRing = -2;
+        }
+    }
+
+    return ( iCurThreadRing >= 0 ) ? &ThreadRings[iCurThreadRing] : nullptr;
+}
+
+void CTraceEvents::Put ( const char cPhase, const char* strName, const int64_t iValue )
+{
+    SThreadRing* pThreadRing = GetThreadRing();
+
+    if ( pThreadRing == nullptr )
+    {
+        return;
+    }
+
+    // only the owning thread writes into the ring buffer, the events of a previous
+    // generation are discarded before the ring buffer is marked as current
+    const int iCurGeneration = iGeneration.load ( std::memory_order_acquire );
+
+    if ( pThreadRing->iGeneration.load ( std::memory_order_relaxed ) != iCurGeneration )
+    {
+        pThreadRing->iNumEvents.store ( 0, std::memory_order_relaxed );
+        pThreadRing->iGeneration.store ( iCurGeneration, std::memory_order_release );
+    }
+
+    const int64_t iNumEvents = pThreadRing->iNumEvents.load ( std::memory_order_relaxed );
+    SEvent&       Event      = pThreadRing->vecEvents[iNumEvents & ( TRACE_EVENTS_RING_SIZE - 1 )];
+
+    Event.iTimeNs = Now();
+    Event.iValue  = iValue;
+    Event.strName = strName;
+    Event.cPhase  = cPhase;
+
+    // complete events are stored with their start time
+    if ( cPhase == 'X' )
+    {
+        Event.iTimeNs -= iValue;
+    }
+
+    pThreadRing->iNumEvents.store ( iNumEvents + 1, std::memory_order_release );
+}
+
+bool CTraceEvents::WriteChromeTrace ( const QString& strFileName )
+{
+    QFile File ( strFileName );
+
+    if ( !File.open ( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+    {
+        return false;
+    }
+
+    QTextStream   Stream ( &File );
+    const int     iCurNumThreads = std::min ( iNumThreads.load ( std::memory_order_relaxed ), TRACE_EVENTS_MAX_NUM_THREADS );
+    const int     iCurGeneration = iGeneration.load ( std::memory_order_acquire );
+    const int64_t iCurStartNs    = iStartNs.load ( std::memory_order_relaxed );
+
+    Stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    Stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"" << APP_NAME << "\"}}";
+
+    for ( int iThread = 0; iThread < iCurNumThreads; iThread++ )
+    {
+        const SThreadRing& ThreadRing = ThreadRings[iThread];
+        const QString      strThreadName =
+            ( ThreadRing.strThreadName != nullptr ) ? QString ( ThreadRing.strThreadName ) : QString ( "thread %1" ).arg ( iThread );
+
+        Stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << iThread << ",\"args\":{\"name\":\"" << strThreadName << "\"}}";
+
+        // the thread has not recorded an event since the tracing was enabled
+        if ( ThreadRing.iGeneration.load ( std::memory_order_acquire ) != iCurGeneration )
+        {
+            continue;
+        }
+
+        // the events up to the write index are complete, but a thread which passed the
+        // enabled check before the tracing was disabled may still be recording the event
+        // at the write index, which overwrites the oldest event if the ring buffer has
+        // wrapped around, so this slot is skipped (only the last events are available
+        // if the ring buffer has wrapped around)
+        const int64_t iNumEvents = ThreadRing.iNumEvents.load ( std::memory_order_acquire );
+
+        for ( int64_t i = std::max ( static_cast<int64_t> ( 0 ), iNumEvents - TRACE_EVENTS_RING_SIZE + 1 ); i < iNumEvents; i++ )
+        {
+            const SEvent& Event = ThreadRing.vecEvents[i & ( TRACE_EVENTS_RING_SIZE - 1 )];
+
+            // skip complete events which started before the tracing was enabled
+            if ( Event.iTimeNs < iCurStartNs )
+            {
+                continue;
+            }
+
+            // the time stamps are given in us relative to the start of the tracing
+            Stream << ",\n{\"name\":\"" << Event.strName << "\",\"ph\":\"" << Event.cPhase << "\",\"pid\":1,\"tid\":" << iThread
+                   << ",\"ts\":" << QString::number ( static_cast<double> ( Event.iTimeNs - iCurStartNs ) / 1000, 'f', 3 );
+
+            switch ( Event.cPhase )
+            {
+            case 'X':
+                Stream << ",\"dur\":" << QString::number ( static_cast<double> ( Event.iValue ) / 1000, 'f', 3 ) << "}";
+                break;
+
+            case 'C':
+                Stream << ",\"args\":{\"value\":" << Event.iValue << "}}";
+                break;
+
+            default:
+                Stream << ",\"s\":\"t\"}";
+                break;
+            }
+        }
+    }
+
+    Stream << "\n]}\n";
+
+    return Stream.status() == QTextStream::Ok;
+}
@@ -0,0 +1,137 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2022
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+#include <vector>
+
+/* Definitions ****************************************************************/
+// maximum number of threads which record trace events
+#define TRACE_EVENTS_MAX_NUM_THREADS 32
+
+// number of trace events kept per thread (must be a power of two), the oldest
+// events are overwritten
+#define TRACE_EVENTS_RING_SIZE 32768
+
+/* Classes ********************************************************************/
+// Timeline of events of all threads which can be written in the Chrome trace
+// event format (to be loaded in chrome://tracing or https://ui.perfetto.dev).
+// Each thread writes into its own ring buffer without locking or allocating
+// memory, so the events can be recorded in the audio path. If tracing is
+// disabled, recording an event is a single atomic load. The event names must
+// be string literals since only the pointers are stored.
+// Enabling the tracing again starts a new generation: the ring buffers are not
+// touched by the enabling thread, each thread discards its own events of a
+// previous generation when it records its next event and the export skips the
+// ring buffers of threads which have not done so yet.
+class CTraceEvents
+{
+public:
+    static void Enable();
+    static void Disable();
+    static bool IsEnabled() { return bEnabled.load ( std::memory_order_acquire ); }
+
+    // the name shown for the calling thread (may be set before tracing is enabled)
+    static void SetThreadName ( const char* strName );
+
+    static int64_t Now() { return Clock.nsecsElapsed(); }
+
+    // an event which ends now and took the given time
+    static void Complete ( const char* strName, const int64_t iDurationNs )
+    {
+        if ( IsEnabled() )
+        {
+            Put ( 'X', strName, iDurationNs );
+        }
+    }
+
+    static void Counter ( const char* strName, const int64_t iValue )
+    {
+        if ( IsEnabled() )
+        {
+            Put ( 'C', strName, iValue );
+        }
+    }
+
+    static void Instant ( const char* strName )
+    {
+        if ( IsEnabled() )
+        {
+            Put ( 'i', strName, 0 );
+        }
+    }
+
+    // must be called after the tracing was disabled: each thread can then only finish
+    // the event it is currently recording, which is not written to the file
+    static bool WriteChromeTrace ( const QString& strFileName );
+
+protected:
+    struct SEvent
+    {
+        int64_t     iTimeNs;
+        int64_t     iValue; // duration for complete events
+        const char* strName;
+        char        cPhase;
+    };
+
+    struct SThreadRing
+    {
+        std::atomic<int64_t> iNumEvents;
+        std::atomic<int>     iGeneration; // generation of the recorded events
+        const char*          strThreadName;
+        std::vector<SEvent>  vecEvents;
+    };
+
+    static void         Put ( const char cPhase, const char* strName, const int64_t iValue );
+    static SThreadRing* GetThreadRing();
+
+    static std::atomic<bool>    bEnabled;
+    static std::atomic<int>     iGeneration;
+    static std::atomic<int64_t> iStartNs; // time at which the current generation was started
+    static std::atomic<int>     iNumThreads;
+    static SThreadRing          ThreadRings[TRACE_EVENTS_MAX_NUM_THREADS];
+    static const QElapsedTimer  Clock; // started once, never restarted
+};
+
+// records a complete event for the lifetime of the object
+class CTraceScope
+{
+public:
+    CTraceScope ( const char* strNName ) : strName ( strNName ), iStartNs ( CTraceEvents::IsEnabled() ? CTraceEvents::Now() : -1 ) {}
+
+    ~CTraceScope()
+    {
+        if ( iStartNs >= 0 )
+        {
+            CTraceEvents::Complete ( strName, CTraceEvents::Now() - iStartNs );
+        }
+    }
+
+protected:
+    const char*   strName;
+    const int64_t iStartNs;
+};
@@ -124,6 +124,49 @@ double CStereoSignalLevelMeter::CalcLogResultForMeter ( const double& dLinearLev
 }
 
 // CRC -------------------------------------------------------------------------
+/*
+    CRC-16 with the generator polynomial x^16 + x^12 + x^5 + 1, the shift
+    register is initialized with ones, the input bits are processed MSB first
+    and the result is inverted.
+    Instead of shifting each single bit through the register, lookup tables
+    are used. Table 0 holds the register update for one input byte, table k
+    the update for one input byte followed by k zero bytes. With these tables
+    four input bytes can be processed at once ("slice-by-4").
+*/
+class CCRCTables
+{
+public:
+    CCRCTables()
+    {
+        for ( int iByte = 0; iByte < 256; iByte++ )
+        {
+            uint32_t iReg = static_cast<uint32_t> ( iByte ) << 8;
+
+            for ( int i = 0; i < 8; i++ )
+            {
+                // shift register and add polynomial if bit 15 was shifted out
+                iReg = ( iReg & 0x8000 ) ? ( ( iReg << 1 ) ^ 0x1021 ) : ( iReg << 1 );
+            }
+
+            iTab[0][iByte] = static_cast<uint16_t> ( iReg );
+        }
+
+        for ( int iSlice = 1; iSlice < 4; iSlice++ )
+        {
+            for ( int iByte = 0; iByte < 256; iByte++ )
+            {
+                const uint32_t iPrev = iTab[iSlice - 1][iByte];
+
+                iTab[iSlice][iByte] = static_cast<uint16_t> ( ( iPrev << 8 ) ^ iTab[0][iPrev >> 8] );
+            }
+        }
+    }
+
+    uint16_t iTab[4][256];
+};
+
+static const CCRCTables CRCTables;
+
 void CCRC::Reset()
 {
     // init state shift-register with ones. Set all registers to "1" with
@@ -133,30 +176,26 @@ void CCRC::Reset()
 
 void CCRC::AddByte ( const uint8_t byNewInput )
 {
-    for ( int i = 0; i < 8; i++ )
-    {
-        // shift bits in shift-register for transition
-        iStateShiftReg <<= 1;
+    // note that only the lower 16 bits of the shift-register are relevant
+    iStateShiftReg = ( iStateShiftReg << 8 ) ^ CRCTables.iTab[0][( ( iStateShiftReg >> 8 ) ^ byNewInput ) & 0xFF];
+}
 
-        // take bit, which was shifted out of the register-size and place it
-        // at the beginning (LSB)
-        // (If condition is not satisfied, implicitly a "0" is added)
-        if ( ( iStateShiftReg & iBitOutMask ) > 0 )
-        {
-            iStateShiftReg |= 1;
-        }
+void CCRC::AddBytes ( const uint8_t* pbyNewInput, const int iNumBytes )
+{
+    int i = 0;
 
-        // add new data bit to the LSB
-        if ( ( byNewInput & ( 1 << ( 8 - i - 1 ) ) ) > 0 )
-        {
-            iStateShiftReg ^= 1;
-        }
+    // process blocks of four bytes
+    for ( ; i + 4 <= iNumBytes; i += 4 )
+    {
+        iStateShiftReg = CRCTables.iTab[3][( ( iStateShiftReg >> 8 ) ^ pbyNewInput[i] ) & 0xFF] ^
+                         CRCTables.iTab[2][( iStateShiftReg ^ pbyNewInput[i + 1] ) & 0xFF] ^ CRCTables.iTab[1][pbyNewInput[i + 2]] ^
+                         CRCTables.iTab[0][pbyNewInput[i + 3]];
+    }
 
-        // add mask to shift-register if first bit is true
-        if ( iStateShiftReg & 1 )
-        {
-            iStateShiftReg ^= iPoly;
-        }
+    // remaining bytes
+    for ( ; i < iNumBytes; i++ )
+    {
+        AddByte ( pbyNewInput[i] );
     }
 }
 
@@ -165,8 +204,8 @@ uint32_t CCRC::GetCRC()
     // return inverted shift-register (1's complement)
     iStateShiftReg = ~iStateShiftReg;
 
-    // remove bit which where shifted out of the shift-register frame
-    return iStateShiftReg & ( iBitOutMask - 1 );
+    // remove bits which are outside the 16 bit shift-register frame
+    return iStateShiftReg & 0xFFFF;
 }
 
 /******************************************************************************\
@@ -374,6 +413,271 @@ void CAudioReverb::Process ( CVector<int16_t>& vecsStereoInOut, const bool bReve
     }
 }
 
+// MixUtils implementation *****************************************************
+void MixUtils::AddToMono ( CVector<float>&         vecfMix,
+                           const CVector<int16_t>& vecsData,
+                           const int               iNumAudioChannels,
+                           const float             fGain,
+                           const int               iFrameSizeSamples )
+{
+    int i, k;
+
+    // if channel gain is 1, avoid multiplication for speed optimization
+    if ( fGain == 1.0f )
+    {
+        if ( iNumAudioChannels == 1 )
+        {
+            // mono
+            for ( i = 0; i < iFrameSizeSamples; i++ )
+            {
+                vecfMix[i] += vecsData[i];
+            }
+        }
+        else
+        {
+            // stereo: apply stereo-to-mono attenuation
+            for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
+            {
+                vecfMix[i] += ( static_cast<float> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
+            }
+        }
+    }
+    else
+    {
+        if ( iNumAudioChannels == 1 )
+        {
+            // mono
+            for ( i = 0; i < iFrameSizeSamples; i++ )
+            {
+                vecfMix[i] += vecsData[i] * fGain;
+            }
+        }
+        else
+        {
+            // stereo: apply stereo-to-mono attenuation
+            for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
+            {
+                vecfMix[i] += fGain * ( static_cast<float> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
+            }
+        }
+    }
+}
+
+void MixUtils::AddToStereo ( CVector<float>&         vecfMix,
+                             const CVector<int16_t>& vecsData,
+                             const int               iNumAudioChannels,
+                             const float             fGainL,
+                             const float             fGainR,
+                             const int               iFrameSizeSamples )
+{
+    int i, k;
+
+    if ( iNumAudioChannels == 1 )
+    {
+        // mono: copy same mono data in both out stereo audio channels
+        for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
+        {
+            vecfMix[k] += vecsData[i] * fGainL;
+            vecfMix[k + 1] += vecsData[i] * fGainR;
+        }
+    }
+    else
+    {
+        // stereo: even samples are the left, odd samples the right channel
+        for ( i = 0; i < ( 2 * iFrameSizeSamples ); i += 2 )
+        {
+            vecfMix[i] += vecsData[i] * fGainL;
+            vecfMix[i + 1] += vecsData[i + 1] * fGainR;
+        }
+    }
+}
+
+void MixUtils::AddToStereoDelayPan ( CVector<float>&         vecfMix,
+                                     const CVector<int16_t>& vecsData,
+                                     const CVector<int16_t>& vecsDataPrev,
+                                     const int               iNumAudioChannels,
+                                     const float             fGain,
+                                     const int               iPanDelL,
+                                     const int               iPanDelR,
+                                     const int               iFrameSizeSamples )
+{
+    int i, k, iLpan, iRpan, iPan;
+
+    if ( iNumAudioChannels == 1 )
+    {
+        // mono: copy same mono data in both out stereo audio channels
+        for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
+        {
+            // pan address shift
+
+            // left channel
+            iLpan = i - iPanDelL;
+            if ( iLpan < 0 )
+            {
+                // get from second
+                iLpan = iLpan + iFrameSizeSamples;
+                vecfMix[k] += vecsDataPrev[iLpan] * fGain;
+            }
+            else
+            {
+                vecfMix[k] += vecsData[iLpan] * fGain;
+            }
+
+            // right channel
+            iRpan = i - iPanDelR;
+            if ( iRpan < 0 )
+            {
+                // get from second
+                iRpan = iRpan + iFrameSizeSamples;
+                vecfMix[k + 1] += vecsDataPrev[iRpan] * fGain;
+            }
+            else
+            {
+                vecfMix[k + 1] += vecsData[iRpan] * fGain;
+            }
+        }
+    }
+    else
+    {
+        // stereo
+        for ( i = 0; i < ( 2 * iFrameSizeSamples ); i++ )
+        {
+            // pan address shift
+            if ( ( i & 1 ) == 0 )
+            {
+                iPan = i - 2 * iPanDelL; // if even : left channel
+            }
+            else
+            {
+                iPan = i - 2 * iPanDelR; // if odd  : right channel
+            }
+
+            // interleaved channels
+            if ( iPan < 0 )
+            {
+                // get from second
+                iPan = iPan + 2 * iFrameSizeSamples;
+                vecfMix[i] += vecsDataPrev[iPan] * fGain;
+            }
+            else
+            {
+                vecfMix[i] += vecsData[iPan] * fGain;
+            }
+        }
+    }
+}
+
+void MixUtils::ConvertToShort ( const CVector<float>& vecfMix, CVector<int16_t>& vecsOut, const int iNumSamples )
+{
+    // convert from float to short with clipping
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        vecsOut[i] = Float2Short ( vecfMix[i] );
+    }
+}
+
+// CTimingHistogram implementation *********************************************
+void CTimingHistogram::Reset()
+{
+    for ( int i = 0; i < TIMING_HIST_NUM_BUCKETS; i++ )
+    {
+        veciBuckets[i].store ( 0, std::memory_order_relaxed );
+    }
+
+    iCount.store ( 0, std::memory_order_relaxed );
+    iSumNs.store ( 0, std::memory_order_relaxed );
+    iMaxNs.store ( 0, std::memory_order_relaxed );
+}
+
+void CTimingHistogram::Add ( const int64_t iValueNs )
+{
+    const int64_t iMaxValueNs     = ( static_cast<int64_t> ( 1 ) << TIMING_HIST_MAX_VALUE_BITS ) - 1;
+    const int64_t iClippedValueNs = std::max ( static_cast<int64_t> ( 0 ), std::min ( iValueNs, iMaxValueNs ) );
+
+    veciBuckets[GetBucketIndex ( iClippedValueNs )].fetch_add ( 1, std::memory_order_relaxed );
+    iCount.fetch_add ( 1, std::memory_order_relaxed );
+    iSumNs.fetch_add ( iClippedValueNs, std::memory_order_relaxed );
+
+    // there is only one writer, therefore no compare and swap loop is needed for the maximum
+    if ( iClippedValueNs > iMaxNs.load ( std::memory_order_relaxed ) )
+    {
+        iMaxNs.store ( iClippedValueNs, std::memory_order_relaxed );
+    }
+}
+
+double CTimingHistogram::GetMeanNs() const
+{
+    const int64_t iCurCount = GetCount();
+
+    if ( iCurCount == 0 )
+    {
+        return 0;
+    }
+
+    return static_cast<double> ( iSumNs.load ( std::memory_order_relaxed ) ) / iCurCount;
+}
+
+int64_t CTimingHistogram::GetPercentileNs ( const double dPercentile ) const
+{
+    // the counters may be updated while reading, therefore the total is taken from the buckets
+    CVector<int64_t> veciCurBuckets ( TIMING_HIST_NUM_BUCKETS );
+    int64_t          iTotal = 0;
+
+    for ( int i = 0; i < TIMING_HIST_NUM_BUCKETS; i++ )
+    {
+        veciCurBuckets[i] = veciBuckets[i].load ( std::memory_order_relaxed );
+        iTotal += veciCurBuckets[i];
+    }
+
+    if ( iTotal == 0 )
+    {
+        return 0;
+    }
+
+    const int64_t iRank = std::max ( static_cast<int64_t> ( 1 ), static_cast<int64_t> ( ceil ( dPercentile / 100 * iTotal ) ) );
+    int64_t       iSum  = 0;
+
+    for ( int i = 0; i < TIMING_HIST_NUM_BUCKETS; i++ )
+    {
+        iSum += veciCurBuckets[i];
+
+        if ( iSum >= iRank )
+        {
+            // the bucket upper value may exceed the largest value actually added
+            return std::min ( GetBucketUpperValue ( i ), GetMaxNs() );
+        }
+    }
+
+    return GetMaxNs();
+}
+
+int CTimingHistogram::GetBucketIndex ( const int64_t iValueNs )
+{
+    // small values are stored exactly, larger values with the sub bucket resolution
+    // of their power of two
+    int iShift = 0;
+
+    while ( ( iValueNs >> iShift ) >= ( 2 << TIMING_HIST_SUB_BUCKET_BITS ) )
+    {
+        iShift++;
+    }
+
+    return ( iShift << TIMING_HIST_SUB_BUCKET_BITS ) + static_cast<int> ( iValueNs >> iShift );
+}
+
+int64_t CTimingHistogram::GetBucketUpperValue ( const int iIndex )
+{
+    if ( iIndex < ( 2 << TIMING_HIST_SUB_BUCKET_BITS ) )
+    {
+        return iIndex;
+    }
+
+    const int iShift     = ( iIndex >> TIMING_HIST_SUB_BUCKET_BITS ) - 1;
+    const int iSubBucket = iIndex - ( iShift << TIMING_HIST_SUB_BUCKET_BITS );
+
+    return ( static_cast<int64_t> ( iSubBucket + 1 ) << iShift ) - 1;
+}
+
 // CHighPrecisionTimer implementation ******************************************
 #ifdef _WIN32
 CHighPrecisionTimer::CHighPrecisionTimer ( const bool bNewUseDoubleSystemFrameSize ) : bUseDoubleSystemFrameSize ( bNewUseDoubleSystemFrameSize )
@@ -527,10 +831,13 @@ void CHighPrecisionTimer::Stop()
 
 void CHighPrecisionTimer::run()
 {
+    CTraceEvents::SetThreadName ( "timer" );
+
     // loop until the thread shall be terminated
     while ( bRun )
     {
         // call processing routine by fireing signal
+        CTraceEvents::Instant ( "timer/tick" );
 
         //### TODO: BEGIN ###//
         // by emit a signal we leave the high priority thread -> maybe use some
@@ -25,6 +25,7 @@
 #pragma once
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #ifdef _WIN32
 #    include <winsock2.h>
 #    include <ws2tcpip.h>
@@ -72,6 +73,7 @@
 #endif
 
 #include "global.h"
+#include "traceevents.h"
 
 #ifndef SERVER_ONLY
 class CClient; // forward declaration of CClient
@@ -505,6 +507,52 @@ enum ERecorderState
     RS_RECORDING       = 3
 };
 
+// Server jam recorder file format enum ----------------------------------------
+enum ERecordingFormat
+{
+    RF_WAV  = 0, // 16 bit PCM RIFF WAVE
+    RF_OPUS = 1, // Ogg/Opus
+    RF_FLAC = 2  // FLAC
+};
+
+inline QString RecordingFormatToFileExtension ( const ERecordingFormat eRecordingFormat )
+{
+    switch ( eRecordingFormat )
+    {
+    case RF_OPUS:
+        return ".opus";
+
+    case RF_FLAC:
+        return ".flac";
+
+    default: // RF_WAV
+        return ".wav";
+    }
+}
+
+// returns true if the file name does not have the extension of any recording format
+inline bool GetRecordingFormatFromFileName ( const QString& strFileName, ERecordingFormat& eRecordingFormat )
+{
+    for ( const ERecordingFormat eFormat : { RF_WAV, RF_OPUS, RF_FLAC } )
+    {
+        if ( strFileName.endsWith ( RecordingFormatToFileExtension ( eFormat ) ) )
+        {
+            eRecordingFormat = eFormat;
+            return false;
+        }
+    }
+
+    return true; // return error code
+}
+
+// Server jam recorder mixdown track enum --------------------------------------
+enum ERecordingMixdown
+{
+    RM_NONE   = 0, // client tracks only
+    RM_STEREO = 1, // additional mixdown track, clients keep their stereo image
+    RM_CENTRE = 2  // additional mixdown track, all clients panned to the centre
+};
+
 // Channel sort type -----------------------------------------------------------
 enum EChSortType
 {
@@ -1081,16 +1129,15 @@ protected:
 class CCRC
 {
 public:
-    CCRC() : iPoly ( ( 1 << 5 ) | ( 1 << 12 ) ), iBitOutMask ( 1 << 16 ) { Reset(); }
+    CCRC() { Reset(); }
 
     void     Reset();
     void     AddByte ( const uint8_t byNewInput );
+    void     AddBytes ( const uint8_t* pbyNewInput, const int iNumBytes );
     bool     CheckCRC ( const uint32_t iCRC ) { return iCRC == GetCRC(); }
     uint32_t GetCRC();
 
 protected:
-    uint32_t iPoly;
-    uint32_t iBitOutMask;
     uint32_t iStateShiftReg;
 };
 
@@ -1153,6 +1200,43 @@ public:
     }
 };
 
+// Audio mixing utilities ------------------------------------------------------
+// The mixing kernels of the server: one source frame (mono or interleaved
+// stereo) is added to the floating point mix of a target channel.
+class MixUtils
+{
+public:
+    // mono target, stereo sources are mixed down with the stereo-to-mono attenuation
+    static void AddToMono ( CVector<float>&         vecfMix,
+                            const CVector<int16_t>& vecsData,
+                            const int               iNumAudioChannels,
+                            const float             fGain,
+                            const int               iFrameSizeSamples );
+
+    // stereo target, mono sources are copied to both channels
+    static void AddToStereo ( CVector<float>&         vecfMix,
+                              const CVector<int16_t>& vecsData,
+                              const int               iNumAudioChannels,
+                              const float             fGainL,
+                              const float             fGainR,
+                              const int               iFrameSizeSamples );
+
+    // stereo target with delay panning: the panned away channel is delayed
+    // instead of attenuated, the samples delayed out of the current frame
+    // vecsData are taken from the previous frame vecsDataPrev
+    static void AddToStereoDelayPan ( CVector<float>&         vecfMix,
+                                      const CVector<int16_t>& vecsData,
+                                      const CVector<int16_t>& vecsDataPrev,
+                                      const int               iNumAudioChannels,
+                                      const float             fGain,
+                                      const int               iPanDelL,
+                                      const int               iPanDelR,
+                                      const int               iFrameSizeSamples );
+
+    // convert the mix to 16 bit with clipping
+    static void ConvertToShort ( const CVector<float>& vecfMix, CVector<int16_t>& vecsOut, const int iNumSamples );
+};
+
 /******************************************************************************\
 * Timing measurement                                                           *
 \******************************************************************************/
@@ -1211,6 +1295,36 @@ protected:
     int           iCnt;
 };
 
+// log-linear (HDR style) histogram of durations in ns with a relative precision
+// of about 6 %, values are added from one thread and may be read from any
+// other thread without locking
+#define TIMING_HIST_SUB_BUCKET_BITS 4  // 16 sub buckets per power of two
+#define TIMING_HIST_MAX_VALUE_BITS  31 // values are clipped at about 2 s
+#define TIMING_HIST_NUM_BUCKETS     ( ( TIMING_HIST_MAX_VALUE_BITS - TIMING_HIST_SUB_BUCKET_BITS + 1 ) << TIMING_HIST_SUB_BUCKET_BITS )
+
+class CTimingHistogram
+{
+public:
+    CTimingHistogram() { Reset(); }
+
+    void Reset();
+    void Add ( const int64_t iValueNs );
+
+    int64_t GetCount() const { return iCount.load ( std::memory_order_relaxed ); }
+    int64_t GetMaxNs() const { return iMaxNs.load ( std::memory_order_relaxed ); }
+    double  GetMeanNs() const;
+    int64_t GetPercentileNs ( const double dPercentile ) const;
+
+protected:
+    static int     GetBucketIndex ( const int64_t iValueNs );
+    static int64_t GetBucketUpperValue ( const int iIndex );
+
+    std::atomic<int64_t> veciBuckets[TIMING_HIST_NUM_BUCKETS];
+    std::atomic<int64_t> iCount;
+    std::atomic<int64_t> iSumNs;
+    std::atomic<int64_t> iMaxNs;
+};
+
 // High resolution timer
 #if ( defined( WIN32 ) || defined( _WIN32 ) )
 // using QTimer for Windows